@@ -61,15 +61,76 @@ set(API_HEADERS
     deeprey-api/visualization/DpColorBar.h
 )
 
-# Core plugin files
-set(CORE_SOURCES
-    src/DpGrib_pi.cpp
-    src/GribOverlayFactory.cpp
+# GRIB decoding, records and their index, interpolation and derived fields.
+# Built as the grib_core static library, free of wxWidgets, OpenCPN and GL,
+# which the plugin links
+set(GRIB_CORE_SOURCES
     src/GribReader.cpp
     src/GribRecord.cpp
     src/GribV1Record.cpp
     src/GribV2Record.cpp
+    src/GribRecordSetBuilder.cpp
+    src/GribDecodeStats.cpp
+    src/GribWriter.cpp
+    src/GribExporter.cpp
+    src/GribCache.cpp
+    src/GribDirectoryWatcher.cpp
+    src/GribTimeIndex.cpp
+    src/GribResidency.cpp
+    src/GribGridCodec.cpp
+    src/GribScratch.cpp
+    src/IsoLineTracer.cpp
+    src/zuFile.cpp
+)
+
+set(GRIB_CORE_HEADERS
+    include/GribReader.h
+    include/GribRecord.h
+    include/GribRecordSet.h
+    include/GribRecordSetBuilder.h
+    include/GribV1Record.h
+    include/GribV2Record.h
+    include/GribDecodeStats.h
+    include/GribWriter.h
+    include/GribExporter.h
+    include/GribCache.h
+    include/GribDirectoryWatcher.h
+    include/GribTimeIndex.h
+    include/GribResidency.h
+    include/GribMemoryUsage.h
+    include/GribGridCodec.h
+    include/GribScratch.h
+    include/IsoLineTracer.h
+    include/zuFile.h
+)
+
+# Command line tools built on grib_core
+set(GRIB_BENCH_SOURCES
+    tools/GribBench.cpp
+)
+
+set(GRIB_GEN_SOURCES
+    tools/GribGen.cpp
+)
+
+# Tests of grib_core, an executable each, as NAME:SOURCE. Each is run as
+# grib-test-NAME DIR, DIR being where it may write files
+set(GRIB_TESTS
+    budget:tests/GribBudgetTest.cpp
+    cache:tests/GribCacheTest.cpp
+    codec:tests/GribGridCodecTest.cpp
+    isoline:tests/IsoLineTracerTest.cpp
+    residency:tests/GribResidencyTest.cpp
+    timeindex:tests/GribTimeIndexTest.cpp
+    watcher:tests/GribDirectoryWatcherTest.cpp
+)
+
+# Core plugin files
+set(CORE_SOURCES
+    src/DpGrib_pi.cpp
+    src/GribOverlayFactory.cpp
     src/GribUIDialog.cpp
+    src/GribTimelineWorker.cpp
     src/GribUIDialogBase.cpp
     src/GribRequestDialog.cpp
     src/GribSettingsDialog.cpp
@@ -77,23 +138,26 @@ set(CORE_SOURCES
     src/CustomGrid.cpp
     src/CursorData.cpp
     src/IsoLine.cpp
+    src/IsoLineWorker.cpp
+    src/GribScreenSampler.cpp
+    src/GribBatchSampler.cpp
+    src/GribRouteSampler.cpp
+    src/GribDatasetSnapshot.cpp
+    src/GribValuesMessage.cpp
+    src/GribEventBus.cpp
     src/XyGribPanel.cpp
     src/XyGribModelDef.cpp
     src/email.cpp
     src/GrabberWin.cpp
-    src/zuFile.cpp
     src/GribColorBarAdapter.cpp
 )
 
 set(CORE_HEADERS
     include/DpGrib_pi.h
     include/GribOverlayFactory.h
-    include/GribReader.h
-    include/GribRecord.h
-    include/GribRecordSet.h
-    include/GribV1Record.h
-    include/GribV2Record.h
     include/GribUIDialog.h
+    include/GribTimelineWorker.h
+    include/GribPlaybackStats.h
     include/GribUIDialogBase.h
     include/GribRequestDialog.h
     include/GribSettingsDialog.h
@@ -101,11 +165,23 @@ set(CORE_HEADERS
     include/CustomGrid.h
     include/CursorData.h
     include/IsoLine.h
+    include/IsoLineWorker.h
+    include/GribScreenSampler.h
+    include/GribBatchSampler.h
+    include/GribSampleQuery.h
+    include/GribRouteSampler.h
+    include/GribRoute.h
+    include/GribExport.h
+    include/GribDatasetSnapshot.h
+    include/GribDataset.h
+    include/GribGridView.h
+    include/GribValuesMessage.h
+    include/GribEventBus.h
+    include/GribEvent.h
     include/XyGribPanel.h
     include/XyGribModelDef.h
     include/email.h
     include/GrabberWin.h
-    include/zuFile.h
     include/icons.h
     include/msg.h
     include/GribColorBarAdapter.h
@@ -117,6 +193,7 @@ set(GL_SOURCES
     src/pi_shaders.cpp
     src/grib_shaders.cpp
     src/DpGribGPUParticles.cpp
+    src/GribGLBatch.cpp
     src/pi_TexFont.cpp
     src/icons.cpp
 )
@@ -126,6 +203,7 @@ set(GL_HEADERS
     include/pi_shaders.h
     include/grib_shaders.h
     include/DpGribGPUParticles.h
+    include/GribGLBatch.h
     include/pi_TexFont.h
     include/pi_gl.h
     include/linmath.h
@@ -147,6 +225,10 @@ set(UTIL_HEADERS
 
 source_group("API\\Source" FILES ${API_SOURCES})
 source_group("API\\Headers" FILES ${API_HEADERS})
+source_group("GribCore\\Source" FILES ${GRIB_CORE_SOURCES})
+source_group("GribCore\\Headers" FILES ${GRIB_CORE_HEADERS})
+source_group("Tools\\Source" FILES ${GRIB_BENCH_SOURCES} ${GRIB_GEN_SOURCES})
+source_group("Tests\\Source" FILES tests/GribTest.h)
 source_group("Core\\Source" FILES ${CORE_SOURCES})
 source_group("Core\\Headers" FILES ${CORE_HEADERS})
 source_group("OpenGL\\Source" FILES ${GL_SOURCES})
@@ -178,6 +260,10 @@ set(HEADERS
 
 add_definitions("-DocpnUSE_GL")
 
+# Configure only grib_core and the command line tools, without wxWidgets,
+# OpenCPN or GL: for benchmarks, tooling and server side preprocessing
+option(GRIB_HEADLESS "Build only the wx-free GRIB core and its tools" OFF)
+
 if (MSVC)
     # Enable parallel builds on MSVC
     target_compile_options(${PACKAGE_NAME} PRIVATE /MP)
@@ -242,12 +328,91 @@ macro(add_plugin_libraries)
         target_link_libraries(_DC_UTILS PRIVATE ${GLEW_LIBRARY})
     endif ()
 
+    # Isolines are built on a worker thread
+    find_package(Threads REQUIRED)
+    target_link_libraries(${PACKAGE_NAME} Threads::Threads)
+
     # wxJSON for JSON parsing
     add_subdirectory("${CMAKE_SOURCE_DIR}/opencpn-libs/wxJSON")
     target_link_libraries(${PACKAGE_NAME} ocpn::wxjson)
 
+endmacro()
+
+macro(add_grib_core)
+    # The wx-free GRIB library, see GRIB_CORE_SOURCES
+    add_library(grib_core STATIC ${GRIB_CORE_SOURCES} ${GRIB_CORE_HEADERS})
+    target_include_directories(grib_core PUBLIC ${CMAKE_SOURCE_DIR}/include)
+
+    # GribResidency and the decoders are used from worker threads
+    find_package(Threads REQUIRED)
+    target_link_libraries(grib_core PUBLIC Threads::Threads)
+
     # Jasper for JPEG 2000 support in GRIB files
     add_subdirectory("${CMAKE_SOURCE_DIR}/libs/jasper")
-    target_link_libraries(${PACKAGE_NAME} JASPER)
-    target_include_directories(${PACKAGE_NAME} PRIVATE ${CMAKE_SOURCE_DIR}/libs/jasper/src/include)
+    target_link_libraries(grib_core PRIVATE JASPER)
+    target_include_directories(grib_core PRIVATE ${CMAKE_SOURCE_DIR}/libs/jasper/src/include)
+
+    # zuFile reads gzip and bzip2 files. Inside OpenCPN the plugin may also
+    # resolve them from the host, so zlib is only linked when found
+    find_package(ZLIB)
+    if (ZLIB_FOUND)
+        target_link_libraries(grib_core PUBLIC ZLIB::ZLIB)
+    endif ()
+    find_package(BZip2)
+    if (BZIP2_FOUND)
+        target_link_libraries(grib_core PUBLIC BZip2::BZip2)
+    else ()
+        file(GLOB _bzip2_sources "${CMAKE_SOURCE_DIR}/libs/bzip2/*.c")
+        add_library(grib_bzip2 STATIC ${_bzip2_sources})
+        target_include_directories(grib_bzip2 PUBLIC ${CMAKE_SOURCE_DIR}/libs/bzip2)
+        target_link_libraries(grib_core PUBLIC grib_bzip2)
+    endif ()
+endmacro()
+
+macro(add_grib_tools)
+    # grib-bench, decode and query benchmark: grib-bench --help. grib-gen,
+    # synthetic GRIB files for it: grib-gen --help. Built by default in
+    # GRIB_HEADLESS builds only
+    if (GRIB_HEADLESS)
+        add_executable(grib-bench ${GRIB_BENCH_SOURCES})
+        add_executable(grib-gen ${GRIB_GEN_SOURCES})
+    else ()
+        add_executable(grib-bench EXCLUDE_FROM_ALL ${GRIB_BENCH_SOURCES})
+        add_executable(grib-gen EXCLUDE_FROM_ALL ${GRIB_GEN_SOURCES})
+    endif ()
+    target_link_libraries(grib-bench grib_core)
+    target_link_libraries(grib-gen grib_core)
+
+    # Encode and decode round trips of every packing grib-gen writes, with
+    # and without a bitmap: ctest in a GRIB_HEADLESS build
+    if (GRIB_HEADLESS)
+        enable_testing()
+        foreach (packing grib1:simple grib2:simple grib2:complex
+                 grib2:spatial grib2:ieee grib2:jpeg2000)
+            string(REPLACE ":" ";" parts ${packing})
+            list(GET parts 0 format)
+            list(GET parts 1 method)
+            string(REPLACE "grib" "" edition ${format})
+            foreach (bitmap "" "--bitmap")
+                set(name grib-gen-${format}-${method}${bitmap})
+                string(REPLACE "--" "-" name ${name})
+                add_test(NAME ${name}
+                    COMMAND grib-gen --edition ${edition} --packing ${method}
+                        ${bitmap} --grid 120x61 --step 3 --steps 4
+                        --params wind,pressure,temperature,gust,waves,current
+                        --verify ${CMAKE_CURRENT_BINARY_DIR}/${name}.grb)
+            endforeach ()
+        endforeach ()
+
+        foreach (test ${GRIB_TESTS})
+            string(REPLACE ":" ";" parts ${test})
+            list(GET parts 0 name)
+            list(GET parts 1 source)
+            add_executable(grib-test-${name} ${source} tests/GribTest.h)
+            target_link_libraries(grib-test-${name} grib_core)
+            add_test(NAME grib-test-${name}
+                COMMAND grib-test-${name}
+                    ${CMAKE_CURRENT_BINARY_DIR}/grib-test-${name}.d)
+        endforeach ()
+    endif ()
 endmacro()
@@ -68,7 +68,12 @@ public:
 
   void GetFirstVisibleCell(int& frow, int& fcol);
   void GetLastVisibleCell(int& lrow, int& lcol);
-  void SetNumericalRow(int row, int col, int datatype, double value);
+  /** Declares row as the direction row of datatype (NumericalRows). */
+  void SetNumericalRow(int row, int datatype);
+  /** Whether the directions of datatype are shown as digits. */
+  bool IsDigitRow(int datatype) const {
+    return m_IsDigit.GetChar(datatype) == 'X';
+  }
 
   GRIBTable* m_gParent;
 
@@ -88,7 +93,6 @@ private:
   wxColour m_greenColour;
   wxColour m_greyColour;
 
-  std::vector<std::vector<double> > m_NumRowVal;
   std::vector<int> m_NumRow;
   wxString m_IsDigit;
 
@@ -57,6 +57,10 @@
 #include "GribSettingsDialog.h"
 #include "GribOverlayFactory.h"
 #include "GribUIDialog.h"
+#include "GribDataset.h"
+#include "GribValuesMessage.h"
+#include "GribEventBus.h"
+#include "GribResidency.h"
 #include "DpGribAPI.h"
 #include "DpGribPersistentSettings.h"
 
@@ -87,6 +91,19 @@ enum SettingsDisplay {
   PARTICLES
 };
 
+/** Runs GribEventBus::Pump() on the GUI thread when deliveries are due. */
+class GribEventTimer : public wxTimer {
+public:
+  GribEventTimer(GribEventBus &bus) : m_bus(bus) {}
+  void Notify() override {
+    int ms = m_bus.Pump();
+    if (ms >= 0) StartOnce(wxMax(ms, 1));
+  }
+
+private:
+  GribEventBus &m_bus;
+};
+
 class DpGrib_pi : public opencpn_plugin_118 {
 public:
   DpGrib_pi(void *ppimgr);
@@ -196,6 +213,17 @@ public:
   bool Internal_GetLoopMode() const;
   void Internal_SetPlaybackSpeed(int speed);
   int Internal_GetPlaybackSpeed() const;
+  // Not forwarded by DpGribAPI until its header in deeprey-api declares them,
+  // other plugins reach them through the GRIB_*_REQUEST messages meanwhile
+  DpGrib::PlaybackStats Internal_GetPlaybackStats() const;
+  void Internal_SetMemoryBudget(size_t bytes);
+  DpGrib::MemoryUsage Internal_GetMemoryUsage() const;
+  void Internal_SetGridCompression(DpGrib::GridCompression compression);
+  DpGrib::GridCompression Internal_GetGridCompression() const;
+  void Internal_SetDecodedCache(bool enable);
+  bool Internal_IsDecodedCacheEnabled() const;
+  void Internal_SetDirectoryWatch(bool enable);
+  bool Internal_IsDirectoryWatchEnabled() const;
 
   // Global symbol spacing control
   void Internal_SetGlobalSymbolSpacing(int pixels);
@@ -269,6 +297,24 @@ public:
   bool Internal_GetVectorValueAt(int layerId, int timeIndex,
                                   double latitude, double longitude,
                                   double& magnitude, double& direction) const;
+  // Not forwarded by DpGribAPI until its header in deeprey-api declares them,
+  // other plugins reach them through the GRIB_*_REQUEST messages meanwhile
+  DpGrib::DatasetPtr Internal_GetDataset() const;
+  bool Internal_GetGrid(int layerId, int timeIndex,
+                        DpGrib::GridView& view) const;
+  bool Internal_SampleValues(const std::vector<int>& layerIds,
+                             const std::vector<DpGrib::SampleQuery>& queries,
+                             std::vector<DpGrib::SampleValue>& values,
+                             unsigned int threads) const;
+  bool Internal_SampleRoute(const DpGrib::RouteRequest& request,
+                            DpGrib::RouteSamples& samples) const;
+  bool Internal_ExportSubset(const DpGrib::ExportRequest& request,
+                             DpGrib::ExportResult& result) const;
+  uint64_t Internal_AddEventCallback(
+      const DpGrib::EventSubscription& subscription,
+      DpGrib::EventCallback callback);
+  void Internal_RemoveEventCallback(uint64_t callbackId);
+  GribEventBus& GetEventBus() { return m_eventBus; }
   wxString Internal_GetLayerUnit(int layerId) const;
   bool Internal_IsVectorLayer(int layerId) const;
   wxString Internal_GetLayerDisplayName(int layerId) const;
@@ -289,6 +335,12 @@ private:
   bool SaveConfig(void);
   void UpdateApiPtr(void);
   void SyncUnitsToGribSettings(void);
+  bool GetGribValuesReply(const wxString &body, wxString &out);
+  void GetGribValuesBatchReply(const wxString &body, std::string &out);
+  void GetGribSampleValuesReply(const wxString &body, wxString &out);
+  void GetGribSampleRouteReply(const wxString &body, wxString &out);
+  void GetGribExportReply(const wxString &body, wxString &out);
+  void RunGribValuesBenchmark(const wxString &body);
 
   bool DoRenderGLOverlay(wxGLContext *pcontext, PlugIn_ViewPort *vp,
                          int canvasIndex);
@@ -313,6 +365,10 @@ private:
 
   GribTimelineRecordSet *m_pLastTimelineSet;
 
+  // Reused by every GRIB_VALUES_BATCH_REQUEST
+  GribValuesBatch m_valuesBatch;
+  std::string m_valuesBatchReply;
+
   // preference data
   bool m_bGRIBUseHiDef;
   bool m_bGRIBUseGradualColors;
@@ -327,6 +383,17 @@ private:
    * points are sparse.
    */
   bool m_bCopyMissWaveRec;
+  /** Megabytes of decoded grids kept in memory, 0 for no limit. Grids
+   * beyond it are evicted, see GribResidency.
+   */
+  int m_MemoryBudgetMB;
+  /** How evicted grids are kept, a DpGrib::GridCompression. */
+  int m_GridCompression;
+  /** Whether loads are cached decoded, see GribCache. */
+  int m_bDecodedCache;
+  wxString m_DecodedCacheDir;
+  /** Whether files arriving in the GRIB directory are merged as they come. */
+  int m_bWatchDirectory;
   int m_bLoadLastOpenFile;
   int m_bStartOptions;
   wxString m_RequestConfig;
@@ -361,6 +428,10 @@ private:
   // Grib API for communication with deepreygui
   DpGrib::DpGribAPI* m_gribAPI;
   DpGrib::DpGribPersistentSettings m_settings;
+
+  // Coalesced API events
+  GribEventBus m_eventBus;
+  GribEventTimer m_eventTimer{m_eventBus};
 };
 
 //----------------------------------------------------------------------------------------
@@ -0,0 +1,81 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Batches of point and time queries on a GRIB file.
+ *
+ * Routing tools ask for thousands of positions along candidate tracks.
+ * Answering them one call at a time brackets the time and finds the grid cell
+ * of every query from scratch. The batch is sorted by time once, each layer
+ * then walks it with a GribTimeCursor so consecutive queries reuse the
+ * bracket, and the grid cell found for the earlier record serves the later
+ * one when both share a geometry. Long batches are split across threads.
+ *
+ * Values are raw record units; the caller calibrates them.
+ */
+
+#ifndef GRIBBATCHSAMPLER_H
+#define GRIBBATCHSAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "GribSampleQuery.h"
+
+class GRIBFile;
+class GribTimeIndex;
+
+/** How a layer reads the records of a file. */
+struct GribSampleLayer {
+  enum Kind {
+    SCALAR,           //!< Value of idx
+    VECTOR,           //!< Magnitude and direction of components idx, idy
+    SCALAR_DIRECTION  //!< Value of idx, direction of idy if present
+  };
+
+  Kind kind = SCALAR;
+  int idx = -1;
+  int idy = -1;
+};
+
+class GribBatchSampler {
+public:
+  /**
+   * @param file The file to sample, it must stay open during Sample().
+   * @param queries The batch, kept by reference until the sampler is
+   * destroyed.
+   */
+  GribBatchSampler(GRIBFile *file,
+                   const std::vector<DpGrib::SampleQuery> &queries);
+
+  /**
+   * Samples one layer.
+   *
+   * @param values Receives one value per query, in query order.
+   * @param threads Maximum number of threads, 0 for one per core.
+   */
+  void Sample(const GribSampleLayer &layer, DpGrib::SampleValue *values,
+              unsigned int threads = 1);
+
+private:
+  void SampleRange(const GribSampleLayer &layer, const GribTimeIndex &index,
+                   const GribTimeIndex *direction, size_t begin, size_t end,
+                   DpGrib::SampleValue *values) const;
+  double ScalarAt(int idx, const GribTimeIndex &index, size_t k1, size_t k2,
+                  const DpGrib::SampleQuery &q) const;
+  bool VectorAt(const GribSampleLayer &layer, const GribTimeIndex &index,
+                size_t k1, size_t k2, const DpGrib::SampleQuery &q,
+                double &M, double &A) const;
+
+  GRIBFile *m_file;
+  const std::vector<DpGrib::SampleQuery> &m_queries;
+  std::vector<size_t> m_order;  // queries by time
+};
+
+#endif
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * On-disk cache of loaded GRIB files, ready to map.
+ *
+ * Loading a file decodes every message, then runs the fixups and files the
+ * records into sets. The cache keeps the outcome: the metadata of every
+ * record of the sets, the record of each set and Idx_* as one column per
+ * Idx_*, and the grids as columns of 16 bit steps above a reference. The
+ * steps are those the grids were packed with when they fit, else 1/65534
+ * of their range.
+ *
+ * Opening a cache maps it and builds the records without their values:
+ * GribResidency reads a grid from the mapping on its first access. A cache
+ * is used only while the sizes and modification times of its source files,
+ * the plugin version and the load options are those it was written for.
+ */
+
+#ifndef GRIBCACHE_H
+#define GRIBCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+class GribRecord;
+class GribRecordSet;
+
+class GribCache {
+public:
+  /** What a cache holds the load of. */
+  struct Key {
+    std::vector<std::string> files;
+    std::string version;    ///< Of the plugin, caches of others are stale
+    unsigned int options = 0;  ///< Load options changing the records
+  };
+
+  /** Where caches go, none are read or written while empty, the default. */
+  static void SetDirectory(const std::string &directory);
+  static std::string GetDirectory();
+
+  /**
+   * Maps the cache of key.
+   * @return nullptr when caching is off, or there is no valid cache of key.
+   */
+  static std::unique_ptr<GribCache> Open(const Key &key);
+  /**
+   * Writes the cache of key for the sets a load gave, replacing any.
+   * @param indices The Idx_* values filed, as GribRecordSetBuilder gives.
+   */
+  static bool Write(const Key &key, const std::vector<GribRecordSet *> &sets,
+                    const std::vector<int> &indices, time_t refDate);
+
+  /** Deletes the records, the mapping goes with the last of them. */
+  ~GribCache();
+
+  size_t GetSetCount() const { return m_times.size(); }
+  time_t GetSetTime(size_t set) const { return m_times[set]; }
+  /** Points the records of set to those of the cache. */
+  void FillSet(size_t set, GribRecordSet &recordSet) const;
+  const std::vector<int> &GetIndices() const { return m_indices; }
+  time_t GetRefDate() const { return m_refDate; }
+  size_t GetRecordCount() const { return m_records.size(); }
+
+private:
+  GribCache() {}
+
+  static std::string PathOf(const Key &key);
+  static bool Stat(const std::string &file, uint64_t &size, int64_t &mtime);
+  bool Read(const unsigned char *base, size_t size, const Key &key);
+  /** Keeps the most recently written caches only. */
+  static void Prune(const std::string &directory, size_t keep);
+
+  std::shared_ptr<const void> m_mapping;
+  std::vector<GribRecord *> m_records;
+  std::vector<time_t> m_times;
+  std::vector<int32_t> m_setIndex;  // Idx_* major, set minor
+  std::vector<int> m_indices;
+  time_t m_refDate = 0;
+};
+
+#endif
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Immutable dataset snapshots handed out by
+ * DpGrib_pi::Internal_GetDataset().
+ */
+
+#ifndef GRIBDATASET_H
+#define GRIBDATASET_H
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include "GribExport.h"
+#include "GribGridView.h"
+#include "GribRoute.h"
+#include "GribSampleQuery.h"
+
+namespace DpGrib {
+
+/**
+ * The GRIB data loaded when the snapshot was taken: records, timeline,
+ * coverage and the display units of every layer.
+ *
+ * A snapshot never changes and may be queried from any thread, concurrently,
+ * without locking. Opening another file or changing units in the plugin does
+ * not affect it; the data stays in memory until the last reference to the
+ * snapshot is released. Values are in the display units of the layer, as
+ * GetScalarValueAt() and GetVectorValueAt() return them.
+ */
+class Dataset {
+public:
+  virtual ~Dataset() {}
+
+  /** Identifies the loaded file; a new snapshot of the same file has it too. */
+  virtual unsigned int GetFileId() const = 0;
+
+  virtual size_t GetTimeCount() const = 0;
+  /** Time of step index, seconds since the epoch (UTC). */
+  virtual time_t GetTime(size_t index) const = 0;
+  virtual bool GetTimeRange(time_t &start, time_t &end) const = 0;
+  /** Area covered by the records, in degrees. */
+  virtual bool GetBounds(double &latMin, double &lonMin, double &latMax,
+                         double &lonMax) const = 0;
+
+  virtual bool IsLayerAvailable(int layerId) const = 0;
+  virtual bool IsVectorLayer(int layerId) const = 0;
+
+  /** Value of a layer at a position and any time within the timeline. */
+  virtual bool GetScalarValueAt(int layerId, time_t time, double latitude,
+                                double longitude, double &value) const = 0;
+  virtual bool GetVectorValueAt(int layerId, time_t time, double latitude,
+                                double longitude, double &magnitude,
+                                double &direction) const = 0;
+
+  /**
+   * View of the grid of a layer at time step timeIndex, without copying.
+   * False when the layer has no record at that step.
+   */
+  virtual bool GetGrid(int layerId, size_t timeIndex,
+                       GridView &view) const = 0;
+
+  /** Same as DpGrib_pi::Internal_SampleValues(). */
+  virtual bool SampleValues(const std::vector<int> &layerIds,
+                            const std::vector<SampleQuery> &queries,
+                            std::vector<SampleValue> &values,
+                            unsigned int threads = 1) const = 0;
+  /** Same as DpGrib_pi::Internal_SampleRoute(). */
+  virtual bool SampleRoute(const RouteRequest &request,
+                           RouteSamples &samples) const = 0;
+  /** Same as DpGrib_pi::Internal_ExportSubset(). */
+  virtual bool Export(const ExportRequest &request,
+                      ExportResult &result) const = 0;
+};
+
+typedef std::shared_ptr<const Dataset> DatasetPtr;
+
+}  // namespace DpGrib
+
+#endif
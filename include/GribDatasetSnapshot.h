@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * DpGrib::Dataset on a loaded GRIBFile.
+ *
+ * The snapshot shares ownership of the file with the control bar, so opening
+ * another file only drops the control bar reference. Unit settings are
+ * copied at creation; everything else it reads is left untouched by the
+ * plugin once the file is loaded.
+ */
+
+#ifndef GRIBDATASETSNAPSHOT_H
+#define GRIBDATASETSNAPSHOT_H
+
+#include <memory>
+#include <string>
+
+#include "GribDataset.h"
+#include "GribBatchSampler.h"
+#include "GribUIDialog.h"
+
+class GribDatasetSnapshot : public DpGrib::Dataset {
+public:
+  GribDatasetSnapshot(std::shared_ptr<GRIBFile> file,
+                      GribOverlaySettings &settings);
+
+  /** How the value APIs read a layer, false if they do not know it. */
+  static bool GetSampleLayer(int layerId, GribSampleLayer &layer);
+
+  unsigned int GetFileId() const override;
+  size_t GetTimeCount() const override;
+  time_t GetTime(size_t index) const override;
+  bool GetTimeRange(time_t &start, time_t &end) const override;
+  bool GetBounds(double &latMin, double &lonMin, double &latMax,
+                 double &lonMax) const override;
+  bool IsLayerAvailable(int layerId) const override;
+  bool IsVectorLayer(int layerId) const override;
+  bool GetScalarValueAt(int layerId, time_t time, double latitude,
+                        double longitude, double &value) const override;
+  bool GetVectorValueAt(int layerId, time_t time, double latitude,
+                        double longitude, double &magnitude,
+                        double &direction) const override;
+  bool GetGrid(int layerId, size_t timeIndex,
+               DpGrib::GridView &view) const override;
+  bool SampleValues(const std::vector<int> &layerIds,
+                    const std::vector<DpGrib::SampleQuery> &queries,
+                    std::vector<DpGrib::SampleValue> &values,
+                    unsigned int threads = 1) const override;
+  bool SampleRoute(const DpGrib::RouteRequest &request,
+                   DpGrib::RouteSamples &samples) const override;
+  bool Export(const DpGrib::ExportRequest &request,
+              DpGrib::ExportResult &result) const override;
+
+private:
+  /** GribOverlaySettings::CalibrateValue() of one layer, frozen. */
+  struct Calibration {
+    double offset = 0.;
+    double factor = 1.;
+    bool beaufort = false;
+
+    double Apply(double v) const {
+      return (v + offset) *
+             (beaufort ? GribOverlaySettings::GetmstobfFactor(v) : factor);
+    }
+  };
+
+  DpGrib::SampleValue Sample(int layerId, time_t time, double latitude,
+                             double longitude) const;
+
+  std::shared_ptr<GRIBFile> m_file;
+  Calibration m_calibration[GribOverlaySettings::SETTINGS_COUNT];
+  std::string m_units[GribOverlaySettings::SETTINGS_COUNT];
+  bool m_hasBounds = false;
+  double m_latMin = 0., m_lonMin = 0., m_latMax = 0., m_lonMax = 0.;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Where the decoders spend their time, for grib-bench.
+ *
+ * The decoders time the stages of reading a message with a
+ * GribDecodeStats::Timer, which does nothing unless collecting was enabled:
+ * the cost of a file read normally is one flag check per section.
+ */
+
+#ifndef GRIBDECODESTATS_H
+#define GRIBDECODESTATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <utility>
+
+class GribDecodeStats {
+public:
+  enum Stage {
+    SCAN,    ///< Finding a message and reading its indicator section
+    PARSE,   ///< Sections up to the data: product, grid, packing, bitmap
+    UNPACK,  ///< Data section
+    FIXUP,   ///< Records the reader derives once a file is read
+    STAGE_COUNT
+  };
+
+  struct Totals {
+    double seconds = 0;
+    unsigned long count = 0;        ///< Sections or messages timed
+    unsigned long long values = 0;  ///< Grid points unpacked, UNPACK only
+  };
+
+  /** Unpacking totals by edition and packing template. */
+  typedef std::map<std::pair<int, int>, Totals> UnpackTotals;
+
+  static void Enable(bool enable);
+  static bool IsEnabled();
+  /** Clears all totals. */
+  static void Reset();
+  static Totals Get(Stage stage);
+  static UnpackTotals GetUnpack();
+
+  /** Lap timer, the time since its start or previous lap goes to a stage. */
+  class Timer {
+  public:
+    Timer() : m_enabled(IsEnabled()) {
+      if (m_enabled) m_start = Clock::now();
+    }
+
+    void Lap(Stage stage) {
+      if (m_enabled) Add(stage, -1, -1, 0, Elapsed());
+    }
+    /** Lap for the data section of a message packed with template. */
+    void LapUnpack(int edition, int packing, size_t values) {
+      if (m_enabled) Add(UNPACK, edition, packing, values, Elapsed());
+    }
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    double Elapsed() {
+      Clock::time_point now = Clock::now();
+      double seconds = std::chrono::duration<double>(now - m_start).count();
+      m_start = now;
+      return seconds;
+    }
+
+    bool m_enabled;
+    Clock::time_point m_start;
+  };
+
+private:
+  static void Add(Stage stage, int edition, int packing, size_t values,
+                  double seconds);
+};
+
+#endif
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Watching a directory for GRIB files arriving or being replaced.
+ *
+ * A thread of its own waits for inotify events on the directory where the
+ * system has them, and scans it at intervals elsewhere or when inotify can't
+ * watch it. A file is reported once its size and modification time have
+ * held for the settle time, so files still being written or copied are only
+ * reported complete. Files already there when watching starts are not
+ * reported until they change.
+ */
+
+#ifndef GRIBDIRECTORYWATCHER_H
+#define GRIBDIRECTORYWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GribDirectoryWatcher {
+public:
+  /**
+   * Receives the paths of new or changed files, oldest first. Called from the
+   * watcher thread: it must only hand the files over to another thread.
+   */
+  typedef std::function<void(const std::vector<std::string> &)> Callback;
+
+  GribDirectoryWatcher() {}
+  ~GribDirectoryWatcher() { Stop(); }
+
+  /** Milliseconds between scans without inotify, 5 s by default. */
+  void SetPollInterval(unsigned int ms) { m_pollMs = ms; }
+  /** Milliseconds a file must stay unchanged, 2 s by default. */
+  void SetSettleTime(unsigned int ms) { m_settleMs = ms; }
+
+  /**
+   * Starts watching directory, instead of any directory watched before, for
+   * files whose names match pattern, an ECMAScript regular expression
+   * matched ignoring case.
+   * @return False when the directory or the pattern are invalid.
+   */
+  bool Start(const std::string &directory, const std::string &pattern,
+             Callback callback);
+  /** Stops the thread, no callback runs once it returns. */
+  void Stop();
+
+  bool IsRunning() const { return m_thread.joinable(); }
+  const std::string &GetDirectory() const { return m_directory; }
+  /** True when changes wake the watcher, false when it polls. */
+  bool IsNotified() const { return m_notify >= 0; }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct FileState {
+    uint64_t size;
+    int64_t mtime;
+    bool operator==(const FileState &s) const {
+      return size == s.size && mtime == s.mtime;
+    }
+  };
+  struct Pending {
+    FileState state;
+    Clock::time_point since;  // of state
+  };
+
+  void Run();
+  /** Updates what is known of the files, returns those settled. */
+  std::vector<std::string> Scan(Clock::time_point now);
+  /** Waits for a change or the stop, at most ms. True on a change. */
+  bool Wait(unsigned int ms);
+
+  std::string m_directory;
+  std::regex m_pattern;
+  Callback m_callback;
+  std::atomic<unsigned int> m_pollMs{5000}, m_settleMs{2000};
+
+  std::map<std::string, FileState> m_known;  // reported or there at start
+  std::map<std::string, Pending> m_pending;  // changed, settling
+
+  int m_notify = -1;  // inotify descriptor, -1 when polling
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop = false;
+  std::thread m_thread;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Coalesced plugin events, see DpGrib_pi::Internal_AddEventCallback().
+ */
+
+#ifndef GRIBEVENT_H
+#define GRIBEVENT_H
+
+#include <ctime>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace DpGrib {
+
+/** Event types, combined as bits. */
+enum EventType {
+  EVENT_STATE = 1,              //!< NotifyStateChanged()
+  EVENT_DATA = 2,               //!< NotifyDataChanged()
+  EVENT_LAYER_STATE = 4,        //!< NotifyLayerStateChanged()
+  EVENT_FORMAT_STATE = 8,       //!< NotifyFormatStateChanged()
+  EVENT_CURSOR = 16,            //!< NotifyCursorPosition()
+  EVENT_TIME = 32,              //!< Timeline moved, e.g. during playback
+  EVENT_DOWNLOAD_PROGRESS = 64, //!< NotifyDownloadProgress()
+  EVENT_ALL = 127
+};
+
+/**
+ * Everything that happened since the previous delivery to a subscriber.
+ *
+ * Only the latest cursor position, time, layer state and download progress
+ * are kept; format changes are merged.
+ */
+struct Events {
+  unsigned int types = 0;  //!< EventType bits that occurred
+  unsigned int count = 0;  //!< Number of events merged
+
+  std::vector<int> disabledLayerIds;
+  /** (layerId, format) pairs, each once. */
+  std::vector<std::pair<int, int>> changedFormats;
+
+  double latitude = 0., longitude = 0.;
+
+  time_t time = 0;  //!< Timeline time, seconds since the epoch (UTC)
+
+  long transferred = 0, total = 0;
+  bool completed = false, success = false;
+};
+
+/** How a subscriber wants its events delivered. */
+struct EventSubscription {
+  unsigned int types = EVENT_ALL;
+  /**
+   * Wait this long after the first pending event before delivering, so the
+   * ones following it are merged. 0 and no maxRate delivers each event
+   * synchronously, like the plain callbacks.
+   */
+  unsigned int coalesceMs = 0;
+  /** Most deliveries per second, 0 for no limit. */
+  double maxRate = 0.;
+  /**
+   * Deliver on the event thread of the plugin instead of the GUI thread.
+   * The callback must then not touch wx windows.
+   */
+  bool ownThread = false;
+};
+
+typedef std::function<void(const Events &)> EventCallback;
+
+}  // namespace DpGrib
+
+#endif
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Coalescing and rate limiting of DpGribAPI events.
+ *
+ * Playback and mouse tracking post events far faster than panels can lay
+ * themselves out. Each subscriber keeps one pending DpGrib::Events that
+ * every post merges into; it is handed over once the coalescing window of
+ * the subscriber has passed and its rate allows. GUI subscribers are served
+ * by Pump(), which the owner calls from the GUI thread when the wake handler
+ * asks for it; ownThread subscribers are served by a thread of the bus.
+ */
+
+#ifndef GRIBEVENTBUS_H
+#define GRIBEVENTBUS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "GribEvent.h"
+
+class GribEventBus {
+public:
+  GribEventBus();
+  ~GribEventBus();
+
+  /**
+   * Called from the posting thread when GUI deliveries become due.
+   * @param handler Receives the delay in milliseconds until Pump() has work.
+   */
+  void SetWakeHandler(std::function<void(int)> handler);
+
+  uint64_t Subscribe(const DpGrib::EventSubscription &subscription,
+                     DpGrib::EventCallback callback);
+  /**
+   * Once it returns the callback is not called again, unless it is called
+   * from that very callback.
+   */
+  void Unsubscribe(uint64_t id);
+  /** Drops every subscriber and stops the thread. */
+  void Clear();
+
+  void PostState();
+  void PostData();
+  void PostLayerState(const std::vector<int> &disabledLayerIds);
+  void PostFormatState(const std::vector<std::pair<int, int>> &changedFormats);
+  void PostCursor(double latitude, double longitude);
+  void PostTime(time_t time);
+  void PostDownloadProgress(long transferred, long total, bool completed,
+                            bool success);
+
+  /**
+   * Delivers what is due to the GUI subscribers.
+   * @return Milliseconds until the next delivery is due, -1 if none pending.
+   */
+  int Pump();
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Subscriber {
+    uint64_t id;
+    DpGrib::EventSubscription subscription;
+    DpGrib::EventCallback callback;
+    DpGrib::Events pending;
+    Clock::time_point first;  // of the pending events
+    Clock::time_point last;   // delivery
+    bool urgent = false;      // download finished, skip the window
+  };
+  typedef std::shared_ptr<Subscriber> SubscriberPtr;
+
+  void Post(const DpGrib::Events &event);
+  static void Merge(DpGrib::Events &pending, const DpGrib::Events &event);
+  Clock::time_point Due(const Subscriber &subscriber) const;
+  /** Hands out the due events of the thread or GUI subscribers, locked. */
+  Clock::time_point TakeDue(bool ownThread, Clock::time_point now,
+                            std::vector<SubscriberPtr> &due,
+                            std::vector<DpGrib::Events> &events);
+  void Deliver(std::vector<SubscriberPtr> &due,
+               std::vector<DpGrib::Events> &events);
+  void Run();
+  void Stop();
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::map<uint64_t, SubscriberPtr> m_subscribers;
+  uint64_t m_nextId = 1;
+  std::function<void(int)> m_wakeHandler;
+  Clock::time_point m_guiWakeAt = Clock::time_point::max();  // next Pump()
+
+  // Subscribers whose callback runs, and on which thread
+  std::multimap<uint64_t, std::thread::id> m_delivering;
+  std::condition_variable m_delivered;
+
+  std::thread m_thread;
+  bool m_stop = false;
+};
+
+#endif
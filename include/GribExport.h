@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Slices of the loaded GRIB data written as GRIB2 files, as done by
+ * DpGrib_pi::Internal_ExportSubset().
+ */
+
+#ifndef GRIBEXPORT_H
+#define GRIBEXPORT_H
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace DpGrib {
+
+struct ExportRequest {
+  /** File to write, replaced. */
+  std::string path;
+  /** Area in degrees, crossing the antimeridian when lonMin > lonMax. */
+  double latMin = -90., lonMin = -180., latMax = 90., lonMax = 180.;
+  /** Time steps to export, all of them when end < start. */
+  time_t start = 0;
+  time_t end = -1;
+  /** GribOverlaySettings layer ids to export, all layers when empty. */
+  std::vector<int> layerIds;
+  /** Keep every thinning-th grid point in both directions. */
+  int thinning = 1;
+  enum Packing {
+    SIMPLE,   //!< GRIB2 template 5.0
+    COMPLEX,  //!< GRIB2 template 5.3, the smallest files
+  };
+  Packing packing = COMPLEX;
+  /** Bits a value, from 1 to 24: 12 keeps 1/4096 of each field's range. */
+  int bits = 12;
+  /** Threads encoding, 0 for one per core. */
+  unsigned int threads = 0;
+};
+
+struct ExportResult {
+  size_t records = 0;  //!< GRIB2 messages written
+  size_t skipped = 0;  //!< Records outside the area or without GRIB2 code
+  size_t bytes = 0;
+};
+
+}  // namespace DpGrib
+
+#endif
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Writing a slice of loaded GRIB data as a new GRIB2 file.
+ *
+ * The records of the record sets in a time range are cropped to an area,
+ * optionally thinned, and encoded again with GribWriter, one message per
+ * record, on as many threads as asked. Values are written as the plugin
+ * holds them, after its fixups, so that reading the file back gives the
+ * same sets.
+ */
+
+#ifndef GRIBEXPORTER_H
+#define GRIBEXPORTER_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "GribWriter.h"
+
+class GribRecord;
+class GribRecordSet;
+
+class GribExporter {
+public:
+  struct Options {
+    /** Area in degrees, crossing the antimeridian when lonMin > lonMax. */
+    double latMin = -90, lonMin = -180, latMax = 90, lonMax = 180;
+    /** Times of the sets to export, all of them when end < start. */
+    time_t start = 0, end = -1;
+    /** Idx_* values to export, all when empty. */
+    std::vector<int> indices;
+    /** Keep every thinning-th point in both directions. */
+    int thinning = 1;
+    /** SIMPLE or COMPLEX_SPATIAL suit low bandwidth links best. */
+    GribWriter::Packing packing = GribWriter::COMPLEX_SPATIAL;
+    /** Bits a packed value. */
+    int bits = 12;
+    /** Threads encoding records, 0 for one per core. */
+    unsigned int threads = 0;
+  };
+
+  struct Result {
+    size_t records = 0;  ///< Messages written
+    size_t skipped = 0;  ///< Records GRIB2 has no code for, or off the area
+    size_t bytes = 0;
+  };
+
+  /**
+   * Appends the messages of the slice to out.
+   * @return False when options are invalid or a record can't be encoded.
+   */
+  static bool Export(const std::vector<GribRecordSet *> &sets,
+                     const Options &options, std::vector<unsigned char> &out,
+                     Result &result);
+
+  /** Same as Export(), to a file replaced only once all is encoded. */
+  static bool ExportFile(const std::vector<GribRecordSet *> &sets,
+                         const Options &options, const std::string &path,
+                         Result &result);
+
+private:
+  /** A record cropped and thinned, ready to encode. */
+  struct Job {
+    const GribRecord *record = nullptr;
+    int i0 = 0, j0 = 0;  // first point kept
+    int step = 1;
+    int period = 0;  // columns of a turn round the globe, else Ni
+    double scale = 1;  // from the plugin units to the GRIB2 ones
+    GribWriter::Field field;
+  };
+
+  static bool Crop(const GribRecord &record, const Options &options,
+                   Job &job);
+  static bool Encode(const Job &job, std::vector<unsigned char> &out);
+};
+
+#endif
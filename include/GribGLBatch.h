@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Retained, batched OpenGL geometry for the vector overlays.
+ *
+ * Barbs, direction arrows and numbers used to reach the driver one line or
+ * one glyph at a time. In OpenGL mode the overlay factory now only appends
+ * their vertexes here while it walks the grid, then draws the whole frame
+ * with a handful of calls: one vertex buffer of lines and hi-def strokes,
+ * one of filled label boxes and one of glyph quads.
+ */
+
+#ifndef GRIBGLBATCH_H
+#define GRIBGLBATCH_H
+
+#include <vector>
+
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include "pi_gl.h"
+
+class TexFont;
+
+/**
+ * Attribute and uniform locations of one of the plugin 2D shader programs,
+ * looked up once per program object rather than on every draw.
+ */
+struct GribGLProgramLocations {
+  GLint program = 0;
+  GLint position = -1;   //!< "position" or "aPos"
+  GLint color = -1;      //!< "colorv", per vertex colour programs only
+  GLint uv = -1;         //!< "aUV", texture programs only
+  GLint tex = -1;        //!< "uTex", texture programs only
+  GLint transform = -1;  //!< "TransformMatrix"
+};
+
+/** Locations in GRIBpi_colorv_tri_shader_program. */
+const GribGLProgramLocations &GribColorvProgramLocations();
+/** Locations in pi_texture_2D_shader_program. */
+const GribGLProgramLocations &GribTexture2DProgramLocations();
+
+class GribGLBatch {
+public:
+  GribGLBatch();
+  ~GribGLBatch();
+
+  /**
+   * Queues count line segments, stored as x1, y1, x2, y2 screen pixels in
+   * vertexes. Segments of the same width are drawn by a single call.
+   */
+  void AddLines(const float *vertexes, int count, const wxColour &colour,
+                float width);
+
+  /**
+   * Like AddLines(), for hi-def graphics: each segment becomes a quad the
+   * pen width wide, as pi_ocpnDC::StrokeLine draws wide antialiased lines,
+   * and all of them are drawn by a single triangle strip.
+   */
+  void AddStrokes(const float *vertexes, int count, const wxColour &colour,
+                  float width);
+
+  /**
+   * Queues a number label: a filled box with a thin outline, and text drawn
+   * with font from (x, y). The font must stay built until Flush().
+   */
+  void AddLabel(int x, int y, int w, int h, const wxColour &back,
+                const wxString &text, TexFont &font, int textx, int texty);
+
+  bool IsEmpty() const;
+
+  /**
+   * Draws everything queued, arrows below labels, then empties the batch.
+   * Needs the GL context the plugin shaders were configured for.
+   */
+  void Flush();
+
+  /** Drops queued geometry without drawing it. */
+  void Clear();
+
+private:
+  // Lines of one width; each vertex is x, y, r, g, b, a.
+  struct LineRun {
+    float width;
+    std::vector<float> vertexes;
+  };
+
+  static void PushVertex(std::vector<float> &v, float x, float y,
+                         const float rgba[4]);
+  static LineRun &Run(std::vector<LineRun> &runs, float width);
+  void DrawRuns(const std::vector<LineRun> &runs, size_t &first);
+
+  std::vector<LineRun> m_arrowRuns;  // barbs and direction arrows
+  std::vector<float> m_strokes;  // hi-def arrows, x, y, r, g, b, a strip
+  std::vector<LineRun> m_labelRuns;  // label outlines, drawn above the fills
+  std::vector<float> m_fills;        // label boxes, x, y, r, g, b, a triangles
+  std::vector<float> m_glyphs;       // x, y, u, v triangles
+  TexFont *m_font;
+
+  std::vector<float> m_upload;  // staging for the line and stroke buffer
+  unsigned int m_lineVBO, m_fillVBO, m_glyphVBO;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Compact in-memory form of a decoded grid, for GribResidency.
+ *
+ * A grid whose packing step is known is stored as integer multiples of that
+ * step above its lowest value, delta coded in variable length bytes: most
+ * fields take one or two bytes a value instead of eight. Values come back
+ * within half a step of what was stored, the precision the file had anyway.
+ *
+ * Other grids, or those asked to be stored exactly, are stored losslessly:
+ * each value is xor-ed with the previous one and the bytes of the results
+ * are run length coded by significance, where sign, exponent and leading
+ * mantissa bits of neighbours mostly cancel out.
+ */
+
+#ifndef GRIBGRIDCODEC_H
+#define GRIBGRIDCODEC_H
+
+#include <cstddef>
+#include <vector>
+
+class GribGridCodec {
+public:
+  /**
+   * Encodes a grid.
+   * @param values The count values of the grid.
+   * @param step Packing step of the values, 0 when unknown or to keep the
+   * values exactly.
+   * @param out [out] The encoded grid.
+   */
+  static void Encode(const double *values, size_t count, double step,
+                     std::vector<unsigned char> &out);
+  /**
+   * Decodes a grid encoded by Encode().
+   * @return False when in is not the encoding of count values.
+   */
+  static bool Decode(const std::vector<unsigned char> &in, double *values,
+                     size_t count);
+
+private:
+  static bool EncodeSteps(const double *values, size_t count, double step,
+                          std::vector<unsigned char> &out);
+  static void EncodeExact(const double *values, size_t count,
+                          std::vector<unsigned char> &out);
+  static bool DecodeSteps(const unsigned char *in, const unsigned char *end,
+                          double *values, size_t count);
+  static bool DecodeExact(const unsigned char *in, const unsigned char *end,
+                          double *values, size_t count);
+};
+
+#endif
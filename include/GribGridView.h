@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Read-only views of decoded grids, as returned by
+ * DpGrib_pi::Internal_GetGrid().
+ */
+
+#ifndef GRIBGRIDVIEW_H
+#define GRIBGRIDVIEW_H
+
+#include <ctime>
+#include <memory>
+#include <string>
+
+namespace DpGrib {
+
+/**
+ * The grid of one layer at one time step, pointing straight at the decoded
+ * record values.
+ *
+ * Values are stored row by row, longitude varying fastest: value (i, j) is
+ * values[j * ni + i], at longitude lon0 + i * di and latitude lat0 + j * dj.
+ * dj is negative for grids running north to south, and longitudes may go
+ * past 180. Points without data hold missingValue.
+ *
+ * Values are in the record units, SI for most layers. The display units of
+ * the layer are (v + offset) * factor, or the Beaufort force of v when
+ * beaufort is set.
+ *
+ * The arrays stay valid, and unchanged, for as long as the view or a copy of
+ * it holds handle, whatever happens to the plugin meanwhile.
+ */
+struct GridView {
+  static const int CURRENT_VERSION = 1;
+  /** Layout version of this structure, CURRENT_VERSION when filled. */
+  int version = 0;
+
+  /** Scalar value, u component of vectors, or wave height. */
+  const double *values = nullptr;
+  /** v component of vectors, wave direction when known, else nullptr. */
+  const double *values2 = nullptr;
+
+  int ni = 0, nj = 0;
+  double lon0 = 0., lat0 = 0.;
+  double di = 0., dj = 0.;
+  double missingValue = -999999999.;
+  time_t time = 0;
+
+  double offset = 0.;
+  double factor = 1.;
+  bool beaufort = false;
+  std::string units;  //!< Display unit symbol, UTF-8
+
+  std::shared_ptr<const void> handle;
+};
+
+}  // namespace DpGrib
+
+#endif
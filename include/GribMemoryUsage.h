@@ -0,0 +1,53 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Grid memory figures reported through DpGrib_pi::Internal_GetMemoryUsage(),
+ * and how evicted grids are kept.
+ */
+
+#ifndef GRIBMEMORYUSAGE_H
+#define GRIBMEMORYUSAGE_H
+
+#include <cstddef>
+
+namespace DpGrib {
+
+/** How grids evicted under the memory budget are kept. */
+enum GridCompression {
+  GRID_COMPRESSION_NONE,      //!< As they are, in a spill file
+  GRID_COMPRESSION_LOSSLESS,  //!< Compressed in memory, exact values
+  /**
+   * Compressed in memory to the precision the file was packed with: values
+   * come back within half its step, which takes a few times less memory.
+   * Grids whose step is not known are kept exactly.
+   */
+  GRID_COMPRESSION_PACKING
+};
+
+/**
+ * Memory taken by the decoded grids of the loaded files.
+ *
+ * Grids not used recently are evicted once current goes over the budget, and
+ * decoded again when used. The budget may be exceeded for a while when the
+ * grids in use do not fit, or while another thread reads the data.
+ */
+struct MemoryUsage {
+  size_t budget = 0;      //!< Bytes, 0 when unlimited
+  size_t current = 0;     //!< Bytes of grids in memory
+  size_t peak = 0;        //!< Highest current so far
+  size_t total = 0;       //!< Bytes of all the grids, in memory or evicted
+  size_t compressed = 0;  //!< Bytes of the evicted grids kept in memory
+  unsigned long evictions = 0;
+  unsigned long reloads = 0;
+};
+
+}  // namespace DpGrib
+
+#endif
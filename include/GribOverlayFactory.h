@@ -45,6 +45,9 @@
 
 #include "pi_ocpndc.h"
 #include "pi_TexFont.h"
+#include "GribGLBatch.h"
+#include "GribScreenSampler.h"
+#include "IsoLineWorker.h"
 
 /**
  * Container for rendered GRIB data visualizations in texture or bitmap form.
@@ -216,6 +219,13 @@ public:
   void Reset();
   void ClearCachedData(void);
   void ClearCachedLabel(void) { m_labelCache.clear(); }
+  // Time spent rendering overlays since the previous call, in ms, used to pace
+  // playback. Only counts CPU time: GL commands may still be queued.
+  double TakeRenderMs() {
+    double ms = m_renderMs;
+    m_renderMs = 0.;
+    return ms;
+  }
   void ClearParticles() {
     // Per-canvas particle state: clear every canvas's CPU map and reset every
     // canvas's GPU instance so a setting/time change restarts cleanly on all.
@@ -321,8 +331,9 @@ private:
    *
    * This function draws isobar lines at specific intervals defined in the
    * settings. It also handles label placement along the isobars. For pressure,
-   * the function supports different unit conversions. The implementation caches
-   * isobar calculations to improve performance.
+   * the function supports different unit conversions. Isobars are built by a
+   * background worker and cached in the timeline set once complete; until
+   * then the levels already built are drawn.
    *
    * @param settings The settings index identifying the data type (PRESSURE,
    * etc.)
@@ -332,6 +343,23 @@ private:
    */
   void RenderGribIsobar(int config, GribRecord **pGR,
                         wxArrayPtrVoid **pIsobarArray, PlugIn_ViewPort *vp);
+  /**
+   * Queues the background build of the isobars of the timeline positions
+   * following current, so they are ready when playback or the user gets
+   * there.
+   *
+   * @param current Key of the displayed isobars.
+   * @param values Level values matching current.rawValues.
+   * @param idy Idx_* of the Y component for a vector magnitude, or -1.
+   */
+  void RequestIsoLinesAhead(const IsoLineKey &current,
+                            const std::vector<double> &values, int idy);
+  /**
+   * Gets the file records the timeline set of key.time comes from, as
+   * GribRecord::SharedView() views. False when key.time is off the file.
+   */
+  bool GetIsoLineSource(const IsoLineKey &key, int idy, IsoLineSource &source);
+  void OnIsoLinesReady();
   /**
    * Renders direction arrows for vector fields like wind or current.
    *
@@ -373,6 +401,8 @@ private:
    * @param vp Current viewport for rendering
    */
   void RenderGribNumbers(int config, GribRecord **pGR, PlugIn_ViewPort *vp);
+  /** Draws what the layers queued in m_glBatch so far, in OpenGL mode. */
+  void FlushGLBatch();
   /**
    * Renders animated particles showing flow patterns.
    *
@@ -449,7 +479,6 @@ private:
                       double scale, bool south = false, bool head = true);
 
   void DrawNumbers(wxPoint p, double value, int settings, wxColour back_color);
-  void FillGrid(GribRecord *pGR);
 
   wxString getLabelString(double value, int settings);
   wxImage &getLabel(double value, int settings, wxColour back_colour);
@@ -510,6 +539,12 @@ private:
 
   TexFont m_TexFontMessage, m_TexFontNumbers;
 
+  // OpenGL mode: barbs, arrows and numbers of the frame being rendered
+  GribGLBatch m_glBatch;
+
+  // Sample lattices of each canvas, kept until its viewport changes
+  GribScreenSampler m_sampler[2];
+
   GRIBUICtrlBar &m_dlg;
   GribOverlaySettings &m_Settings;
 
@@ -525,6 +560,11 @@ private:
   int m_gpuAnimTargetMs;
   long long m_gpuRefreshStampMs;
 
+  IsoLineWorker m_isoLineWorker;
+  int m_isoLineLookAhead;  // config key IsoLineLookAhead
+
+  double m_renderMs = 0.;  // see TakeRenderMs()
+
   LineBuffer m_WindArrowCache[14];
   LineBuffer m_SingleArrow[2], m_DoubleArrow[2];
 
@@ -0,0 +1,42 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Playback pacing figures reported through
+ * DpGrib_pi::Internal_GetPlaybackStats().
+ */
+
+#ifndef GRIBPLAYBACKSTATS_H
+#define GRIBPLAYBACKSTATS_H
+
+namespace DpGrib {
+
+/**
+ * How well playback keeps up with the requested speed.
+ *
+ * Playback advances the timeline on a fixed schedule, one step per timer
+ * period. When preparing and rendering a frame takes longer than that, the
+ * steps that fell due meanwhile are skipped so that the animation keeps the
+ * requested pace instead of running in slow motion. Rates and counts cover
+ * the current playback, or the last one once stopped.
+ */
+struct PlaybackStats {
+  bool playing = false;
+  double targetIntervalMs = 0.;  //!< Timer period, time of one step
+  double achievedRate = 0.;      //!< Steps per second, skipped ones included
+  double shownRate = 0.;         //!< Frames actually shown per second
+  double frameCostMs = 0.;       //!< Average preparation plus render time
+  int stride = 1;                //!< Steps per shown frame at the moment
+  unsigned long shownFrames = 0;
+  unsigned long skippedSteps = 0;
+};
+
+}  // namespace DpGrib
+
+#endif
@@ -34,17 +34,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef GRIBREADER_H
 #define GRIBREADER_H
 
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include "wx/wx.h"
-#endif  // precompiled headers
-
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <set>
 #include <map>
+#include <string>
 
 #include "GribRecord.h"
 #include "zuFile.h"
@@ -53,13 +48,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 class GribReader {
 public:
   GribReader();
-  GribReader(const wxString fname);
+  GribReader(const std::string &fname);
   ~GribReader();
 
-  void openFile(const wxString fname);
+  void openFile(const std::string &fname);
   bool isOk() { return ok; }
   long getFileSize() { return fileSize; }
-  wxString getFileName() { return fileName; }
+  std::string getFileName() { return fileName; }
 
   int getNumberOfGribRecords(int dataType, int levelType, int levelValue);
   int getTotalNumberOfGribRecords();
@@ -126,7 +121,7 @@ public:
 
 private:
   bool ok;
-  wxString fileName;
+  std::string fileName;
   ZUFILE *file;
   long fileSize;
   //        double    hoursBetweenRecords;
@@ -30,6 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <iostream>
 #include <cmath>
 
+#include "GribResidency.h"
+
 #define DEBUG_INFO false
 #define DEBUG_ERROR true
 #define grib_debug(format, ...)             \
@@ -152,6 +154,32 @@ public:
   static zuint getLevelValue(zuint code) { return (code >> 16) & 0xFFFF; }
 };
 
+/**
+ * Geometry of a GribRecord grid. Records with equal geometry share grid
+ * cells, so a GribSampleCell found on one is valid for the others.
+ */
+struct GribGridGeometry {
+  double Lo1, La1, Lo2, La2, Di, Dj;
+  int Ni, Nj;
+
+  bool operator==(const GribGridGeometry &g) const {
+    return Lo1 == g.Lo1 && La1 == g.La1 && Lo2 == g.Lo2 && La2 == g.La2 &&
+           Di == g.Di && Dj == g.Dj && Ni == g.Ni && Nj == g.Nj;
+  }
+};
+
+/**
+ * Grid cell holding a point and the position of the point in it, as found by
+ * GribRecord::getSampleCell(). Finding the cell is the part of an
+ * interpolation that only depends on the position, so it can be done once
+ * for a point sampled on several records.
+ */
+struct GribSampleCell {
+  bool inMap;          ///< False when the point is outside the grid
+  int i0, j0, i1, j1;  ///< Corners of the cell
+  double dx, dy;       ///< Distances from corner (i0, j0), in grid units
+};
+
 /**
  * Represents a meteorological data grid from a GRIB (Gridded Binary) file.
  *
@@ -183,6 +211,11 @@ class GribRecord {
 public:
   /** Copy constructor performs a deep copy of the GribRecord. */
   GribRecord(const GribRecord &rec);
+  /**
+   * Member-wise, so shallow: data and BMSbits end up shared. Used to start
+   * new records from the fields of existing ones, which then replace both.
+   */
+  GribRecord &operator=(const GribRecord &) = default;
   GribRecord() { m_bfilled = false; }
 
   virtual ~GribRecord();
@@ -255,6 +288,15 @@ public:
   static GribRecord *MagnitudeRecord(const GribRecord &rec1,
                                      const GribRecord &rec2);
 
+  /**
+   * A read-only record with the fields of rec, sharing its values through
+   * shareValues() instead of copying them: they stay alive as long as the
+   * view does, whatever GribResidency evicts meanwhile. The bitmap is left
+   * out, GRIB_NOTDEF marks the points it has no value for. Records
+   * GribResidency does not manage are copied, as they may go any time.
+   */
+  static std::shared_ptr<const GribRecord> SharedView(const GribRecord &rec);
+
   /**
    * Converts wind or current values from polar (direction/speed) to cartesian
    * (U/V) components.
@@ -477,10 +519,32 @@ public:
    * @return Data value at grid point (i,j)
    * @note No bounds checking is performed
    */
-  double getValue(int i, int j) const { return data[j * Ni + i]; }
+  double getValue(int i, int j) const { return values()[j * Ni + i]; }
+
+  /**
+   * Returns the whole data array, Ni * Nj values in getValue() order, or
+   * nullptr when the record holds no data. Only valid until the next
+   * GribResidency::Trim(), see shareValues().
+   */
+  const double *getValues() const { return values(); }
+
+  /**
+   * The data array, kept alive past an eviction by GribResidency. nullptr
+   * for records it does not manage, whose array lives as long as they do.
+   */
+  std::shared_ptr<const double> shareValues() const {
+    return m_residency.owner ? m_residency.owner->Share(this) : nullptr;
+  }
+  /**
+   * Like shareValues(), but an evicted array is read back for the caller
+   * only, see GribResidency::Peek().
+   */
+  std::shared_ptr<const double> peekValues() const {
+    return m_residency.owner ? m_residency.owner->Peek(this) : nullptr;
+  }
 
   void setValue(zuint i, zuint j, double v) {
-    if (i < Ni && j < Nj) data[j * Ni + i] = v;
+    if (i < Ni && j < Nj) mutableValues()[j * Ni + i] = v;
   }
 
   /**
@@ -528,6 +592,41 @@ public:
                                     const GribRecord *GRY, double px, double py,
                                     bool numericalInterpolation = true);
 
+  /**
+   * Finds the grid cell holding a point, wrapping the longitude around the
+   * world like getInterpolatedValue() does.
+   *
+   * @param px Longitude in degrees.
+   * @param py Latitude in degrees.
+   * @param cell [out] Cell and position of the point; cell.inMap is false
+   * when the point is outside the grid.
+   * @return cell.inMap
+   */
+  bool getSampleCell(double px, double py, GribSampleCell &cell) const;
+
+  /**
+   * Same as getInterpolatedValue(px, py, ...) for a point whose cell was
+   * found with getSampleCell() on a record of the same grid geometry.
+   */
+  double getInterpolatedValue(const GribSampleCell &cell,
+                              bool numericalInterpolation = true,
+                              bool dir = false) const;
+
+  /**
+   * Same as getInterpolatedValues(M, A, GRX, GRY, px, py, ...) for a point
+   * whose cell was found with getSampleCell() on a record of the same grid
+   * geometry as both GRX and GRY.
+   */
+  static bool getInterpolatedValues(double &M, double &A, const GribRecord *GRX,
+                                    const GribRecord *GRY,
+                                    const GribSampleCell &cell,
+                                    bool numericalInterpolation = true);
+
+  /** Geometry of the grid, to tell whether records share grid cells. */
+  GribGridGeometry getGridGeometry() const {
+    return {Lo1, La1, Lo2, La2, Di, Dj, (int)Ni, (int)Nj};
+  }
+
   /**
    * Converts grid index i to longitude in degrees.
    *
@@ -587,8 +686,20 @@ public:
   void print();
   bool isFilled() { return m_bfilled; }
   void setFilled(bool val = true) { m_bfilled = val; }
+  /**
+   * Fills isolated GRIB_NOTDEF points with the average of their defined
+   * neighbours, along latitudes then along longitudes, and marks the record
+   * filled. Done lazily, by the GUI thread, for the layers drawn as arrows
+   * or maps: the values other readers see are as decoded until then.
+   */
+  void fillHoles();
 
 private:
+  friend class GribCache;
+  friend class GribResidency;
+
+  // Cell of a point already known to be in the map
+  void getCell(double px, double py, GribSampleCell &cell) const;
   // Is a point within the extent of the grid?
   inline bool isPointInMap(double x, double y) const;
   inline bool isXInMap(double x) const;
@@ -763,7 +874,28 @@ protected:
   zuint BMSsize;
   zuchar *BMSbits;
   // SECTION 4: BINARY DATA SECTION (BDS)
-  double *data;
+  GribGridPointer data;  // access through values() once decoded
+  // Step of the values as packed in the file, 0 when unknown or changed since
+  double packingStep = 0;
+
+  // The data array, read back when GribResidency evicted it
+  const double *values() const {
+    const double *v = data;
+    if (m_residency.owner) {
+      m_residency.owner->Touch(m_residency);
+      if (!v) v = m_residency.owner->Load(this);
+    }
+    return v;
+  }
+  // The data array about to be changed: the saved copy becomes stale
+  double *mutableValues() {
+    double *v = const_cast<double *>(values());
+    if (m_residency.saved) m_residency.owner->Modified(this);
+    packingStep = 0;
+    return v;
+  }
+
+  GribResidencyEntry m_residency;
   // SECTION 5: END SECTION (ES)
 
   time_t makeDate(zuint year, zuint month, zuint day, zuint hour, zuint min,
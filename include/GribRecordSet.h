@@ -24,6 +24,8 @@
  * the same reference time. A record set combines multiple meteorological
  * (wind, pressure, waves, etc.) valid at a single forecast time.
  */
+#include <cassert>
+
 #include "GribRecord.h"
 
 /**
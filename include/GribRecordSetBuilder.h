@@ -0,0 +1,48 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Filing the records of a GribReader by time.
+ *
+ * The reader keeps records by data type and level, the plugin wants one
+ * GribRecordSet per forecast time holding a record of each Idx_* kind.
+ * GribRecordSetBuilder maps data types and levels to Idx_* values, picks
+ * between records competing for the same one, and turns direction and
+ * speed records into U/V components.
+ */
+
+#ifndef GRIBRECORDSETBUILDER_H
+#define GRIBRECORDSETBUILDER_H
+
+#include <vector>
+
+class GribReader;
+class GribRecord;
+class GribRecordSet;
+
+class GribRecordSetBuilder {
+public:
+  /**
+   * Files the records of reader into sets.
+   *
+   * @param sets One set per date of the reader, in date order.
+   * @param indices [out] The Idx_* values filed, in the order first filed,
+   * with 1000 + model for fields filed from a model with its own display.
+   * @return The last record looked at, nullptr when the reader has none.
+   */
+  static GribRecord *Build(GribReader &reader,
+                           const std::vector<GribRecordSet *> &sets,
+                           std::vector<int> &indices);
+
+private:
+  static void Polar2UV(const std::vector<GribRecordSet *> &sets,
+                       bool polarWind, bool polarCurrent);
+};
+
+#endif
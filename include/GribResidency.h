@@ -0,0 +1,185 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Memory budget for the decoded grids of loaded files.
+ *
+ * GribReader hands every record it keeps to GribResidency. When the grids in
+ * memory go over the budget, Trim() evicts those used least recently: their
+ * values are saved once, compressed in memory by GribGridCodec or written to
+ * a spill file, and the array is dropped. The next access through the record
+ * decodes them again, so the budget bounds a working set of recent grids
+ * while the rest of the file takes a fraction of its decoded size.
+ *
+ * Evicting frees arrays that other code may be reading, so it only happens
+ * in Trim(), called by the GUI thread where it holds no grid pointer. Code
+ * reading records on other threads holds a GribResidency::ReadGuard, during
+ * which Trim() leaves everything in place. Arrays shared through
+ * GribRecord::shareValues() outlive their eviction.
+ */
+
+#ifndef GRIBRESIDENCY_H
+#define GRIBRESIDENCY_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GribGridCodec.h"
+#include "GribMemoryUsage.h"
+
+class GribRecord;
+class GribResidency;
+
+/**
+ * Grid array of a record. Loads and stores are atomic, as a record may be
+ * read back on one thread while another reads it too.
+ */
+class GribGridPointer {
+public:
+  GribGridPointer(double *p = nullptr) : m_p(p) {}
+  GribGridPointer(const GribGridPointer &p) : m_p(p.get()) {}
+  GribGridPointer &operator=(const GribGridPointer &p) {
+    return *this = p.get();
+  }
+  GribGridPointer &operator=(double *p) {
+    m_p.store(p, std::memory_order_release);
+    return *this;
+  }
+
+  double *get() const { return m_p.load(std::memory_order_acquire); }
+  operator double *() const { return get(); }
+
+private:
+  std::atomic<double *> m_p;
+};
+
+/**
+ * What GribResidency keeps in each record. Copies of a record are not
+ * managed, whatever the record they come from.
+ */
+struct GribResidencyEntry {
+  GribResidencyEntry() {}
+  GribResidencyEntry(const GribResidencyEntry &) {}
+  GribResidencyEntry &operator=(const GribResidencyEntry &) { return *this; }
+
+  GribResidency *owner = nullptr;
+  size_t slot = 0;                    // in the records of owner
+  int64_t spill = -1;                 // offset in the spill file, -1 if none
+  std::vector<unsigned char> packed;  // compressed copy, when not spilled
+  bool saved = false;                 // a copy has the current values
+  std::shared_ptr<double> grid;       // owns the values while in memory
+  // Or the values are in a mapped GribCache file, as 16 bit steps above a
+  // reference, 0xffff for missing ones
+  std::shared_ptr<const void> mapping;
+  const uint16_t *quantized = nullptr;
+  double reference = 0, step = 0;
+  mutable std::atomic<unsigned int> lastUse{0};
+};
+
+class GribResidency {
+public:
+  /**
+   * The instance all files share. Never destroyed, as records may be kept
+   * by dataset snapshots past the plugin.
+   */
+  static GribResidency &Get();
+
+  /** Bytes of grids to keep in memory, 0 for no limit. */
+  void SetBudget(size_t bytes);
+  /**
+   * Where the spill file goes. Without one, the default, grids are not
+   * evicted uncompressed. A spill file already open stays where it is.
+   */
+  void SetSpillDirectory(const std::string &directory);
+  /**
+   * How grids are saved when evicted. Only DpGrib::GRID_COMPRESSION_NONE
+   * uses the spill file; grids already saved stay as they are.
+   */
+  void SetCompression(DpGrib::GridCompression compression);
+  DpGrib::MemoryUsage GetUsage();
+
+  /** Takes over the values of a decoded record. */
+  void Manage(GribRecord *rec);
+  /**
+   * Takes over a record with no values yet, they are read from quantized
+   * on first access. mapping keeps quantized valid while the record lives.
+   */
+  void ManageMapped(GribRecord *rec, std::shared_ptr<const void> mapping,
+                    const uint16_t *quantized, double reference, double step);
+  /** Forgets a managed record, from its destructor. */
+  void Release(GribRecord *rec);
+
+  /**
+   * Evicts the grids used least recently until under the budget. Grids used
+   * since the previous call are kept. Call it from the GUI thread, or the
+   * only thread of a program without one, while holding no grid pointer.
+   */
+  void Trim();
+
+  /** Keeps the grids in memory as they are while it lives. */
+  class ReadGuard {
+  public:
+    ReadGuard();
+    ~ReadGuard();
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard &operator=(const ReadGuard &) = delete;
+  };
+
+  /** Marks a record as used, called on every access. */
+  void Touch(const GribResidencyEntry &entry) const {
+    unsigned int now = m_generation.load(std::memory_order_relaxed);
+    if (entry.lastUse.load(std::memory_order_relaxed) != now)
+      entry.lastUse.store(now, std::memory_order_relaxed);
+  }
+  /** Reads back the values of an evicted record. */
+  double *Load(const GribRecord *rec);
+  std::shared_ptr<const double> Share(const GribRecord *rec);
+  /**
+   * Like Share(), but an evicted grid is read back for the caller only: it
+   * stays evicted, and the record is not marked as used. For passes over
+   * many records, which would otherwise load them all before a Trim().
+   */
+  std::shared_ptr<const double> Peek(const GribRecord *rec);
+  /** The values of rec changed, its saved copy is stale. */
+  void Modified(GribRecord *rec);
+
+private:
+  GribResidency() {}
+
+  static size_t Bytes(const GribRecord *rec);
+  bool Evict(GribRecord *rec);
+  bool Save(GribRecord *rec);
+  void Discard(GribResidencyEntry &entry);  // the compressed copy
+  double *LoadLocked(const GribRecord *rec);
+  std::shared_ptr<double> ReadBack(const GribRecord *rec);
+  void CloseSpill();
+
+  std::mutex m_mutex;
+  std::vector<GribRecord *> m_records;
+  std::atomic<unsigned int> m_generation{0};
+  int m_readers = 0;  // ReadGuards alive
+
+  size_t m_budget = 0;
+  size_t m_current = 0, m_peak = 0, m_total = 0, m_compressed = 0;
+  DpGrib::GridCompression m_compression = DpGrib::GRID_COMPRESSION_PACKING;
+  unsigned long m_evictions = 0, m_reloads = 0;
+
+  std::string m_spillDirectory;
+  std::string m_spillPath;
+  std::fstream m_spill;
+  int64_t m_spillEnd = 0;
+  bool m_spillFailed = false;
+};
+
+#endif
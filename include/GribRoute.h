@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Weather along a timed route, as returned by
+ * DpGrib_pi::Internal_SampleRoute().
+ */
+
+#ifndef GRIBROUTE_H
+#define GRIBROUTE_H
+
+#include <ctime>
+#include <vector>
+
+#include "GribSampleQuery.h"
+
+namespace DpGrib {
+
+struct RouteWaypoint {
+  double latitude = 0.;
+  double longitude = 0.;
+  /** Passing time, used when RouteRequest::useTimestamps is set. */
+  time_t time = 0;
+  /** Speed in knots on the leg starting here, otherwise. */
+  double speed = 0.;
+};
+
+struct RouteRequest {
+  /** Legs are rhumb lines between consecutive waypoints. */
+  std::vector<RouteWaypoint> waypoints;
+  /** Time at the first waypoint when timing from leg speeds. */
+  time_t departure = 0;
+  /** Time every point from the waypoint times instead of the speeds. */
+  bool useTimestamps = false;
+  /** Distance between samples in nautical miles. */
+  double spacing = 1.;
+  /** GribOverlaySettings layer ids to sample. */
+  std::vector<int> layerIds;
+  /** Threads for the sampling, 0 for one per core. */
+  unsigned int threads = 0;
+};
+
+/**
+ * The samples of a route: the route points, then the values of every layer
+ * at every point, layer by layer. Waypoints are always among the points.
+ */
+struct RouteSamples {
+  std::vector<double> latitude;
+  std::vector<double> longitude;
+  std::vector<time_t> time;
+  std::vector<double> distance;  //!< From the first waypoint, nautical miles
+  std::vector<int> leg;          //!< Index of the waypoint starting the leg
+  std::vector<int> layerIds;
+  std::vector<SampleValue> values;
+
+  size_t Size() const { return time.size(); }
+  const SampleValue &Value(size_t layer, size_t k) const {
+    return values[layer * Size() + k];
+  }
+};
+
+}  // namespace DpGrib
+
+#endif
@@ -0,0 +1,42 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Densification of timed routes into batches of point queries.
+ *
+ * A route is cut into points at a fixed spacing along its rhumb line legs and
+ * each point gets its passing time. The points then go through
+ * GribBatchSampler in a single batch, every layer at once.
+ */
+
+#ifndef GRIBROUTESAMPLER_H
+#define GRIBROUTESAMPLER_H
+
+#include <vector>
+
+#include "GribRoute.h"
+
+class GribRouteSampler {
+public:
+  /**
+   * Fills the route points of samples and the matching queries.
+   *
+   * @return false if the route has no point, or a leg cannot be timed: a
+   * speed that is not positive, or waypoint times going backwards.
+   */
+  static bool Densify(const DpGrib::RouteRequest &request,
+                      DpGrib::RouteSamples &samples,
+                      std::vector<DpGrib::SampleQuery> &queries);
+
+  /** Length of a rhumb line in nautical miles. */
+  static double RhumbDistance(double lat0, double lon0, double lat1,
+                              double lon1);
+};
+
+#endif
@@ -0,0 +1,41 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Point and time queries of DpGrib_pi::Internal_SampleValues().
+ */
+
+#ifndef GRIBSAMPLEQUERY_H
+#define GRIBSAMPLEQUERY_H
+
+#include <ctime>
+
+namespace DpGrib {
+
+/** A position at a time, seconds since the epoch (UTC). */
+struct SampleQuery {
+  double latitude = 0.;
+  double longitude = 0.;
+  time_t time = 0;
+};
+
+/**
+ * Value of one layer for one query, in the display units of the layer like
+ * GetScalarValueAt() and GetVectorValueAt() return it.
+ */
+struct SampleValue {
+  bool valid = false;         //!< false where the layer has no data
+  bool hasDirection = false;  //!< Vector layers, and waves when known
+  double value = 0.;          //!< Scalar value or vector magnitude
+  double direction = 0.;      //!< Degrees, direction coming from
+};
+
+}  // namespace DpGrib
+
+#endif
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Scratch memory for decoding GRIB messages.
+ *
+ * The decoders need a handful of buffers per message: the message itself,
+ * bitmaps, packing groups. They take them from a GribScratch arena, a bump
+ * allocator emptied at once when the message is done. Each thread keeps its
+ * arena between messages, so once it has grown to the largest message of a
+ * file, decoding a record only allocates the grid it keeps.
+ */
+
+#ifndef GRIBSCRATCH_H
+#define GRIBSCRATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class GribScratch {
+public:
+  /** Totals over all arenas since the program started. */
+  struct Counters {
+    unsigned long blocks = 0;       ///< Heap allocations made by arenas
+    unsigned long allocations = 0;  ///< Buffers handed out from them
+  };
+  static Counters GetCounters();
+
+  /**
+   * An arena for the lifetime of the lease: the one of the calling thread,
+   * or a new one while that one is leased already. Everything allocated from
+   * it is freed with the lease, which may end on another thread.
+   */
+  class Lease {
+  public:
+    Lease() : m_scratch(Acquire()) {}
+    ~Lease() { Release(m_scratch); }
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    GribScratch *operator->() const { return m_scratch; }
+
+  private:
+    GribScratch *m_scratch;
+  };
+
+  /**
+   * Uninitialized room for count values, aligned for any type.
+   * @return nullptr when out of memory.
+   */
+  template <typename T>
+  T *Allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "scratch memory is released without destructors");
+    if (count > SIZE_MAX / sizeof(T)) return nullptr;
+    return static_cast<T *>(Allocate(count * sizeof(T)));
+  }
+  void *Allocate(size_t bytes);
+
+  /** Frees everything allocated, keeping the memory for the next message. */
+  void Reset();
+
+private:
+  GribScratch() {}
+
+  static GribScratch *Acquire();
+  static void Release(GribScratch *scratch);
+
+  struct Block {
+    std::unique_ptr<char[]> memory;
+    size_t size;
+  };
+  std::vector<Block> m_blocks;  // allocating from the last one
+  size_t m_used = 0;            // bytes of the last block in use
+};
+
+#endif
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Screen-space sample lattices shared by the overlay layers.
+ *
+ * Fixed-spacing barbs and arrows, numbers and the DC overlay image all sample
+ * the records on a regular lattice of screen points. Projecting those points
+ * and finding the grid cell holding each of them only depends on the
+ * viewport, the lattice and the grid geometry, so it is done once here and
+ * reused by every layer, and by following frames until the viewport moves.
+ */
+
+#ifndef GRIBSCREENSAMPLER_H
+#define GRIBSCREENSAMPLER_H
+
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ocpn_plugin.h"
+
+#include "GribRecord.h"
+
+/** One point of a lattice. */
+struct GribSamplePoint {
+  wxPoint p;        //!< Screen position
+  double lat, lon;  //!< Geographic position
+};
+
+class GribSampleLattice {
+public:
+  const std::vector<GribSamplePoint> &Points() const { return m_points; }
+  size_t Size() const { return m_points.size(); }
+  const GribSamplePoint &operator[](size_t k) const { return m_points[k]; }
+
+  /** rec->getInterpolatedValue() at point k. */
+  double Value(const GribRecord *rec, size_t k,
+               bool numericalInterpolation = true, bool dir = false);
+
+  /** GribRecord::getInterpolatedValues() at point k. */
+  bool Values(double &M, double &A, const GribRecord *GRX,
+              const GribRecord *GRY, size_t k,
+              bool numericalInterpolation = true);
+
+private:
+  friend class GribScreenSampler;
+
+  const std::vector<GribSampleCell> &Cells(const GribRecord *rec);
+
+  std::vector<GribSamplePoint> m_points;
+  // Cells of every point, per grid geometry sampled so far
+  std::vector<std::pair<GribGridGeometry, std::vector<GribSampleCell>>>
+      m_cells;
+};
+
+class GribScreenSampler {
+public:
+  /**
+   * Geographic lattice with points about spacing pixels apart. Its origin
+   * is a whole multiple of its step so that it stays on the same positions
+   * when panning.
+   */
+  GribSampleLattice &GeoLattice(PlugIn_ViewPort *vp, int spacing);
+
+  /** Points x0 + n * step < x1, y0 + m * step < y1, column by column. */
+  GribSampleLattice &ScreenLattice(PlugIn_ViewPort *vp, int x0, int y0,
+                                   int x1, int y1, int step);
+
+  /** Drops every lattice. */
+  void Clear();
+
+private:
+  void CheckViewPort(PlugIn_ViewPort *vp);
+
+  struct ViewPortKey {
+    double clat, clon, scale, rotation, skew;
+    int width, height, projection;
+
+    bool operator==(const ViewPortKey &k) const {
+      return clat == k.clat && clon == k.clon && scale == k.scale &&
+             rotation == k.rotation && skew == k.skew && width == k.width &&
+             height == k.height && projection == k.projection;
+    }
+  };
+  ViewPortKey m_vp = {};
+  bool m_valid = false;
+
+  // (kind, x0, y0, x1, y1, step); geographic lattices only use step
+  typedef std::tuple<int, int, int, int, int, int> LatticeKey;
+  std::map<LatticeKey, GribSampleLattice> m_lattices;
+};
+
+#endif
@@ -68,9 +68,11 @@ struct GribOverlaySettings {
     return (input + CalibrationOffset(settings)) *
            CalibrationFactor(settings, input);
   }
+  /** True when the calibration factor of settings depends on the value. */
+  bool HasBeaufortUnits(int settings);
   int GetMinFromIndex(int index);
   wxString GetAltitudeFromIndex(int index, int unit);
-  double GetmstobfFactor(double input);
+  static double GetmstobfFactor(double input);
   double GetbftomsFactor(double input);
   wxString GetUnitSymbol(int settings);
   double GetMin(int settings);
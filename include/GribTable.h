@@ -55,11 +55,90 @@
 #include "DpGrib_pi.h"
 #include "ocpn_plugin.h"
 #include "CustomGrid.h"
+#include "GribTimeIndex.h"
+
+#include <vector>
 
 class GRIBUICtrlBar;
 
 enum NumericalRows { R_WIND, R_WAVES, R_CURRENT };
 
+/**
+ * Table model of the GRIB data table.
+ *
+ * Only the cursor position is read, with the point sampling of the control
+ * bar: a time step is sampled when one of its cells is first asked for, and
+ * cells are formatted as they are painted. Opening the table therefore costs
+ * the visible columns, not a timeline record set per time step.
+ */
+class GribTableData : public wxGridTableBase {
+public:
+  enum RowType {
+    WIND_DIR,
+    WIND_SPEED,
+    WIND_GUST,
+    PRESSURE,
+    WAVE_DIR,
+    WAVE_HSIG,
+    WAVE_PER,
+    RAINFALL,
+    CLOUD,
+    AIR_TEMP,
+    SEA_TEMP,
+    CAPE,
+    COMP_REFL,
+    CURRENT_DIR,
+    CURRENT_SPEED,
+    ROW_TYPE_COUNT
+  };
+
+  /**
+   * @param dialog Control bar of the active file.
+   * @param grid Grid showing the table, holds the direction display choice.
+   * @param lat Latitude of the sampled position.
+   * @param lon Longitude of the sampled position.
+   */
+  GribTableData(GRIBUICtrlBar &dialog, CustomGrid &grid, double lat,
+                double lon);
+
+  int GetNumberRows() override { return m_rows.size(); }
+  int GetNumberCols() override { return m_columns.size(); }
+  wxString GetValue(int row, int col) override;
+  void SetValue(int row, int col, const wxString &value) override {}
+  bool IsEmptyCell(int row, int col) override;
+  wxString GetRowLabelValue(int row) override;
+  wxString GetColLabelValue(int col) override;
+  bool CanHaveAttributes() override { return true; }
+  wxGridCellAttr *GetAttr(int row, int col,
+                          wxGridCellAttr::wxAttrKind kind) override;
+
+private:
+  /** Raw values of one time step at the position, by row type. */
+  struct Column {
+    time_t time;
+    bool sampled = false;
+    double values[ROW_TYPE_COUNT];
+    wxString label;
+  };
+
+  void AddRow(RowType type, const wxString &label);
+  const Column &GetColumn(int col);
+  double SampleScalar(int idx, time_t time, bool dir);
+  wxString Format(RowType type, double value, wxColour &colour) const;
+
+  GRIBUICtrlBar &m_dialog;
+  CustomGrid &m_grid;
+  double m_lat, m_lon;
+
+  std::vector<RowType> m_rows;
+  std::vector<wxString> m_rowLabels;
+  std::vector<Column> m_columns;
+  GribTimeCursor m_cursors[Idx_COUNT];
+
+  wxFont m_font;
+  wxColour m_defaultColour;
+};
+
 /**
  * Dialog showing GRIB data in a table format.
  *
@@ -95,29 +174,14 @@ public:
   void CloseDialog();
 
 private:
-  void AddDataRow(int num_rows, int num_cols, wxString label,
-                  wxGridCellAttr *row_attr);
   void AutoSizeDataRows();
   int GetVisibleRow(int col);
   void OnScrollToNowTimer(wxTimerEvent &event);
 
-  wxString GetWind(GribRecord **recordarray, int datatype, double &wdir);
-  wxString GetWindGust(GribRecord **recordarray, int datatype);
-  wxString GetPressure(GribRecord **recordarray);
-  wxString GetWaves(GribRecord **recordarray, int datatype, double &wdir);
-  wxString GetRainfall(GribRecord **recordarray);
-  wxString GetCloudCover(GribRecord **recordarray);
-  wxString GetAirTemp(GribRecord **recordarray);
-  wxString GetSeaTemp(GribRecord **recordarray);
-  wxString GetCAPE(GribRecord **recordarray);
-  wxString GetCompRefl(GribRecord **recordarray);
-  wxString GetCurrent(GribRecord **recordarray, int datatype, double &wdir);
-
   void OnClose(wxCloseEvent &event);
   void OnOKButton(wxCommandEvent &event);
 
   GRIBUICtrlBar *m_pGDialog;
-  wxColour m_pDataCellsColour;
   wxTimer m_tScrollToNowTimer;
 };
 
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Sorted timelines for the point queries.
+ *
+ * A GRIB file keeps one GribTimeIndex per record type, listing the record
+ * sets that hold the type in time order. Bracketing a time is a binary search
+ * instead of a walk over every set, and a GribTimeCursor turns the queries of
+ * a caller moving forward in time, like a routing calculation, into a check
+ * of the interval it used last.
+ */
+
+#ifndef GRIBTIMEINDEX_H
+#define GRIBTIMEINDEX_H
+
+#include <cstddef>
+#include <ctime>
+#include <vector>
+
+/**
+ * Position of the last bracketing done with it. Only a hint: a cursor that
+ * does not fit the index or time at hand costs a binary search, so one
+ * cursor per record type is enough whatever the file.
+ */
+struct GribTimeCursor {
+  size_t pos = 0;
+};
+
+class GribTimeIndex {
+public:
+  static const size_t NONE = (size_t)-1;
+
+  void Clear();
+  /** Appends a set, times must come in increasing order. */
+  void Add(time_t time, unsigned int set);
+
+  size_t Size() const { return m_times.size(); }
+  time_t Time(size_t k) const { return m_times[k]; }
+  /** Position of the set in the record set array of the file. */
+  unsigned int Set(size_t k) const { return m_sets[k]; }
+
+  /** First position at or after time, Size() if none. */
+  size_t LowerBound(time_t time) const;
+
+  /**
+   * Finds the positions around time. On an exact match before and after are
+   * both that position, otherwise before is the last earlier one and after
+   * the first later one, NONE when there is no such position.
+   *
+   * @param cursor Optional, tried first and updated.
+   * @return true if both before and after were found.
+   */
+  bool Bracket(time_t time, size_t &before, size_t &after,
+               GribTimeCursor *cursor = nullptr) const;
+
+private:
+  bool Around(size_t k, time_t time) const;
+
+  std::vector<time_t> m_times;
+  std::vector<unsigned int> m_sets;
+};
+
+#endif
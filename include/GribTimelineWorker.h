@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Background preparation of playback frames.
+ *
+ * During playback the control bar asks for the timeline record sets of the
+ * next few positions. Worker threads build them, temporal interpolation and
+ * magnitude grids included, while the current frame is on screen, and the
+ * playback timer only swaps in a finished set.
+ */
+
+#ifndef GRIBTIMELINEWORKER_H
+#define GRIBTIMELINEWORKER_H
+
+#include <ctime>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GribTimelineRecordSet;
+
+class GribTimelineWorker {
+public:
+  enum State { UNKNOWN, PENDING, READY };
+
+  /**
+   * Builds the set of one timeline position, or returns nullptr. Called from
+   * the worker threads: it must only read data that stays alive and unchanged
+   * until the next SetBuilder() or Clear().
+   */
+  typedef std::function<GribTimelineRecordSet *(time_t)> Builder;
+
+  GribTimelineWorker();
+  ~GribTimelineWorker();
+
+  /**
+   * Replaces the builder. Drops every frame and waits for the builds in
+   * progress, so the data the previous builder read may be freed afterwards.
+   * Nothing is built while the builder is empty.
+   */
+  void SetBuilder(Builder builder);
+
+  /**
+   * Makes times, in playback order, the look-ahead window: frames not known
+   * yet are queued, frames of other times are dropped.
+   */
+  void Request(const std::vector<time_t> &times);
+
+  State GetState(time_t time);
+
+  /**
+   * Takes the frame of time when it is READY; the caller then owns it.
+   * Returns nullptr otherwise.
+   */
+  GribTimelineRecordSet *Take(time_t time);
+
+  /** Stops the worker threads; further requests are ignored. */
+  void Stop();
+
+private:
+  struct Frame {
+    ~Frame();
+
+    time_t time;
+    bool running = false;
+    bool done = false;
+    bool cancelled = false;
+    GribTimelineRecordSet *set = nullptr;  // guarded by m_mutex
+  };
+
+  void Run();
+  void DropAll(std::unique_lock<std::mutex> &lock);
+  std::shared_ptr<Frame> Find(time_t time);
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;    // work queued or stopping
+  std::condition_variable m_idle;  // a build finished
+  std::list<std::shared_ptr<Frame>> m_frames;  // playback order
+  Builder m_builder;
+  int m_running = 0;  // builds in progress
+  bool m_stop = false;
+  std::vector<std::thread> m_threads;
+};
+
+#endif
@@ -47,12 +47,24 @@
 #include <wx/fileconf.h>
 #include <wx/glcanvas.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
 #include "GribUIDialogBase.h"
 #include "CursorData.h"
 #include "GribSettingsDialog.h"
 #include "GribRequestDialog.h"
+#include "GribCache.h"
+#include "GribDirectoryWatcher.h"
 #include "GribReader.h"
 #include "GribRecordSet.h"
+#include "GribPlaybackStats.h"
+#include "GribTimeIndex.h"
+#include "GribTimelineWorker.h"
 #include "IsoLine.h"
 #include "GrabberWin.h"
 
@@ -162,6 +174,18 @@ public:
 
   void ClearCachedData();
 
+  /**
+   * Returns the magnitude of the vector whose components are records idx and
+   * idy, built on first use and then kept with the set.
+   *
+   * The cache is keyed by idx alone: a given x component always pairs with
+   * the same y component.
+   *
+   * @return Record owned by the set; not isOk() when the components can not
+   * be combined. nullptr when either component is missing.
+   */
+  GribRecord *GetMagnitudeRecord(int idx, int idy);
+
   /**
    * Array of cached isobar calculations for each data type (wind, pressure,
    * etc).
@@ -170,6 +194,9 @@ public:
    * Used to speed up rendering by avoiding recalculation of isobars.
    */
   wxArrayPtrVoid *m_IsobarArray[Idx_COUNT];
+
+private:
+  GribRecord *m_MagnitudeArray[Idx_COUNT];
 };
 
 //----------------------------------------------------------------------------------------------------------
@@ -192,6 +219,12 @@ public:
   ~GRIBUICtrlBar();
 
   void OpenFile(bool newestFile = false);
+  /**
+   * Watches the GRIB directory for new or updated files when the plugin
+   * setting asks for it, stops watching otherwise. Files arriving are merged
+   * into the active file in the background, see IngestFiles().
+   */
+  void UpdateDirectoryWatch();
 
   void ContextMenuItemCallback(int id);
   void SetFactoryOptions();
@@ -223,7 +256,45 @@ public:
    * data, or NULL if no valid data.
    */
   GribTimelineRecordSet *GetTimeLineRecordSet(wxDateTime time);
+  /**
+   * GetTimeLineRecordSet() on any file. Only reads the record sets and the
+   * per type time indexes, so it can run on a worker thread while the file
+   * stays open.
+   *
+   * @param file The file.
+   * @param time The target datetime.
+   */
+  static GribTimelineRecordSet *BuildTimeLineRecordSet(GRIBFile *file,
+                                                       wxDateTime time);
+  /**
+   * Finds the file record sets bracketing a time for one record type.
+   *
+   * @param idx Idx_* of the record type.
+   * @param time Time to bracket.
+   * @param GRS1 Set at or before time.
+   * @param GRS2 Set at or after time; same as GRS1 on an exact match.
+   * @param interp Weight of GRS2 for a linear interpolation in time.
+   * @return false if time is out of the range covered by idx.
+   */
+  bool GetBracketingRecordSets(int idx, wxDateTime time, GribRecordSet *&GRS1,
+                               GribRecordSet *&GRS2, double &interp);
+  /** GetBracketingRecordSets() on the record sets of any file. */
+  static bool GetBracketingRecordSets(GRIBFile *file, int idx,
+                                      wxDateTime time, GribRecordSet *&GRS1,
+                                      GribRecordSet *&GRS2, double &interp);
+  /**
+   * Returns the timeline positions that follow a time, as playback or the
+   * "next" button would reach them.
+   *
+   * @param time Current timeline position.
+   * @param count Maximum number of positions.
+   * @param times Receives the positions, in order.
+   */
+  void GetNextTimelineTimes(wxDateTime time, int count,
+                            std::vector<wxDateTime> &times);
   void StopPlayBack();
+  /** Pacing figures of the current or last playback. */
+  DpGrib::PlaybackStats GetPlaybackStats();
   void TimelineChanged();
   void CreateActiveFileFromNames(const wxArrayString &filenames);
   void PopulateComboDataList();
@@ -258,11 +329,18 @@ public:
   void SetScaledBitmap(double factor);
   void OpenFileFromJSON(wxString json);
 
-  //
+  /**
+   * Value of record type idx at a position, linearly interpolated in time.
+   *
+   * @param cursor Speeds up callers querying forward in time, see
+   * GribTimeCursor. Without one, a cursor of the calling thread is used.
+   */
   double getTimeInterpolatedValue(int idx, double lon, double lat,
-                                  wxDateTime t);
+                                  wxDateTime t,
+                                  GribTimeCursor *cursor = nullptr);
   bool getTimeInterpolatedValues(double &M, double &A, int idx1, int idx2,
-                                 double lon, double lat, wxDateTime t);
+                                 double lon, double lat, wxDateTime t,
+                                 GribTimeCursor *cursor = nullptr);
   
   /**
    * Get formatted GRIB value at a point for a given layer.
@@ -326,8 +404,11 @@ public:
   /** Plugin instance that owns this control bar. */
   DpGrib_pi *pPlugIn;
   GribRequestSetting *pReq_Dialog;
-  /** Currently active GRIB file being displayed. */
-  GRIBFile *m_bGRIBActiveFile;
+  /**
+   * Currently active GRIB file being displayed. Dataset snapshots share it
+   * and keep it alive after another file is opened.
+   */
+  std::shared_ptr<GRIBFile> m_bGRIBActiveFile;
   bool m_bDataPlot[GribOverlaySettings::GEO_ALTITUDE];  // only for no altitude
                                                         // parameters
   bool m_CDataIsShown;
@@ -414,7 +495,26 @@ private:
 
   wxDateTime MinTime();
   wxArrayString GetFilesInDirectory();
+  /**
+   * Merges files into the active file on a worker thread, or queues them
+   * while a merge runs. The view moves over to the merged file once ready.
+   */
+  void IngestFiles(const wxArrayString &files);
+  void OnFilesIngested(std::shared_ptr<GRIBFile> base,
+                       std::shared_ptr<GRIBFile> merged);
+  /** Shows file, a merge of the active file, at the time shown now. */
+  void SwapActiveFile(const std::shared_ptr<GRIBFile> &file);
   void SetGribTimelineRecordSet(GribTimelineRecordSet *pTimelineSet);
+  /**
+   * The set of time, taken from the playback frames when ready and built here
+   * otherwise. During playback also asks for the frames that follow.
+   */
+  GribTimelineRecordSet *TakeTimeLineRecordSet(wxDateTime time);
+  /** Has the playback frames following time built in the background. */
+  void RequestPlaybackFrames(wxDateTime time);
+  void StartPlaybackPacing();
+  /** Timeline steps due at this timer event, 0 if it came early. */
+  int PlaybackStepsDue();
   int GetNearestIndex(wxDateTime time, int model);
   int GetNearestValue(wxDateTime time, int model);
   bool GetGribZoneLimits(GribTimelineRecordSet *timelineSet, double *latmin,
@@ -441,6 +541,27 @@ private:
   bool m_pNowMode;
   bool m_HasAltitude;
 
+  // Files arriving in m_grib_dir, merged by m_ingestThread
+  GribDirectoryWatcher m_dirWatcher;
+  std::thread m_ingestThread;
+  wxArrayString m_ingestQueue;  // arrived during a merge
+
+  // Playback frames built ahead of the displayed one
+  GribTimelineWorker m_timelineWorker;
+  int m_playbackLookAhead;      // config key PlaybackLookAhead
+  unsigned int m_playbackFile;  // GRIBFile counter the frames are built from
+  int m_playbackAltitude;       // m_Altitude the frames are built for
+
+  // Playback pacing, monotonic ms (see OnPlayStopTimer)
+  double m_playbackPeriodMs;      // timer period of the schedule
+  double m_playbackStartMs;       // playback start
+  double m_playbackLastMs;        // last frame shown
+  double m_playbackDueMs;         // next timeline step falls due
+  double m_playbackPrepMs;        // preparation time of the frame on screen
+  int m_playbackStride;           // steps per shown frame, for the look-ahead
+  unsigned long m_playbackSteps;  // steps advanced, skipped ones included
+  DpGrib::PlaybackStats m_playbackStats;
+
   bool m_SelectionIsSaved;
   int m_Selection_index;
   wxString m_Selection_label;
@@ -489,6 +610,24 @@ public:
    */
   GRIBFile(const wxArrayString &file_names, bool CumRec, bool WaveRec,
            bool newestFile = false);
+  /**
+   * Creates a GRIBFile holding the records of base and those of more files,
+   * decoding only the latter.
+   *
+   * Records of file_names replace those of base of the same kind and time,
+   * base itself is left as it is and shares its records with the new file.
+   * Safe to call on any thread while base is in use.
+   *
+   * Accumulations are differenced, and missing records copied, along the
+   * whole timeline: when file_names hold such records, or another run than
+   * base, the merge is refused and NeedsFullLoad() tells to load all the
+   * files instead.
+   *
+   * @param file_names GRIB files to add, replacing their previous version
+   * when base holds it.
+   */
+  GRIBFile(const std::shared_ptr<GRIBFile> &base,
+           const wxArrayString &file_names, bool CumRec, bool WaveRec);
   ~GRIBFile();
 
   /**
@@ -496,6 +635,8 @@ public:
    * @return true if at least one valid GRIB record was loaded.
    */
   bool IsOK(void) { return m_bOK; }
+  /** Whether a merge was refused, see the merging constructor. */
+  bool NeedsFullLoad() const { return m_bNeedsFullLoad; }
   /**
    * Gets the list of source filenames being used.
    * When newestFile=true, will contain only the newest file.
@@ -527,22 +668,64 @@ public:
 
   const unsigned int GetCounter() { return m_counter; }
 
+  /** Times of all record sets, in array order. */
+  const GribTimeIndex &GetSetTimeIndex() const { return m_SetTimeIndex; }
+  /**
+   * Times of the record sets holding a record of type idx, at the record
+   * current date. Built with the file.
+   */
+  const GribTimeIndex &GetTimeIndex(int idx) const { return m_TimeIndex[idx]; }
+  /**
+   * Times of the record sets holding both idx1 and idx2, as used by vector
+   * queries. Built on first use.
+   */
+  const GribTimeIndex &GetTimeIndex(int idx1, int idx2);
+
   WX_DEFINE_ARRAY_INT(int, GribIdxArray);
   GribIdxArray m_GribIdxArray;
 
 private:
+  /**
+   * Owner of records: a reader, or a cache they were loaded from. Files
+   * merged from this one share it while their sets hold its records.
+   */
+  struct RecordStore {
+    std::unique_ptr<GribReader> reader;
+    std::unique_ptr<GribCache> cache;
+    std::unordered_set<const GribRecord *> records;  //!< Those in sets
+  };
+
+  static bool ReadFiles(GribReader &reader, const wxArrayString &file_names,
+                        bool newestFile, wxString &file_name);
+  static void FixupRecords(GribReader &reader, bool CumRec, bool WaveRec);
+  /** Whether FixupRecords() would change or add records of reader. */
+  static bool HasFixupRecords(GribReader &reader, bool WaveRec);
+  static void CollectRecords(const std::vector<GribRecordSet *> &sets,
+                             std::unordered_set<const GribRecord *> &records);
+  /** Takes the record sets from the cache of key, if there is a valid one. */
+  bool LoadCache(const GribCache::Key &key);
+  /** Builds m_TimeIndex from the record sets. */
+  void IndexTimes();
+
   static unsigned int ID;  //!< Unique identifier counter for GRIBFile instances
 
   const unsigned int m_counter;  //!< This instance's unique ID
   bool m_bOK;                    //!< Whether file loading succeeded
+  bool m_bNeedsFullLoad = false;  //!< Whether a merge was refused
   wxString m_last_message;       //!< Error message if loading failed
   wxArrayString m_FileNames;     //!< Source GRIB filenames
-  GribReader *m_pGribReader;     //!< Parser for GRIB file format
+  /** Where the records of the sets are, this file's own one first. */
+  std::vector<std::shared_ptr<RecordStore>> m_Stores;
   time_t m_pRefDateTime;         //!< Reference time of the model run
 
   /** An array of GribRecordSets found in this GRIB file. */
   ArrayOfGribRecordSets m_GribRecordSetArray;
 
+  GribTimeIndex m_SetTimeIndex;
+  GribTimeIndex m_TimeIndex[Idx_COUNT];
+  std::map<int, GribTimeIndex> m_PairTimeIndex;  //!< Keyed by idx1, idx2
+  std::mutex m_PairTimeIndexMutex;
+
   int m_nGribRecords;
 };
 
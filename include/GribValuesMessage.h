@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Batched GRIB_VALUES messages.
+ *
+ * GRIB_VALUES_REQUEST answers one point per message and goes through a full
+ * JSON tree both ways. GRIB_VALUES_BATCH_REQUEST carries many points and has
+ * a fixed, flat layout read by a small scanner:
+ *
+ *     {"Id": 7, "Fields": "WIND,CURRENT,GUST,SWELL",
+ *      "Points": [lat, lon, time, lat, lon, time, ...]}
+ *
+ * Id, optional, is a string or a number and is echoed as sent. Times are
+ * seconds since the epoch (UTC). Instead of "Points", "Binary" may hold the
+ * same numbers as base64 encoded little-endian IEEE doubles, and "Reply":
+ * "binary" asks for the values that way too.
+ *
+ * The GRIB_VALUES_BATCH reply echoes Id and Fields, gives Count, and lists
+ * the values point by point in field order: wind speed and direction,
+ * current speed and direction, gust, significant wave height. Values are in
+ * record units like the GRIB_VALUES reply; missing ones are null in JSON and
+ * GRIB_NOTDEF in binary.
+ *
+ * One GribValuesBatch is meant to serve every message: its buffers keep
+ * their capacity, so a steady stream of requests of similar size does not
+ * allocate beyond the time sort of the sampler.
+ */
+
+#ifndef GRIBVALUESMESSAGE_H
+#define GRIBVALUESMESSAGE_H
+
+#include <string>
+#include <vector>
+
+#include "GribSampleQuery.h"
+
+class GRIBFile;
+
+class GribValuesBatch {
+public:
+  enum Field { WIND = 1, CURRENT = 2, GUST = 4, SWELL = 8 };
+
+  /**
+   * Reads a GRIB_VALUES_BATCH_REQUEST body.
+   * @return false if it is malformed or asks for no known field.
+   */
+  bool Parse(const char *body);
+
+  /** Number of values per point for the requested fields. */
+  int ValuesPerPoint() const;
+
+  /**
+   * Samples the parsed points.
+   * @param file May be null, all values are then missing.
+   */
+  void Sample(GRIBFile *file);
+
+  /** Writes the GRIB_VALUES_BATCH body of the sampled values. */
+  void FormatReply(std::string &out) const;
+
+  unsigned int GetFields() const { return m_fields; }
+  const std::vector<DpGrib::SampleQuery> &GetPoints() const {
+    return m_points;
+  }
+  /** ValuesPerPoint() values per point, GRIB_NOTDEF if missing. */
+  const std::vector<double> &GetValues() const { return m_values; }
+
+  static void EncodeBase64(const void *data, size_t size, std::string &out);
+  static bool DecodeBase64(const char *text, size_t size,
+                           std::vector<char> &data);
+
+private:
+  std::string m_id;  // Id token, string or number, echoed
+  unsigned int m_fields = 0;
+  bool m_binaryReply = false;
+  std::vector<DpGrib::SampleQuery> m_points;
+  std::vector<double> m_values;
+  std::vector<DpGrib::SampleValue> m_samples;
+  std::vector<char> m_binary;
+};
+
+#endif
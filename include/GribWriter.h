@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Encoding grids as GRIB messages.
+ *
+ * The counterpart of the decoders, for building test and benchmark files
+ * that GribReader reads: one regular latitude/longitude grid per message,
+ * GRIB1 with simple packing or GRIB2 with any of the data templates the
+ * decoder knows, missing values given by a bitmap.
+ */
+
+#ifndef GRIBWRITER_H
+#define GRIBWRITER_H
+
+#include <ctime>
+#include <vector>
+
+class GribWriter {
+public:
+  /** GRIB2 data representation templates, GRIB1 only has SIMPLE. */
+  enum Packing {
+    SIMPLE = 0,              ///< 5.0
+    COMPLEX = 2,             ///< 5.2
+    COMPLEX_SPATIAL = 3,     ///< 5.3, second order differences by default
+    IEEE = 4,                ///< 5.4
+    JPEG2000 = 40,           ///< 5.40, lossless
+  };
+
+  struct Field {
+    int edition = 2;
+    /** Parameter, GRIB2 discipline, category and number. */
+    int discipline = 0, category = 0, number = 0;
+    /** Parameter, GRIB1 table 2. */
+    int parameter = 0;
+    /**
+     * Level, from GRIB2 table 4.5 or GRIB1 table 3 depending on the edition,
+     * e.g. 103 or 105 for a height above ground.
+     */
+    int levelType = 1, levelValue = 0;
+    int center = 7;   ///< NCEP
+    int process = 2;  ///< GRIB1 model or GRIB2 generating process
+    time_t reference = 0;
+    int forecastHours = 0;
+
+    /**
+     * Grid of ni by nj points, the first at lon1, lat1, row after row.
+     * di > 0, dj < 0 for rows going north to south.
+     */
+    int ni = 0, nj = 0;
+    double lon1 = 0, lat1 = 0, di = 1, dj = -1;
+
+    Packing packing = SIMPLE;
+    /** Bits a value: the precision of the packed templates, 32 or 64 for
+     * IEEE. */
+    int bits = 16;
+    /** Values are packed in units of 10^-decimalScale. */
+    int decimalScale = 0;
+    /** Order of the differences of COMPLEX_SPATIAL, 1 or 2. */
+    int spatialOrder = 2;
+
+    /** ni * nj values, GRIB_NOTDEF for missing ones. */
+    const double *values = nullptr;
+  };
+
+  /**
+   * Appends a message holding field to out.
+   * @return False when the field can't be encoded: an unknown edition or
+   * packing, a bit count out of range, no or too many values.
+   */
+  static bool Encode(const Field &field, std::vector<unsigned char> &out);
+
+  /**
+   * Greatest difference between a value of field and what decoding its
+   * message gives back.
+   */
+  static double Tolerance(const Field &field);
+
+private:
+  /** Integer packing of the values, as value * 10^D = R + X * 2^E. */
+  struct Packed {
+    double reference = 0;  // R
+    int binaryScale = 0;   // E
+    int bits = 0;          // needed by the largest X
+    std::vector<unsigned int> x;
+    std::vector<bool> present;
+    size_t count = 0;  // of present values
+  };
+
+  static bool Pack(const Field &field, bool ibmReference, Packed &packed);
+
+  static bool EncodeGrib1(const Field &field, std::vector<unsigned char> &out);
+  static bool EncodeGrib2(const Field &field, std::vector<unsigned char> &out);
+
+  static void DataSimple(const Packed &packed, int bits,
+                         std::vector<unsigned char> &section);
+  static bool DataComplex(const Field &field, const Packed &packed,
+                          std::vector<unsigned char> &drs,
+                          std::vector<unsigned char> &data);
+  static bool DataJpeg2000(const Field &field, const Packed &packed,
+                           std::vector<unsigned char> &data);
+};
+
+#endif
@@ -46,19 +46,18 @@
 #include <cmath>
 #include <vector>
 #include <list>
+#include <map>
 #include <set>
+#include <tuple>
 
 #include "ocpn_plugin.h"
 
 #include "GribReader.h"
+#include "IsoLineTracer.h"
 
 class ViewPort;
 class wxDC;
 
-class Segment;
-WX_DECLARE_LIST(Segment, MySegList);
-WX_DECLARE_LIST(MySegList, MySegListList);
-
 //-------------------------------------------------------------------------------------------------------
 //  Cohen & Sutherland Line clipping algorithms
 //-------------------------------------------------------------------------------------------------------
@@ -90,32 +89,6 @@ extern "C" ClipResult cohen_sutherland_line_clip_i(int *x0, int *y0, int *x1,
 
 #endif
 
-// TODO: join segments and draw a spline
-
-//===============================================================
-// Elément d'isobare qui passe dans un carré (ab-cd)de la grille.
-// a  b
-// c  d
-// Rejoint l'arête (i,j)-(k,l) à l'arête (m,n)-(o,p) (indices ds la grille GRIB)
-
-class Segment {
-public:
-  Segment(int I, int w, int J, char c1, char c2, char c3, char c4,
-          const GribRecord *rec, double pressure);
-
-  int i, j, k, l;   // arête 1
-  double px1, py1;  // Coordonées de l'intersection (i,j)-(k,l)
-  int m, n, o, p;   // arête 2
-  double px2, py2;  // Coordonées de l'intersection (m,n)-(o,p)
-  bool bUsed;
-
-private:
-  void traduitCode(int I, int w, int J, char c1, int &i, int &j);
-
-  void intersectionAreteGrille(int i, int j, int k, int l, double *x, double *y,
-                               const GribRecord *rec, double pressure);
-};
-
 class GRIBOverlayFactory;
 class TexFont;
 
@@ -125,6 +98,23 @@ public:
   IsoLine(double val, double coeff, double offset, const GribRecord *rec);
   ~IsoLine();
 
+  /**
+   * Builds the isolines of several levels in a single pass over the grid.
+   *
+   * Each grid cell is only tested against the levels lying between its
+   * minimum and maximum corner values, and the segments of every level are
+   * joined into continuous polylines by hashing the grid edges they cross.
+   *
+   * @param values Level values as displayed, used for labels.
+   * @param rawValues Matching level values in the units of the record.
+   * @param rec Record to contour.
+   * @return One new IsoLine per level, in the order of values; owned by
+   * the caller.
+   */
+  static std::vector<IsoLine *> BuildIsoLines(
+      const std::vector<double> &values, const std::vector<double> &rawValues,
+      const GribRecord *rec);
+
   void drawIsoLine(GRIBOverlayFactory *pof, wxDC *dc, PlugIn_ViewPort *vp,
                    bool bHiDef);
 
@@ -134,32 +124,56 @@ public:
                            int density, int first, wxString label,
                            wxColour &color, TexFont &texfont);
 
-  int getNbSegments() { return trace.size(); }
+  int getNbSegments() { return m_lines.points.size() - getNbLines(); }
+  int getNbLines() {
+    return m_lines.lineStart.size() ? m_lines.lineStart.size() - 1 : 0;
+  }
+
+  /**
+   * Zoom band of a viewport, from its view_scale_ppm: each band up doubles
+   * the tolerance used to simplify the isolines, negative bands draw them at
+   * full resolution.
+   */
+  static int getZoomBand(PlugIn_ViewPort *vp);
 
   double getValue() { return value; }
 
 private:
+  IsoLine(double val, const GribRecord *rec);
+
   double value;
   int W, H;  // taille de la grille
-  const GribRecord *rec;
 
   wxColour isoLineColor;
-  std::list<Segment *> trace;
-
-  void intersectionAreteGrille(int i, int j, int k, int l, double *x, double *y,
-                               const GribRecord *rec);
-
-  //-----------------------------------------------------------------------
-  // Génère la liste des segments.
-  // Les coordonnées sont les indices dans la grille du GribRecord
-  //---------------------------------------------------------
-  void extractIsoLine(const GribRecord *rec);
-  MySegList *BuildContinuousSegment(void);
-
-  MySegList m_seglist;
-  MySegListList m_SegListList;
 
-  double m_pixelMM;
+  IsoLinePolylines m_lines;  // full resolution
+
+  // Douglas-Peucker simplified m_lines, built on first use of each zoom band
+  std::map<int, IsoLinePolylines> m_simplified;
+  const IsoLinePolylines &getPolylines(int band);
+
+  // Points labels may go at, with their Mercator position in degrees, per
+  // density and first label
+  struct LabelCandidate {
+    IsoLinePoint pt;
+    double x, y;
+  };
+  std::map<std::pair<int, int>, std::vector<LabelCandidate>> m_labelCandidates;
+
+  // Label positions, per step of view scale and rotation and label layout
+  struct LabelKey {
+    int scale, rotation;
+    int density, first, width, height;
+    bool operator<(const LabelKey &k) const {
+      return std::tie(scale, rotation, density, first, width, height) <
+             std::tie(k.scale, k.rotation, k.density, k.first, k.width,
+                      k.height);
+    }
+  };
+  std::map<LabelKey, std::vector<IsoLinePoint>> m_labelCache;
+  const std::vector<IsoLinePoint> &getLabelPositions(PlugIn_ViewPort *vp,
+                                                     int density, int first,
+                                                     int width, int height);
 };
 
 #endif
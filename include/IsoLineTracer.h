@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Contour tracing for IsoLine, free of wxWidgets and OpenCPN.
+ *
+ * A single pass over the grid tests each cell against the levels lying
+ * between its minimum and maximum corner values only, and the segments of
+ * each level are joined into continuous polylines by hashing the grid edges
+ * they cross.
+ */
+
+#ifndef ISOLINETRACER_H
+#define ISOLINETRACER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "GribRecord.h"
+
+// Point of an isoline, in grid coordinates (lon, lat).
+struct IsoLinePoint {
+  double x, y;
+};
+
+// Continuous polylines stored back to back: line k runs from
+// points[lineStart[k]] to points[lineStart[k + 1] - 1].
+struct IsoLinePolylines {
+  std::vector<IsoLinePoint> points;
+  std::vector<size_t> lineStart;
+};
+
+class IsoLineTracer {
+public:
+  /**
+   * Traces the isolines of several levels.
+   *
+   * @param values The grid.Ni * grid.Nj values, as GribRecord::getValues()
+   * has them; GRIB_NOTDEF cells are skipped.
+   * @param grid Geometry of the grid. A grid going all around the world is
+   * closed across the antimeridian.
+   * @param levels Levels to trace, in any order.
+   * @param lines [out] The polylines of each level, in the order of levels.
+   */
+  static void Trace(const double *values, const GribGridGeometry &grid,
+                    const std::vector<double> &levels,
+                    std::vector<IsoLinePolylines> &lines);
+};
+
+#endif
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Background isoline generation.
+ *
+ * Contours are built on a worker thread so that the render path never waits
+ * on them. The overlay factory requests the isolines of the displayed
+ * timeline position plus a few positions ahead, draws whatever levels are
+ * ready and is told when more arrive.
+ */
+
+#ifndef ISOLINEWORKER_H
+#define ISOLINEWORKER_H
+
+#include <ctime>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GribRecord;
+class IsoLine;
+
+/** Identifies the isolines of one layer at one timeline position. */
+struct IsoLineKey {
+  unsigned int fileId;  //!< GRIBFile counter of the source file
+  time_t time;          //!< Timeline position
+  int idx;              //!< Idx_* of the contoured record
+  std::vector<double> rawValues;  //!< Levels, in record units
+
+  bool operator==(const IsoLineKey &k) const {
+    return fileId == k.fileId && time == k.time && idx == k.idx &&
+           rawValues == k.rawValues;
+  }
+};
+
+/**
+ * Records contoured by a job, GribRecord::SharedView() views of the file
+ * records: the job keeps their grids alive without copying them.
+ *
+ * x1 alone is contoured as is. With y1 the magnitude of (x1, y1) is used.
+ * With x2 (and y2) the record is first interpolated in time from the "1"
+ * records towards the "2" ones by interp.
+ */
+struct IsoLineSource {
+  std::shared_ptr<const GribRecord> x1, y1, x2, y2;
+  double interp = 0.;
+};
+
+class IsoLineWorker {
+public:
+  enum State { UNKNOWN, PENDING, READY };
+
+  IsoLineWorker();
+  ~IsoLineWorker();
+
+  /**
+   * Sets the function called, from the worker thread, each time new levels
+   * become available. Its argument tells whether the job was urgent, i.e.
+   * for what is on screen rather than a look-ahead.
+   */
+  void SetReadyCallback(std::function<void(bool urgent)> callback);
+
+  /**
+   * Queues the isolines of key. Urgent requests go ahead of look-ahead ones;
+   * re-requesting a queued look-ahead as urgent promotes it.
+   */
+  void Request(const IsoLineKey &key, const std::vector<double> &values,
+               const IsoLineSource &source, bool urgent);
+
+  /** True when key is queued, being built or ready. */
+  bool IsKnown(const IsoLineKey &key);
+
+  /**
+   * Gets the isolines of key.
+   *
+   * READY: all levels are built; they are moved to lines, the caller now
+   * owns them and the worker forgets key.
+   * PENDING: lines receives the levels built so far, still owned by the
+   * worker and only valid until the next call on this object.
+   * UNKNOWN: key was never requested, or was dropped.
+   */
+  State Fetch(const IsoLineKey &key, std::vector<IsoLine *> &lines);
+
+  /** Drops every queued and built job. */
+  void Clear();
+
+  /** Stops the worker thread; further requests are ignored. */
+  void Stop();
+
+private:
+  struct Job {
+    ~Job();
+
+    IsoLineKey key;
+    std::vector<double> values;
+    IsoLineSource source;
+    bool urgent;
+    bool running = false;
+    bool cancelled = false;
+    bool done = false;
+    std::vector<IsoLine *> lines;  // guarded by m_mutex
+  };
+
+  void Run();
+  void Build(const std::shared_ptr<Job> &job);
+  void Trim(unsigned int fileId);
+  std::shared_ptr<Job> Find(const IsoLineKey &key);
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::list<std::shared_ptr<Job>> m_jobs;  // queue order, most urgent first
+  std::function<void(bool)> m_readyCallback;
+  bool m_stop = false;
+  std::thread m_thread;
+};
+
+#endif
@@ -41,6 +41,8 @@
 #ifndef __TEXFONT_H__
 #define __TEXFONT_H__
 
+#include <vector>
+
 /* support ascii plus degree symbol for now pack font in a single texture 16x8
  */
 #define DEGREE_GLYPH 127
@@ -78,6 +80,12 @@ public:
   void RenderString(const wxString &string, int x = 0, int y = 0);
   bool IsBuilt() { return m_built; }
 
+  /* append the glyphs of string at x, y as two triangles each of
+     (x, y, u, v) vertexes, to be drawn later with GetTexture() bound */
+  void GetGlyphQuads(const wxString &string, int x, int y,
+                     std::vector<float> &vertexes);
+  unsigned int GetTexture() { return texobj; }
+
 private:
   void GetTextExtent(const char *string, int *width, int *height);
   void RenderGlyph(int c);
@@ -55,10 +55,8 @@ CustomGrid::CustomGrid(wxWindow* parent, wxWindowID id, const wxPoint& pos,
   }
   if (m_IsDigit.Len() != wxString(_T("XXX")).Len()) m_IsDigit = _T("XXX");
   // create structure for all numerical rows
-  for (unsigned int i = 0; i < m_IsDigit.Len(); i++) {
+  for (unsigned int i = 0; i < m_IsDigit.Len(); i++)
     m_NumRow.push_back(wxNOT_FOUND);
-    m_NumRowVal.push_back(std::vector<double>());
-  }
   // init labels attr
   wxFont labelfont = GetOCPNGUIScaledFont_PlugIn(_("Dialog")).MakeBold();
   SetLabelFont(labelfont);
@@ -110,7 +108,6 @@ CustomGrid::~CustomGrid() {
     pConf->SetPath(_T ( "/Settings/GRIB" ));
     pConf->Write(_T ( "GribDataTableRowPref" ), m_IsDigit);
   }
-  m_NumRowVal.clear();
   m_NumRow.clear();
 }
 
@@ -241,19 +238,7 @@ void CustomGrid::OnLabeClick(wxGridEvent& event) {
         m_IsDigit.SetChar(idx, '.');
       else
         m_IsDigit.SetChar(idx, 'X');
-      for (int c = 0; c < m_numCols; c++) {
-        double value = m_NumRowVal[idx][c];
-        /*Current direction is generally reported as the "flow" direction, which
-         * is opposite from wind convention. So, adjust.*/
-        if (idx == R_CURRENT && m_IsDigit.GetChar(idx) == 'X' &&
-            value != GRIB_NOTDEF) {
-          value += 180;
-          if (value >= 360) value -= 360;
-          if (value < 0) value += 360;
-        }
-        SetCellRenderer(
-            row, c, new CustomRenderer(value, m_IsDigit.GetChar(idx) == 'X'));
-      }
+      // the table gives the renderers of the new format on the next paint
       m_tRefreshTimer.Start(10, wxTIMER_ONE_SHOT);
     }
   }
@@ -267,19 +252,8 @@ int CustomGrid::GetRowIndex(int row) {
   return idx;
 }
 
-void CustomGrid::SetNumericalRow(int row, int col, int datatype, double value) {
+void CustomGrid::SetNumericalRow(int row, int datatype) {
   m_NumRow[datatype] = row;
-  m_NumRowVal[datatype].push_back(value);
-  /*Current direction is generally reported as the "flow" direction,which is
-   * opposite from wind convention. So, adjust.*/
-  if (datatype == R_CURRENT && m_IsDigit.GetChar(datatype) == 'X' &&
-      value != GRIB_NOTDEF) {
-    value += 180;
-    if (value >= 360) value -= 360;
-    if (value < 0) value += 360;
-  }
-  SetCellRenderer(
-      row, col, new CustomRenderer(value, m_IsDigit.GetChar(datatype) == 'X'));
 }
 
 void CustomGrid::OnMouseEvent(wxMouseEvent& event) {
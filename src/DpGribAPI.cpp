@@ -143,6 +143,9 @@ void DpGribAPI::NotifyStateChanged() {
             callback();
         }
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostState();
+    }
 }
 
 uint64_t DpGribAPI::AddDataChangedCallback(std::function<void()> callback) {
@@ -164,6 +167,9 @@ void DpGribAPI::NotifyDataChanged() {
             callback();
         }
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostData();
+    }
 }
 
 // =============================================================================
@@ -189,6 +195,10 @@ void DpGribAPI::NotifyLayerStateChanged(const std::vector<int>& disabledLayerIds
             callback(disabledLayerIds);
         }
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostLayerState(
+            disabledLayerIds);
+    }
 }
 
 // =============================================================================
@@ -214,6 +224,10 @@ void DpGribAPI::NotifyFormatStateChanged(const std::vector<std::pair<int, int>>&
             callback(changedFormats);
         }
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostFormatState(
+            changedFormats);
+    }
 }
 
 // =============================================================================
@@ -454,6 +468,10 @@ void DpGribAPI::NotifyCursorPosition(double latitude, double longitude) {
         auto &callback = kv.second;
         if (callback) callback(latitude, longitude);
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostCursor(latitude,
+                                                                    longitude);
+    }
 }
 
 // =============================================================================
@@ -479,6 +497,10 @@ void DpGribAPI::NotifyDownloadProgress(long transferred, long total,
             callback(transferred, total, completed, success);
         }
     }
+    if (m_plugin) {
+        static_cast<DpGrib_pi*>(m_plugin)->GetEventBus().PostDownloadProgress(
+            transferred, total, completed, success);
+    }
 }
 
 // =============================================================================
@@ -259,6 +259,8 @@ void DpGribGPUParticles::UploadWindData(GribRecord *pGRX, GribRecord *pGRY) {
   int Ni = pGRX->getNi();
   int Nj = pGRX->getNj();
   bool flipJ = (pGRX->getDj() < 0);
+  const double *uValues = pGRX->getValues(), *vValues = pGRY->getValues();
+  if (!uValues || !vValues) return;
 
   std::vector<float> uData(Ni * Nj);
   std::vector<float> vData(Ni * Nj);
@@ -266,8 +268,8 @@ void DpGribGPUParticles::UploadWindData(GribRecord *pGRX, GribRecord *pGRY) {
   for (int j = 0; j < Nj; j++) {
     int srcJ = flipJ ? (Nj - 1 - j) : j;
     for (int i = 0; i < Ni; i++) {
-      double valU = pGRX->getValue(i, srcJ);
-      double valV = pGRY->getValue(i, srcJ);
+      double valU = uValues[srcJ * Ni + i];
+      double valV = vValues[srcJ * Ni + i];
       uData[j * Ni + i] = (valU == GRIB_NOTDEF) ? 0.0f : (float)valU;
       vData[j * Ni + i] = (valV == GRIB_NOTDEF) ? 0.0f : (float)valV;
     }
@@ -336,12 +338,14 @@ void DpGribGPUParticles::UploadWavePeriodData(GribRecord *pGRPer) {
   int Ni = pGRPer->getNi();
   int Nj = pGRPer->getNj();
   bool flipJ = (pGRPer->getDj() < 0);
+  const double *values = pGRPer->getValues();
+  if (!values) return;
 
   std::vector<float> perData(Ni * Nj);
   for (int j = 0; j < Nj; j++) {
     int srcJ = flipJ ? (Nj - 1 - j) : j;
     for (int i = 0; i < Ni; i++) {
-      double val = pGRPer->getValue(i, srcJ);
+      double val = values[srcJ * Ni + i];
       perData[j * Ni + i] = (val == GRIB_NOTDEF) ? 0.0f : (float)val;
     }
   }
@@ -32,10 +32,13 @@
 #endif
 #endif  // precompiled headers
 
+#include <chrono>
+
 #include <wx/fileconf.h>
 #include <wx/stdpaths.h>
 
 #include "DpGrib_pi.h"
+#include "GribDatasetSnapshot.h"
 #include "DpUnitManager.h"
 
 #ifdef __WXQT__
@@ -145,6 +148,16 @@ int DpGrib_pi::Init(void) {
   if (!wxDirExists(data_path)) {
     wxMkdir(data_path);
   }
+  // Grids evicted under the memory budget are spilled next to our data
+  GribResidency::Get().SetSpillDirectory(
+      std::string(data_path.mb_str(wxConvFile)));
+  GribResidency::Get().SetBudget((size_t)wxMax(m_MemoryBudgetMB, 0) << 20);
+  GribResidency::Get().SetCompression(
+      (DpGrib::GridCompression)m_GridCompression);
+  // So do the caches of decoded files, when enabled
+  m_DecodedCacheDir = data_path + wxFileName::GetPathSeparator() + "cache";
+  Internal_SetDecodedCache(m_bDecodedCache != 0);
+
   m_local_sources_catalog =
       data_path + wxFileName::GetPathSeparator() + local_grib_catalog;
   if (!wxFileExists(m_local_sources_catalog)) {
@@ -174,6 +187,15 @@ int DpGrib_pi::Init(void) {
     m_CursorDataxy = wxPoint(20, 170);
   }
 
+  // GUI subscribers of the event bus are served by m_eventTimer
+  m_eventBus.SetWakeHandler([this](int ms) {
+    if (wxThread::IsMain())
+      m_eventTimer.StartOnce(wxMax(ms, 1));
+    else
+      wxTheApp->CallAfter(
+          [this, ms] { m_eventTimer.StartOnce(wxMax(ms, 1)); });
+  });
+
   // Create API instance for communication with deepreygui
   if (!m_gribAPI) {
     m_gribAPI = new DpGrib::DpGribAPI(&m_settings, this);
@@ -204,6 +226,10 @@ bool DpGrib_pi::DeInit(void) {
   delete m_pGRIBOverlayFactory;
   m_pGRIBOverlayFactory = nullptr;
 
+  m_eventTimer.Stop();
+  m_eventBus.SetWakeHandler(nullptr);
+  m_eventBus.Clear();
+
   // Clean up API and notify deepreygui
   if (m_gribAPI) {
     delete m_gribAPI;
@@ -768,6 +794,72 @@ void DpGrib_pi::SetDialogFont(wxWindow *dialog, wxFont *font) {
   dialog->Refresh();
 }
 
+// Numbers of plugin messages, which wxJSONReader keeps as integers when
+// they have no fraction
+static double JSONDouble(const wxJSONValue &v, double def = 0.) {
+  if (v.IsDouble()) return v.AsDouble();
+  if (v.IsInt64()) return (double)v.AsInt64();
+  if (v.IsUInt64()) return (double)v.AsUInt64();
+  return def;
+}
+
+static std::vector<int> JSONInts(const wxJSONValue &array) {
+  std::vector<int> ints;
+  for (int k = 0; k < array.Size(); k++)
+    ints.push_back((int)JSONDouble(array.ItemAt(k)));
+  return ints;
+}
+
+static bool JSONBool(const wxJSONValue &v, bool def = false) {
+  return v.IsBool() ? v.AsBool() : def;
+}
+
+// null where the layer has no data, [value, direction] for vectors
+static wxJSONValue SampleValueToJSON(const DpGrib::SampleValue &value) {
+  wxJSONValue v;
+  if (!value.valid) return v;
+  if (!value.hasDirection) return wxJSONValue(value.value);
+  v.Append(value.value);
+  v.Append(value.direction);
+  return v;
+}
+
+// Body of GRIB_EVENTS, only the members of the types that occurred
+static wxJSONValue EventsToJSON(uint64_t subscription,
+                                const DpGrib::Events &events) {
+  wxJSONValue v;
+  v[_T("Subscription")] = (wxUint64)subscription;
+  v[_T("Types")] = events.types;
+  v[_T("Count")] = events.count;
+  if (events.types & DpGrib::EVENT_LAYER_STATE) {
+    wxJSONValue &layers = v[_T("DisabledLayers")] =
+        wxJSONValue(wxJSONTYPE_ARRAY);
+    for (int layerId : events.disabledLayerIds) layers.Append(layerId);
+  }
+  if (events.types & DpGrib::EVENT_FORMAT_STATE) {
+    wxJSONValue &formats = v[_T("ChangedFormats")] =
+        wxJSONValue(wxJSONTYPE_ARRAY);
+    for (const std::pair<int, int> &format : events.changedFormats) {
+      wxJSONValue pair;
+      pair.Append(format.first);
+      pair.Append(format.second);
+      formats.Append(pair);
+    }
+  }
+  if (events.types & DpGrib::EVENT_CURSOR) {
+    v[_T("lat")] = events.latitude;
+    v[_T("lon")] = events.longitude;
+  }
+  if (events.types & DpGrib::EVENT_TIME) v[_T("Time")] = (wxInt64)events.time;
+  if (events.types & DpGrib::EVENT_DOWNLOAD_PROGRESS) {
+    v[_T("Transferred")] = events.transferred;
+    v[_T("Total")] = events.total;
+    v[_T("Completed")] = events.completed;
+    v[_T("Success")] = events.success;
+  }
+  return v;
+}
+
 void DpGrib_pi::SetPluginMessage(wxString &message_id, wxString &message_body) {
   // Handle discovery request from deeprey-gui
   //
@@ -795,74 +887,19 @@ void DpGrib_pi::SetPluginMessage(wxString &message_id, wxString &message_body) {
   if (message_id == _T("GRIB_VALUES_REQUEST")) {
     if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
 
-    // lat, lon, time, what
-    wxJSONReader r;
-    wxJSONValue v;
-    r.Parse(message_body, &v);
-    if (!v.HasMember(_T("Day"))) {
-      // bogus or loading grib
-      SendPluginMessage(wxString(_T("GRIB_VALUES")), _T(""));
-      return;
-    }
-    wxDateTime time(v[_T("Day")].AsInt(),
-                    (wxDateTime::Month)v[_T("Month")].AsInt(),
-                    v[_T("Year")].AsInt(), v[_T("Hour")].AsInt(),
-                    v[_T("Minute")].AsInt(), v[_T("Second")].AsInt());
-    double lat = v[_T("lat")].AsDouble();
-    double lon = v[_T("lon")].AsDouble();
+    wxString out;
+    if (GetGribValuesReply(message_body, out))
+      SendPluginMessage(wxString(_T("GRIB_VALUES")), out);
+  } else if (message_id == _T("GRIB_VALUES_BATCH_REQUEST")) {
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
 
-    if (m_pGribCtrlBar) {
-      if (v.HasMember(_T("WIND SPEED"))) {
-        double vkn, ang;
-        if (m_pGribCtrlBar->getTimeInterpolatedValues(
-                vkn, ang, Idx_WIND_VX, Idx_WIND_VY, lon, lat, time) &&
-            vkn != GRIB_NOTDEF) {
-          v[_T("Type")] = wxT("Reply");
-          v[_T("WIND SPEED")] = vkn;
-          v[_T("WIND DIR")] = ang;
-        } else {
-          v.Remove(_T("WIND SPEED"));
-          v.Remove(_T("WIND DIR"));
-        }
-      }
-      if (v.HasMember(_T("CURRENT SPEED"))) {
-        double vkn, ang;
-        if (m_pGribCtrlBar->getTimeInterpolatedValues(
-                vkn, ang, Idx_SEACURRENT_VX, Idx_SEACURRENT_VY, lon, lat,
-                time) &&
-            vkn != GRIB_NOTDEF) {
-          v[_T("Type")] = wxT("Reply");
-          v[_T("CURRENT SPEED")] = vkn;
-          v[_T("CURRENT DIR")] = ang;
-        } else {
-          v.Remove(_T("CURRENT SPEED"));
-          v.Remove(_T("CURRENT DIR"));
-        }
-      }
-      if (v.HasMember(_T("GUST"))) {
-        double vkn = m_pGribCtrlBar->getTimeInterpolatedValue(Idx_WIND_GUST,
-                                                              lon, lat, time);
-        if (vkn != GRIB_NOTDEF) {
-          v[_T("Type")] = wxT("Reply");
-          v[_T("GUST")] = vkn;
-        } else
-          v.Remove(_T("GUST"));
-      }
-      if (v.HasMember(_T("SWELL"))) {
-        double vkn = m_pGribCtrlBar->getTimeInterpolatedValue(Idx_HTSIGW, lon,
-                                                              lat, time);
-        if (vkn != GRIB_NOTDEF) {
-          v[_T("Type")] = wxT("Reply");
-          v[_T("SWELL")] = vkn;
-        } else
-          v.Remove(_T("SWELL"));
-      }
+    GetGribValuesBatchReply(message_body, m_valuesBatchReply);
+    SendPluginMessage(wxString(_T("GRIB_VALUES_BATCH")),
+                      wxString::FromUTF8(m_valuesBatchReply.c_str()));
+  } else if (message_id == _T("GRIB_VALUES_BENCHMARK_REQUEST")) {
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
 
-      wxJSONWriter w;
-      wxString out;
-      w.Write(v, out);
-      SendPluginMessage(wxString(_T("GRIB_VALUES")), out);
-    }
+    RunGribValuesBenchmark(message_body);
   } else if (message_id == _T("GRIB_VERSION_REQUEST")) {
     wxJSONValue v;
     v[_T("GribVersionMinor")] = GetAPIVersionMinor();
@@ -916,6 +953,545 @@ void DpGrib_pi::SetPluginMessage(wxString &message_id, wxString &message_body) {
       m_pGribCtrlBar->SetDialogsStyleSizePosition(true);
     }
   }
+
+  else if (message_id == _T("GRIB_PLAYBACK_STATS_REQUEST")) {
+    DpGrib::PlaybackStats stats = Internal_GetPlaybackStats();
+    wxJSONValue v;
+    v[_T("Playing")] = stats.playing;
+    v[_T("TargetIntervalMs")] = stats.targetIntervalMs;
+    v[_T("AchievedRate")] = stats.achievedRate;
+    v[_T("ShownRate")] = stats.shownRate;
+    v[_T("FrameCostMs")] = stats.frameCostMs;
+    v[_T("Stride")] = stats.stride;
+    v[_T("ShownFrames")] = stats.shownFrames;
+    v[_T("SkippedSteps")] = stats.skippedSteps;
+
+    wxJSONWriter w;
+    wxString out;
+    w.Write(v, out);
+    SendPluginMessage(wxString(_T("GRIB_PLAYBACK_STATS")), out);
+  } else if (message_id == _T("GRIB_SAMPLE_VALUES_REQUEST")) {
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
+
+    wxString out;
+    GetGribSampleValuesReply(message_body, out);
+    SendPluginMessage(wxString(_T("GRIB_SAMPLE_VALUES")), out);
+  } else if (message_id == _T("GRIB_SAMPLE_ROUTE_REQUEST")) {
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
+
+    wxString out;
+    GetGribSampleRouteReply(message_body, out);
+    SendPluginMessage(wxString(_T("GRIB_SAMPLE_ROUTE")), out);
+  } else if (message_id == _T("GRIB_DATASET_REQUEST")) {
+    // The reply points at a DpGrib::DatasetPtr that lives only while
+    // GRIB_DATASET is delivered: receivers copy the shared_ptr to keep the
+    // snapshot. Null when no file is loaded
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
+
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    DpGrib::DatasetPtr dataset = Internal_GetDataset();
+
+    wxJSONValue reply;
+    if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+    time_t start, end;
+    if (dataset && dataset->GetTimeRange(start, end)) {
+      reply[_T("FileId")] = dataset->GetFileId();
+      reply[_T("TimeCount")] = (wxUint64)dataset->GetTimeCount();
+      reply[_T("Start")] = (wxInt64)start;
+      reply[_T("End")] = (wxInt64)end;
+    }
+    char ptr[64];
+    snprintf(ptr, sizeof ptr, "%p", dataset ? &dataset : nullptr);
+    reply[_T("GribVersionMajor")] = PLUGIN_VERSION_MAJOR;
+    reply[_T("GribVersionMinor")] = PLUGIN_VERSION_MINOR;
+    reply[_T("DatasetPtr")] = wxString::From8BitData(ptr);
+
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_DATASET")), out);
+  } else if (message_id == _T("GRIB_GRID_REQUEST")) {
+    // {"Id": 3, "Layer": 0, "TimeIndex": 2}. The reply gives the geometry
+    // and units of the grid, and points at a DpGrib::GridView that lives
+    // only while GRIB_GRID is delivered: receivers copy the view, whose
+    // handle keeps the values
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
+
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    int layerId = (int)JSONDouble(v.ItemAt(_T("Layer")), -1);
+    int timeIndex = (int)JSONDouble(v.ItemAt(_T("TimeIndex")), -1);
+    DpGrib::GridView view;
+    bool success = Internal_GetGrid(layerId, timeIndex, view);
+
+    wxJSONValue reply;
+    if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+    reply[_T("Success")] = success;
+    if (success) {
+      reply[_T("Version")] = view.version;
+      reply[_T("Ni")] = view.ni;
+      reply[_T("Nj")] = view.nj;
+      reply[_T("Lon0")] = view.lon0;
+      reply[_T("Lat0")] = view.lat0;
+      reply[_T("Di")] = view.di;
+      reply[_T("Dj")] = view.dj;
+      reply[_T("MissingValue")] = view.missingValue;
+      reply[_T("Time")] = (wxInt64)view.time;
+      reply[_T("Vector")] = view.values2 != nullptr;
+      reply[_T("Offset")] = view.offset;
+      reply[_T("Factor")] = view.factor;
+      reply[_T("Beaufort")] = view.beaufort;
+      reply[_T("Units")] = wxString::FromUTF8(view.units.c_str());
+    }
+    char ptr[64];
+    snprintf(ptr, sizeof ptr, "%p", success ? &view : nullptr);
+    reply[_T("GridViewPtr")] = wxString::From8BitData(ptr);
+
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_GRID")), out);
+  } else if (message_id == _T("GRIB_EVENTS_SUBSCRIBE_REQUEST")) {
+    // {"Id": 3, "Types": 127, "CoalesceMs": 100, "MaxRate": 10}, as in
+    // EventSubscription. The GRIB_EVENTS_SUBSCRIBED reply echoes Id and gives
+    // the Subscription, which every GRIB_EVENTS it is sent carries. Always
+    // delivered on the GUI thread, plugin messages may not be sent from
+    // another
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    DpGrib::EventSubscription subscription;
+    subscription.types = (unsigned int)JSONDouble(v.ItemAt(_T("Types")),
+                                                  subscription.types);
+    subscription.coalesceMs =
+        (unsigned int)wxMax(JSONDouble(v.ItemAt(_T("CoalesceMs"))), 0.);
+    subscription.maxRate = wxMax(JSONDouble(v.ItemAt(_T("MaxRate"))), 0.);
+
+    std::shared_ptr<uint64_t> id = std::make_shared<uint64_t>(0);
+    *id = Internal_AddEventCallback(
+        subscription, [this, id](const DpGrib::Events &events) {
+          wxJSONWriter w(wxJSONWRITER_NONE);
+          wxString out;
+          w.Write(EventsToJSON(*id, events), out);
+          SendPluginMessage(wxString(_T("GRIB_EVENTS")), out);
+        });
+
+    wxJSONValue reply;
+    if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+    reply[_T("Subscription")] = (wxUint64)*id;
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_EVENTS_SUBSCRIBED")), out);
+  } else if (message_id == _T("GRIB_EVENTS_UNSUBSCRIBE_REQUEST")) {
+    // {"Subscription": 12}
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    Internal_RemoveEventCallback(
+        (uint64_t)JSONDouble(v.ItemAt(_T("Subscription"))));
+  } else if (message_id == _T("GRIB_MEMORY_REQUEST")) {
+    // {"Budget": bytes, "Compression": 2} sets the memory budget, 0 for
+    // none, and the DpGrib::GridCompression of evicted grids; without them
+    // the GRIB_MEMORY reply only gives the usage and compression
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    if (v.HasMember(_T("Budget")))
+      Internal_SetMemoryBudget(
+          (size_t)wxMax(JSONDouble(v.ItemAt(_T("Budget"))), 0.));
+    int compression = (int)JSONDouble(v.ItemAt(_T("Compression")), -1);
+    if (compression >= DpGrib::GRID_COMPRESSION_NONE &&
+        compression <= DpGrib::GRID_COMPRESSION_PACKING)
+      Internal_SetGridCompression((DpGrib::GridCompression)compression);
+
+    DpGrib::MemoryUsage usage = Internal_GetMemoryUsage();
+    wxJSONValue reply;
+    reply[_T("Budget")] = (wxUint64)usage.budget;
+    reply[_T("Current")] = (wxUint64)usage.current;
+    reply[_T("Peak")] = (wxUint64)usage.peak;
+    reply[_T("Total")] = (wxUint64)usage.total;
+    reply[_T("Compressed")] = (wxUint64)usage.compressed;
+    reply[_T("Evictions")] = usage.evictions;
+    reply[_T("Reloads")] = usage.reloads;
+    reply[_T("Compression")] = (int)Internal_GetGridCompression();
+
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_MEMORY")), out);
+  } else if (message_id == _T("GRIB_EXPORT_REQUEST")) {
+    if (!m_pGribCtrlBar) OnToolbarToolCallback(0);
+
+    wxString out;
+    GetGribExportReply(message_body, out);
+    SendPluginMessage(wxString(_T("GRIB_EXPORT")), out);
+  } else if (message_id == _T("GRIB_DECODED_CACHE_REQUEST")) {
+    // {"Enable": true} turns the decoded cache on or off; GRIB_DECODED_CACHE
+    // answers whether it is
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    if (v.ItemAt(_T("Enable")).IsBool())
+      Internal_SetDecodedCache(v.ItemAt(_T("Enable")).AsBool());
+
+    wxJSONValue reply;
+    reply[_T("Enabled")] = Internal_IsDecodedCacheEnabled();
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_DECODED_CACHE")), out);
+  } else if (message_id == _T("GRIB_DIRECTORY_WATCH_REQUEST")) {
+    // {"Enable": true} starts or stops watching the GRIB directory;
+    // GRIB_DIRECTORY_WATCH answers whether it is watched
+    wxJSONReader r;
+    wxJSONValue v;
+    r.Parse(message_body, &v);
+    if (v.ItemAt(_T("Enable")).IsBool())
+      Internal_SetDirectoryWatch(v.ItemAt(_T("Enable")).AsBool());
+
+    wxJSONValue reply;
+    reply[_T("Enabled")] = Internal_IsDirectoryWatchEnabled();
+    wxJSONWriter w;
+    wxString out;
+    w.Write(reply, out);
+    SendPluginMessage(wxString(_T("GRIB_DIRECTORY_WATCH")), out);
+  }
+}
+
+void DpGrib_pi::GetGribSampleValuesReply(const wxString &body,
+                                         wxString &out) {
+  // {"Id": 3, "Layers": [0, 4], "Points": [lat, lon, time, ...],
+  //  "Threads": 0}, times in seconds since the epoch (UTC). The reply echoes
+  // Id and Layers, and gives Success and the Values of each layer, point by
+  // point, as Internal_SampleValues() has them
+  wxJSONReader r;
+  wxJSONValue v;
+  r.Parse(body, &v);
+  std::vector<int> layerIds = JSONInts(v.ItemAt(_T("Layers")));
+  wxJSONValue points = v.ItemAt(_T("Points"));
+  std::vector<DpGrib::SampleQuery> queries(points.Size() / 3);
+  for (size_t k = 0; k < queries.size(); k++) {
+    queries[k].latitude = JSONDouble(points.ItemAt(3 * k));
+    queries[k].longitude = JSONDouble(points.ItemAt(3 * k + 1));
+    queries[k].time = (time_t)JSONDouble(points.ItemAt(3 * k + 2));
+  }
+  unsigned int threads = (unsigned int)wxMax(
+      JSONDouble(v.ItemAt(_T("Threads")), 1.), 0.);
+
+  std::vector<DpGrib::SampleValue> values;
+  bool success = Internal_SampleValues(layerIds, queries, values, threads);
+
+  wxJSONValue reply;
+  if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+  reply[_T("Layers")] = v.ItemAt(_T("Layers"));
+  reply[_T("Success")] = success;
+  wxJSONValue &all = reply[_T("Values")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  for (size_t l = 0; l < layerIds.size(); l++) {
+    wxJSONValue layer(wxJSONTYPE_ARRAY);
+    for (size_t k = 0; k < queries.size(); k++)
+      layer.Append(SampleValueToJSON(values[l * queries.size() + k]));
+    all.Append(layer);
+  }
+
+  wxJSONWriter w(wxJSONWRITER_NONE);
+  out.Clear();
+  w.Write(reply, out);
+}
+
+void DpGrib_pi::GetGribSampleRouteReply(const wxString &body,
+                                        wxString &out) {
+  // {"Id": 3, "Waypoints": [{"lat": 50.1, "lon": -1.2, "time": t,
+  //  "speed": 6.5}, ...], "Departure": t, "UseTimestamps": false,
+  //  "Spacing": 1, "Layers": [0, 4], "Threads": 0}, as in RouteRequest. The
+  // reply echoes Id and Layers, and gives Success, the route points in
+  // Latitudes, Longitudes, Times, Distances and Legs, and the Values of
+  // each layer at every point like GRIB_SAMPLE_VALUES
+  wxJSONReader r;
+  wxJSONValue v;
+  r.Parse(body, &v);
+  DpGrib::RouteRequest request;
+  wxJSONValue waypoints = v.ItemAt(_T("Waypoints"));
+  for (int k = 0; k < waypoints.Size(); k++) {
+    wxJSONValue w = waypoints.ItemAt(k);
+    DpGrib::RouteWaypoint waypoint;
+    waypoint.latitude = JSONDouble(w.ItemAt(_T("lat")));
+    waypoint.longitude = JSONDouble(w.ItemAt(_T("lon")));
+    waypoint.time = (time_t)JSONDouble(w.ItemAt(_T("time")));
+    waypoint.speed = JSONDouble(w.ItemAt(_T("speed")));
+    request.waypoints.push_back(waypoint);
+  }
+  request.departure = (time_t)JSONDouble(v.ItemAt(_T("Departure")));
+  request.useTimestamps = JSONBool(v.ItemAt(_T("UseTimestamps")));
+  request.spacing = JSONDouble(v.ItemAt(_T("Spacing")), request.spacing);
+  request.layerIds = JSONInts(v.ItemAt(_T("Layers")));
+  request.threads =
+      (unsigned int)wxMax(JSONDouble(v.ItemAt(_T("Threads"))), 0.);
+
+  DpGrib::RouteSamples samples;
+  bool success = Internal_SampleRoute(request, samples);
+
+  wxJSONValue reply;
+  if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+  reply[_T("Layers")] = v.ItemAt(_T("Layers"));
+  reply[_T("Success")] = success;
+  wxJSONValue &lat = reply[_T("Latitudes")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  wxJSONValue &lon = reply[_T("Longitudes")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  wxJSONValue &time = reply[_T("Times")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  wxJSONValue &distance = reply[_T("Distances")] =
+      wxJSONValue(wxJSONTYPE_ARRAY);
+  wxJSONValue &leg = reply[_T("Legs")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  for (size_t k = 0; k < samples.Size(); k++) {
+    lat.Append(samples.latitude[k]);
+    lon.Append(samples.longitude[k]);
+    time.Append((wxInt64)samples.time[k]);
+    distance.Append(samples.distance[k]);
+    leg.Append(samples.leg[k]);
+  }
+  wxJSONValue &all = reply[_T("Values")] = wxJSONValue(wxJSONTYPE_ARRAY);
+  for (size_t l = 0; success && l < samples.layerIds.size(); l++) {
+    wxJSONValue layer(wxJSONTYPE_ARRAY);
+    for (size_t k = 0; k < samples.Size(); k++)
+      layer.Append(SampleValueToJSON(samples.Value(l, k)));
+    all.Append(layer);
+  }
+
+  wxJSONWriter w(wxJSONWRITER_NONE);
+  out.Clear();
+  w.Write(reply, out);
+}
+
+void DpGrib_pi::GetGribExportReply(const wxString &body, wxString &out) {
+  // {"Id": 3, "Path": "/tmp/slice.grb2", "LatMin": 40, "LonMin": -10,
+  //  "LatMax": 50, "LonMax": 5, "Start": t, "End": t, "Layers": [0, 4],
+  //  "Thinning": 2, "Packing": 1, "Bits": 12, "Threads": 0}, as in
+  // ExportRequest; Packing is 0 for simple, 1 for complex. Only Path is
+  // required. The reply echoes Id and gives Success, Records, Skipped and
+  // Bytes
+  wxJSONReader r;
+  wxJSONValue v;
+  r.Parse(body, &v);
+  wxString path;
+  bool hasPath = v.ItemAt(_T("Path")).AsString(path) && !path.IsEmpty();
+  DpGrib::ExportRequest request;
+  request.path = std::string(path.mb_str(wxConvFile));
+  request.latMin = JSONDouble(v.ItemAt(_T("LatMin")), request.latMin);
+  request.lonMin = JSONDouble(v.ItemAt(_T("LonMin")), request.lonMin);
+  request.latMax = JSONDouble(v.ItemAt(_T("LatMax")), request.latMax);
+  request.lonMax = JSONDouble(v.ItemAt(_T("LonMax")), request.lonMax);
+  request.start = (time_t)JSONDouble(v.ItemAt(_T("Start")), request.start);
+  request.end = (time_t)JSONDouble(v.ItemAt(_T("End")), request.end);
+  request.layerIds = JSONInts(v.ItemAt(_T("Layers")));
+  request.thinning = (int)JSONDouble(v.ItemAt(_T("Thinning")), 1);
+  request.packing = JSONDouble(v.ItemAt(_T("Packing")), 1) == 0
+                        ? DpGrib::ExportRequest::SIMPLE
+                        : DpGrib::ExportRequest::COMPLEX;
+  request.bits = (int)JSONDouble(v.ItemAt(_T("Bits")), request.bits);
+  request.threads =
+      (unsigned int)wxMax(JSONDouble(v.ItemAt(_T("Threads"))), 0.);
+
+  DpGrib::ExportResult result;
+  bool success = hasPath && Internal_ExportSubset(request, result);
+
+  wxJSONValue reply;
+  if (v.HasMember(_T("Id"))) reply[_T("Id")] = v[_T("Id")];
+  reply[_T("Success")] = success;
+  reply[_T("Records")] = (wxUint64)result.records;
+  reply[_T("Skipped")] = (wxUint64)result.skipped;
+  reply[_T("Bytes")] = (wxUint64)result.bytes;
+
+  wxJSONWriter w;
+  out.Clear();
+  w.Write(reply, out);
+}
+
+bool DpGrib_pi::GetGribValuesReply(const wxString &body, wxString &out) {
+  // lat, lon, time, what
+  wxJSONReader r;
+  wxJSONValue v;
+  r.Parse(body, &v);
+  if (!v.HasMember(_T("Day"))) {
+    // bogus or loading grib
+    out.Clear();
+    return true;
+  }
+  wxDateTime time(v[_T("Day")].AsInt(),
+                  (wxDateTime::Month)v[_T("Month")].AsInt(),
+                  v[_T("Year")].AsInt(), v[_T("Hour")].AsInt(),
+                  v[_T("Minute")].AsInt(), v[_T("Second")].AsInt());
+  double lat = v[_T("lat")].AsDouble();
+  double lon = v[_T("lon")].AsDouble();
+
+  if (m_pGribCtrlBar) {
+    if (v.HasMember(_T("WIND SPEED"))) {
+      double vkn, ang;
+      if (m_pGribCtrlBar->getTimeInterpolatedValues(
+              vkn, ang, Idx_WIND_VX, Idx_WIND_VY, lon, lat, time) &&
+          vkn != GRIB_NOTDEF) {
+        v[_T("Type")] = wxT("Reply");
+        v[_T("WIND SPEED")] = vkn;
+        v[_T("WIND DIR")] = ang;
+      } else {
+        v.Remove(_T("WIND SPEED"));
+        v.Remove(_T("WIND DIR"));
+      }
+    }
+    if (v.HasMember(_T("CURRENT SPEED"))) {
+      double vkn, ang;
+      if (m_pGribCtrlBar->getTimeInterpolatedValues(
+              vkn, ang, Idx_SEACURRENT_VX, Idx_SEACURRENT_VY, lon, lat,
+              time) &&
+          vkn != GRIB_NOTDEF) {
+        v[_T("Type")] = wxT("Reply");
+        v[_T("CURRENT SPEED")] = vkn;
+        v[_T("CURRENT DIR")] = ang;
+      } else {
+        v.Remove(_T("CURRENT SPEED"));
+        v.Remove(_T("CURRENT DIR"));
+      }
+    }
+    if (v.HasMember(_T("GUST"))) {
+      double vkn = m_pGribCtrlBar->getTimeInterpolatedValue(Idx_WIND_GUST,
+                                                            lon, lat, time);
+      if (vkn != GRIB_NOTDEF) {
+        v[_T("Type")] = wxT("Reply");
+        v[_T("GUST")] = vkn;
+      } else
+        v.Remove(_T("GUST"));
+    }
+    if (v.HasMember(_T("SWELL"))) {
+      double vkn = m_pGribCtrlBar->getTimeInterpolatedValue(Idx_HTSIGW, lon,
+                                                            lat, time);
+      if (vkn != GRIB_NOTDEF) {
+        v[_T("Type")] = wxT("Reply");
+        v[_T("SWELL")] = vkn;
+      } else
+        v.Remove(_T("SWELL"));
+    }
+
+    wxJSONWriter w;
+    out.Clear();
+    w.Write(v, out);
+    return true;
+  }
+  return false;
+}
+
+void DpGrib_pi::GetGribValuesBatchReply(const wxString &body,
+                                        std::string &out) {
+  if (!m_valuesBatch.Parse(body.utf8_str())) {
+    // bogus, same as GRIB_VALUES
+    out.clear();
+    return;
+  }
+  m_valuesBatch.Sample(m_pGribCtrlBar ? m_pGribCtrlBar->m_bGRIBActiveFile.get()
+                                      : nullptr);
+  m_valuesBatch.FormatReply(out);
+}
+
+void DpGrib_pi::RunGribValuesBenchmark(const wxString &body) {
+  // {"Messages": 200, "Points": 100}
+  wxJSONReader r;
+  wxJSONValue v;
+  r.Parse(body, &v);
+  int messages = v.HasMember(_T("Messages")) ? v[_T("Messages")].AsInt() : 200;
+  int points = v.HasMember(_T("Points")) ? v[_T("Points")].AsInt() : 100;
+  messages = wxMax(messages, 1);
+  points = wxMax(points, 1);
+
+  DpGrib::DatasetPtr dataset = Internal_GetDataset();
+  double latMin, lonMin, latMax, lonMax;
+  time_t start, end;
+  if (!dataset || !dataset->GetBounds(latMin, lonMin, latMax, lonMax) ||
+      !dataset->GetTimeRange(start, end)) {
+    SendPluginMessage(wxString(_T("GRIB_VALUES_BENCHMARK")), _T(""));
+    return;
+  }
+
+  // The same pseudo-random points for every run
+  std::vector<double> triples;
+  wxArrayString legacy;
+  wxString text = _T("{\"Id\":1,\"Fields\":\"WIND,CURRENT,GUST,SWELL\",")
+                  _T("\"Points\":[");
+  unsigned int seed = 12345;
+  for (int k = 0; k < points; k++) {
+    double p[3];
+    for (int i = 0; i < 3; i++) {
+      seed = seed * 1103515245 + 12345;
+      p[i] = ((seed >> 8) & 0xFFFF) / 65535.;
+    }
+    double lat = latMin + p[0] * (latMax - latMin);
+    double lon = lonMin + p[1] * (lonMax - lonMin);
+    time_t t = start + (time_t)(p[2] * (end - start));
+    triples.push_back(lat);
+    triples.push_back(lon);
+    triples.push_back((double)t);
+    text += wxString::Format(_T("%s%.6f,%.6f,%lld"), k ? _T(",") : _T(""),
+                             lat, lon, (long long)t);
+
+    wxDateTime dt(t);
+    wxJSONValue q;
+    q[_T("Day")] = (int)dt.GetDay();
+    q[_T("Month")] = (int)dt.GetMonth();
+    q[_T("Year")] = dt.GetYear();
+    q[_T("Hour")] = dt.GetHour();
+    q[_T("Minute")] = dt.GetMinute();
+    q[_T("Second")] = dt.GetSecond();
+    q[_T("lat")] = lat;
+    q[_T("lon")] = lon;
+    q[_T("WIND SPEED")] = 1;
+    q[_T("CURRENT SPEED")] = 1;
+    q[_T("GUST")] = 1;
+    q[_T("SWELL")] = 1;
+    wxJSONWriter w(wxJSONWRITER_NONE);
+    wxString s;
+    w.Write(q, s);
+    legacy.Add(s);
+  }
+  text += _T("]}");
+  std::string encoded;
+  GribValuesBatch::EncodeBase64(triples.data(),
+                                triples.size() * sizeof(double), encoded);
+  wxString binary =
+      _T("{\"Id\":1,\"Fields\":\"WIND,CURRENT,GUST,SWELL\",")
+      _T("\"Reply\":\"binary\",\"Binary\":\"") +
+      wxString::FromUTF8(encoded.c_str()) + _T("\"}");
+
+  // Replies are built but not broadcast
+  typedef std::chrono::steady_clock Clock;
+  wxString out;
+  Clock::time_point t0 = Clock::now();
+  for (int m = 0; m < messages; m++)
+    GetGribValuesReply(legacy[m % points], out);
+  Clock::time_point t1 = Clock::now();
+  for (int m = 0; m < messages; m++)
+    GetGribValuesBatchReply(text, m_valuesBatchReply);
+  Clock::time_point t2 = Clock::now();
+  for (int m = 0; m < messages; m++)
+    GetGribValuesBatchReply(binary, m_valuesBatchReply);
+  Clock::time_point t3 = Clock::now();
+
+  auto us = [messages](Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::micro>(b - a).count() / messages;
+  };
+  wxJSONValue result;
+  result[_T("Messages")] = messages;
+  result[_T("Points")] = points;
+  result[_T("LegacyMessageUs")] = us(t0, t1);
+  result[_T("LegacyPointUs")] = us(t0, t1);
+  result[_T("BatchMessageUs")] = us(t1, t2);
+  result[_T("BatchPointUs")] = us(t1, t2) / points;
+  result[_T("BinaryMessageUs")] = us(t2, t3);
+  result[_T("BinaryPointUs")] = us(t2, t3) / points;
+
+  wxJSONWriter w;
+  out.Clear();
+  w.Write(result, out);
+  wxLogMessage(_T("GRIB_VALUES benchmark: ") + out);
+  SendPluginMessage(wxString(_T("GRIB_VALUES_BENCHMARK")), out);
 }
 
 void DpGrib_pi::UpdateApiPtr() {
@@ -948,6 +1524,14 @@ bool DpGrib_pi::LoadConfig(void) {
   pConf->Read(_T( "ShowGRIBIcon" ), &m_bGRIBShowIcon, 1);
   pConf->Read(_T( "CopyFirstCumulativeRecord" ), &m_bCopyFirstCumRec, 1);
   pConf->Read(_T( "CopyMissingWaveRecord" ), &m_bCopyMissWaveRec, 1);
+  pConf->Read(_T( "MemoryBudgetMB" ), &m_MemoryBudgetMB, 0);
+  pConf->Read(_T( "GridCompression" ), &m_GridCompression,
+              (int)DpGrib::GRID_COMPRESSION_PACKING);
+  if (m_GridCompression < DpGrib::GRID_COMPRESSION_NONE ||
+      m_GridCompression > DpGrib::GRID_COMPRESSION_PACKING)
+    m_GridCompression = DpGrib::GRID_COMPRESSION_PACKING;
+  pConf->Read(_T( "DecodedCache" ), &m_bDecodedCache, 0);
+  pConf->Read(_T( "WatchGribDirectory" ), &m_bWatchDirectory, 0);
 #ifdef __WXMSW__
   pConf->Read(_T("GribIconsScaleFactor"), &m_GribIconsScaleFactor, 1);
 #endif
@@ -1004,6 +1588,10 @@ bool DpGrib_pi::SaveConfig(void) {
   pConf->Write(_T ( "GRIBUseGradualColors" ), m_bGRIBUseGradualColors);
   pConf->Write(_T ( "CopyFirstCumulativeRecord" ), m_bCopyFirstCumRec);
   pConf->Write(_T ( "CopyMissingWaveRecord" ), m_bCopyMissWaveRec);
+  pConf->Write(_T ( "MemoryBudgetMB" ), m_MemoryBudgetMB);
+  pConf->Write(_T ( "GridCompression" ), m_GridCompression);
+  pConf->Write(_T ( "DecodedCache" ), m_bDecodedCache);
+  pConf->Write(_T ( "WatchGribDirectory" ), m_bWatchDirectory);
   pConf->Write(_T ( "DrawBarbedArrowHead" ), m_bDrawBarbedArrowHead);
   pConf->Write(_T ( "ZoomToCenterAtInit"), m_bZoomToCenterAtInit);
 #ifdef __WXMSW__
@@ -1042,6 +1630,8 @@ void DpGrib_pi::SetColorScheme(PI_ColorScheme cs) {
 void DpGrib_pi::SendTimelineMessage(wxDateTime time) {
   if (!m_pGribCtrlBar) return;
 
+  if (time.IsValid()) m_eventBus.PostTime(time.GetTicks());
+
   wxJSONValue v;
   if (time.IsValid()) {
     v[_T("Day")] = time.GetDay();
@@ -1196,6 +1786,54 @@ int DpGrib_pi::Internal_GetPlaybackSpeed() const {
   return m_pGribCtrlBar->m_OverlaySettings.m_UpdatesPerSecond;
 }
 
+DpGrib::PlaybackStats DpGrib_pi::Internal_GetPlaybackStats() const {
+  if (!m_pGribCtrlBar) return DpGrib::PlaybackStats();
+  return m_pGribCtrlBar->GetPlaybackStats();
+}
+
+void DpGrib_pi::Internal_SetMemoryBudget(size_t bytes) {
+  // Kept in whole megabytes, rounded up so that a small budget stays one
+  size_t megabytes = (bytes + (1 << 20) - 1) >> 20;
+  m_MemoryBudgetMB = (int)wxMin(megabytes, (size_t)INT_MAX);
+  GribResidency::Get().SetBudget((size_t)m_MemoryBudgetMB << 20);
+  if (wxThread::IsMain()) GribResidency::Get().Trim();
+}
+
+DpGrib::MemoryUsage DpGrib_pi::Internal_GetMemoryUsage() const {
+  return GribResidency::Get().GetUsage();
+}
+
+void DpGrib_pi::Internal_SetGridCompression(
+    DpGrib::GridCompression compression) {
+  m_GridCompression = compression;
+  GribResidency::Get().SetCompression(compression);
+}
+
+DpGrib::GridCompression DpGrib_pi::Internal_GetGridCompression() const {
+  return (DpGrib::GridCompression)m_GridCompression;
+}
+
+void DpGrib_pi::Internal_SetDecodedCache(bool enable) {
+  m_bDecodedCache = enable;
+  // Files loaded from now on only, the cache of the active one is written
+  // the next time it is loaded
+  GribCache::SetDirectory(
+      enable ? std::string(m_DecodedCacheDir.mb_str(wxConvFile)) : "");
+}
+
+bool DpGrib_pi::Internal_IsDecodedCacheEnabled() const {
+  return m_bDecodedCache != 0;
+}
+
+void DpGrib_pi::Internal_SetDirectoryWatch(bool enable) {
+  m_bWatchDirectory = enable;
+  if (m_pGribCtrlBar) m_pGribCtrlBar->UpdateDirectoryWatch();
+}
+
+bool DpGrib_pi::Internal_IsDirectoryWatchEnabled() const {
+  return m_bWatchDirectory != 0;
+}
+
 void DpGrib_pi::Internal_SetGlobalSymbolSpacing(int pixels) {
   if (!m_pGribCtrlBar) return;
 
@@ -2240,6 +2878,66 @@ bool DpGrib_pi::Internal_GetVectorValueAt(int layerId, int timeIndex,
   return true;
 }
 
+DpGrib::DatasetPtr DpGrib_pi::Internal_GetDataset() const {
+  if (!Internal_HasActiveFile()) {
+    return nullptr;
+  }
+  return std::make_shared<GribDatasetSnapshot>(
+      m_pGribCtrlBar->m_bGRIBActiveFile, m_pGribCtrlBar->m_OverlaySettings);
+}
+
+bool DpGrib_pi::Internal_GetGrid(int layerId, int timeIndex,
+                                 DpGrib::GridView& view) const {
+  DpGrib::DatasetPtr dataset = Internal_GetDataset();
+  if (!dataset || timeIndex < 0) {
+    view = DpGrib::GridView();
+    return false;
+  }
+  return dataset->GetGrid(layerId, timeIndex, view);
+}
+
+bool DpGrib_pi::Internal_SampleValues(
+    const std::vector<int>& layerIds,
+    const std::vector<DpGrib::SampleQuery>& queries,
+    std::vector<DpGrib::SampleValue>& values, unsigned int threads) const {
+  DpGrib::DatasetPtr dataset = Internal_GetDataset();
+  if (!dataset) {
+    values.assign(layerIds.size() * queries.size(), DpGrib::SampleValue());
+    return false;
+  }
+  return dataset->SampleValues(layerIds, queries, values, threads);
+}
+
+bool DpGrib_pi::Internal_SampleRoute(const DpGrib::RouteRequest& request,
+                                     DpGrib::RouteSamples& samples) const {
+  DpGrib::DatasetPtr dataset = Internal_GetDataset();
+  if (!dataset) {
+    samples = DpGrib::RouteSamples();
+    return false;
+  }
+  return dataset->SampleRoute(request, samples);
+}
+
+bool DpGrib_pi::Internal_ExportSubset(const DpGrib::ExportRequest& request,
+                                      DpGrib::ExportResult& result) const {
+  DpGrib::DatasetPtr dataset = Internal_GetDataset();
+  if (!dataset) {
+    result = DpGrib::ExportResult();
+    return false;
+  }
+  return dataset->Export(request, result);
+}
+
+uint64_t DpGrib_pi::Internal_AddEventCallback(
+    const DpGrib::EventSubscription& subscription,
+    DpGrib::EventCallback callback) {
+  return m_eventBus.Subscribe(subscription, std::move(callback));
+}
+
+void DpGrib_pi::Internal_RemoveEventCallback(uint64_t callbackId) {
+  m_eventBus.Unsubscribe(callbackId);
+}
+
 wxString DpGrib_pi::Internal_GetLayerUnit(int layerId) const {
   if (!m_pGribCtrlBar) {
     return wxEmptyString;
@@ -0,0 +1,178 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribBatchSampler.h
+ */
+
+#include "GribBatchSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "GribResidency.h"
+#include "GribUIDialog.h"
+
+// Below this a thread costs more to start than it saves
+static const size_t MIN_QUERIES_PER_THREAD = 512;
+
+GribBatchSampler::GribBatchSampler(
+    GRIBFile *file, const std::vector<DpGrib::SampleQuery> &queries)
+    : m_file(file), m_queries(queries), m_order(queries.size()) {
+  for (size_t k = 0; k < m_order.size(); k++) m_order[k] = k;
+  std::stable_sort(m_order.begin(), m_order.end(), [&](size_t a, size_t b) {
+    return m_queries[a].time < m_queries[b].time;
+  });
+}
+
+void GribBatchSampler::Sample(const GribSampleLayer &layer,
+                              DpGrib::SampleValue *values,
+                              unsigned int threads) {
+  for (size_t k = 0; k < m_queries.size(); k++)
+    values[k] = DpGrib::SampleValue();
+  if (layer.idx < 0 || layer.idx >= Idx_COUNT) return;
+  if (layer.kind != GribSampleLayer::SCALAR &&
+      (layer.idy < 0 || layer.idy >= Idx_COUNT))
+    return;
+
+  // Resolved here, the pair index is built under a lock on first use
+  const GribTimeIndex &index =
+      layer.kind == GribSampleLayer::VECTOR
+          ? m_file->GetTimeIndex(layer.idx, layer.idy)
+          : m_file->GetTimeIndex(layer.idx);
+  const GribTimeIndex *direction =
+      layer.kind == GribSampleLayer::SCALAR_DIRECTION
+          ? &m_file->GetTimeIndex(layer.idy)
+          : nullptr;
+
+  // Callers may be on any thread, keep the grids where they are meanwhile
+  GribResidency::ReadGuard guard;
+
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t chunks = std::min<size_t>(
+      threads, std::max<size_t>(1, m_order.size() / MIN_QUERIES_PER_THREAD));
+  if (chunks <= 1) {
+    SampleRange(layer, index, direction, 0, m_order.size(), values);
+    return;
+  }
+
+  // Contiguous time ranges, so that every thread keeps its cursors warm
+  std::vector<std::thread> pool;
+  size_t step = (m_order.size() + chunks - 1) / chunks;
+  for (size_t begin = 0; begin < m_order.size(); begin += step) {
+    size_t end = std::min(begin + step, m_order.size());
+    pool.emplace_back(&GribBatchSampler::SampleRange, this, std::cref(layer),
+                      std::cref(index), direction, begin, end, values);
+  }
+  for (std::thread &thread : pool) thread.join();
+}
+
+void GribBatchSampler::SampleRange(const GribSampleLayer &layer,
+                                   const GribTimeIndex &index,
+                                   const GribTimeIndex *direction,
+                                   size_t begin, size_t end,
+                                   DpGrib::SampleValue *values) const {
+  GribTimeCursor cursor, dirCursor;
+  for (size_t k = begin; k < end; k++) {
+    const DpGrib::SampleQuery &q = m_queries[m_order[k]];
+    DpGrib::SampleValue &v = values[m_order[k]];
+
+    size_t k1, k2;
+    if (!index.Bracket(q.time, k1, k2, &cursor)) continue;
+
+    if (layer.kind == GribSampleLayer::VECTOR) {
+      double M, A;
+      if (!VectorAt(layer, index, k1, k2, q, M, A) || M == GRIB_NOTDEF)
+        continue;
+      v.value = M;
+      v.direction = A;
+      v.valid = v.hasDirection = true;
+      continue;
+    }
+
+    double value = ScalarAt(layer.idx, index, k1, k2, q);
+    if (value == GRIB_NOTDEF) continue;
+    v.value = value;
+    v.valid = true;
+
+    if (direction && direction->Bracket(q.time, k1, k2, &dirCursor)) {
+      double dir = ScalarAt(layer.idy, *direction, k1, k2, q);
+      if (dir != GRIB_NOTDEF) {
+        v.direction = dir;
+        v.hasDirection = true;
+      }
+    }
+  }
+}
+
+// Same blend as GRIBUICtrlBar::getTimeInterpolatedValue()
+double GribBatchSampler::ScalarAt(int idx, const GribTimeIndex &index,
+                                  size_t k1, size_t k2,
+                                  const DpGrib::SampleQuery &q) const {
+  ArrayOfGribRecordSets *rsa = m_file->GetRecordSetArrayPtr();
+  GribRecord *before = rsa->Item(index.Set(k1)).m_GribRecordPtrArray[idx];
+
+  GribSampleCell cell;
+  before->getSampleCell(q.longitude, q.latitude, cell);
+  double v1 = before->getInterpolatedValue(cell);
+  if (k1 == k2) return v1;
+  if (v1 == GRIB_NOTDEF) return GRIB_NOTDEF;
+
+  GribRecord *after = rsa->Item(index.Set(k2)).m_GribRecordPtrArray[idx];
+  double v2 = after->getGridGeometry() == before->getGridGeometry()
+                  ? after->getInterpolatedValue(cell)
+                  : after->getInterpolatedValue(q.longitude, q.latitude);
+  if (v2 == GRIB_NOTDEF) return GRIB_NOTDEF;
+
+  time_t t1 = index.Time(k1), t2 = index.Time(k2);
+  double k = fabs((double)(q.time - t1) / (t2 - t1));
+  return (1.0 - k) * v1 + k * v2;
+}
+
+// Same blend as GRIBUICtrlBar::getTimeInterpolatedValues()
+bool GribBatchSampler::VectorAt(const GribSampleLayer &layer,
+                                const GribTimeIndex &index, size_t k1,
+                                size_t k2, const DpGrib::SampleQuery &q,
+                                double &M, double &A) const {
+  ArrayOfGribRecordSets *rsa = m_file->GetRecordSetArrayPtr();
+  GribRecordSet &before = rsa->Item(index.Set(k1));
+  GribRecord *X1 = before.m_GribRecordPtrArray[layer.idx];
+  GribRecord *Y1 = before.m_GribRecordPtrArray[layer.idy];
+  GribGridGeometry geometry = X1->getGridGeometry();
+  bool shared = Y1->getGridGeometry() == geometry;
+
+  GribSampleCell cell;
+  if (shared) X1->getSampleCell(q.longitude, q.latitude, cell);
+  auto values = [&](double &m, double &a, GribRecord *X, GribRecord *Y) {
+    if (shared && X->getGridGeometry() == geometry &&
+        Y->getGridGeometry() == geometry)
+      return GribRecord::getInterpolatedValues(m, a, X, Y, cell, true);
+    return GribRecord::getInterpolatedValues(m, a, X, Y, q.longitude,
+                                             q.latitude, true);
+  };
+
+  if (k1 == k2) return values(M, A, X1, Y1);
+
+  GribRecordSet &after = rsa->Item(index.Set(k2));
+  double v1m, v1a, v2m, v2a;
+  if (!values(v1m, v1a, X1, Y1)) return false;
+  if (!values(v2m, v2a, after.m_GribRecordPtrArray[layer.idx],
+              after.m_GribRecordPtrArray[layer.idy]))
+    return false;
+  if (v1m == GRIB_NOTDEF || v2m == GRIB_NOTDEF || v1a == GRIB_NOTDEF ||
+      v2a == GRIB_NOTDEF)
+    return false;
+
+  time_t t1 = index.Time(k1), t2 = index.Time(k2);
+  double k = fabs((double)(q.time - t1) / (t2 - t1));
+  M = (1.0 - k) * v1m + k * v2m;
+  A = (1.0 - k) * v1a + k * v2a;
+  return true;
+}
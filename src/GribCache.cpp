@@ -0,0 +1,581 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribCache.h
+ */
+
+#include "GribCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "GribRecord.h"
+#include "GribRecordSet.h"
+#include "GribResidency.h"
+
+namespace {
+
+// File layout, all sections 8 byte aligned in the byte order of the writer:
+//   Header
+//   Source[sourceCount], each followed by its path
+//   int64_t times[setCount]
+//   int32_t setIndex[Idx_COUNT][setCount], record numbers, -1 for none
+//   int32_t indices[indexCount]
+//   uint16_t values[Ni * Nj] of each record in turn
+//   CachedRecord records[recordCount]
+const char MAGIC[8] = {'D', 'P', 'G', 'R', 'I', 'B', 'C', '\n'};
+const uint32_t FORMAT = 1;
+const uint32_t ORDER_MARK = 0x01020304;
+const uint16_t MISSING = 0xffff;
+const uint16_t STEPS = MISSING - 1;  // the largest quantized value
+const size_t KEEP = 16;              // caches in the directory
+
+struct Header {
+  char magic[8];
+  uint32_t format, byteOrder;
+  uint32_t recordSize, idxCount;  // layout checks
+  uint64_t fileSize;
+  char version[32];
+  uint32_t options, sourceCount;
+  uint64_t recordCount, setCount, indexCount;
+  int64_t refDate;
+  uint64_t sources, times, setIndex, indices, records;  // offsets
+};
+
+struct Source {
+  uint64_t size;
+  int64_t mtime;
+  uint32_t pathLength, reserved;
+};
+
+enum {
+  FLAG_OK = 1 << 0,
+  FLAG_KNOWN_DATA = 1 << 1,
+  FLAG_WAVE_DATA = 1 << 2,
+  FLAG_DUPLICATED = 1 << 3,
+  FLAG_DI_DJ = 1 << 4,
+  FLAG_EARTH_SPHERIC = 1 << 5,
+  FLAG_U_EAST_V_NORTH = 1 << 6,
+  FLAG_SCAN_I_POSITIVE = 1 << 7,
+  FLAG_SCAN_J_POSITIVE = 1 << 8,
+  FLAG_ADJACENT_I = 1 << 9,
+  FLAG_FILLED = 1 << 10,  // holes filled before writing, see fillHoles()
+};
+
+// What GribRecord holds besides its values
+struct CachedRecord {
+  double La1, Lo1, La2, Lo2;
+  double latMin, lonMin, latMax, lonMax;
+  double Di, Dj;
+  double reference, step;  // of the quantized values
+  int64_t refDate, curDate;
+  uint64_t values;  // offset of the column
+  int32_t id, dataCenterModel;
+  uint32_t levelValue;
+  uint32_t refyear, refmonth, refday, refhour, refminute;
+  uint32_t periodP1, periodP2, periodsec;
+  uint32_t Ni, Nj;
+  uint16_t flags;
+  uint8_t editionNumber, idCenter, idModel, idGrid, dataType, levelType;
+  uint8_t timeRange, NV, PV, gridType, resolFlags, scanFlags;
+  char strRefDate[32], strCurDate[32];
+};
+
+static_assert(sizeof(Header) % 8 == 0, "Header breaks the alignment");
+static_assert(sizeof(Source) % 8 == 0, "Source breaks the alignment");
+static_assert(sizeof(CachedRecord) % 8 == 0, "Record breaks the alignment");
+
+uint64_t Align(uint64_t offset) { return (offset + 7) & ~(uint64_t)7; }
+
+std::mutex s_mutex;
+std::string s_directory;
+
+uint64_t Fnv1a(uint64_t hash, const void *data, size_t size) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t k = 0; k < size; k++) {
+    hash ^= bytes[k];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Quantizes a grid on the steps it was packed with when it has few enough,
+// else on STEPS steps from its minimum to its maximum
+void Quantize(const GribRecord &rec, const double *values, size_t count,
+              double packingStep, std::vector<uint16_t> &out, double &reference,
+              double &step) {
+  int ni = rec.getNi();
+  double lo = INFINITY, hi = -INFINITY;
+  for (size_t k = 0; k < count; k++) {
+    double v = values[k];
+    if (v == GRIB_NOTDEF || std::isnan(v) || !rec.hasValue(k % ni, k / ni))
+      continue;
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+  out.assign(count, MISSING);
+  if (lo > hi) {  // nothing defined
+    reference = 0;
+    step = 1;
+    return;
+  }
+  reference = lo;
+  if (packingStep > 0 && (hi - lo) / packingStep <= STEPS)
+    step = packingStep;
+  else
+    step = hi > lo ? (hi - lo) / STEPS : 1;
+  for (size_t k = 0; k < count; k++) {
+    double v = values[k];
+    if (v == GRIB_NOTDEF || std::isnan(v) || !rec.hasValue(k % ni, k / ni))
+      continue;
+    long q = std::lround((v - lo) / step);
+    out[k] = (uint16_t)std::min<long>(std::max(q, 0L), STEPS);
+  }
+}
+
+// Maps the whole of a file, unmapped with the last copy of the pointer
+std::shared_ptr<const void> Map(const std::string &path, size_t &size) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return nullptr;
+  LARGE_INTEGER length;
+  if (!GetFileSizeEx(file, &length) || length.QuadPart <= 0) {
+    CloseHandle(file);
+    return nullptr;
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) return nullptr;
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);  // the view keeps it
+  if (!view) return nullptr;
+  size = (size_t)length.QuadPart;
+  return std::shared_ptr<const void>(
+      view, [](const void *p) { UnmapViewOfFile(p); });
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  size_t length = (size_t)st.st_size;
+  void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps it
+  if (view == MAP_FAILED) return nullptr;
+  size = length;
+  return std::shared_ptr<const void>(view, [length](const void *p) {
+    munmap(const_cast<void *>(p), length);
+  });
+#endif
+}
+
+bool Put(FILE *file, const void *data, size_t size) {
+  return fwrite(data, 1, size, file) == size;
+}
+
+bool Pad(FILE *file, uint64_t size) {
+  static const char zeros[8] = {};
+  return Put(file, zeros, (size_t)(Align(size) - size));
+}
+
+}  // namespace
+
+void GribCache::SetDirectory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_directory = directory;
+}
+
+std::string GribCache::GetDirectory() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_directory;
+}
+
+std::string GribCache::PathOf(const Key &key) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const std::string &file : key.files)
+    hash = Fnv1a(hash, file.c_str(), file.size() + 1);
+  hash = Fnv1a(hash, key.version.c_str(), key.version.size() + 1);
+  hash = Fnv1a(hash, &key.options, sizeof key.options);
+  char name[40];
+  snprintf(name, sizeof name, "/grib-%016llx.cache", (unsigned long long)hash);
+  return GetDirectory() + name;
+}
+
+bool GribCache::Stat(const std::string &file, uint64_t &size,
+                     int64_t &mtime) {
+  std::error_code ec;
+  std::filesystem::path path(file);
+  size = std::filesystem::file_size(path, ec);
+  if (ec) return false;
+  auto time = std::filesystem::last_write_time(path, ec);
+  if (ec) return false;
+  mtime = (int64_t)time.time_since_epoch().count();
+  return true;
+}
+
+std::unique_ptr<GribCache> GribCache::Open(const Key &key) {
+  if (GetDirectory().empty() || key.files.empty()) return nullptr;
+  size_t size = 0;
+  std::shared_ptr<const void> mapping = Map(PathOf(key), size);
+  if (!mapping) return nullptr;
+
+  std::unique_ptr<GribCache> cache(new GribCache());
+  cache->m_mapping = mapping;
+  if (!cache->Read(static_cast<const unsigned char *>(mapping.get()), size,
+                   key))
+    return nullptr;
+  return cache;
+}
+
+bool GribCache::Read(const unsigned char *base, size_t size, const Key &key) {
+  if (size < sizeof(Header)) return false;
+  const Header &header = *reinterpret_cast<const Header *>(base);
+  if (memcmp(header.magic, MAGIC, sizeof MAGIC) || header.format != FORMAT ||
+      header.byteOrder != ORDER_MARK ||
+      header.recordSize != sizeof(CachedRecord) ||
+      header.idxCount != Idx_COUNT || header.fileSize != size ||
+      strncmp(header.version, key.version.c_str(), sizeof header.version) ||
+      header.options != key.options || header.sourceCount != key.files.size())
+    return false;
+
+  // Sections in the file, counts are bounded by its size first
+  auto fits = [size](uint64_t offset, uint64_t count, uint64_t item) {
+    return offset % 8 == 0 && offset <= size && count <= size &&
+           count * item <= size - offset;
+  };
+  if (!fits(header.times, header.setCount, sizeof(int64_t)) ||
+      !fits(header.setIndex, header.setCount * Idx_COUNT, sizeof(int32_t)) ||
+      !fits(header.indices, header.indexCount, sizeof(int32_t)) ||
+      !fits(header.records, header.recordCount, sizeof(CachedRecord)))
+    return false;
+
+  // Stale once a source changed
+  uint64_t offset = header.sources;
+  for (const std::string &file : key.files) {
+    if (!fits(offset, 1, sizeof(Source))) return false;
+    const Source &source = *reinterpret_cast<const Source *>(base + offset);
+    offset += sizeof(Source);
+    if (source.pathLength != file.size() ||
+        !fits(offset, source.pathLength, 1) ||
+        memcmp(base + offset, file.data(), file.size()))
+      return false;
+    offset = Align(offset + source.pathLength);
+    uint64_t fileSize;
+    int64_t mtime;
+    if (!Stat(file, fileSize, mtime) || fileSize != source.size ||
+        mtime != source.mtime)
+      return false;
+  }
+
+  const CachedRecord *cached =
+      reinterpret_cast<const CachedRecord *>(base + header.records);
+  m_records.reserve(header.recordCount);
+  for (uint64_t k = 0; k < header.recordCount; k++) {
+    const CachedRecord &c = cached[k];
+    uint64_t count = (uint64_t)c.Ni * c.Nj;
+    if (!count || !fits(c.values, count, sizeof(uint16_t))) return false;
+
+    GribRecord *rec = new GribRecord();
+    m_records.push_back(rec);
+    rec->id = c.id;
+    rec->ok = c.flags & FLAG_OK;
+    rec->knownData = c.flags & FLAG_KNOWN_DATA;
+    rec->waveData = c.flags & FLAG_WAVE_DATA;
+    rec->IsDuplicated = c.flags & FLAG_DUPLICATED;
+    rec->eof = false;
+    memcpy(rec->strRefDate, c.strRefDate, sizeof rec->strRefDate);
+    memcpy(rec->strCurDate, c.strCurDate, sizeof rec->strCurDate);
+    rec->strRefDate[sizeof rec->strRefDate - 1] = 0;
+    rec->strCurDate[sizeof rec->strCurDate - 1] = 0;
+    rec->dataCenterModel = c.dataCenterModel;
+    rec->m_bfilled = c.flags & FLAG_FILLED;
+
+    rec->editionNumber = c.editionNumber;
+    rec->idCenter = c.idCenter;
+    rec->idModel = c.idModel;
+    rec->idGrid = c.idGrid;
+    rec->dataType = c.dataType;
+    rec->levelType = c.levelType;
+    rec->levelValue = c.levelValue;
+    rec->dataKey =
+        GribRecord::makeKey(rec->dataType, rec->levelType, rec->levelValue);
+    // Points without a value were quantized as missing
+    rec->hasBMS = false;
+    rec->BMSsize = 0;
+    rec->BMSbits = nullptr;
+
+    rec->refyear = c.refyear;
+    rec->refmonth = c.refmonth;
+    rec->refday = c.refday;
+    rec->refhour = c.refhour;
+    rec->refminute = c.refminute;
+    rec->periodP1 = c.periodP1;
+    rec->periodP2 = c.periodP2;
+    rec->timeRange = c.timeRange;
+    rec->periodsec = c.periodsec;
+    rec->refDate = (time_t)c.refDate;
+    rec->curDate = (time_t)c.curDate;
+
+    rec->NV = c.NV;
+    rec->PV = c.PV;
+    rec->gridType = c.gridType;
+    rec->Ni = c.Ni;
+    rec->Nj = c.Nj;
+    rec->La1 = c.La1;
+    rec->Lo1 = c.Lo1;
+    rec->La2 = c.La2;
+    rec->Lo2 = c.Lo2;
+    rec->latMin = c.latMin;
+    rec->lonMin = c.lonMin;
+    rec->latMax = c.latMax;
+    rec->lonMax = c.lonMax;
+    rec->Di = c.Di;
+    rec->Dj = c.Dj;
+    rec->resolFlags = c.resolFlags;
+    rec->scanFlags = c.scanFlags;
+    rec->hasDiDj = c.flags & FLAG_DI_DJ;
+    rec->isEarthSpheric = c.flags & FLAG_EARTH_SPHERIC;
+    rec->isUeastVnorth = c.flags & FLAG_U_EAST_V_NORTH;
+    rec->isScanIpositive = c.flags & FLAG_SCAN_I_POSITIVE;
+    rec->isScanJpositive = c.flags & FLAG_SCAN_J_POSITIVE;
+    rec->isAdjacentI = c.flags & FLAG_ADJACENT_I;
+
+    rec->data = nullptr;
+    rec->packingStep = c.step;
+    GribResidency::Get().ManageMapped(
+        rec, m_mapping, reinterpret_cast<const uint16_t *>(base + c.values),
+        c.reference, c.step);
+  }
+
+  const int64_t *times = reinterpret_cast<const int64_t *>(base + header.times);
+  m_times.assign(times, times + header.setCount);
+  const int32_t *setIndex =
+      reinterpret_cast<const int32_t *>(base + header.setIndex);
+  m_setIndex.assign(setIndex, setIndex + header.setCount * Idx_COUNT);
+  for (int32_t number : m_setIndex)
+    if (number < -1 || number >= (int64_t)header.recordCount) return false;
+  const int32_t *indices =
+      reinterpret_cast<const int32_t *>(base + header.indices);
+  m_indices.assign(indices, indices + header.indexCount);
+  m_refDate = (time_t)header.refDate;
+  return true;
+}
+
+GribCache::~GribCache() {
+  for (GribRecord *rec : m_records) delete rec;
+}
+
+void GribCache::FillSet(size_t set, GribRecordSet &recordSet) const {
+  size_t sets = m_times.size();
+  recordSet.m_Reference_Time = m_times[set];
+  for (int idx = 0; idx < Idx_COUNT; idx++) {
+    int32_t number = m_setIndex[idx * sets + set];
+    recordSet.m_GribRecordPtrArray[idx] =
+        number < 0 ? nullptr : m_records[number];
+  }
+}
+
+bool GribCache::Write(const Key &key, const std::vector<GribRecordSet *> &sets,
+                      const std::vector<int> &indices, time_t refDate) {
+  std::string directory = GetDirectory();
+  if (directory.empty() || key.files.empty() ||
+      key.version.size() >= sizeof(Header::version))
+    return false;
+
+  std::vector<unsigned char> sources;
+  for (const std::string &file : key.files) {
+    Source source = {};
+    if (!Stat(file, source.size, source.mtime)) return false;
+    source.pathLength = (uint32_t)file.size();
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&source);
+    sources.insert(sources.end(), bytes, bytes + sizeof source);
+    sources.insert(sources.end(), file.begin(), file.end());
+    sources.resize(Align(sources.size()));
+  }
+
+  // Records shared between sets are written once
+  std::vector<const GribRecord *> records;
+  std::map<const GribRecord *, int32_t> numbers;
+  std::vector<int32_t> setIndex(sets.size() * Idx_COUNT, -1);
+  for (size_t j = 0; j < sets.size(); j++) {
+    for (int idx = 0; idx < Idx_COUNT; idx++) {
+      const GribRecord *rec = sets[j]->m_GribRecordPtrArray[idx];
+      if (!rec) continue;
+      if (!rec->getNi() || !rec->getNj()) return false;
+      auto found = numbers.emplace(rec, (int32_t)records.size());
+      if (found.second) records.push_back(rec);
+      setIndex[idx * sets.size() + j] = found.first->second;
+    }
+  }
+  std::vector<int64_t> times;
+  for (const GribRecordSet *set : sets) times.push_back(set->m_Reference_Time);
+  std::vector<int32_t> indices32(indices.begin(), indices.end());
+
+  Header header = {};
+  memcpy(header.magic, MAGIC, sizeof MAGIC);
+  header.format = FORMAT;
+  header.byteOrder = ORDER_MARK;
+  header.recordSize = sizeof(CachedRecord);
+  header.idxCount = Idx_COUNT;
+  strncpy(header.version, key.version.c_str(), sizeof header.version - 1);
+  header.options = key.options;
+  header.sourceCount = (uint32_t)key.files.size();
+  header.recordCount = records.size();
+  header.setCount = sets.size();
+  header.indexCount = indices32.size();
+  header.refDate = refDate;
+  header.sources = sizeof(Header);
+  header.times = header.sources + sources.size();
+  header.setIndex = header.times + times.size() * sizeof(int64_t);
+  header.indices = Align(header.setIndex + setIndex.size() * sizeof(int32_t));
+  uint64_t values = Align(header.indices + indices32.size() * sizeof(int32_t));
+  header.records = values;
+  for (const GribRecord *rec : records)
+    header.records += Align((uint64_t)rec->getNi() * rec->getNj() * 2);
+  header.fileSize = header.records + records.size() * sizeof(CachedRecord);
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  std::string path = PathOf(key);
+  std::string temporary = path + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "wb");
+  if (!file) return false;
+
+  bool ok = Put(file, &header, sizeof header) &&
+            Put(file, sources.data(), sources.size()) &&
+            Put(file, times.data(), times.size() * sizeof(int64_t)) &&
+            Put(file, setIndex.data(), setIndex.size() * sizeof(int32_t)) &&
+            Pad(file, setIndex.size() * sizeof(int32_t)) &&
+            Put(file, indices32.data(), indices32.size() * sizeof(int32_t)) &&
+            Pad(file, indices32.size() * sizeof(int32_t));
+
+  // Evicted grids are read back one at a time, and not kept, so a large
+  // file is written within the memory budget
+  std::vector<CachedRecord> cached(records.size());
+  std::vector<uint16_t> column;
+  for (size_t k = 0; ok && k < records.size(); k++) {
+    const GribRecord &rec = *records[k];
+    std::shared_ptr<const double> peeked = rec.peekValues();
+    const double *data = peeked ? peeked.get() : rec.values();
+    if (!data) {
+      ok = false;
+      break;
+    }
+    size_t count = (size_t)rec.getNi() * rec.getNj();
+    CachedRecord &c = cached[k];
+    Quantize(rec, data, count, rec.packingStep, column, c.reference, c.step);
+    c.values = values;
+    values += Align(count * 2);
+    ok = Put(file, column.data(), count * 2) && Pad(file, count * 2);
+
+    c.id = rec.id;
+    c.flags = (rec.ok ? FLAG_OK : 0) | (rec.knownData ? FLAG_KNOWN_DATA : 0) |
+              (rec.waveData ? FLAG_WAVE_DATA : 0) |
+              (rec.IsDuplicated ? FLAG_DUPLICATED : 0) |
+              (rec.hasDiDj ? FLAG_DI_DJ : 0) |
+              (rec.isEarthSpheric ? FLAG_EARTH_SPHERIC : 0) |
+              (rec.isUeastVnorth ? FLAG_U_EAST_V_NORTH : 0) |
+              (rec.isScanIpositive ? FLAG_SCAN_I_POSITIVE : 0) |
+              (rec.isScanJpositive ? FLAG_SCAN_J_POSITIVE : 0) |
+              (rec.isAdjacentI ? FLAG_ADJACENT_I : 0) |
+              (rec.m_bfilled ? FLAG_FILLED : 0);
+    memcpy(c.strRefDate, rec.strRefDate, sizeof c.strRefDate);
+    memcpy(c.strCurDate, rec.strCurDate, sizeof c.strCurDate);
+    c.dataCenterModel = rec.dataCenterModel;
+    c.editionNumber = rec.editionNumber;
+    c.idCenter = rec.idCenter;
+    c.idModel = rec.idModel;
+    c.idGrid = rec.idGrid;
+    c.dataType = rec.dataType;
+    c.levelType = rec.levelType;
+    c.levelValue = rec.levelValue;
+    c.refyear = rec.refyear;
+    c.refmonth = rec.refmonth;
+    c.refday = rec.refday;
+    c.refhour = rec.refhour;
+    c.refminute = rec.refminute;
+    c.periodP1 = rec.periodP1;
+    c.periodP2 = rec.periodP2;
+    c.timeRange = rec.timeRange;
+    c.periodsec = rec.periodsec;
+    c.refDate = rec.refDate;
+    c.curDate = rec.curDate;
+    c.NV = rec.NV;
+    c.PV = rec.PV;
+    c.gridType = rec.gridType;
+    c.Ni = rec.Ni;
+    c.Nj = rec.Nj;
+    c.La1 = rec.La1;
+    c.Lo1 = rec.Lo1;
+    c.La2 = rec.La2;
+    c.Lo2 = rec.Lo2;
+    c.latMin = rec.latMin;
+    c.lonMin = rec.lonMin;
+    c.latMax = rec.latMax;
+    c.lonMax = rec.lonMax;
+    c.Di = rec.Di;
+    c.Dj = rec.Dj;
+    c.resolFlags = rec.resolFlags;
+    c.scanFlags = rec.scanFlags;
+  }
+  ok = ok && Put(file, cached.data(), cached.size() * sizeof(CachedRecord));
+  ok = fclose(file) == 0 && ok;
+
+  if (ok) std::filesystem::rename(temporary, path, ec);
+  if (!ok || ec) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  Prune(directory, KEEP);
+  return true;
+}
+
+void GribCache::Prune(const std::string &directory, size_t keep) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  std::vector<std::pair<fs::file_time_type, fs::path>> caches;
+  for (fs::directory_iterator it(directory, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    const fs::path &path = it->path();
+    if (path.extension() != ".cache" ||
+        path.filename().string().compare(0, 5, "grib-"))
+      continue;
+    fs::file_time_type time = fs::last_write_time(path, ec);
+    if (!ec) caches.emplace_back(time, path);
+    ec.clear();
+  }
+  if (caches.size() <= keep) return;
+  std::sort(caches.begin(), caches.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+  // Caches still mapped stay where that fails, they go next time
+  for (size_t k = keep; k < caches.size(); k++) fs::remove(caches[k].second, ec);
+}
@@ -0,0 +1,303 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribDatasetSnapshot.h
+ */
+
+#include "GribDatasetSnapshot.h"
+
+#include <algorithm>
+
+#include "GribExporter.h"
+#include "GribResidency.h"
+#include "GribRouteSampler.h"
+
+// What a DpGrib::GridView keeps alive
+struct GridHandle {
+  std::shared_ptr<GRIBFile> file;
+  std::shared_ptr<const double> values, values2;
+};
+
+GribDatasetSnapshot::GribDatasetSnapshot(std::shared_ptr<GRIBFile> file,
+                                         GribOverlaySettings &settings)
+    : m_file(file) {
+  for (int i = 0; i < GribOverlaySettings::SETTINGS_COUNT; i++) {
+    m_calibration[i].offset = settings.CalibrationOffset(i);
+    m_calibration[i].beaufort = settings.HasBeaufortUnits(i);
+    if (!m_calibration[i].beaufort)
+      m_calibration[i].factor = settings.CalibrationFactor(i, 1.);
+    m_units[i] = settings.GetUnitSymbol(i).ToStdString(wxConvUTF8);
+  }
+
+  ArrayOfGribRecordSets *rsa = m_file->GetRecordSetArrayPtr();
+  for (unsigned int j = 0; j < rsa->GetCount(); j++) {
+    for (int i = 0; i < Idx_COUNT; i++) {
+      GribRecord *rec = rsa->Item(j).m_GribRecordPtrArray[i];
+      if (!rec || !rec->isOk()) continue;
+      if (!m_hasBounds) {
+        m_latMin = rec->getLatMin(), m_lonMin = rec->getLonMin();
+        m_latMax = rec->getLatMax(), m_lonMax = rec->getLonMax();
+        m_hasBounds = true;
+        continue;
+      }
+      m_latMin = std::min(m_latMin, rec->getLatMin());
+      m_lonMin = std::min(m_lonMin, rec->getLonMin());
+      m_latMax = std::max(m_latMax, rec->getLatMax());
+      m_lonMax = std::max(m_lonMax, rec->getLonMax());
+    }
+  }
+}
+
+bool GribDatasetSnapshot::GetSampleLayer(int layerId, GribSampleLayer &layer) {
+  switch (layerId) {
+    case GribOverlaySettings::WIND:
+      layer.kind = GribSampleLayer::VECTOR;
+      layer.idx = Idx_WIND_VX;
+      layer.idy = Idx_WIND_VY;
+      return true;
+    case GribOverlaySettings::CURRENT:
+      layer.kind = GribSampleLayer::VECTOR;
+      layer.idx = Idx_SEACURRENT_VX;
+      layer.idy = Idx_SEACURRENT_VY;
+      return true;
+    case GribOverlaySettings::WAVE:
+      layer.kind = GribSampleLayer::SCALAR_DIRECTION;
+      layer.idx = Idx_HTSIGW;
+      layer.idy = Idx_WVDIR;
+      return true;
+    case GribOverlaySettings::WIND_GUST:
+      layer.idx = Idx_WIND_GUST;
+      break;
+    case GribOverlaySettings::PRESSURE:
+      layer.idx = Idx_PRESSURE;
+      break;
+    case GribOverlaySettings::PRECIPITATION:
+      layer.idx = Idx_PRECIP_TOT;
+      break;
+    case GribOverlaySettings::CLOUD:
+      layer.idx = Idx_CLOUD_TOT;
+      break;
+    case GribOverlaySettings::AIR_TEMPERATURE:
+      layer.idx = Idx_AIR_TEMP;
+      break;
+    case GribOverlaySettings::SEA_TEMPERATURE:
+      layer.idx = Idx_SEA_TEMP;
+      break;
+    case GribOverlaySettings::CAPE:
+      layer.idx = Idx_CAPE;
+      break;
+    case GribOverlaySettings::COMP_REFL:
+      layer.idx = Idx_COMP_REFL;
+      break;
+    case GribOverlaySettings::WAVE_PERIOD:
+      layer.idx = Idx_WVPER;
+      break;
+    default:
+      return false;
+  }
+  layer.kind = GribSampleLayer::SCALAR;
+  return true;
+}
+
+unsigned int GribDatasetSnapshot::GetFileId() const {
+  return m_file->GetCounter();
+}
+
+size_t GribDatasetSnapshot::GetTimeCount() const {
+  return m_file->GetSetTimeIndex().Size();
+}
+
+time_t GribDatasetSnapshot::GetTime(size_t index) const {
+  const GribTimeIndex &times = m_file->GetSetTimeIndex();
+  return index < times.Size() ? times.Time(index) : (time_t)-1;
+}
+
+bool GribDatasetSnapshot::GetTimeRange(time_t &start, time_t &end) const {
+  const GribTimeIndex &times = m_file->GetSetTimeIndex();
+  if (times.Size() == 0) return false;
+  start = times.Time(0);
+  end = times.Time(times.Size() - 1);
+  return true;
+}
+
+bool GribDatasetSnapshot::GetBounds(double &latMin, double &lonMin,
+                                    double &latMax, double &lonMax) const {
+  if (!m_hasBounds) return false;
+  latMin = m_latMin, lonMin = m_lonMin;
+  latMax = m_latMax, lonMax = m_lonMax;
+  return true;
+}
+
+bool GribDatasetSnapshot::IsLayerAvailable(int layerId) const {
+  GribSampleLayer layer;
+  if (!GetSampleLayer(layerId, layer)) return false;
+  if (m_file->GetTimeIndex(layer.idx).Size() == 0) return false;
+  return layer.kind != GribSampleLayer::VECTOR ||
+         m_file->GetTimeIndex(layer.idy).Size() != 0;
+}
+
+bool GribDatasetSnapshot::IsVectorLayer(int layerId) const {
+  GribSampleLayer layer;
+  return GetSampleLayer(layerId, layer) &&
+         layer.kind != GribSampleLayer::SCALAR;
+}
+
+bool GribDatasetSnapshot::GetGrid(int layerId, size_t timeIndex,
+                                  DpGrib::GridView &view) const {
+  view = DpGrib::GridView();
+  GribSampleLayer layer;
+  if (!GetSampleLayer(layerId, layer)) return false;
+
+  GribResidency::ReadGuard guard;
+  ArrayOfGribRecordSets *rsa = m_file->GetRecordSetArrayPtr();
+  if (timeIndex >= rsa->GetCount()) return false;
+  GribRecordSet &set = rsa->Item(timeIndex);
+  GribRecord *rec = set.m_GribRecordPtrArray[layer.idx];
+  if (!rec || !rec->isOk() || !rec->getValues()) return false;
+
+  GribRecord *rec2 = nullptr;
+  if (layer.kind != GribSampleLayer::SCALAR) {
+    rec2 = set.m_GribRecordPtrArray[layer.idy];
+    // Both arrays are read with the geometry of the first one
+    if (rec2 && (!rec2->isOk() || !rec2->getValues() ||
+                 !(rec2->getGridGeometry() == rec->getGridGeometry())))
+      rec2 = nullptr;
+    if (!rec2 && layer.kind == GribSampleLayer::VECTOR) return false;
+  }
+
+  view.version = DpGrib::GridView::CURRENT_VERSION;
+  view.values = rec->getValues();
+  view.values2 = rec2 ? rec2->getValues() : nullptr;
+  view.ni = rec->getNi();
+  view.nj = rec->getNj();
+  view.lon0 = rec->getX(0);
+  view.lat0 = rec->getY(0);
+  view.di = rec->getDi();
+  view.dj = rec->getDj();
+  view.missingValue = GRIB_NOTDEF;
+  view.time = set.m_Reference_Time;
+  view.offset = m_calibration[layerId].offset;
+  view.factor = m_calibration[layerId].factor;
+  view.beaufort = m_calibration[layerId].beaufort;
+  view.units = m_units[layerId];
+
+  // The records live as long as the file, their arrays until evicted
+  auto handle = std::make_shared<GridHandle>();
+  handle->file = m_file;
+  handle->values = rec->shareValues();
+  handle->values2 = rec2 ? rec2->shareValues() : nullptr;
+  if (handle->values) view.values = handle->values.get();
+  if (handle->values2) view.values2 = handle->values2.get();
+  view.handle = handle;
+  return true;
+}
+
+DpGrib::SampleValue GribDatasetSnapshot::Sample(int layerId, time_t time,
+                                                double latitude,
+                                                double longitude) const {
+  std::vector<DpGrib::SampleQuery> queries(1);
+  queries[0].latitude = latitude;
+  queries[0].longitude = longitude;
+  queries[0].time = time;
+  std::vector<DpGrib::SampleValue> values;
+  SampleValues(std::vector<int>(1, layerId), queries, values);
+  return values[0];
+}
+
+bool GribDatasetSnapshot::GetScalarValueAt(int layerId, time_t time,
+                                           double latitude, double longitude,
+                                           double &value) const {
+  GribSampleLayer layer;
+  if (!GetSampleLayer(layerId, layer) || layer.kind == GribSampleLayer::VECTOR)
+    return false;
+
+  DpGrib::SampleValue v = Sample(layerId, time, latitude, longitude);
+  if (!v.valid) return false;
+  value = v.value;
+  return true;
+}
+
+bool GribDatasetSnapshot::GetVectorValueAt(int layerId, time_t time,
+                                           double latitude, double longitude,
+                                           double &magnitude,
+                                           double &direction) const {
+  if (!IsVectorLayer(layerId)) return false;
+
+  DpGrib::SampleValue v = Sample(layerId, time, latitude, longitude);
+  if (!v.valid || !v.hasDirection) return false;
+  magnitude = v.value;
+  direction = v.direction;
+  return true;
+}
+
+bool GribDatasetSnapshot::SampleValues(
+    const std::vector<int> &layerIds,
+    const std::vector<DpGrib::SampleQuery> &queries,
+    std::vector<DpGrib::SampleValue> &values, unsigned int threads) const {
+  values.assign(layerIds.size() * queries.size(), DpGrib::SampleValue());
+
+  // Sorted once for all the layers
+  GribBatchSampler sampler(m_file.get(), queries);
+  for (size_t l = 0; l < layerIds.size(); l++) {
+    GribSampleLayer layer;
+    if (!GetSampleLayer(layerIds[l], layer)) continue;
+
+    DpGrib::SampleValue *out = values.data() + l * queries.size();
+    sampler.Sample(layer, out, threads);
+
+    const Calibration &calibration = m_calibration[layerIds[l]];
+    for (size_t k = 0; k < queries.size(); k++)
+      if (out[k].valid) out[k].value = calibration.Apply(out[k].value);
+  }
+  return true;
+}
+
+bool GribDatasetSnapshot::SampleRoute(const DpGrib::RouteRequest &request,
+                                      DpGrib::RouteSamples &samples) const {
+  std::vector<DpGrib::SampleQuery> queries;
+  if (!GribRouteSampler::Densify(request, samples, queries)) return false;
+  return SampleValues(request.layerIds, queries, samples.values,
+                      request.threads);
+}
+
+bool GribDatasetSnapshot::Export(const DpGrib::ExportRequest &request,
+                                 DpGrib::ExportResult &result) const {
+  result = DpGrib::ExportResult();
+  GribExporter::Options options;
+  options.latMin = request.latMin, options.lonMin = request.lonMin;
+  options.latMax = request.latMax, options.lonMax = request.lonMax;
+  options.start = request.start, options.end = request.end;
+  for (int layerId : request.layerIds) {
+    GribSampleLayer layer;
+    if (!GetSampleLayer(layerId, layer)) return false;
+    options.indices.push_back(layer.idx);
+    if (layer.kind != GribSampleLayer::SCALAR)
+      options.indices.push_back(layer.idy);
+  }
+  options.thinning = request.thinning;
+  options.packing = request.packing == DpGrib::ExportRequest::SIMPLE
+                        ? GribWriter::SIMPLE
+                        : GribWriter::COMPLEX_SPATIAL;
+  options.bits = request.bits;
+  options.threads = request.threads;
+
+  ArrayOfGribRecordSets *rsa = m_file->GetRecordSetArrayPtr();
+  std::vector<GribRecordSet *> sets;
+  for (unsigned int j = 0; j < rsa->GetCount(); j++)
+    sets.push_back(&rsa->Item(j));
+
+  GribExporter::Result exported;
+  if (!GribExporter::ExportFile(sets, options, request.path, exported))
+    return false;
+  result.records = exported.records;
+  result.skipped = exported.skipped;
+  result.bytes = exported.bytes;
+  return true;
+}
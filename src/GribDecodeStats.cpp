@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribDecodeStats.h
+ */
+
+#include "GribDecodeStats.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+std::atomic<bool> s_enabled{false};
+
+std::mutex s_mutex;
+GribDecodeStats::Totals s_stages[GribDecodeStats::STAGE_COUNT];
+GribDecodeStats::UnpackTotals s_unpack;
+
+void Accumulate(GribDecodeStats::Totals &totals, size_t values,
+                double seconds) {
+  totals.seconds += seconds;
+  totals.count++;
+  totals.values += values;
+}
+
+}  // namespace
+
+void GribDecodeStats::Enable(bool enable) { s_enabled = enable; }
+
+bool GribDecodeStats::IsEnabled() {
+  return s_enabled.load(std::memory_order_relaxed);
+}
+
+void GribDecodeStats::Reset() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  for (Totals &totals : s_stages) totals = Totals();
+  s_unpack.clear();
+}
+
+GribDecodeStats::Totals GribDecodeStats::Get(Stage stage) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_stages[stage];
+}
+
+GribDecodeStats::UnpackTotals GribDecodeStats::GetUnpack() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_unpack;
+}
+
+void GribDecodeStats::Add(Stage stage, int edition, int packing,
+                          size_t values, double seconds) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  Accumulate(s_stages[stage], values, seconds);
+  if (stage == UNPACK)
+    Accumulate(s_unpack[std::make_pair(edition, packing)], values, seconds);
+}
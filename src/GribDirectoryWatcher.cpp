@@ -0,0 +1,173 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribDirectoryWatcher.h
+ */
+
+#include "GribDirectoryWatcher.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Longest wait with inotify, bounding how long Stop() waits for the thread
+const unsigned int NOTIFY_WAIT_MS = 250;
+
+}  // namespace
+
+bool GribDirectoryWatcher::Start(const std::string &directory,
+                                 const std::string &pattern,
+                                 Callback callback) {
+  Stop();
+  std::error_code ec;
+  if (!std::filesystem::is_directory(directory, ec)) return false;
+  try {
+    m_pattern = std::regex(pattern, std::regex::ECMAScript | std::regex::icase);
+  } catch (const std::regex_error &) {
+    return false;
+  }
+  m_directory = directory;
+  m_callback = std::move(callback);
+  m_known.clear();
+  m_pending.clear();
+
+  // What is there now is known, whatever its state
+  Clock::time_point now = Clock::now();
+  Scan(now);
+  for (auto &pending : m_pending) m_known[pending.first] = pending.second.state;
+  m_pending.clear();
+
+#ifdef __linux__
+  m_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_notify >= 0 &&
+      inotify_add_watch(m_notify, directory.c_str(),
+                        IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                            IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM) < 0) {
+    close(m_notify);  // e.g. out of watches: poll
+    m_notify = -1;
+  }
+#endif
+
+  m_stop = false;
+  m_thread = std::thread(&GribDirectoryWatcher::Run, this);
+  return true;
+}
+
+void GribDirectoryWatcher::Stop() {
+  if (!m_thread.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+#ifdef __linux__
+  if (m_notify >= 0) close(m_notify);
+#endif
+  m_notify = -1;
+}
+
+void GribDirectoryWatcher::Run() {
+  for (;;) {
+    // With inotify, scans follow changes, and repeat while files settle
+    bool changed;
+    if (IsNotified())
+      changed = Wait(m_pending.empty() ? NOTIFY_WAIT_MS
+                                       : std::min(NOTIFY_WAIT_MS,
+                                                  m_settleMs.load()));
+    else
+      changed = Wait(m_pending.empty() ? m_pollMs.load()
+                                       : std::min(m_pollMs.load(),
+                                                  m_settleMs.load()));
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stop) return;
+    }
+    if (IsNotified() && !changed && m_pending.empty()) continue;
+
+    std::vector<std::string> settled = Scan(Clock::now());
+    if (!settled.empty() && m_callback) m_callback(settled);
+  }
+}
+
+bool GribDirectoryWatcher::Wait(unsigned int ms) {
+#ifdef __linux__
+  if (m_notify >= 0) {
+    pollfd fd = {m_notify, POLLIN, 0};
+    if (poll(&fd, 1, (int)ms) <= 0) return false;
+    // Which file changed does not matter, the scan finds out
+    char events[4096];
+    while (read(m_notify, events, sizeof events) > 0) {
+    }
+    return true;
+  }
+#endif
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return m_stop; });
+  return false;
+}
+
+std::vector<std::string> GribDirectoryWatcher::Scan(Clock::time_point now) {
+  namespace fs = std::filesystem;
+  std::vector<std::pair<int64_t, std::string>> settled;
+  std::map<std::string, FileState> present;
+
+  std::error_code ec;
+  for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    std::error_code fileEc;
+    if (!it->is_regular_file(fileEc)) continue;
+    const fs::path &path = it->path();
+    if (!std::regex_match(path.filename().string(), m_pattern)) continue;
+    FileState state;
+    state.size = fs::file_size(path, fileEc);
+    if (fileEc) continue;
+    state.mtime = (int64_t)fs::last_write_time(path, fileEc)
+                      .time_since_epoch()
+                      .count();
+    if (fileEc) continue;
+    present[path.string()] = state;
+  }
+  if (ec) return {};  // directory gone or unreadable: wait for it back
+
+  for (const auto &file : present) {
+    auto known = m_known.find(file.first);
+    if (known != m_known.end() && known->second == file.second) {
+      m_pending.erase(file.first);
+      continue;
+    }
+    auto pending = m_pending.find(file.first);
+    if (pending == m_pending.end() || !(pending->second.state == file.second)) {
+      m_pending[file.first] = {file.second, now};
+    } else if (now - pending->second.since >=
+               std::chrono::milliseconds(m_settleMs.load())) {
+      settled.emplace_back(file.second.mtime, file.first);
+      m_known[file.first] = file.second;
+      m_pending.erase(pending);
+    }
+  }
+  // Files removed are new again if they come back
+  for (auto it = m_known.begin(); it != m_known.end();)
+    it = present.count(it->first) ? std::next(it) : m_known.erase(it);
+  for (auto it = m_pending.begin(); it != m_pending.end();)
+    it = present.count(it->first) ? std::next(it) : m_pending.erase(it);
+
+  std::sort(settled.begin(), settled.end());
+  std::vector<std::string> files;
+  for (const auto &file : settled) files.push_back(file.second);
+  return files;
+}
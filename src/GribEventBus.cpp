@@ -0,0 +1,292 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribEventBus.h
+ */
+
+#include "GribEventBus.h"
+
+#include <algorithm>
+
+GribEventBus::GribEventBus() {}
+
+GribEventBus::~GribEventBus() { Stop(); }
+
+void GribEventBus::SetWakeHandler(std::function<void(int)> handler) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_wakeHandler = std::move(handler);
+}
+
+uint64_t GribEventBus::Subscribe(const DpGrib::EventSubscription &subscription,
+                                 DpGrib::EventCallback callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SubscriberPtr subscriber = std::make_shared<Subscriber>();
+  subscriber->id = m_nextId++;
+  subscriber->subscription = subscription;
+  subscriber->callback = std::move(callback);
+  m_subscribers[subscriber->id] = subscriber;
+
+  if (subscription.ownThread && !m_thread.joinable()) {
+    m_stop = false;
+    m_thread = std::thread(&GribEventBus::Run, this);
+  }
+  return subscriber->id;
+}
+
+void GribEventBus::Unsubscribe(uint64_t id) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_subscribers.erase(id);
+
+  // Wait for a delivery in flight on another thread
+  std::thread::id self = std::this_thread::get_id();
+  m_delivered.wait(lock, [&] {
+    auto range = m_delivering.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it)
+      if (it->second != self) return false;
+    return true;
+  });
+}
+
+void GribEventBus::Clear() {
+  Stop();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_subscribers.clear();
+  m_guiWakeAt = Clock::time_point::max();
+}
+
+void GribEventBus::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  if (!m_thread.joinable()) return;
+  if (m_thread.get_id() == std::this_thread::get_id())
+    m_thread.detach();  // from one of its own callbacks
+  else
+    m_thread.join();
+}
+
+void GribEventBus::PostState() {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_STATE;
+  Post(event);
+}
+
+void GribEventBus::PostData() {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_DATA;
+  Post(event);
+}
+
+void GribEventBus::PostLayerState(const std::vector<int> &disabledLayerIds) {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_LAYER_STATE;
+  event.disabledLayerIds = disabledLayerIds;
+  Post(event);
+}
+
+void GribEventBus::PostFormatState(
+    const std::vector<std::pair<int, int>> &changedFormats) {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_FORMAT_STATE;
+  event.changedFormats = changedFormats;
+  Post(event);
+}
+
+void GribEventBus::PostCursor(double latitude, double longitude) {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_CURSOR;
+  event.latitude = latitude;
+  event.longitude = longitude;
+  Post(event);
+}
+
+void GribEventBus::PostTime(time_t time) {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_TIME;
+  event.time = time;
+  Post(event);
+}
+
+void GribEventBus::PostDownloadProgress(long transferred, long total,
+                                        bool completed, bool success) {
+  DpGrib::Events event;
+  event.types = DpGrib::EVENT_DOWNLOAD_PROGRESS;
+  event.transferred = transferred;
+  event.total = total;
+  event.completed = completed;
+  event.success = success;
+  Post(event);
+}
+
+static int Milliseconds(std::chrono::steady_clock::duration d) {
+  if (d.count() <= 0) return 0;
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(d).count();
+  return (int)std::min<decltype(ms)>(ms, 1 << 30);
+}
+
+void GribEventBus::Post(const DpGrib::Events &posted) {
+  DpGrib::Events event = posted;
+  event.count = 1;
+
+  std::vector<SubscriberPtr> due;
+  std::vector<DpGrib::Events> events;
+  bool threadWork = false;
+  int wakeMs = -1;
+  std::function<void(int)> wake;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Clock::time_point now = Clock::now();
+    for (auto &entry : m_subscribers) {
+      Subscriber &s = *entry.second;
+      const DpGrib::EventSubscription &options = s.subscription;
+      if (!(options.types & event.types)) continue;
+
+      if (!options.coalesceMs && options.maxRate <= 0. && !options.ownThread) {
+        due.push_back(entry.second);
+        events.push_back(event);
+        continue;
+      }
+
+      if (!s.pending.types) s.first = now;
+      Merge(s.pending, event);
+      if (event.completed) s.urgent = true;
+
+      if (options.ownThread) {
+        threadWork = true;
+        continue;
+      }
+      Clock::time_point at = Due(s);
+      if (at < m_guiWakeAt) {
+        m_guiWakeAt = at;
+        wakeMs = Milliseconds(at - now);
+      }
+    }
+    if (wakeMs >= 0) wake = m_wakeHandler;
+  }
+
+  if (threadWork) m_wake.notify_all();
+  if (wake) wake(wakeMs);
+  Deliver(due, events);
+}
+
+void GribEventBus::Merge(DpGrib::Events &pending,
+                         const DpGrib::Events &event) {
+  pending.types |= event.types;
+  pending.count += event.count;
+  if (event.types & DpGrib::EVENT_LAYER_STATE)
+    pending.disabledLayerIds = event.disabledLayerIds;
+  if (event.types & DpGrib::EVENT_FORMAT_STATE) {
+    for (auto &format : event.changedFormats)
+      if (std::find(pending.changedFormats.begin(),
+                    pending.changedFormats.end(),
+                    format) == pending.changedFormats.end())
+        pending.changedFormats.push_back(format);
+  }
+  if (event.types & DpGrib::EVENT_CURSOR) {
+    pending.latitude = event.latitude;
+    pending.longitude = event.longitude;
+  }
+  if (event.types & DpGrib::EVENT_TIME) pending.time = event.time;
+  if (event.types & DpGrib::EVENT_DOWNLOAD_PROGRESS) {
+    pending.transferred = event.transferred;
+    pending.total = event.total;
+    pending.completed = event.completed;
+    pending.success = event.success;
+  }
+}
+
+GribEventBus::Clock::time_point GribEventBus::Due(
+    const Subscriber &subscriber) const {
+  const DpGrib::EventSubscription &options = subscriber.subscription;
+  Clock::time_point at = subscriber.first;
+  if (!subscriber.urgent)
+    at += std::chrono::milliseconds(options.coalesceMs);
+  if (options.maxRate > 0.) {
+    auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1. / options.maxRate));
+    at = std::max(at, subscriber.last + interval);
+  }
+  return at;
+}
+
+GribEventBus::Clock::time_point GribEventBus::TakeDue(
+    bool ownThread, Clock::time_point now, std::vector<SubscriberPtr> &due,
+    std::vector<DpGrib::Events> &events) {
+  Clock::time_point next = Clock::time_point::max();
+  for (auto &entry : m_subscribers) {
+    Subscriber &s = *entry.second;
+    if (s.subscription.ownThread != ownThread || !s.pending.types) continue;
+    Clock::time_point at = Due(s);
+    if (at > now) {
+      next = std::min(next, at);
+      continue;
+    }
+    due.push_back(entry.second);
+    events.push_back(std::move(s.pending));
+    s.pending = DpGrib::Events();
+    s.last = now;
+    s.urgent = false;
+  }
+  return next;
+}
+
+void GribEventBus::Deliver(std::vector<SubscriberPtr> &due,
+                           std::vector<DpGrib::Events> &events) {
+  std::thread::id self = std::this_thread::get_id();
+  for (size_t k = 0; k < due.size(); k++) {
+    std::multimap<uint64_t, std::thread::id>::iterator delivering;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Unsubscribed by an earlier callback
+      if (!m_subscribers.count(due[k]->id)) continue;
+      delivering = m_delivering.emplace(due[k]->id, self);
+    }
+    if (due[k]->callback) due[k]->callback(events[k]);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_delivering.erase(delivering);
+    }
+    m_delivered.notify_all();
+  }
+}
+
+int GribEventBus::Pump() {
+  std::vector<SubscriberPtr> due;
+  std::vector<DpGrib::Events> events;
+  Clock::time_point now = Clock::now(), next;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    next = TakeDue(false, now, due, events);
+    m_guiWakeAt = next;
+  }
+  Deliver(due, events);
+  return next == Clock::time_point::max() ? -1 : Milliseconds(next - now);
+}
+
+void GribEventBus::Run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stop) {
+    std::vector<SubscriberPtr> due;
+    std::vector<DpGrib::Events> events;
+    Clock::time_point next = TakeDue(true, Clock::now(), due, events);
+    if (!due.empty()) {
+      lock.unlock();
+      Deliver(due, events);
+      lock.lock();
+      continue;
+    }
+    if (next == Clock::time_point::max())
+      m_wake.wait(lock);
+    else
+      m_wake.wait_until(lock, next);
+  }
+}
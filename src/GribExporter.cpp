@@ -0,0 +1,339 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribExporter.h
+ */
+
+#include "GribExporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <thread>
+
+#include "GribRecord.h"
+#include "GribRecordSet.h"
+#include "GribResidency.h"
+
+namespace {
+
+// Grid coordinates are given to a few decimals, points on the area edges
+// are kept
+const double EDGE = 1e-6;
+
+struct Grib2Code {
+  int discipline, category, number;
+};
+
+// The inverse of GRBV2_TO_DATA() in GribV2Record.cpp
+bool Grib2CodeOf(int dataType, int levelType, Grib2Code &code) {
+  switch (dataType) {
+    case GRB_TEMP:
+      code = {0, 0, 0};
+      break;
+    case GRB_TPOT:
+      code = {0, 0, 2};
+      break;
+    case GRB_TMAX:
+      code = {0, 0, 4};
+      break;
+    case GRB_TMIN:
+      code = {0, 0, 5};
+      break;
+    case GRB_DEWPOINT:
+      code = {0, 0, 6};
+      break;
+    case GRB_HUMID_SPEC:
+      code = {0, 1, 0};
+      break;
+    case GRB_HUMID_REL:
+      code = {0, 1, 1};
+      break;
+    case GRB_PRECIP_RATE:
+      code = {0, 1, 7};
+      break;
+    case GRB_PRECIP_TOT:
+      code = {0, 1, 8};
+      break;
+    case GRB_SNOW_DEPTH:
+      code = {0, 1, 11};
+      break;
+    case GRB_FRZRAIN_CATEG:
+      code = {0, 1, 193};
+      break;
+    case GRB_SNOW_CATEG:
+      code = {0, 1, 195};
+      break;
+    case GRB_WIND_DIR:
+      code = {0, 2, 0};
+      break;
+    case GRB_WIND_SPEED:
+      code = {0, 2, 1};
+      break;
+    case GRB_WIND_VX:
+      code = {0, 2, 2};
+      break;
+    case GRB_WIND_VY:
+      code = {0, 2, 3};
+      break;
+    case GRB_WIND_GUST:
+      code = {0, 2, 22};
+      break;
+    case GRB_PRESSURE:
+      // Reduced to mean sea level, or at the level
+      code = {0, 3, levelType == LV_MSL ? 1 : 0};
+      break;
+    case GRB_GEOPOT_HGT:
+      code = {0, 3, 5};
+      break;
+    case GRB_CLOUD_TOT:
+      code = {0, 6, 1};
+      break;
+    case GRB_CAPE:
+      code = {0, 7, 6};
+      break;
+    case GRB_COMP_REFL:
+      code = {0, 16, 196};
+      break;
+    case GRB_HTSGW:
+      code = {10, 0, 3};
+      break;
+    case GRB_WVDIR:
+      code = {10, 0, 4};
+      break;
+    case GRB_WVHGT:
+      code = {10, 0, 5};
+      break;
+    case GRB_WVPER:
+      code = {10, 0, 6};
+      break;
+    case GRB_DIR:
+      code = {10, 0, 14};
+      break;
+    case GRB_PER:
+      code = {10, 0, 15};
+      break;
+    case GRB_CUR_DIR:
+      code = {10, 1, 0};
+      break;
+    case GRB_CUR_SPEED:
+      code = {10, 1, 1};
+      break;
+    case GRB_UOGRD:
+      code = {10, 1, 2};
+      break;
+    case GRB_VOGRD:
+      code = {10, 1, 3};
+      break;
+    case GRB_WTMP:
+      code = {10, 3, 0};
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+// GRIB2 table 4.5 level of a record level, the inverse of
+// GribV2Record::translateDataType()
+bool Grib2LevelOf(int levelType, int levelValue, int &type, int &value) {
+  value = levelValue;
+  switch (levelType) {
+    case LV_GND_SURF:
+    case LV_ISOTHERM0:
+    case LV_ATMOS_ENT:
+    case LV_ATMOS_ALL:  // NCEP local code, read as is
+      type = levelType;
+      return true;
+    case LV_ISOBARIC:
+      type = 100;
+      value = levelValue * 100;  // hPa to Pa
+      return true;
+    case LV_MSL:
+      type = 101;
+      return true;
+    case LV_ABOV_GND:
+      type = 103;
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool GribExporter::Export(const std::vector<GribRecordSet *> &sets,
+                          const Options &options,
+                          std::vector<unsigned char> &out, Result &result) {
+  result = Result();
+  if (options.thinning < 1 || options.latMin > options.latMax) return false;
+
+  std::vector<int> indices = options.indices;
+  if (indices.empty()) {
+    for (int idx = 0; idx < Idx_COUNT; idx++) indices.push_back(idx);
+  }
+  bool allTimes = options.end < options.start;
+
+  // Records may be shared between sets, each is written once
+  std::set<const GribRecord *> seen;
+  std::vector<Job> jobs;
+  for (const GribRecordSet *set : sets) {
+    time_t t = set->m_Reference_Time;
+    if (!allTimes && (t < options.start || t > options.end)) continue;
+    for (int idx : indices) {
+      if (idx < 0 || idx >= Idx_COUNT) return false;
+      const GribRecord *rec = set->m_GribRecordPtrArray[idx];
+      if (!rec || !rec->isOk() || !seen.insert(rec).second) continue;
+      Job job;
+      if (Crop(*rec, options, job))
+        jobs.push_back(job);
+      else
+        result.skipped++;
+    }
+  }
+
+  // Callers may be on any thread, keep the grids where they are meanwhile
+  GribResidency::ReadGuard guard;
+
+  std::vector<std::vector<unsigned char>> messages(jobs.size());
+  std::atomic<size_t> next{0};
+  std::atomic<bool> ok{true};
+  auto work = [&]() {
+    for (size_t k; ok && (k = next++) < jobs.size();) {
+      if (!Encode(jobs[k], messages[k])) ok = false;
+    }
+  };
+  unsigned int threads = options.threads;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = (unsigned int)std::min<size_t>(threads, jobs.size());
+  std::vector<std::thread> pool;
+  for (unsigned int t = 1; t < threads; t++) pool.emplace_back(work);
+  work();
+  for (std::thread &thread : pool) thread.join();
+  if (!ok) return false;
+
+  for (const std::vector<unsigned char> &message : messages) {
+    out.insert(out.end(), message.begin(), message.end());
+    result.bytes += message.size();
+  }
+  result.records = messages.size();
+  return true;
+}
+
+bool GribExporter::ExportFile(const std::vector<GribRecordSet *> &sets,
+                              const Options &options, const std::string &path,
+                              Result &result) {
+  std::vector<unsigned char> out;
+  if (!Export(sets, options, out, result)) return false;
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+  return fclose(file) == 0 && ok;
+}
+
+bool GribExporter::Crop(const GribRecord &rec, const Options &options,
+                        Job &job) {
+  GribWriter::Field &field = job.field;
+  Grib2Code code;
+  if (!Grib2CodeOf(rec.getDataType(), rec.getLevelType(), code) ||
+      !Grib2LevelOf(rec.getLevelType(), rec.getLevelValue(), field.levelType,
+                    field.levelValue))
+    return false;
+
+  int ni = rec.getNi(), nj = rec.getNj();
+  double di = rec.getDi(), dj = rec.getDj();
+  if (ni < 2 || nj < 2 || di <= 0 || dj == 0) return false;
+  int step = options.thinning;
+
+  // Columns: the west edge of the area as an offset east of the first one,
+  // in [0, 360), or west of it when the area starts off a regional grid
+  double width = options.lonMax - options.lonMin;
+  if (width < 0) width += 360;
+  double off = std::fmod(options.lonMin - rec.getX(0), 360.);
+  if (off < 0) off += 360;
+  bool global = ni * di >= 360 - di / 2;
+  // Global grids may repeat their first column at the end
+  int period = global ? std::min(ni, (int)std::lround(360 / di)) : ni;
+  if (!global && off > (ni - 1) * di + EDGE) off -= 360;
+  int first = (int)std::ceil(off / di - EDGE);
+  int last = (int)std::floor((off + width) / di + EDGE);
+  if (global) {
+    last = std::min(last, first + period - 1);
+  } else {
+    first = std::max(first, 0);
+    last = std::min(last, ni - 1);
+  }
+  int columns = last < first ? 0 : (last - first) / step + 1;
+
+  // Rows
+  double lat1 = rec.getY(0);
+  double north = (options.latMax - lat1) / dj;
+  double south = (options.latMin - lat1) / dj;
+  int top = std::max(0, (int)std::ceil(std::min(north, south) - EDGE));
+  int bottom = std::min(nj - 1, (int)std::floor(std::max(north, south) + EDGE));
+  int rows = bottom < top ? 0 : (bottom - top) / step + 1;
+
+  // Decoders want two points or more each way
+  if (columns < 2 || rows < 2) return false;
+
+  job.record = &rec;
+  job.i0 = ((first % period) + period) % period;
+  job.j0 = top;
+  job.step = step;
+  job.period = period;
+  // The decoder reads precipitation rates per second, holds them per hour
+  job.scale = rec.getDataType() == GRB_PRECIP_RATE ? 1 / 3600. : 1;
+
+  field.edition = 2;
+  field.discipline = code.discipline;
+  field.category = code.category;
+  field.number = code.number;
+  field.center = rec.getIdCenter();
+  field.process = rec.getIdModel();
+  time_t ref = rec.getRecordRefDate(), date = rec.getRecordCurrentDate();
+  if (date >= ref && (date - ref) % 3600 == 0) {
+    field.reference = ref;
+    field.forecastHours = (int)((date - ref) / 3600);
+  } else {
+    field.reference = date;  // an analysis then
+    field.forecastHours = 0;
+  }
+
+  field.ni = columns;
+  field.nj = rows;
+  field.lon1 = std::fmod(rec.getX(0) + first * di, 360.);
+  if (field.lon1 < 0) field.lon1 += 360;
+  field.lat1 = rec.getY(top);
+  field.di = di * step;
+  field.dj = dj * step;
+  field.packing = options.packing;
+  field.bits = options.bits;
+  return true;
+}
+
+bool GribExporter::Encode(const Job &job, std::vector<unsigned char> &out) {
+  const GribRecord &rec = *job.record;
+  const double *values = rec.getValues();
+  if (!values) return false;
+  GribWriter::Field field = job.field;
+  int ni = rec.getNi();
+  std::vector<double> cropped((size_t)field.ni * field.nj);
+  for (int j = 0; j < field.nj; j++) {
+    const double *row = values + (size_t)(job.j0 + j * job.step) * ni;
+    for (int i = 0; i < field.ni; i++) {
+      double v = row[(job.i0 + i * job.step) % job.period];
+      cropped[(size_t)j * field.ni + i] =
+          v == GRIB_NOTDEF ? GRIB_NOTDEF : v * job.scale;
+    }
+  }
+  field.values = cropped.data();
+  return GribWriter::Encode(field, out);
+}
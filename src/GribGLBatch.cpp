@@ -0,0 +1,296 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribGLBatch.h
+ */
+
+#include "GribGLBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "linmath.h"
+#include "pi_shaders.h"
+#include "pi_TexFont.h"
+
+extern float g_piGLMinSymbolLineWidth;
+
+// Floats per vertex in the line and fill buffers (x, y, r, g, b, a) and in
+// the glyph buffer (x, y, u, v).
+static const int COLOR_VERTEX = 6;
+static const int GLYPH_VERTEX = 4;
+
+const GribGLProgramLocations &GribColorvProgramLocations() {
+  static GribGLProgramLocations loc;
+#ifdef ocpnUSE_GL
+  GLint program = GRIBpi_colorv_tri_shader_program;
+  if (program && loc.program != program) {
+    loc.program = program;
+    loc.position = glGetAttribLocation(program, "position");
+    loc.color = glGetAttribLocation(program, "colorv");
+    loc.transform = glGetUniformLocation(program, "TransformMatrix");
+  }
+#endif
+  return loc;
+}
+
+const GribGLProgramLocations &GribTexture2DProgramLocations() {
+  static GribGLProgramLocations loc;
+#ifdef ocpnUSE_GL
+  GLint program = pi_texture_2D_shader_program;
+  if (program && loc.program != program) {
+    loc.program = program;
+    loc.position = glGetAttribLocation(program, "aPos");
+    loc.uv = glGetAttribLocation(program, "aUV");
+    loc.tex = glGetUniformLocation(program, "uTex");
+    loc.transform = glGetUniformLocation(program, "TransformMatrix");
+  }
+#endif
+  return loc;
+}
+
+GribGLBatch::GribGLBatch()
+    : m_font(nullptr), m_lineVBO(0), m_fillVBO(0), m_glyphVBO(0) {}
+
+GribGLBatch::~GribGLBatch() {
+#ifdef ocpnUSE_GL
+  if (m_lineVBO) glDeleteBuffers(1, &m_lineVBO);
+  if (m_fillVBO) glDeleteBuffers(1, &m_fillVBO);
+  if (m_glyphVBO) glDeleteBuffers(1, &m_glyphVBO);
+#endif
+}
+
+void GribGLBatch::PushVertex(std::vector<float> &v, float x, float y,
+                             const float rgba[4]) {
+  v.push_back(x);
+  v.push_back(y);
+  v.insert(v.end(), rgba, rgba + 4);
+}
+
+GribGLBatch::LineRun &GribGLBatch::Run(std::vector<LineRun> &runs,
+                                       float width) {
+  // Only a few distinct widths occur in a frame
+  for (LineRun &run : runs)
+    if (run.width == width) return run;
+  runs.push_back(LineRun());
+  runs.back().width = width;
+  return runs.back();
+}
+
+void GribGLBatch::AddLines(const float *vertexes, int count,
+                           const wxColour &colour, float width) {
+  // Labels queued by an earlier pass stay below these arrows
+  if (!m_fills.empty()) Flush();
+
+  const float rgba[4] = {colour.Red() / 255.f, colour.Green() / 255.f,
+                         colour.Blue() / 255.f, colour.Alpha() / 255.f};
+  std::vector<float> &v = Run(m_arrowRuns, width).vertexes;
+  for (int i = 0; i < 2 * count; i++)
+    PushVertex(v, vertexes[2 * i], vertexes[2 * i + 1], rgba);
+}
+
+void GribGLBatch::AddStrokes(const float *vertexes, int count,
+                             const wxColour &colour, float width) {
+  if (!m_fills.empty()) Flush();
+
+  const float rgba[4] = {colour.Red() / 255.f, colour.Green() / 255.f,
+                         colour.Blue() / 255.f, colour.Alpha() / 255.f};
+  float half = wxMax(g_piGLMinSymbolLineWidth, width) / 2;
+  std::vector<float> &v = m_strokes;
+  for (int i = 0; i < count; i++) {
+    const float *l = vertexes + 4 * i;
+    float dx = l[2] - l[0], dy = l[3] - l[1];
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len == 0) continue;
+    float nx = -dy / len * half, ny = dx / len * half;
+
+    // A degenerate triangle pair joins this quad to the previous one
+    if (!v.empty()) {
+      float last[COLOR_VERTEX];
+      std::copy(v.end() - COLOR_VERTEX, v.end(), last);
+      v.insert(v.end(), last, last + COLOR_VERTEX);
+      PushVertex(v, l[0] + nx, l[1] + ny, rgba);
+    }
+    PushVertex(v, l[0] + nx, l[1] + ny, rgba);
+    PushVertex(v, l[0] - nx, l[1] - ny, rgba);
+    PushVertex(v, l[2] + nx, l[3] + ny, rgba);
+    PushVertex(v, l[2] - nx, l[3] - ny, rgba);
+  }
+}
+
+void GribGLBatch::AddLabel(int x, int y, int w, int h, const wxColour &back,
+                           const wxString &text, TexFont &font, int textx,
+                           int texty) {
+  const float rgba[4] = {back.Red() / 255.f, back.Green() / 255.f,
+                         back.Blue() / 255.f, back.Alpha() / 255.f};
+  const float corners[4][2] = {
+      {(float)x, (float)y},
+      {(float)(x + w), (float)y},
+      {(float)(x + w), (float)(y + h)},
+      {(float)x, (float)(y + h)}};
+
+  static const int tris[6] = {0, 1, 2, 0, 2, 3};
+  for (int k : tris) PushVertex(m_fills, corners[k][0], corners[k][1], rgba);
+
+  static const float black[4] = {0, 0, 0, 1};
+  std::vector<float> &v = Run(m_labelRuns, 1).vertexes;
+  for (int k = 0; k < 4; k++) {
+    PushVertex(v, corners[k][0], corners[k][1], black);
+    PushVertex(v, corners[(k + 1) % 4][0], corners[(k + 1) % 4][1], black);
+  }
+
+  // Every glyph of a batch comes from one atlas
+  wxASSERT(!m_font || m_font == &font || m_glyphs.empty());
+  m_font = &font;
+  font.GetGlyphQuads(text, textx, texty, m_glyphs);
+}
+
+bool GribGLBatch::IsEmpty() const {
+  for (const LineRun &run : m_arrowRuns)
+    if (!run.vertexes.empty()) return false;
+  for (const LineRun &run : m_labelRuns)
+    if (!run.vertexes.empty()) return false;
+  return m_strokes.empty() && m_fills.empty() && m_glyphs.empty();
+}
+
+void GribGLBatch::Clear() {
+  // Keep the allocations, the next frame has about as much to draw
+  for (LineRun &run : m_arrowRuns) run.vertexes.clear();
+  for (LineRun &run : m_labelRuns) run.vertexes.clear();
+  m_strokes.clear();
+  m_fills.clear();
+  m_glyphs.clear();
+  m_font = nullptr;
+}
+
+void GribGLBatch::DrawRuns(const std::vector<LineRun> &runs, size_t &first) {
+#ifdef ocpnUSE_GL
+  for (const LineRun &run : runs) {
+    size_t n = run.vertexes.size() / COLOR_VERTEX;
+    if (!n) continue;
+    glLineWidth(wxMax(g_piGLMinSymbolLineWidth, run.width));
+    glDrawArrays(GL_LINES, first, n);
+    first += n;
+  }
+#endif
+}
+
+void GribGLBatch::Flush() {
+  if (IsEmpty()) return;
+
+#ifdef ocpnUSE_GL
+  const GribGLProgramLocations &cv = GribColorvProgramLocations();
+  if (!cv.program) {
+    Clear();
+    return;
+  }
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+#ifndef __OCPN__ANDROID__
+  //      Enable anti-aliased lines, at best quality
+  glEnable(GL_LINE_SMOOTH);
+  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+#endif
+
+  mat4x4 I;
+  mat4x4_identity(I);
+
+  glUseProgram(cv.program);
+  glUniformMatrix4fv(cv.transform, 1, GL_FALSE, (const GLfloat *)I);
+  glEnableVertexAttribArray(cv.position);
+  glEnableVertexAttribArray(cv.color);
+
+  // All lines, arrows and their hi-def strokes first then label outlines,
+  // go in one buffer
+  m_upload.clear();
+  for (const LineRun &run : m_arrowRuns)
+    m_upload.insert(m_upload.end(), run.vertexes.begin(), run.vertexes.end());
+  m_upload.insert(m_upload.end(), m_strokes.begin(), m_strokes.end());
+  for (const LineRun &run : m_labelRuns)
+    m_upload.insert(m_upload.end(), run.vertexes.begin(), run.vertexes.end());
+
+  const GLsizei stride = COLOR_VERTEX * sizeof(float);
+  size_t first = 0;
+  if (!m_upload.empty()) {
+    if (!m_lineVBO) glGenBuffers(1, &m_lineVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_upload.size() * sizeof(float),
+                 m_upload.data(), GL_STREAM_DRAW);
+    glVertexAttribPointer(cv.position, 2, GL_FLOAT, GL_FALSE, stride, 0);
+    glVertexAttribPointer(cv.color, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const void *)(2 * sizeof(float)));
+    DrawRuns(m_arrowRuns, first);
+    if (!m_strokes.empty()) {
+      size_t n = m_strokes.size() / COLOR_VERTEX;
+      glDrawArrays(GL_TRIANGLE_STRIP, first, n);
+      first += n;
+    }
+  }
+
+  if (!m_fills.empty()) {
+    if (!m_fillVBO) glGenBuffers(1, &m_fillVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_fillVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_fills.size() * sizeof(float),
+                 m_fills.data(), GL_STREAM_DRAW);
+    glVertexAttribPointer(cv.position, 2, GL_FLOAT, GL_FALSE, stride, 0);
+    glVertexAttribPointer(cv.color, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const void *)(2 * sizeof(float)));
+    glDrawArrays(GL_TRIANGLES, 0, m_fills.size() / COLOR_VERTEX);
+  }
+
+  if (!m_upload.empty() && first * COLOR_VERTEX < m_upload.size()) {
+    glBindBuffer(GL_ARRAY_BUFFER, m_lineVBO);
+    glVertexAttribPointer(cv.position, 2, GL_FLOAT, GL_FALSE, stride, 0);
+    glVertexAttribPointer(cv.color, 4, GL_FLOAT, GL_FALSE, stride,
+                          (const void *)(2 * sizeof(float)));
+    DrawRuns(m_labelRuns, first);
+  }
+
+  glDisableVertexAttribArray(cv.position);
+  glDisableVertexAttribArray(cv.color);
+
+  const GribGLProgramLocations &tx = GribTexture2DProgramLocations();
+  if (!m_glyphs.empty() && m_font && tx.program) {
+    glUseProgram(tx.program);
+    glUniformMatrix4fv(tx.transform, 1, GL_FALSE, (const GLfloat *)I);
+    glUniform1i(tx.tex, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_font->GetTexture());
+
+    if (!m_glyphVBO) glGenBuffers(1, &m_glyphVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_glyphVBO);
+    glBufferData(GL_ARRAY_BUFFER, m_glyphs.size() * sizeof(float),
+                 m_glyphs.data(), GL_STREAM_DRAW);
+
+    const GLsizei gstride = GLYPH_VERTEX * sizeof(float);
+    glVertexAttribPointer(tx.position, 2, GL_FLOAT, GL_FALSE, gstride, 0);
+    glVertexAttribPointer(tx.uv, 2, GL_FLOAT, GL_FALSE, gstride,
+                          (const void *)(2 * sizeof(float)));
+    glEnableVertexAttribArray(tx.position);
+    glEnableVertexAttribArray(tx.uv);
+
+    glDrawArrays(GL_TRIANGLES, 0, m_glyphs.size() / GLYPH_VERTEX);
+
+    glDisableVertexAttribArray(tx.position);
+    glDisableVertexAttribArray(tx.uv);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glUseProgram(0);
+
+#ifndef __OCPN__ANDROID__
+  glDisable(GL_LINE_SMOOTH);
+#endif
+  glDisable(GL_BLEND);
+#endif
+
+  Clear();
+}
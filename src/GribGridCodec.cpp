@@ -0,0 +1,191 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribGridCodec.h
+ */
+
+#include "GribGridCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "GribRecord.h"
+
+namespace {
+
+const unsigned char STEPS = 'S', EXACT = 'X';
+// Beyond this many steps a value is not worth an integer
+const double MAX_STEPS = 1099511627776.;  // 2^40
+
+void PutDouble(std::vector<unsigned char> &out, double v) {
+  unsigned char bytes[sizeof v];
+  memcpy(bytes, &v, sizeof v);
+  out.insert(out.end(), bytes, bytes + sizeof v);
+}
+
+uint64_t Bits(double v) {
+  uint64_t u;
+  memcpy(&u, &v, sizeof u);
+  return u;
+}
+
+// Byte of significance plane of the xor of value k with the previous one
+unsigned char PlaneByte(const double *values, size_t k, int plane) {
+  uint64_t u = Bits(values[k]) ^ (k ? Bits(values[k - 1]) : 0);
+  return (unsigned char)(u >> (8 * plane));
+}
+
+}  // namespace
+
+void GribGridCodec::Encode(const double *values, size_t count, double step,
+                           std::vector<unsigned char> &out) {
+  out.clear();
+  if (step > 0 && std::isfinite(step) &&
+      EncodeSteps(values, count, step, out))
+    return;
+  out.clear();
+  EncodeExact(values, count, out);
+}
+
+bool GribGridCodec::Decode(const std::vector<unsigned char> &in,
+                           double *values, size_t count) {
+  if (in.empty()) return false;
+  const unsigned char *begin = in.data() + 1, *end = in.data() + in.size();
+  switch (in[0]) {
+    case STEPS:
+      return DecodeSteps(begin, end, values, count);
+    case EXACT:
+      return DecodeExact(begin, end, values, count);
+  }
+  return false;
+}
+
+bool GribGridCodec::EncodeSteps(const double *values, size_t count,
+                                double step, std::vector<unsigned char> &out) {
+  double lo = HUGE_VAL, hi = -HUGE_VAL;
+  for (size_t k = 0; k < count; k++) {
+    double v = values[k];
+    if (v == GRIB_NOTDEF) continue;
+    if (!std::isfinite(v)) return false;
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+  }
+  if (lo > hi) lo = hi = 0;  // nothing defined
+  if ((hi - lo) / step >= MAX_STEPS) return false;
+
+  out.reserve(1 + 2 * sizeof(double) + count * 2);
+  out.push_back(STEPS);
+  PutDouble(out, lo);
+  PutDouble(out, step);
+  // 0 for GRIB_NOTDEF, 1 + steps above lo otherwise, delta coded
+  uint64_t previous = 0;
+  for (size_t k = 0; k < count; k++) {
+    double v = values[k];
+    uint64_t s = 0;
+    if (v != GRIB_NOTDEF) {
+      double x = std::floor((v - lo) / step + 0.5);
+      if (std::fabs(lo + x * step - v) > step * 0.500001) return false;
+      s = (uint64_t)x + 1;
+    }
+    int64_t delta = (int64_t)(s - previous);
+    uint64_t z = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+    while (z >= 0x80) {
+      out.push_back((unsigned char)(z | 0x80));
+      z >>= 7;
+    }
+    out.push_back((unsigned char)z);
+    previous = s;
+  }
+  return true;
+}
+
+bool GribGridCodec::DecodeSteps(const unsigned char *in,
+                                const unsigned char *end, double *values,
+                                size_t count) {
+  double lo, step;
+  if (end - in < (ptrdiff_t)(2 * sizeof(double))) return false;
+  memcpy(&lo, in, sizeof lo);
+  memcpy(&step, in + sizeof lo, sizeof step);
+  in += 2 * sizeof(double);
+
+  uint64_t s = 0;
+  for (size_t k = 0; k < count; k++) {
+    uint64_t z = 0;
+    for (int shift = 0;; shift += 7) {
+      if (in == end || shift > 63) return false;
+      unsigned char b = *in++;
+      z |= (uint64_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) break;
+    }
+    s += (z >> 1) ^ (0 - (z & 1));
+    values[k] = s ? lo + (double)(s - 1) * step : GRIB_NOTDEF;
+  }
+  return in == end;
+}
+
+void GribGridCodec::EncodeExact(const double *values, size_t count,
+                                std::vector<unsigned char> &out) {
+  out.reserve(1 + count * 4);
+  out.push_back(EXACT);
+  // Most significant plane first; each one is a sequence of runs: 0-127
+  // for 1-128 literal bytes, 128-255 for 1-128 zeros
+  for (int plane = 7; plane >= 0; plane--) {
+    size_t k = 0;
+    while (k < count) {
+      size_t n = 0;
+      while (k + n < count && n < 128 && !PlaneByte(values, k + n, plane)) n++;
+      if (n >= 2 || (n == 1 && k + 1 == count)) {
+        out.push_back((unsigned char)(127 + n));
+        k += n;
+        continue;
+      }
+      size_t start = k;
+      while (k < count && k - start < 128) {
+        if (!PlaneByte(values, k, plane) && k + 1 < count &&
+            !PlaneByte(values, k + 1, plane))
+          break;
+        k++;
+      }
+      out.push_back((unsigned char)(k - start - 1));
+      for (size_t i = start; i < k; i++)
+        out.push_back(PlaneByte(values, i, plane));
+    }
+  }
+}
+
+bool GribGridCodec::DecodeExact(const unsigned char *in,
+                                const unsigned char *end, double *values,
+                                size_t count) {
+  std::vector<uint64_t> bits(count, 0);
+  for (int plane = 7; plane >= 0; plane--) {
+    size_t k = 0;
+    while (k < count) {
+      if (in == end) return false;
+      unsigned char c = *in++;
+      if (c >= 128) {
+        k += c - 127;
+        continue;
+      }
+      size_t n = c + 1;
+      if (n > count - k || n > (size_t)(end - in)) return false;
+      for (size_t i = 0; i < n; i++)
+        bits[k++] |= (uint64_t)*in++ << (8 * plane);
+    }
+    if (k != count) return false;
+  }
+  uint64_t previous = 0;
+  for (size_t k = 0; k < count; k++) {
+    previous ^= bits[k];
+    memcpy(&values[k], &previous, sizeof previous);
+  }
+  return in == end;
+}
@@ -34,7 +34,6 @@
 
 #include <wx/glcanvas.h>
 #include <wx/graphics.h>
-#include <wx/progdlg.h>
 #include "pi_ocpndc.h"
 #include "pi_shaders.h"
 #include "grib_shaders.h"
@@ -273,6 +272,21 @@ GRIBOverlayFactory::GRIBOverlayFactory(GRIBUICtrlBar &dlg)
   }
   m_gpuAnimTargetMs = (int)wxMax(33L, wxMin(target, 500L));
 
+  // Timeline positions ahead of the displayed one whose isobars are built in
+  // the background (config key IsoLineLookAhead, 0 to disable).
+  long lookAhead = 3;
+  if (pConf) {
+    wxString oldPath = pConf->GetPath();
+    pConf->SetPath(_T("/PlugIns/GRIB"));
+    pConf->Read(_T("IsoLineLookAhead"), &lookAhead, lookAhead);
+    pConf->SetPath(oldPath);
+  }
+  m_isoLineLookAhead = (int)wxMax(0L, wxMin(lookAhead, 8L));
+  // Called from the worker thread: only post to the GUI thread from here
+  m_isoLineWorker.SetReadyCallback([this](bool urgent) {
+    if (urgent) CallAfter(&GRIBOverlayFactory::OnIsoLinesReady);
+  });
+
   // Generate the wind arrow cache
 
   if (m_pixelMM < 0.2) {
@@ -393,6 +407,9 @@ GRIBOverlayFactory::GRIBOverlayFactory(GRIBUICtrlBar &dlg)
 }
 
 GRIBOverlayFactory::~GRIBOverlayFactory() {
+  // No more ready notifications once destruction starts
+  m_isoLineWorker.Stop();
+
   ClearCachedData();
 
   ClearParticles();
@@ -521,7 +538,12 @@ bool GRIBOverlayFactory::RenderGLGribOverlay(wxGLContext *pcontext,
     m_bGPUInitialized = true;
   }
 
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
   bool rv = DoRenderGribOverlay(vp, canvasIndex);
+  m_renderMs += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
 
   // qDebug() << "RenderGLGribOverlayDone" << sw.GetTime();
 
@@ -570,7 +592,12 @@ bool GRIBOverlayFactory::RenderGribOverlay(wxDC &dc, PlugIn_ViewPort *vp,
 #endif
     m_pdc = &dc;
 #endif
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
   bool rv = DoRenderGribOverlay(vp, canvasIndex);
+  m_renderMs += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
 
   return rv;
 }
@@ -710,6 +737,10 @@ bool GRIBOverlayFactory::DoRenderGribOverlay(PlugIn_ViewPort *vp,
       }
     }
   }
+
+  // barbs, arrows and numbers queued since the last unbatched layer
+  FlushGLBatch();
+
   if (m_Altitude) {
     if (!m_Message_Hiden.IsEmpty()) m_Message_Hiden.Append(_T("\n"));
     m_Message_Hiden.Append(_("Warning : Data at Geopotential Height"))
@@ -1046,20 +1077,19 @@ bool GRIBOverlayFactory::GetActiveDataRange(int settings, double &dispMin,
 
     GribRecord *pGRA = pGR[idx], *pGRM = nullptr;
     if (idy >= 0 && !polar && pGR[idy]) {
-      pGRM = GribRecord::MagnitudeRecord(*pGR[idx], *pGR[idy]);
-      if (!pGRM || !pGRM->isOk()) {
-        delete pGRM;
-        return false;
-      }
+      pGRM = m_pGribTimelineRecordSet->GetMagnitudeRecord(idx, idy);
+      if (!pGRM || !pGRM->isOk()) return false;
       pGRA = pGRM;
     }
 
     double lo = 0.0, hi = 0.0;
     bool any = false;
     const int ni = pGRA->getNi(), nj = pGRA->getNj();
+    const double *values = pGRA->getValues();
+    if (!values) return false;
     for (int j = 0; j < nj; ++j) {
       for (int i = 0; i < ni; ++i) {
-        const double v = pGRA->getValue(i, j);
+        const double v = values[j * ni + i];
         if (v == GRIB_NOTDEF) continue;
         if (!any) {
           lo = hi = v;
@@ -1072,7 +1102,6 @@ bool GRIBOverlayFactory::GetActiveDataRange(int settings, double &dispMin,
       }
     }
 
-    delete pGRM;
     if (!any) return false;
     m_legendRawMin = lo;
     m_legendRawMax = hi;
@@ -1196,11 +1225,16 @@ bool GRIBOverlayFactory::CreateGribGLTexture(GribOverlay *pGO, int settings,
   th = height_pot;
 #endif
 
+  // Read once for the whole grid rather than per texel
+  const double *values = pGR->getValues();
+  if (!values) return false;
+  const int ni = pGR->getNi(), nj = pGR->getNj();
+
   unsigned char *data = new unsigned char[tw * th * 4];
   if (samples == 0) {
-    for (int j = 0; j < pGR->getNj(); j++) {
-      for (int i = 0; i < pGR->getNi(); i++) {
-        double v = pGR->getValue(i, j);
+    for (int j = 0; j < nj; j++) {
+      for (int i = 0; i < ni; i++) {
+        double v = values[j * ni + i];
         int y = (j + 1) * delta;
         int x = (i + !repeat) * delta;
         int doff = 4 * (y * tw + x);
@@ -1208,9 +1242,9 @@ bool GRIBOverlayFactory::CreateGribGLTexture(GribOverlay *pGO, int settings,
       }
     }
   } else if (samples == 1) {  // optimized case when there is only 1 sample
-    for (int j = 0; j < pGR->getNj(); j++) {
-      for (int i = 0; i < pGR->getNi(); i++) {
-        double v = pGR->getValue(i, j);
+    for (int j = 0; j < nj; j++) {
+      for (int i = 0; i < ni; i++) {
+        double v = values[j * ni + i];
         int y = j + 1;
         int x = i + !repeat;
         int doff = 4 * (y * tw + x);
@@ -1218,15 +1252,15 @@ bool GRIBOverlayFactory::CreateGribGLTexture(GribOverlay *pGO, int settings,
       }
     }
   } else {
-    for (int j = 0; j < pGR->getNj(); j++) {
-      for (int i = 0; i < pGR->getNi(); i++) {
-        double v00 = pGR->getValue(i, j), v01 = GRIB_NOTDEF;
+    for (int j = 0; j < nj; j++) {
+      for (int i = 0; i < ni; i++) {
+        double v00 = values[j * ni + i], v01 = GRIB_NOTDEF;
         double v10 = GRIB_NOTDEF, v11 = GRIB_NOTDEF;
-        if (i < pGR->getNi() - 1) {
-          v01 = pGR->getValue(i + 1, j);
-          if (j < pGR->getNj() - 1) v11 = pGR->getValue(i + 1, j + 1);
+        if (i < ni - 1) {
+          v01 = values[j * ni + i + 1];
+          if (j < nj - 1) v11 = values[(j + 1) * ni + i + 1];
         }
-        if (j < pGR->getNj() - 1) v10 = pGR->getValue(i, j + 1);
+        if (j < nj - 1) v10 = values[(j + 1) * ni + i];
 
         for (int ys = 0; ys < samples; ys++) {
           int y = j * samples + ys + 1;
@@ -1357,39 +1391,37 @@ wxImage GRIBOverlayFactory::CreateGribImage(int settings, GribRecord *pGR,
   wxImage gr_image(width, height);
   gr_image.InitAlpha();
 
-  wxPoint p;
-  for (int ipix = 0; ipix < (width - grib_pixel_size + 1);
-       ipix += grib_pixel_size) {
-    for (int jpix = 0; jpix < (height - grib_pixel_size + 1);
-         jpix += grib_pixel_size) {
-      double lat, lon;
-      p.x = ipix + porg.x;
-      p.y = jpix + porg.y;
-      GetCanvasLLPix(vp, p, &lat, &lon);
+  // Shared by the overlays of records with the same extent
+  GribSampleLattice &lattice = m_sampler[m_activeCanvas].ScreenLattice(
+      vp, porg.x, porg.y, porg.x + width - grib_pixel_size + 1,
+      porg.y + height - grib_pixel_size + 1, grib_pixel_size);
 
-      double v = pGR->getInterpolatedValue(lon, lat);
-      if (v != GRIB_NOTDEF) {
-        v = m_Settings.CalibrateValue(settings, v);
-        wxColour c = GetGraphicColor(settings, v);
+  for (size_t k = 0; k < lattice.Size(); k++) {
+    int ipix = lattice[k].p.x - porg.x;
+    int jpix = lattice[k].p.y - porg.y;
 
-        // set full transparency if no rain or no clouds at all
-        unsigned char a =
-            isClearSky(settings, v) ? 0 : m_Settings.m_iOverlayTransparency;
+    double v = lattice.Value(pGR, k);
+    if (v != GRIB_NOTDEF) {
+      v = m_Settings.CalibrateValue(settings, v);
+      wxColour c = GetGraphicColor(settings, v);
 
-        unsigned char r = c.Red();
-        unsigned char g = c.Green();
-        unsigned char b = c.Blue();
+      // set full transparency if no rain or no clouds at all
+      unsigned char a =
+          isClearSky(settings, v) ? 0 : m_Settings.m_iOverlayTransparency;
 
-        for (int xp = 0; xp < grib_pixel_size; xp++)
-          for (int yp = 0; yp < grib_pixel_size; yp++) {
-            gr_image.SetRGB(ipix + xp, jpix + yp, r, g, b);
-            gr_image.SetAlpha(ipix + xp, jpix + yp, a);
-          }
-      } else {
-        for (int xp = 0; xp < grib_pixel_size; xp++)
-          for (int yp = 0; yp < grib_pixel_size; yp++)
-            gr_image.SetAlpha(ipix + xp, jpix + yp, 0);
-      }
+      unsigned char r = c.Red();
+      unsigned char g = c.Green();
+      unsigned char b = c.Blue();
+
+      for (int xp = 0; xp < grib_pixel_size; xp++)
+        for (int yp = 0; yp < grib_pixel_size; yp++) {
+          gr_image.SetRGB(ipix + xp, jpix + yp, r, g, b);
+          gr_image.SetAlpha(ipix + xp, jpix + yp, a);
+        }
+    } else {
+      for (int xp = 0; xp < grib_pixel_size; xp++)
+        for (int yp = 0; yp < grib_pixel_size; yp++)
+          gr_image.SetAlpha(ipix + xp, jpix + yp, 0);
     }
   }
 
@@ -1721,23 +1753,6 @@ void GRIBOverlayFactory::RenderGribBarbedArrows(int settings, GribRecord **pGR,
   wxColour colour;
   GetGlobalColor(_T ( "YELO2" ), &colour);
 
-#ifdef ocpnUSE_GL
-  if (!m_pdc) {
-#ifndef __OCPN__ANDROID__
-    //      Enable anti-aliased lines, at best quality
-    glEnable(GL_LINE_SMOOTH);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-    glLineWidth(2);
-#else
-    glLineWidth(5);  // 5 pixels for dense displays
-#endif
-
-    glEnableClientState(GL_VERTEX_ARRAY);
-  }
-#endif
-
   if (m_Settings.Settings[settings].m_bBarbArrFixSpac) {
     // Get spacing in pixels from settings
     int space_pixels =
@@ -1745,45 +1760,20 @@ void GRIBOverlayFactory::RenderGribBarbedArrows(int settings, GribRecord **pGR,
     int arrowSize = 16;
     int total_spacing = space_pixels + arrowSize;  // Physical pixels.
 
-    // Convert pixel spacing to geographic spacing
-    // We need to create a reference point and move it by the spacing to find
-    // the geo difference
-    wxPoint center(vp->pix_width / 2, vp->pix_height / 2);
-    double center_lat, center_lon;
-    GetCanvasLLPix(vp, center, &center_lat, &center_lon);
-
-    // Find lat/lon of a point offset by total_spacing
-    wxPoint offset_point(center.x + total_spacing, center.y + total_spacing);
-    double offset_lat, offset_lon;
-    GetCanvasLLPix(vp, offset_point, &offset_lat, &offset_lon);
-
-    // Calculate spacing in geographic coordinates
-    double lat_spacing = fabs(center_lat - offset_lat);
-    double lon_spacing = fabs(center_lon - offset_lon);
-
-    // Generate grid in geographic coordinates
-    // Find grid origin that aligns with whole-number multiples of spacing
-    double start_lat = floor(vp->lat_min / lat_spacing) * lat_spacing;
-    double start_lon = floor(vp->lon_min / lon_spacing) * lon_spacing;
-
-    // Expand bounds slightly to ensure we cover the viewport edges
-    double end_lat = vp->lat_max + lat_spacing;
-    double end_lon = vp->lon_max + lon_spacing;
-
-    // Draw grid of arrows based on geographical coordinates
-    for (double lat = start_lat; lat <= end_lat; lat += lat_spacing) {
-      for (double lon = start_lon; lon <= end_lon; lon += lon_spacing) {
-        // Convert geographic point to screen coordinates
-        wxPoint p;
-        GetCanvasPixLL(vp, &p, lat, lon);
+    // Grid of arrows based on geographical coordinates, shared with the other
+    // layers using the same spacing
+    GribSampleLattice &lattice =
+        m_sampler[m_activeCanvas].GeoLattice(vp, total_spacing);
 
-        // Get data value at this location
-        double vkn, ang;
-        if (GribRecord::getInterpolatedValues(vkn, ang, pGRX, pGRY, lon, lat)) {
-          drawWindArrowWithBarbs(settings, p.x, p.y, vkn * 3.6 / 1.852,
-                                 (ang - 90) * M_PI / 180, (lat < 0.), colour,
-                                 vp->rotation);
-        }
+    for (size_t k = 0; k < lattice.Size(); k++) {
+      const GribSamplePoint &pt = lattice[k];
+
+      // Get data value at this location
+      double vkn, ang;
+      if (lattice.Values(vkn, ang, pGRX, pGRY, k)) {
+        drawWindArrowWithBarbs(settings, pt.p.x, pt.p.y, vkn * 3.6 / 1.852,
+                               (ang - 90) * M_PI / 180, (pt.lat < 0.), colour,
+                               vp->rotation);
       }
     }
   } else {
@@ -1795,6 +1785,9 @@ void GRIBOverlayFactory::RenderGribBarbedArrows(int settings, GribRecord **pGR,
     //    Get the the grid
     int imax = pGRX->getNi();  // Longitude
     int jmax = pGRX->getNj();  // Latitude
+    const double *xValues = pGRX->getValues(), *yValues = pGRY->getValues();
+    if (!xValues || !yValues) return;
+    const int yNi = pGRY->getNi();
 
     wxPoint firstpx(-1000, -1000);
     wxPoint oldpx(-1000, -1000);
@@ -1834,8 +1827,8 @@ void GRIBOverlayFactory::RenderGribBarbedArrows(int settings, GribRecord **pGR,
 
         if (lon > 180) lon -= 360;
 
-        double vx = pGRX->getValue(i, j);
-        double vy = pGRY->getValue(i, j);
+        double vx = xValues[j * imax + i];
+        double vy = yValues[j * yNi + i];
 
         if (vx != GRIB_NOTDEF && vy != GRIB_NOTDEF) {
           double vkn, ang;
@@ -1847,10 +1840,6 @@ void GRIBOverlayFactory::RenderGribBarbedArrows(int settings, GribRecord **pGR,
       }
     }
   }
-
-#ifdef ocpnUSE_GL
-  if (!m_pdc) glDisableClientState(GL_VERTEX_ARRAY);
-#endif
 }
 
 void GRIBOverlayFactory::RenderGribIsobar(int settings, GribRecord **pGR,
@@ -1864,32 +1853,23 @@ void GRIBOverlayFactory::RenderGribIsobar(int settings, GribRecord **pGR,
   SettingsIdToGribId(settings, idx, idy, polar);
   if (idx < 0) return;
 
-  GribRecord *pGRA = pGR[idx], *pGRM = nullptr;
-
-  if (!pGRA) return;
+  if (!pGR[idx]) return;
 
   wxColour back_color;
   GetGlobalColor(_T ( "DILG1" ), &back_color);
 
-  //    Initialize the array of Isobars if necessary
-  if (!pIsobarArray[idx]) {
-    // build magnitude from multiple record types like wind and current
-    if (idy >= 0 && !polar && pGR[idy]) {
-      pGRM = GribRecord::MagnitudeRecord(*pGR[idx], *pGR[idy]);
-      if (!pGRM->isOk()) {
-        m_Message_Hiden.Append(_("IsoBar Unable to compute record magnitude"));
-        delete pGRM;
-        return;
-      }
-      pGRA = pGRM;
-    }
-
-    pIsobarArray[idx] = new wxArrayPtrVoid;
-    IsoLine *piso;
-
-    wxGenericProgressDialog *progressdialog = nullptr;
-    wxDateTime start = wxDateTime::Now();
+  // build magnitude from multiple record types like wind and current
+  bool magnitude = idy >= 0 && !polar && pGR[idy];
+  if (magnitude && (pGR[idx]->getNi() != pGR[idy]->getNi() ||
+                    pGR[idx]->getNj() != pGR[idy]->getNj())) {
+    m_Message_Hiden.Append(_("IsoBar Unable to compute record magnitude"));
+    return;
+  }
 
+  //    Isobars are built in the background; until they are all there, draw
+  //    the levels that are ready and get refreshed when more arrive.
+  std::vector<IsoLine *> pending;
+  if (!pIsobarArray[idx]) {
     double min = m_Settings.GetMin(settings);
     double max = m_Settings.GetMax(settings);
 
@@ -1899,33 +1879,49 @@ void GRIBOverlayFactory::RenderGribIsobar(int settings, GribRecord **pGR,
                         ? 0.03
                         : 1.;  // divide spacing by 1/33 for PRESURRE & inHG
 
+    std::vector<double> values, rawValues;
     for (double press = min; press <= max;
          press += (m_Settings.Settings[settings].m_iIsoBarSpacing * factor)) {
-      if (progressdialog)
-        progressdialog->Update(press - min);
-      else {
-        wxDateTime now = wxDateTime::Now();
-        if ((now - start).GetSeconds() > 3 && press - min < (max - min) / 2) {
-          progressdialog = new wxGenericProgressDialog(
-              _("Building Isobar map"), _("Wind"), max - min + 1, nullptr,
-              wxPD_SMOOTH | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
-        }
-      }
-
-      piso = new IsoLine(press,
-                         m_Settings.CalibrationFactor(settings, press, true),
-                         m_Settings.CalibrationOffset(settings), pGRA);
+      values.push_back(press);
+      rawValues.push_back(
+          press / m_Settings.CalibrationFactor(settings, press, true) -
+          m_Settings.CalibrationOffset(settings));
+    }
 
-      pIsobarArray[idx]->Add(piso);
+    IsoLineKey key;
+    key.fileId = m_pGribTimelineRecordSet->m_ID;
+    key.time = m_pGribTimelineRecordSet->m_Reference_Time;
+    key.idx = idx;
+    key.rawValues = rawValues;
+
+    if (!m_isoLineWorker.IsKnown(key)) {
+      //    The file records the timeline set comes from share their grids;
+      //    its own interpolated records would have to be copied
+      IsoLineSource source;
+      if (!GetIsoLineSource(key, magnitude ? idy : -1, source)) {
+        source.x1 = GribRecord::SharedView(*pGR[idx]);
+        if (magnitude) source.y1 = GribRecord::SharedView(*pGR[idy]);
+      }
+      m_isoLineWorker.Request(key, values, source, true);
     }
-    delete progressdialog;
+    RequestIsoLinesAhead(key, values, magnitude ? idy : -1);
 
-    delete pGRM;
+    std::vector<IsoLine *> lines;
+    if (m_isoLineWorker.Fetch(key, lines) == IsoLineWorker::READY) {
+      pIsobarArray[idx] = new wxArrayPtrVoid;
+      for (IsoLine *piso : lines) pIsobarArray[idx]->Add(piso);
+    } else
+      pending = lines;
   }
 
-  //    Draw the Isobars
-  for (unsigned int i = 0; i < pIsobarArray[idx]->GetCount(); i++) {
-    IsoLine *piso = (IsoLine *)pIsobarArray[idx]->Item(i);
+  std::vector<IsoLine *> isolines = pending;
+  if (pIsobarArray[idx])
+    for (unsigned int i = 0; i < pIsobarArray[idx]->GetCount(); i++)
+      isolines.push_back((IsoLine *)pIsobarArray[idx]->Item(i));
+
+  //    Draw the Isobars, over what the layers before queued
+  if (!isolines.empty()) FlushGLBatch();
+  for (IsoLine *piso : isolines) {
     piso->drawIsoLine(this, m_pdc, vp, true);  // g_bGRIBUseHiDef
 
     // Draw Isobar labels
@@ -1942,48 +1938,51 @@ void GRIBOverlayFactory::RenderGribIsobar(int settings, GribRecord **pGR,
   }
 }
 
-void GRIBOverlayFactory::FillGrid(GribRecord *pGR) {
-  //    Get the the grid
-  int imax = pGR->getNi();  // Longitude
-  int jmax = pGR->getNj();  // Latitude
+void GRIBOverlayFactory::RequestIsoLinesAhead(const IsoLineKey &current,
+                                              const std::vector<double> &values,
+                                              int idy) {
+  std::vector<wxDateTime> times;
+  m_dlg.GetNextTimelineTimes(wxDateTime(current.time), m_isoLineLookAhead,
+                             times);
 
-  for (int i = 0; i < imax; i++) {
-    for (int j = 1; j < jmax - 1; j++) {
-      if (pGR->getValue(i, j) == GRIB_NOTDEF) {
-        double acc = 0;
-        double div = 0;
-        if (pGR->getValue(i, j - 1) != GRIB_NOTDEF) {
-          acc += pGR->getValue(i, j - 1);
-          div += 1;
-        }
-        if (pGR->getValue(i, j + 1) != GRIB_NOTDEF) {
-          acc += pGR->getValue(i, j + 1);
-          div += 1;
-        }
-        if (div > 1) pGR->setValue(i, j, acc / div);
-      }
-    }
-  }
+  for (const wxDateTime &time : times) {
+    IsoLineKey key = current;
+    key.time = time.GetTicks();
+    if (m_isoLineWorker.IsKnown(key)) continue;
 
-  for (int j = 0; j < jmax; j++) {
-    for (int i = 1; i < imax - 1; i++) {
-      if (pGR->getValue(i, j) == GRIB_NOTDEF) {
-        double acc = 0;
-        double div = 0;
-        if (pGR->getValue(i - 1, j) != GRIB_NOTDEF) {
-          acc += pGR->getValue(i - 1, j);
-          div += 1;
-        }
-        if (pGR->getValue(i + 1, j) != GRIB_NOTDEF) {
-          acc += pGR->getValue(i + 1, j);
-          div += 1;
-        }
-        if (div > 1) pGR->setValue(i, j, acc / div);
-      }
-    }
+    IsoLineSource source;
+    if (!GetIsoLineSource(key, idy, source)) break;
+    m_isoLineWorker.Request(key, values, source, false);
   }
+}
 
-  pGR->setFilled(true);
+bool GRIBOverlayFactory::GetIsoLineSource(const IsoLineKey &key, int idy,
+                                          IsoLineSource &source) {
+  GribRecordSet *GRS1, *GRS2;
+  double interp;
+  if (!m_dlg.GetBracketingRecordSets(key.idx, wxDateTime(key.time), GRS1, GRS2,
+                                     interp))
+    return false;
+
+  auto share = [](const GribRecord *rec) {
+    return rec ? GribRecord::SharedView(*rec) : nullptr;
+  };
+  source.x1 = share(GRS1->m_GribRecordPtrArray[key.idx]);
+  if (idy >= 0) source.y1 = share(GRS1->m_GribRecordPtrArray[idy]);
+  if (GRS1 != GRS2) {
+    source.x2 = share(GRS2->m_GribRecordPtrArray[key.idx]);
+    if (idy >= 0) source.y2 = share(GRS2->m_GribRecordPtrArray[idy]);
+    if (!source.y1 || !source.y2) source.y1 = source.y2 = nullptr;
+    source.interp = interp;
+  }
+  return source.x1 != nullptr;
+}
+
+void GRIBOverlayFactory::OnIsoLinesReady() {
+  for (int i = 0; i < GetCanvasCount(); i++) {
+    wxWindow *canvas = GetCanvasByIndex(i);
+    if (canvas && canvas->IsShownOnScreen()) canvas->Refresh(false);
+  }
 }
 
 void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
@@ -2000,8 +1999,8 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
   pGRX = pGR[idx];
   pGRY = pGR[idy];
   if (!pGRX || !pGRY) return;
-  if (!pGRX->isFilled()) FillGrid(pGRX);
-  if (!pGRY->isFilled()) FillGrid(pGRY);
+  if (!pGRX->isFilled()) pGRX->fillHoles();
+  if (!pGRY->isFilled()) pGRY->fillHoles();
 
   // Set arrows Size
   int arrowWidth = 2;
@@ -2020,21 +2019,11 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
   GetGlobalColor(_T ( "DILG3" ), &colour);
 
 #ifdef ocpnUSE_GL
-  if (!m_pdc) {
-    if (m_pixelMM > 0.2) {
-      //      Enable anti-aliased lines, at best quality
-      glEnable(GL_LINE_SMOOTH);
-      glEnable(GL_BLEND);
-      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-      glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-    } else {
-      if (m_Settings.Settings[settings].m_iDirectionArrowForm == 0)  // Single?
-        arrowWidth = 4;
-      else
-        arrowWidth = 3;
-    }
-
-    glEnableClientState(GL_VERTEX_ARRAY);
+  if (!m_pdc && m_pixelMM <= 0.2) {
+    if (m_Settings.Settings[settings].m_iDirectionArrowForm == 0)  // Single?
+      arrowWidth = 4;
+    else
+      arrowWidth = 3;
   }
 #endif
 
@@ -2045,66 +2034,40 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
     int arrowSize = 16;
     int total_spacing = space_pixels + arrowSize;  // Physical pixels.
 
-    // Convert pixel spacing to geographic spacing
-    // We need to create a reference point and move it by the spacing to find
-    // the geo difference
-    wxPoint center(vp->pix_width / 2, vp->pix_height / 2);
-    double center_lat, center_lon;
-    GetCanvasLLPix(vp, center, &center_lat, &center_lon);
-
-    // Find lat/lon of a point offset by total_spacing
-    wxPoint offset_point(center.x + total_spacing, center.y + total_spacing);
-    double offset_lat, offset_lon;
-    GetCanvasLLPix(vp, offset_point, &offset_lat, &offset_lon);
-
-    // Calculate spacing in geographic coordinates
-    double lat_spacing = fabs(center_lat - offset_lat);
-    double lon_spacing = fabs(center_lon - offset_lon);
-
-    // Generate grid in geographic coordinates
-    // Find grid origin that aligns with whole-number multiples of spacing
-    double start_lat = floor(vp->lat_min / lat_spacing) * lat_spacing;
-    double start_lon = floor(vp->lon_min / lon_spacing) * lon_spacing;
-
-    // Expand bounds slightly to ensure we cover the viewport edges
-    double end_lat = vp->lat_max + lat_spacing;
-    double end_lon = vp->lon_max + lon_spacing;
-
-    // Draw grid of arrows based on geographical coordinates
-    for (double lat = start_lat; lat <= end_lat; lat += lat_spacing) {
-      for (double lon = start_lon; lon <= end_lon; lon += lon_spacing) {
-        // Convert geographic point to screen coordinates
-        wxPoint p;
-        GetCanvasPixLL(vp, &p, lat, lon);
+    // Grid of arrows based on geographical coordinates, shared with the other
+    // layers using the same spacing
+    GribSampleLattice &lattice =
+        m_sampler[m_activeCanvas].GeoLattice(vp, total_spacing);
 
-        double sh, dir;
-        double scale = 1.0;
+    for (size_t k = 0; k < lattice.Size(); k++) {
+      const wxPoint &p = lattice[k].p;
 
-        if (polar) {  // wave arrows
-          sh = pGRX->getInterpolatedValue(lon, lat, true);
-          dir = pGRY->getInterpolatedValue(lon, lat, true, true);
+      double sh, dir;
+      double scale = 1.0;
 
-          if (dir == GRIB_NOTDEF || sh == GRIB_NOTDEF) continue;
-        } else {  // current arrows
-          if (!GribRecord::getInterpolatedValues(sh, dir, pGRX, pGRY, lon, lat))
-            continue;
-          scale = wxMax(1.0, sh);  // Size depends on magnitude.
-        }
-
-        dir = (dir - 90) * M_PI / 180.;
+      if (polar) {  // wave arrows
+        sh = lattice.Value(pGRX, k, true);
+        dir = lattice.Value(pGRY, k, true, true);
 
-        // draw arrows
-        if (m_Settings.Settings[settings].m_iDirectionArrowForm == 0)
-          drawSingleArrow(p.x, p.y, dir + vp->rotation, colour, arrowWidth,
-                          arrowSizeIdx, scale);
-        else if (m_Settings.Settings[settings].m_iDirectionArrowForm == 1)
-          drawDoubleArrow(p.x, p.y, dir + vp->rotation, colour, arrowWidth,
-                          arrowSizeIdx, scale);
-        else
-          drawSingleArrow(p.x, p.y, dir + vp->rotation, colour,
-                          wxMax(1, wxMin(8, (int)(sh + 0.5))), arrowSizeIdx,
-                          scale);
+        if (dir == GRIB_NOTDEF || sh == GRIB_NOTDEF) continue;
+      } else {  // current arrows
+        if (!lattice.Values(sh, dir, pGRX, pGRY, k)) continue;
+        scale = wxMax(1.0, sh);  // Size depends on magnitude.
       }
+
+      dir = (dir - 90) * M_PI / 180.;
+
+      // draw arrows
+      if (m_Settings.Settings[settings].m_iDirectionArrowForm == 0)
+        drawSingleArrow(p.x, p.y, dir + vp->rotation, colour, arrowWidth,
+                        arrowSizeIdx, scale);
+      else if (m_Settings.Settings[settings].m_iDirectionArrowForm == 1)
+        drawDoubleArrow(p.x, p.y, dir + vp->rotation, colour, arrowWidth,
+                        arrowSizeIdx, scale);
+      else
+        drawSingleArrow(p.x, p.y, dir + vp->rotation, colour,
+                        wxMax(1, wxMin(8, (int)(sh + 0.5))), arrowSizeIdx,
+                        scale);
     }
 
   } else {  // end fixed spacing -> minimum spacing
@@ -2118,6 +2081,9 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
     //    Get the the grid
     int imax = pGRX->getNi();  // Longitude
     int jmax = pGRX->getNj();  // Latitude
+    const double *xValues = pGRX->getValues(), *yValues = pGRY->getValues();
+    if (!xValues || !yValues) return;
+    const int yNi = pGRY->getNi();
 
     wxPoint firstpx(-1000, -1000);
     wxPoint oldpx(-1000, -1000);
@@ -2156,8 +2122,8 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
             double sh, dir, wdh;
             double scale = 1.0;
             if (polar) {  // wave arrows
-              dir = pGRY->getValue(i, j);
-              sh = pGRX->getValue(i, j);
+              dir = yValues[j * yNi + i];
+              sh = xValues[j * imax + i];
 
               if (dir == GRIB_NOTDEF || sh == GRIB_NOTDEF) continue;
 
@@ -2189,10 +2155,6 @@ void GRIBOverlayFactory::RenderGribDirectionArrows(int settings,
       }
     }
   }
-
-#ifdef ocpnUSE_GL
-  if (!m_pdc) glDisableClientState(GL_VERTEX_ARRAY);
-#endif
 }
 
 void GRIBOverlayFactory::RenderGribOverlayMap(int settings, GribRecord **pGR,
@@ -2209,17 +2171,16 @@ void GRIBOverlayFactory::RenderGribOverlayMap(int settings, GribRecord **pGR,
   if (!pGRA) return;
 
   if (idy >= 0 && !polar && pGR[idy]) {
-    pGRM = GribRecord::MagnitudeRecord(*pGR[idx], *pGR[idy]);
+    pGRM = m_pGribTimelineRecordSet->GetMagnitudeRecord(idx, idy);
     if (!pGRM->isOk()) {
       m_Message_Hiden.Append(
           _("OverlayMap Unable to compute record magnitude"));
-      delete pGRM;
       return;
     }
     pGRA = pGRM;
   }
 
-  if (!pGRA->isFilled()) FillGrid(pGRA);
+  if (!pGRA->isFilled()) pGRA->fillHoles();
 
   wxPoint porg;
   GetCanvasPixLL(vp, &porg, pGRA->getLatMax(), pGRA->getLonMin());
@@ -2299,7 +2260,6 @@ void GRIBOverlayFactory::RenderGribOverlayMap(int settings, GribRecord **pGR,
     }
   }
 
-  delete pGRM;
 }
 
 void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
@@ -2318,11 +2278,10 @@ void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
 
   /* build magnitude from multiple record types like wind and current */
   if (idy >= 0 && !polar && pGR[idy]) {
-    pGRM = GribRecord::MagnitudeRecord(*pGR[idx], *pGR[idy]);
+    pGRM = m_pGribTimelineRecordSet->GetMagnitudeRecord(idx, idy);
     if (!pGRM->isOk()) {
       m_Message_Hiden.Append(
           _("GribNumbers Unable to compute record magnitude"));
-      delete pGRM;
       return;
     }
     pGRA = pGRM;
@@ -2351,19 +2310,19 @@ void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
       pbr.x = m_ParentSize.GetWidth();
     }
 
-    for (int i = wxMax(ptl.x, 0); i < wxMin(pbr.x, m_ParentSize.GetWidth());
-         i += (space + wstring)) {
-      for (int j = wxMax(ptl.y, 0); j < wxMin(pbr.y, m_ParentSize.GetHeight());
-           j += (space + wstring)) {
-        double lat, lon, val;
-        GetCanvasLLPix(vp, wxPoint(i, j), &lat, &lon);
-        val = pGRA->getInterpolatedValue(lon, lat, true);
-        if (val != GRIB_NOTDEF) {
-          double value = m_Settings.CalibrateValue(settings, val);
-          wxColour back_color = GetGraphicColor(settings, value);
-
-          DrawNumbers(wxPoint(i, j), value, settings, back_color);
-        }
+    // Shared with the other number layers over the same extent
+    GribSampleLattice &lattice = m_sampler[m_activeCanvas].ScreenLattice(
+        vp, wxMax(ptl.x, 0), wxMax(ptl.y, 0),
+        wxMin(pbr.x, m_ParentSize.GetWidth()),
+        wxMin(pbr.y, m_ParentSize.GetHeight()), space + wstring);
+
+    for (size_t k = 0; k < lattice.Size(); k++) {
+      double val = lattice.Value(pGRA, k, true);
+      if (val != GRIB_NOTDEF) {
+        double value = m_Settings.CalibrateValue(settings, val);
+        wxColour back_color = GetGraphicColor(settings, value);
+
+        DrawNumbers(lattice[k].p, value, settings, back_color);
       }
     }
   } else {
@@ -2375,6 +2334,8 @@ void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
     //    Get the the grid
     int imax = pGRA->getNi();  // Longitude
     int jmax = pGRA->getNj();  // Latitude
+    const double *values = pGRA->getValues();
+    if (!values) return;
 
     wxPoint firstpx(-1000, -1000);
     wxPoint oldpx(-1000, -1000);
@@ -2409,7 +2370,7 @@ void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
             if (lon > 180) lon -= 360;
 
             if (PointInLLBox(vp, lon, lat)) {
-              double mag = pGRA->getValue(i, j);
+              double mag = values[j * imax + i];
 
               if (mag != GRIB_NOTDEF) {
                 double value = m_Settings.CalibrateValue(settings, mag);
@@ -2424,7 +2385,6 @@ void GRIBOverlayFactory::RenderGribNumbers(int settings, GribRecord **pGR,
     }
   }
 
-  delete pGRM;
 }
 
 void GRIBOverlayFactory::DrawNumbers(wxPoint p, double value, int settings,
@@ -2478,36 +2438,17 @@ void GRIBOverlayFactory::DrawNumbers(wxPoint p, double value, int settings,
     m_TexFontNumbers.RenderString(label, p.x, p.y);
     glDisable(GL_TEXTURE_2D);
 #else
-
-#ifdef __WXQT__
-    wxFont font = GetOCPNGUIScaledFont_PlugIn(_("Dialog"));
-#else
-    wxFont font(9, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL,
-                wxFONTWEIGHT_NORMAL);
-#endif
-
     wxString label = getLabelString(value, settings);
-
-    m_oDC->SetFont(font);
     int w, h;
-    m_oDC->GetTextExtent(label, &w, &h);
+    m_TexFontNumbers.GetTextExtent(label, &w, &h);
 
     int label_offsetx = 5, label_offsety = 1;
     int x = p.x - label_offsetx, y = p.y - label_offsety;
     w += 2 * label_offsetx, h += 2 * label_offsety;
 
-    m_oDC->SetBrush(wxBrush(back_color));
-    m_oDC->DrawRoundedRectangle(x, y, w, h, 0);
-
-    /* draw bounding rectangle */
-    m_oDC->SetPen(wxPen(wxColour(0, 0, 0), 1));
-    m_oDC->DrawLine(x, y, x + w, y);
-    m_oDC->DrawLine(x + w, y, x + w, y + h);
-    m_oDC->DrawLine(x + w, y + h, x, y + h);
-    m_oDC->DrawLine(x, y + h, x, y);
-
-    m_oDC->DrawText(label, p.x, p.y);
-
+    /* box, bounding rectangle and text, drawn by FlushGLBatch() */
+    m_glBatch.AddLabel(x, y, w, h, back_color, label, m_TexFontNumbers, p.x,
+                       p.y);
 #endif
 #endif
   }
@@ -2531,6 +2472,8 @@ void GRIBOverlayFactory::RenderGribParticles(int settings, GribRecord **pGR,
 
   if (!pGRX || !pGRY) return;
 
+  FlushGLBatch();
+
   // GPU particle path — one renderer instance per canvas (lazily created), so
   // each canvas keeps its own viewport-sized FBOs and pan-tracking caches.
   if (m_bUseGPURenderer) {
@@ -3120,6 +3063,14 @@ void GRIBOverlayFactory::drawWindArrowWithBarbs(int settings, int x, int y,
                  m_bDrawBarbedArrowHead);
 }
 
+void GRIBOverlayFactory::FlushGLBatch() {
+#ifdef ocpnUSE_GL
+  // Before anything drawn outside the batch, in the painter's order of the
+  // layers; batched passes in between share one draw
+  if (!m_pdc) m_glBatch.Flush();
+#endif
+}
+
 void GRIBOverlayFactory::drawLineBuffer(LineBuffer &buffer, int x, int y,
                                         double ang, double scale, bool south,
                                         bool head) {
@@ -3158,17 +3109,13 @@ void GRIBOverlayFactory::drawLineBuffer(LineBuffer &buffer, int x, int y,
   } else {  // OpenGL mode
 #ifdef ocpnUSE_GL
     if (m_oDC) {
-      for (int i = 0; i < count; i++) {
-        float *l = vertexes + 4 * i;
-        if (m_hiDefGraphics)
-          m_oDC->StrokeLine(l[0], l[1], l[2], l[3]);
-        else
-          m_oDC->DrawLine(l[0], l[1], l[2], l[3]);
-      }
+      // queued, drawn by FlushGLBatch() before the next unbatched layer
+      const wxPen &pen = m_oDC->GetPen();
+      if (m_hiDefGraphics)
+        m_glBatch.AddStrokes(vertexes, count, pen.GetColour(), pen.GetWidth());
+      else
+        m_glBatch.AddLines(vertexes, count, pen.GetColour(), pen.GetWidth());
     }
-
-//        glVertexPointer(2, GL_FLOAT, 2*sizeof(float), vertexes);
-//        glDrawArrays(GL_LINES, 0, 2*count);
 #endif
   }
 }
@@ -3200,16 +3147,15 @@ void GRIBOverlayFactory::DrawSingleGLTexture(GribOverlay *pGO, GribRecord *pGR,
   coords[6] = -width;
   coords[7] = 0;
 
-  extern int pi_texture_2D_shader_program;
-  glUseProgram(pi_texture_2D_shader_program);
+  // Locations are looked up once per program, not per draw
+  const GribGLProgramLocations &loc = GribTexture2DProgramLocations();
+  glUseProgram(loc.program);
 
-  // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(pi_texture_2D_shader_program, "aPos");
-  GLint mUvAttrib = glGetAttribLocation(pi_texture_2D_shader_program, "aUV");
+  GLint mPosAttrib = loc.position;
+  GLint mUvAttrib = loc.uv;
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(pi_texture_2D_shader_program, "uTex");
-  glUniform1i(texUni, 0);
+  glUniform1i(loc.tex, 0);
 
   // Disable VBO's (vertex buffer objects) for attributes.
   glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -3235,8 +3181,7 @@ void GRIBOverlayFactory::DrawSingleGLTexture(GribOverlay *pGO, GribRecord *pGR,
   Q[3][0] = x;
   Q[3][1] = y;
 
-  GLint matloc =
-      glGetUniformLocation(pi_texture_2D_shader_program, "TransformMatrix");
+  GLint matloc = loc.transform;
   glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
 
   // Select the active texture unit.
@@ -19,13 +19,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * \file
  * \implements \ref GribReader.h
  */
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include "wx/wx.h"
-#endif  // precompiled headers
-
 #include "GribReader.h"
+#include "GribDecodeStats.h"
+#include "GribResidency.h"
 #include "GribV1Record.h"
 #include "GribV2Record.h"
 #include <cassert>
@@ -36,10 +32,10 @@ GribReader::GribReader() {
   dewpointDataStatus = NO_DATA_IN_FILE;
 }
 //-------------------------------------------------------------------------------
-GribReader::GribReader(const wxString fname) {
+GribReader::GribReader(const std::string &fname) {
   ok = false;
   dewpointDataStatus = NO_DATA_IN_FILE;
-  if (fname != _T("")) {
+  if (!fname.empty()) {
     openFile(fname);
   } else {
     clean_all_vectors();
@@ -90,6 +86,11 @@ void GribReader::storeRecordInMap(GribRecord *rec) {
     assert(mapGribRecords[rec->getKey()]);
   }
   mapGribRecords[rec->getKey()]->push_back(rec);
+
+  // Large files are held to the memory budget while they load
+  GribResidency &residency = GribResidency::Get();
+  residency.Manage(rec);
+  residency.Trim();
 }
 
 //---------------------------------------------------------------------------------
@@ -385,6 +386,8 @@ void GribReader::computeAccumulationRecords(int dataType, int levelType,
       prev = rec;
       p1 = prev->getPeriodP1();
       p2 = prev->getPeriodP2();
+      // Only prev is needed again, the others go over the budget
+      GribResidency::Get().Trim();
     }
   }
   if (prev != 0 && p2 > p1 && prev->getTimeRange() == 4) {
@@ -424,6 +427,7 @@ void GribReader::readGribFileContent() {
   fileSize = zu_filesize(file);
   readAllGribRecords();
   createListDates();
+  GribDecodeStats::Timer timer;
   //    hoursBetweenRecords = computeHoursBeetweenGribRecords();
   // XXX should it be done after reading all files, rather than per file?
   if (getNumberOfGribRecords(GRB_WIND_GUST, LV_GND_SURF, 0) == 0) {
@@ -443,12 +447,17 @@ void GribReader::readGribFileContent() {
   // If no, compute it with Magnus-Tetens formula, if possible.
   //-----------------------------------------------------
   dewpointDataStatus = DATA_IN_FILE;
-  if (getNumberOfGribRecords(GRB_DEWPOINT, LV_ABOV_GND, 2) != 0) return;
+  if (getNumberOfGribRecords(GRB_DEWPOINT, LV_ABOV_GND, 2) != 0) {
+    timer.Lap(GribDecodeStats::FIXUP);
+    return;
+  }
 
   dewpointDataStatus = NO_DATA_IN_FILE;
   if (getNumberOfGribRecords(GRB_HUMID_REL, LV_ABOV_GND, 2) == 0 ||
-      getNumberOfGribRecords(GRB_TEMP, LV_ABOV_GND, 2) == 0)
+      getNumberOfGribRecords(GRB_TEMP, LV_ABOV_GND, 2) == 0) {
+    timer.Lap(GribDecodeStats::FIXUP);
     return;
+  }
 
   dewpointDataStatus = COMPUTED_DATA;
   for (auto iter : setAllDates) {
@@ -469,6 +478,7 @@ void GribReader::readGribFileContent() {
     }
     storeRecordInMap(recDewpoint);
   }
+  timer.Lap(GribDecodeStats::FIXUP);
 }
 
 //---------------------------------------------------
@@ -682,17 +692,17 @@ double GribReader::computeDewPoint(double lon, double lat, time_t now) {
 //-------------------------------------------------------------------------------
 // Lecture complète d'un fichier GRIB
 //-------------------------------------------------------------------------------
-void GribReader::openFile(const wxString fname) {
-  grib_debug("Open file: %s", (const char *)fname.mb_str());
+void GribReader::openFile(const std::string &fname) {
+  grib_debug("Open file: %s", fname.c_str());
   fileName = fname;
   ok = false;
   // clean_all_vectors();
   //--------------------------------------------------------
   // Open the file
   //--------------------------------------------------------
-  file = zu_open((const char *)fname.mb_str(), "rb", ZU_COMPRESS_AUTO);
+  file = zu_open(fname.c_str(), "rb", ZU_COMPRESS_AUTO);
   if (file == nullptr) {
-    erreur("Can't open file: %s", (const char *)fname.mb_str());
+    erreur("Can't open file: %s", fname.c_str());
     return;
   }
   readGribFileContent();
@@ -700,17 +710,17 @@ void GribReader::openFile(const wxString fname) {
   // Look for compressed files with alternate extensions
   if (!ok) {
     if (file != nullptr) zu_close(file);
-    file = zu_open((const char *)fname.mb_str(), "rb", ZU_COMPRESS_BZIP);
+    file = zu_open(fname.c_str(), "rb", ZU_COMPRESS_BZIP);
     if (file != nullptr) readGribFileContent();
   }
   if (!ok) {
     if (file != nullptr) zu_close(file);
-    file = zu_open((const char *)fname.mb_str(), "rb", ZU_COMPRESS_GZIP);
+    file = zu_open(fname.c_str(), "rb", ZU_COMPRESS_GZIP);
     if (file != nullptr) readGribFileContent();
   }
   if (!ok) {
     if (file != nullptr) zu_close(file);
-    file = zu_open((const char *)fname.mb_str(), "rb", ZU_COMPRESS_NONE);
+    file = zu_open(fname.c_str(), "rb", ZU_COMPRESS_NONE);
     if (file != nullptr) readGribFileContent();
   }
   if (file != nullptr) {
@@ -19,13 +19,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * \file
  * \implements \ref GribRecord.h
  */
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include "wx/wx.h"
-#endif  // precompiled headers
-
 #include <stdlib.h>
+#include <algorithm>
 
 // #include <QDateTime>
 
@@ -59,10 +54,10 @@ GribRecord::GribRecord(const GribRecord &rec) {
   *this = rec;
   IsDuplicated = true;
   // recopie les champs de bits
-  if (rec.data != nullptr) {
+  if (const double *values = rec.values()) {
     int size = rec.Ni * rec.Nj;
     this->data = new double[size];
-    for (int i = 0; i < size; i++) this->data[i] = rec.data[i];
+    std::copy(values, values + size, this->data.get());
   }
   if (rec.BMSbits != nullptr) {
     int size = rec.BMSsize;
@@ -81,17 +76,17 @@ bool GribRecord::GetInterpolatedParameters(
   /* make sure Dj both have same sign */
   if (rec1.getDj() * rec2.getDj() <= 0) return false;
 
-  Di = wxMax(rec1.getDi(), rec2.getDi());
-  Dj = rec1.getDj() > 0 ? wxMax(rec1.getDj(), rec2.getDj())
-                        : wxMin(rec1.getDj(), rec2.getDj());
+  Di = std::max(rec1.getDi(), rec2.getDi());
+  Dj = rec1.getDj() > 0 ? std::max(rec1.getDj(), rec2.getDj())
+                        : std::min(rec1.getDj(), rec2.getDj());
 
   /* get overlapping region */
   if (Dj > 0)
-    La1 = wxMax(rec1.La1, rec2.La1), La2 = wxMin(rec1.La2, rec2.La2);
+    La1 = std::max(rec1.La1, rec2.La1), La2 = std::min(rec1.La2, rec2.La2);
   else
-    La1 = wxMin(rec1.La1, rec2.La1), La2 = wxMax(rec1.La2, rec2.La2);
+    La1 = std::min(rec1.La1, rec2.La1), La2 = std::max(rec1.La2, rec2.La2);
 
-  Lo1 = wxMax(rec1.Lo1, rec2.Lo1), Lo2 = wxMin(rec1.Lo2, rec2.Lo2);
+  Lo1 = std::max(rec1.Lo1, rec2.Lo1), Lo2 = std::min(rec1.Lo2, rec2.Lo2);
 
   // align gribs on integer boundaries
   int i, j;
@@ -113,7 +108,7 @@ bool GribRecord::GetInterpolatedParameters(
     rec2offdi = (Lo1 - rec2.Lo1) / rec2.Di;
     if (rec1offdi == floor(rec1offdi) && rec2offdi == floor(rec2offdi)) break;
 
-    Lo1 += wxMin(rec1.Di, rec2.Di);
+    Lo1 += std::min(rec1.Di, rec2.Di);
   }
   if (i == iiters)  // failed to align, would need spacial interpolation to work
     return false;
@@ -130,8 +125,8 @@ bool GribRecord::GetInterpolatedParameters(
     rec2offdj = (La1 - rec2.La1) / rec2.Dj;
     if (rec1offdj == floor(rec1offdj) && rec2offdj == floor(rec2offdj)) break;
 
-    La1 += Dj < 0 ? wxMax(rec1.getDj(), rec2.getDj())
-                  : wxMin(rec1.getDj(), rec2.getDj());
+    La1 += Dj < 0 ? std::max(rec1.getDj(), rec2.getDj())
+                  : std::min(rec1.getDj(), rec2.getDj());
   }
   if (j == jiters)  // failed to align
     return false;
@@ -148,7 +143,7 @@ bool GribRecord::GetInterpolatedParameters(
   rec1offi = rec1offdi, rec2offi = rec2offdi;
   rec1offj = rec1offdj, rec2offj = rec2offdj;
 
-  if (!rec1.data || !rec2.data) return false;
+  if (!rec1.values() || !rec2.values()) return false;
 
   return true;
 }
@@ -170,6 +165,7 @@ GribRecord *GribRecord::InterpolatedRecord(const GribRecord &rec1,
   // recopie les champs de bits
   int size = Ni * Nj;
   double *data = new double[size];
+  const double *values1 = rec1.values(), *values2 = rec2.values();
 
   zuchar *BMSbits = nullptr;
   if (rec1.BMSbits != nullptr && rec2.BMSbits != nullptr)
@@ -180,7 +176,7 @@ GribRecord *GribRecord::InterpolatedRecord(const GribRecord &rec1,
       int in = j * Ni + i;
       int i1 = (j * jm1 + rec1offj) * rec1.Ni + i * im1 + rec1offi;
       int i2 = (j * jm2 + rec2offj) * rec2.Ni + i * im2 + rec2offi;
-      double data1 = rec1.data[i1], data2 = rec2.data[i2];
+      double data1 = values1[i1], data2 = values2[i2];
       if (data1 == GRIB_NOTDEF || data2 == GRIB_NOTDEF)
         data[in] = GRIB_NOTDEF;
       else {
@@ -214,7 +210,7 @@ GribRecord *GribRecord::InterpolatedRecord(const GribRecord &rec1,
   ret->data = data;
   ret->BMSbits = BMSbits;
 
-  ret->latMin = wxMin(La1, La2), ret->latMax = wxMax(La1, La2);
+  ret->latMin = std::min(La1, La2), ret->latMax = std::max(La1, La2);
   ret->lonMin = Lo1, ret->lonMax = Lo2;
 
   ret->m_bfilled = false;
@@ -238,7 +234,9 @@ GribRecord *GribRecord::Interpolated2DRecord(
                                  rec2offi, rec2offj))
     return nullptr;
 
-  if (!rec1y.data || !rec2y.data || !rec1y.isOk() || !rec2y.isOk() ||
+  const double *values1x = rec1x.values(), *values1y = rec1y.values();
+  const double *values2x = rec2x.values(), *values2y = rec2y.values();
+  if (!values1y || !values2y || !rec1y.isOk() || !rec2y.isOk() ||
       rec1x.Di != rec1y.Di || rec1x.Dj != rec1y.Dj || rec2x.Di != rec2y.Di ||
       rec2x.Dj != rec2y.Dj || rec1x.Ni != rec1y.Ni || rec1x.Nj != rec1y.Nj ||
       rec2x.Ni != rec2y.Ni || rec2x.Nj != rec2y.Nj) {
@@ -256,8 +254,8 @@ GribRecord *GribRecord::Interpolated2DRecord(
       int in = j * Ni + i;
       int i1 = (j * jm1 + rec1offj) * rec1x.Ni + i * im1 + rec1offi;
       int i2 = (j * jm2 + rec2offj) * rec2x.Ni + i * im2 + rec2offi;
-      double data1x = rec1x.data[i1], data1y = rec1y.data[i1];
-      double data2x = rec2x.data[i2], data2y = rec2y.data[i2];
+      double data1x = values1x[i1], data1y = values1y[i1];
+      double data2x = values2x[i2], data2y = values2y[i2];
       if (data1x == GRIB_NOTDEF || data1y == GRIB_NOTDEF ||
           data2x == GRIB_NOTDEF || data2y == GRIB_NOTDEF) {
         datax[in] = GRIB_NOTDEF;
@@ -297,7 +295,7 @@ GribRecord *GribRecord::Interpolated2DRecord(
   ret->BMSbits = nullptr;
   ret->hasBMS = false;  // I don't think wind or current ever use BMS correct?
 
-  ret->latMin = wxMin(La1, La2), ret->latMax = wxMax(La1, La2);
+  ret->latMin = std::min(La1, La2), ret->latMax = std::max(La1, La2);
   ret->lonMin = Lo1, ret->lonMax = Lo2;
 
   rety = new GribRecord;
@@ -315,13 +313,15 @@ GribRecord *GribRecord::MagnitudeRecord(const GribRecord &rec1,
   GribRecord *rec = new GribRecord(rec1);
 
   /* generate a record which is the combined magnitude of two records */
-  if (rec1.data && rec2.data && rec1.Ni == rec2.Ni && rec1.Nj == rec2.Nj) {
+  const double *values1 = rec1.values(), *values2 = rec2.values();
+  if (values1 && values2 && rec1.Ni == rec2.Ni && rec1.Nj == rec2.Nj) {
     int size = rec1.Ni * rec1.Nj;
+    double *data = rec->data;
     for (int i = 0; i < size; i++)
-      if (rec1.data[i] == GRIB_NOTDEF || rec2.data[i] == GRIB_NOTDEF)
-        rec->data[i] = GRIB_NOTDEF;
+      if (values1[i] == GRIB_NOTDEF || values2[i] == GRIB_NOTDEF)
+        data[i] = GRIB_NOTDEF;
       else
-        rec->data[i] = sqrt(pow(rec1.data[i], 2) + pow(rec2.data[i], 2));
+        data[i] = sqrt(pow(values1[i], 2) + pow(values2[i], 2));
   } else
     rec->ok = false;
 
@@ -337,16 +337,34 @@ GribRecord *GribRecord::MagnitudeRecord(const GribRecord &rec1,
   return rec;
 }
 
+std::shared_ptr<const GribRecord> GribRecord::SharedView(
+    const GribRecord &rec) {
+  std::shared_ptr<const double> values = rec.shareValues();
+  if (!values) return std::make_shared<GribRecord>(rec);
+
+  GribRecord *view = new GribRecord;
+  *view = rec;
+  view->IsDuplicated = true;
+  view->data = const_cast<double *>(values.get());
+  view->BMSbits = nullptr;
+  view->hasBMS = false;
+  return std::shared_ptr<const GribRecord>(view, [values](GribRecord *r) {
+    r->data = nullptr;  // owned by values
+    delete r;
+  });
+}
+
 void GribRecord::Polar2UV(GribRecord *pDIR, GribRecord *pSPEED) {
-  if (pDIR->data && pSPEED->data && pDIR->Ni == pSPEED->Ni &&
+  if (pDIR->values() && pSPEED->values() && pDIR->Ni == pSPEED->Ni &&
       pDIR->Nj == pSPEED->Nj) {
+    double *dirs = pDIR->mutableValues(), *speeds = pSPEED->mutableValues();
     int size = pDIR->Ni * pDIR->Nj;
     for (int i = 0; i < size; i++) {
-      if (pDIR->data[i] != GRIB_NOTDEF && pSPEED->data[i] != GRIB_NOTDEF) {
-        double dir = pDIR->data[i];
-        double speed = pSPEED->data[i];
-        pDIR->data[i] = -speed * sin(dir * M_PI / 180.);
-        pSPEED->data[i] = -speed * cos(dir * M_PI / 180.);
+      if (dirs[i] != GRIB_NOTDEF && speeds[i] != GRIB_NOTDEF) {
+        double dir = dirs[i];
+        double speed = speeds[i];
+        dirs[i] = -speed * sin(dir * M_PI / 180.);
+        speeds[i] = -speed * cos(dir * M_PI / 180.);
       }
     }
     if (pDIR->dataType == GRB_WIND_DIR) {
@@ -361,24 +379,26 @@ void GribRecord::Polar2UV(GribRecord *pDIR, GribRecord *pSPEED) {
 
 void GribRecord::Substract(const GribRecord &rec, bool pos) {
   // for now only substract records of same size
-  if (rec.data == 0 || !rec.isOk()) return;
+  const double *other = rec.values();
+  if (other == 0 || !rec.isOk()) return;
 
-  if (data == 0 || !isOk()) return;
+  if (values() == 0 || !isOk()) return;
 
   if (Ni != rec.Ni || Nj != rec.Nj) return;
 
+  double *data = mutableValues();
   zuint size = Ni * Nj;
   for (zuint i = 0; i < size; i++) {
-    if (rec.data[i] == GRIB_NOTDEF) continue;
+    if (other[i] == GRIB_NOTDEF) continue;
     if (data[i] == GRIB_NOTDEF) {
-      data[i] = -rec.data[i];
+      data[i] = -other[i];
       if (BMSbits != 0) {
         if (BMSsize > i) {
           BMSbits[i >> 3] |= 1 << (i & 7);
         }
       }
     } else
-      data[i] -= rec.data[i];
+      data[i] -= other[i];
     if (data[i] < 0. && pos) {
       // data type should be positive...
       data[i] = 0.;
@@ -397,9 +417,10 @@ void GribRecord::Average(const GribRecord &rec) {
   // rec  : 0-11
   // compute average 11-12
 
-  if (rec.data == 0 || !rec.isOk()) return;
+  const double *other = rec.values();
+  if (other == 0 || !rec.isOk()) return;
 
-  if (data == 0 || !isOk()) return;
+  if (values() == 0 || !isOk()) return;
 
   if (Ni != rec.Ni || Nj != rec.Nj) return;
 
@@ -410,13 +431,14 @@ void GribRecord::Average(const GribRecord &rec) {
 
   if (d2 <= d1) return;
 
+  double *data = mutableValues();
   zuint size = Ni * Nj;
   double diff = d2 - d1;
   for (zuint i = 0; i < size; i++) {
-    if (rec.data[i] == GRIB_NOTDEF) continue;
+    if (other[i] == GRIB_NOTDEF) continue;
     if (data[i] == GRIB_NOTDEF) continue;
 
-    data[i] = (data[i] * d2 - rec.data[i] * d1) / diff;
+    data[i] = (data[i] * d2 - other[i] * d1) / diff;
   }
 }
 
@@ -433,12 +455,13 @@ std::string GribRecord::makeKey(
   //  wxSnprintf((wxChar *)ktmp, 32, "%d-%d-%d", dataType, levelType,
   //  levelValue); return std::string(ktmp);
 
-  wxString k;
-  k.Printf(_T("%d-%d-%d"), dataType, levelType, levelValue);
-  return std::string(k.mb_str());
+  char k[40];
+  snprintf(k, sizeof k, "%d-%d-%d", dataType, levelType, levelValue);
+  return std::string(k);
 }
 //-----------------------------------------
 GribRecord::~GribRecord() {
+  if (m_residency.owner) m_residency.owner->Release(this);
   if (data) {
     delete[] data;
     data = nullptr;
@@ -454,8 +477,10 @@ GribRecord::~GribRecord() {
 
 //-------------------------------------------------------------------------------
 void GribRecord::multiplyAllData(double k) {
-  if (data == 0 || !isOk()) return;
+  if (values() == 0 || !isOk()) return;
 
+  double step = packingStep;
+  double *data = mutableValues();
   for (zuint j = 0; j < Nj; j++) {
     for (zuint i = 0; i < Ni; i++) {
       if (isDefined(i, j)) {
@@ -463,6 +488,51 @@ void GribRecord::multiplyAllData(double k) {
       }
     }
   }
+  packingStep = step * fabs(k);  // still on a grid, a scaled one
+}
+
+//-------------------------------------------------------------------------------
+void GribRecord::fillHoles() {
+  m_bfilled = true;
+  const double *v = values();
+  if (!v) return;
+  // Most grids have none: keep them untouched, and on their packing grid
+  if (std::find(v, v + Ni * Nj, GRIB_NOTDEF) == v + Ni * Nj) return;
+
+  double *data = mutableValues();
+  for (zuint i = 0; i < Ni; i++) {
+    for (zuint j = 1; j + 1 < Nj; j++) {
+      if (data[j * Ni + i] != GRIB_NOTDEF) continue;
+      double acc = 0;
+      double div = 0;
+      if (data[(j - 1) * Ni + i] != GRIB_NOTDEF) {
+        acc += data[(j - 1) * Ni + i];
+        div += 1;
+      }
+      if (data[(j + 1) * Ni + i] != GRIB_NOTDEF) {
+        acc += data[(j + 1) * Ni + i];
+        div += 1;
+      }
+      if (div > 1) data[j * Ni + i] = acc / div;
+    }
+  }
+
+  for (zuint j = 0; j < Nj; j++) {
+    for (zuint i = 1; i + 1 < Ni; i++) {
+      if (data[j * Ni + i] != GRIB_NOTDEF) continue;
+      double acc = 0;
+      double div = 0;
+      if (data[j * Ni + i - 1] != GRIB_NOTDEF) {
+        acc += data[j * Ni + i - 1];
+        div += 1;
+      }
+      if (data[j * Ni + i + 1] != GRIB_NOTDEF) {
+        acc += data[j * Ni + i + 1];
+        div += 1;
+      }
+      if (div > 1) data[j * Ni + i] = acc / div;
+    }
+  }
 }
 
 //----------------------------------------------
@@ -516,20 +586,7 @@ time_t GribRecord::makeDate(zuint year, zuint month, zuint day, zuint hour,
 
 //===============================================================================================
 
-double GribRecord::getInterpolatedValue(double px, double py,
-                                        bool numericalInterpolation,
-                                        bool dir) const {
-  if (!ok || Di == 0 || Dj == 0) return GRIB_NOTDEF;
-
-  if (!isPointInMap(px, py)) {
-    px += 360.0;  // tour du monde à droite ?
-    if (!isPointInMap(px, py)) {
-      px -= 2 * 360.0;  // tour du monde à gauche ?
-      if (!isPointInMap(px, py)) {
-        return GRIB_NOTDEF;
-      }
-    }
-  }
+void GribRecord::getCell(double px, double py, GribSampleCell &cell) const {
   double pi, pj;  // coord. in grid unit
   pi = (px - Lo1) / Di;
   pj = (py - La1) / Dj;
@@ -545,9 +602,55 @@ double GribRecord::getInterpolatedValue(double px, double py,
 
   if (j1 >= Nj) j1 = j0;
 
+  cell.inMap = true;
+  cell.i0 = i0, cell.j0 = j0;
+  cell.i1 = i1, cell.j1 = j1;
+
   // distances to 00
-  double dx = pi - i0;
-  double dy = pj - j0;
+  cell.dx = pi - i0;
+  cell.dy = pj - j0;
+}
+
+bool GribRecord::getSampleCell(double px, double py,
+                               GribSampleCell &cell) const {
+  cell.inMap = false;
+  if (!ok || Di == 0 || Dj == 0) return false;
+
+  if (!isPointInMap(px, py)) {
+    px += 360.0;  // tour du monde à droite ?
+    if (!isPointInMap(px, py)) {
+      px -= 2 * 360.0;  // tour du monde à gauche ?
+      if (!isPointInMap(px, py)) {
+        return false;
+      }
+    }
+  }
+  getCell(px, py, cell);
+  return true;
+}
+
+double GribRecord::getInterpolatedValue(double px, double py,
+                                        bool numericalInterpolation,
+                                        bool dir) const {
+  GribSampleCell cell;
+  if (!getSampleCell(px, py, cell)) return GRIB_NOTDEF;
+
+  return getInterpolatedValue(cell, numericalInterpolation, dir);
+}
+
+double GribRecord::getInterpolatedValue(const GribSampleCell &cell,
+                                        bool numericalInterpolation,
+                                        bool dir) const {
+  if (!ok || Di == 0 || Dj == 0 || !cell.inMap) return GRIB_NOTDEF;
+
+  int i0 = cell.i0, j0 = cell.j0;
+  int i1 = cell.i1, j1 = cell.j1;
+  double dx = cell.dx, dy = cell.dy;
+
+  // Once per sample rather than per corner
+  const double *grid = values();
+  if (!grid) return GRIB_NOTDEF;
+  auto getValue = [grid, this](int i, int j) { return grid[j * Ni + i]; };
 
   if (!numericalInterpolation) {
     if (dx >= 0.5) i0 = i1;
@@ -664,31 +767,40 @@ bool GribRecord::getInterpolatedValues(double &M, double &A,
       }
     }
   }
-  double pi, pj;  // coord. in grid unit
-  pi = (px - GRX->Lo1) / GRX->Di;
-  pj = (py - GRX->La1) / GRX->Dj;
+  GribSampleCell cell;
+  GRX->getCell(px, py, cell);
 
-  // 00 10      point is in a square
-  // 01 11
-  int i0 = (int)pi;  // point 00
-  int j0 = (int)pj;
+  return getInterpolatedValues(M, A, GRX, GRY, cell, numericalInterpolation);
+}
 
-  unsigned int i1 = pi + 1, j1 = pj + 1;
-  if (i1 >= GRX->Ni) i1 = i0;
+bool GribRecord::getInterpolatedValues(double &M, double &A,
+                                       const GribRecord *GRX,
+                                       const GribRecord *GRY,
+                                       const GribSampleCell &cell,
+                                       bool numericalInterpolation) {
+  if (!GRX || !GRY) return false;
 
-  if (j1 >= GRX->Nj) j1 = j0;
+  if (!GRX->ok || !GRY->ok || GRX->Di == 0 || GRX->Dj == 0) return false;
 
-  // distances to 00
-  double dx = pi - i0;
-  double dy = pj - j0;
+  if (!cell.inMap) return false;
+
+  int i0 = cell.i0, j0 = cell.j0;
+  int i1 = cell.i1, j1 = cell.j1;
+  double dx = cell.dx, dy = cell.dy;
+
+  const double *xValues = GRX->values(), *yValues = GRY->values();
+  if (!xValues || !yValues) return false;
+  int xNi = GRX->Ni, yNi = GRY->Ni;
+  auto getX = [xValues, xNi](int i, int j) { return xValues[j * xNi + i]; };
+  auto getY = [yValues, yNi](int i, int j) { return yValues[j * yNi + i]; };
 
   if (!numericalInterpolation) {
     double vx, vy;
     if (dx >= 0.5) i0 = i1;
     if (dy >= 0.5) j0 = j1;
 
-    vx = GRX->getValue(i0, j0);
-    vy = GRY->getValue(i0, j0);
+    vx = getX(i0, j0);
+    vy = getY(i0, j0);
     if (vx == GRIB_NOTDEF || vy == GRIB_NOTDEF) return false;
 
     M = sqrt(vx * vx + vy * vy);
@@ -708,18 +820,18 @@ bool GribRecord::getInterpolatedValues(double &M, double &A,
   //         nbval ++;
 
   int nbval = 0;  // how many values in grid ?
-  if (GRY->getValue(i0, j0) != GRIB_NOTDEF) nbval++;
-  if (GRY->getValue(i1, j0) != GRIB_NOTDEF) nbval++;
-  if (GRY->getValue(i0, j1) != GRIB_NOTDEF) nbval++;
-  if (GRY->getValue(i1, j1) != GRIB_NOTDEF) nbval++;
+  if (getY(i0, j0) != GRIB_NOTDEF) nbval++;
+  if (getY(i1, j0) != GRIB_NOTDEF) nbval++;
+  if (getY(i0, j1) != GRIB_NOTDEF) nbval++;
+  if (getY(i1, j1) != GRIB_NOTDEF) nbval++;
 
   if (nbval <= 3) return false;
 
   nbval = 0;  // how many values in grid ?
-  if (GRX->getValue(i0, j0) != GRIB_NOTDEF) nbval++;
-  if (GRX->getValue(i1, j0) != GRIB_NOTDEF) nbval++;
-  if (GRX->getValue(i0, j1) != GRIB_NOTDEF) nbval++;
-  if (GRX->getValue(i1, j1) != GRIB_NOTDEF) nbval++;
+  if (getX(i0, j0) != GRIB_NOTDEF) nbval++;
+  if (getX(i1, j0) != GRIB_NOTDEF) nbval++;
+  if (getX(i0, j1) != GRIB_NOTDEF) nbval++;
+  if (getX(i1, j1) != GRIB_NOTDEF) nbval++;
 
   if (nbval <= 3) return false;
 
@@ -732,16 +844,16 @@ bool GribRecord::getInterpolatedValues(double &M, double &A,
   // kx = distance(xa,x)
   // ky = distance(xa,y)
   if (nbval == 4) {
-    double x00x = GRX->getValue(i0, j0), x00y = GRY->getValue(i0, j0);
+    double x00x = getX(i0, j0), x00y = getY(i0, j0);
     double x00m = sqrt(x00x * x00x + x00y * x00y), x00a = atan2(x00x, x00y);
 
-    double x01x = GRX->getValue(i0, j1), x01y = GRY->getValue(i0, j1);
+    double x01x = getX(i0, j1), x01y = getY(i0, j1);
     double x01m = sqrt(x01x * x01x + x01y * x01y), x01a = atan2(x01x, x01y);
 
-    double x10x = GRX->getValue(i1, j0), x10y = GRY->getValue(i1, j0);
+    double x10x = getX(i1, j0), x10y = getY(i1, j0);
     double x10m = sqrt(x10x * x10x + x10y * x10y), x10a = atan2(x10x, x10y);
 
-    double x11x = GRX->getValue(i1, j1), x11y = GRY->getValue(i1, j1);
+    double x11x = getX(i1, j1), x11y = getY(i1, j1);
     double x11m = sqrt(x11x * x11x + x11y * x11y), x11a = atan2(x11x, x11y);
 
     double x0m = (1 - dx) * x00m + dx * x10m,
@@ -0,0 +1,250 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribRecordSetBuilder.h
+ */
+
+#include "GribRecordSetBuilder.h"
+
+#include <algorithm>
+
+#include "GribReader.h"
+#include "GribRecordSet.h"
+
+namespace {
+
+//    Where records of a data type go in a GribRecordSet
+struct GribIdxMapping {
+  enum {  // what the data type tells about the file
+    POLAR_WIND = 1,
+    POLAR_CURRENT = 2,
+    SIG_WAVE = 4,
+    SIG_H = 8
+  };
+  int idx = -1;
+  bool byLevel = false;  // isobaric records go by level, see IsobaricLevel()
+  int isobaric[4] = {-1, -1, -1, -1};
+  int model = -1;  // records of this model also add 1000 + model
+  unsigned int flags = 0;
+};
+
+int IsobaricLevel(zuint value) {
+  switch (value) {
+    case 300:
+      return 0;
+    case 500:
+      return 1;
+    case 700:
+      return 2;
+    case 850:
+      return 3;
+  }
+  return -1;
+}
+
+const GribIdxMapping &GribIdxMappingOf(zuchar dataType) {
+  static const std::vector<GribIdxMapping> table = [] {
+    std::vector<GribIdxMapping> t(256);
+    auto levels = [&](int type, int idx, int i300, int i500, int i700,
+                      int i850) {
+      t[type].idx = idx;
+      t[type].byLevel = true;
+      t[type].isobaric[0] = i300;
+      t[type].isobaric[1] = i500;
+      t[type].isobaric[2] = i700;
+      t[type].isobaric[3] = i850;
+    };
+    levels(GRB_WIND_VX, Idx_WIND_VX, Idx_WIND_VX300, Idx_WIND_VX500,
+           Idx_WIND_VX700, Idx_WIND_VX850);
+    levels(GRB_WIND_VY, Idx_WIND_VY, Idx_WIND_VY300, Idx_WIND_VY500,
+           Idx_WIND_VY700, Idx_WIND_VY850);
+    t[GRB_WIND_DIR] = t[GRB_WIND_VX];
+    t[GRB_WIND_DIR].flags = GribIdxMapping::POLAR_WIND;
+    t[GRB_WIND_SPEED] = t[GRB_WIND_VY];
+    t[GRB_WIND_SPEED].flags = GribIdxMapping::POLAR_WIND;
+    levels(GRB_TEMP, Idx_AIR_TEMP, Idx_AIR_TEMP300, Idx_AIR_TEMP500,
+           Idx_AIR_TEMP700, Idx_AIR_TEMP850);
+    t[GRB_TEMP].model = NORWAY_METNO;
+    levels(GRB_HUMID_REL, -1, Idx_HUMID_RE300, Idx_HUMID_RE500,
+           Idx_HUMID_RE700, Idx_HUMID_RE850);
+    levels(GRB_GEOPOT_HGT, -1, Idx_GEOP_HGT300, Idx_GEOP_HGT500,
+           Idx_GEOP_HGT700, Idx_GEOP_HGT850);
+
+    t[GRB_UOGRD].idx = Idx_SEACURRENT_VX;
+    t[GRB_VOGRD].idx = Idx_SEACURRENT_VY;
+    t[GRB_CUR_DIR].idx = Idx_SEACURRENT_VX;
+    t[GRB_CUR_DIR].flags = GribIdxMapping::POLAR_CURRENT;
+    t[GRB_CUR_SPEED].idx = Idx_SEACURRENT_VY;
+    t[GRB_CUR_SPEED].flags = GribIdxMapping::POLAR_CURRENT;
+
+    t[GRB_WIND_GUST].idx = Idx_WIND_GUST;
+    t[GRB_PRESSURE].idx = Idx_PRESSURE;
+    t[GRB_HTSGW].idx = Idx_HTSIGW;
+    t[GRB_HTSGW].flags = GribIdxMapping::SIG_H;
+    t[GRB_PER].idx = Idx_WVPER;
+    t[GRB_PER].flags = GribIdxMapping::SIG_WAVE;
+    t[GRB_DIR].idx = Idx_WVDIR;
+    t[GRB_DIR].flags = GribIdxMapping::SIG_WAVE;
+    t[GRB_WVHGT].idx = Idx_HTSIGW;  // Translation from NOAA WW3
+    t[GRB_WVPER].idx = Idx_WVPER;
+    t[GRB_WVDIR].idx = Idx_WVDIR;
+    t[GRB_PRECIP_RATE].idx = Idx_PRECIP_TOT;
+    t[GRB_PRECIP_TOT].idx = Idx_PRECIP_TOT;
+    t[GRB_CLOUD_TOT].idx = Idx_CLOUD_TOT;
+    t[GRB_WTMP].idx = Idx_SEA_TEMP;
+    t[GRB_WTMP].model = NOAA_GFS;
+    t[GRB_CAPE].idx = Idx_CAPE;
+    t[GRB_COMP_REFL].idx = Idx_COMP_REFL;
+    return t;
+  }();
+  return table[dataType];
+}
+
+}  // namespace
+
+GribRecord *GribRecordSetBuilder::Build(
+    GribReader &reader, const std::vector<GribRecordSet *> &sets,
+    std::vector<int> &indices) {
+  GribRecord *pRec = nullptr;
+  bool polarWind(false);
+  bool polarCurrent(false);
+  bool sigWave(false);
+  bool sigH(false);
+  auto filed = [&](int idx) {
+    if (std::find(indices.begin(), indices.end(), idx) == indices.end())
+      indices.push_back(idx);
+  };
+
+  //    Iterate over the map to get vectors of related GribRecords
+  std::map<std::string, std::vector<GribRecord *> *> *p_map =
+      reader.getGribMap();
+  std::map<std::string, std::vector<GribRecord *> *>::iterator it;
+  for (it = p_map->begin(); it != p_map->end(); it++) {
+    std::vector<GribRecord *> *ls = (*it).second;
+    for (zuint i = 0; i < ls->size(); i++) {
+      pRec = ls->at(i);
+      time_t thistime = pRec->getRecordCurrentDate();
+
+      auto pos = std::lower_bound(
+          sets.begin(), sets.end(), thistime,
+          [](const GribRecordSet *set, time_t time) {
+            return set->m_Reference_Time < time;
+          });
+      if (pos == sets.end() || (*pos)->m_Reference_Time != thistime) continue;
+      GribRecordSet &set = **pos;
+
+      const GribIdxMapping &map = GribIdxMappingOf(pRec->getDataType());
+      if (map.flags & GribIdxMapping::POLAR_WIND) polarWind = true;
+      if (map.flags & GribIdxMapping::POLAR_CURRENT) polarCurrent = true;
+      if (map.flags & GribIdxMapping::SIG_WAVE) sigWave = true;
+      if (map.flags & GribIdxMapping::SIG_H) sigH = true;
+
+      int idx = map.idx;
+      if (pRec->getLevelType() == LV_ISOBARIC && map.byLevel) {
+        int level = IsobaricLevel(pRec->getLevelValue());
+        idx = level == -1 ? -1 : map.isobaric[level];
+      }
+      if (idx == -1) {
+        // XXX bug ?
+        continue;
+      }
+      int mdx = -1;
+      if (map.model != -1 && (int)pRec->getDataCenterModel() == map.model)
+        mdx = 1000 + map.model;
+
+      bool skip = false;
+
+      if (set.m_GribRecordPtrArray[idx]) {
+        // already one
+        GribRecord *oRec = set.m_GribRecordPtrArray[idx];
+        if (idx == Idx_PRESSURE) {
+          skip = (oRec->getLevelType() == LV_MSL);
+        } else {
+          // we favor UV over DIR/SPEED
+          if (polarWind) {
+            if (oRec->getDataType() == GRB_WIND_VY ||
+                oRec->getDataType() == GRB_WIND_VX)
+              skip = true;
+          }
+          if (polarCurrent) {
+            if (oRec->getDataType() == GRB_UOGRD ||
+                oRec->getDataType() == GRB_VOGRD)
+              skip = true;
+          }
+          // favor average aka timeRange == 3 (HRRR subhourly subsets have
+          // both 3 and 0 records for winds)
+          if (!skip && (oRec->getTimeRange() == 3)) {
+            skip = true;
+          }
+          // we favor significant Wave other wind wave.
+          if (sigH) {
+            if (oRec->getDataType() == GRB_HTSGW) skip = true;
+          }
+          if (sigWave) {
+            if (oRec->getDataType() == GRB_DIR ||
+                oRec->getDataType() == GRB_PER)
+              skip = true;
+          }
+        }
+      }
+      if (!skip) {
+        set.m_GribRecordPtrArray[idx] = pRec;
+        filed(idx);
+        if (mdx != -1) filed(mdx);
+      }
+    }
+  }
+
+  if (polarWind || polarCurrent) Polar2UV(sets, polarWind, polarCurrent);
+  return pRec;
+}
+
+void GribRecordSetBuilder::Polar2UV(const std::vector<GribRecordSet *> &sets,
+                                    bool polarWind, bool polarCurrent) {
+  for (GribRecordSet *set : sets) {
+    GribRecord **records = set->m_GribRecordPtrArray;
+    for (unsigned int i = 0; i < Idx_COUNT; i++) {
+      GribRecord *pRec = records[i];
+      if (pRec == nullptr) continue;
+      int idx = -1;
+      if (polarWind && pRec->getDataType() == GRB_WIND_DIR) {
+        switch (i) {
+          case Idx_WIND_VX300:
+            idx = Idx_WIND_VY300;
+            break;
+          case Idx_WIND_VX500:
+            idx = Idx_WIND_VY500;
+            break;
+          case Idx_WIND_VX700:
+            idx = Idx_WIND_VY700;
+            break;
+          case Idx_WIND_VX850:
+            idx = Idx_WIND_VY850;
+            break;
+          case Idx_WIND_VX:
+            idx = Idx_WIND_VY;
+            break;
+          default:
+            break;
+        }
+        if (idx != -1 && records[idx] != nullptr &&
+            records[idx]->getDataType() == GRB_WIND_SPEED)
+          GribRecord::Polar2UV(pRec, records[idx]);
+      }
+      if (polarCurrent && pRec->getDataType() == GRB_CUR_DIR &&
+          i == Idx_SEACURRENT_VX) {
+        idx = Idx_SEACURRENT_VY;
+        if (records[idx] != nullptr &&
+            records[idx]->getDataType() == GRB_CUR_SPEED)
+          GribRecord::Polar2UV(pRec, records[idx]);
+      }
+    }
+  }
+}
@@ -0,0 +1,296 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribResidency.h
+ */
+
+#include "GribResidency.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#include "GribRecord.h"
+
+GribResidency &GribResidency::Get() {
+  static GribResidency *instance = new GribResidency();
+  return *instance;
+}
+
+void GribResidency::SetBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_budget = bytes;
+}
+
+void GribResidency::SetSpillDirectory(const std::string &directory) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_spillDirectory = directory;
+  if (!m_spill.is_open()) m_spillFailed = false;
+}
+
+void GribResidency::SetCompression(DpGrib::GridCompression compression) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_compression = compression;
+}
+
+DpGrib::MemoryUsage GribResidency::GetUsage() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  DpGrib::MemoryUsage usage;
+  usage.budget = m_budget;
+  usage.current = m_current;
+  usage.peak = m_peak;
+  usage.total = m_total;
+  usage.compressed = m_compressed;
+  usage.evictions = m_evictions;
+  usage.reloads = m_reloads;
+  return usage;
+}
+
+size_t GribResidency::Bytes(const GribRecord *rec) {
+  return (size_t)rec->getNi() * rec->getNj() * sizeof(double);
+}
+
+void GribResidency::Manage(GribRecord *rec) {
+  GribResidencyEntry &entry = rec->m_residency;
+  double *values = rec->data;
+  if (entry.owner || !values) return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  entry.owner = this;
+  entry.slot = m_records.size();
+  entry.spill = -1;
+  entry.saved = false;
+  entry.grid.reset(values, std::default_delete<double[]>());
+  entry.lastUse = m_generation.load();
+  m_records.push_back(rec);
+
+  size_t bytes = Bytes(rec);
+  m_total += bytes;
+  m_current += bytes;
+  m_peak = std::max(m_peak, m_current);
+}
+
+void GribResidency::ManageMapped(GribRecord *rec,
+                                 std::shared_ptr<const void> mapping,
+                                 const uint16_t *quantized, double reference,
+                                 double step) {
+  GribResidencyEntry &entry = rec->m_residency;
+  if (entry.owner || rec->data) return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  entry.owner = this;
+  entry.slot = m_records.size();
+  entry.spill = -1;
+  entry.saved = true;  // the mapping is the saved copy
+  entry.mapping = std::move(mapping);
+  entry.quantized = quantized;
+  entry.reference = reference;
+  entry.step = step;
+  entry.lastUse = m_generation.load();
+  m_records.push_back(rec);
+  m_total += Bytes(rec);
+}
+
+void GribResidency::Release(GribRecord *rec) {
+  GribResidencyEntry &entry = rec->m_residency;
+  if (entry.owner != this) return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t bytes = Bytes(rec);
+  m_total -= bytes;
+  if (rec->data) m_current -= bytes;
+  rec->data = nullptr;
+  entry.grid.reset();
+  Discard(entry);
+  entry.owner = nullptr;
+
+  m_records[entry.slot] = m_records.back();
+  m_records[entry.slot]->m_residency.slot = entry.slot;
+  m_records.pop_back();
+  if (m_records.empty()) CloseSpill();
+}
+
+void GribResidency::Trim() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Records used from now on are recent for the next call
+  unsigned int now = m_generation.fetch_add(1);
+  if (!m_budget || m_current <= m_budget || m_readers) return;
+  if (m_compression == DpGrib::GRID_COMPRESSION_NONE && m_spillFailed) return;
+
+  std::vector<GribRecord *> candidates;
+  for (GribRecord *rec : m_records)
+    if (rec->data && rec->m_residency.lastUse.load() != now)
+      candidates.push_back(rec);
+  // Oldest first; the age is wrap-around safe
+  std::sort(candidates.begin(), candidates.end(),
+            [now](const GribRecord *a, const GribRecord *b) {
+              return now - a->m_residency.lastUse.load() >
+                     now - b->m_residency.lastUse.load();
+            });
+
+  // Some headroom, so that loading keeps evicting in batches
+  size_t target = m_budget - m_budget / 8;
+  for (GribRecord *rec : candidates) {
+    if (m_current <= target) break;
+    if (!Evict(rec)) break;
+  }
+}
+
+bool GribResidency::Evict(GribRecord *rec) {
+  GribResidencyEntry &entry = rec->m_residency;
+  if (!entry.saved && !Save(rec)) return false;
+  rec->data = nullptr;
+  entry.grid.reset();
+  m_current -= Bytes(rec);
+  m_evictions++;
+  return true;
+}
+
+bool GribResidency::Save(GribRecord *rec) {
+  GribResidencyEntry &entry = rec->m_residency;
+  if (m_compression != DpGrib::GRID_COMPRESSION_NONE) {
+    double step = m_compression == DpGrib::GRID_COMPRESSION_PACKING
+                      ? rec->packingStep
+                      : 0;
+    GribGridCodec::Encode(rec->data.get(), (size_t)rec->getNi() * rec->getNj(),
+                          step, entry.packed);
+    entry.packed.shrink_to_fit();
+    m_compressed += entry.packed.size();
+    entry.saved = true;
+    return true;
+  }
+
+  if (m_spillFailed) return false;
+  if (!m_spill.is_open()) {
+    if (m_spillDirectory.empty()) {
+      m_spillFailed = true;
+      return false;
+    }
+    std::random_device seed;
+    char name[32];
+    snprintf(name, sizeof name, "/grib-%08x.spill", seed());
+    m_spillPath = m_spillDirectory + name;
+    m_spill.open(m_spillPath, std::ios::in | std::ios::out |
+                                  std::ios::binary | std::ios::trunc);
+    if (!m_spill.is_open()) {
+      m_spillFailed = true;
+      return false;
+    }
+    // Gone with the process where open files can be unlinked
+    if (!std::remove(m_spillPath.c_str())) m_spillPath.clear();
+    m_spillEnd = 0;
+  }
+
+  // A stale copy is rewritten in place, the size of a grid never changes
+  int64_t offset = entry.spill >= 0 ? entry.spill : m_spillEnd;
+  m_spill.seekp(offset);
+  m_spill.write(reinterpret_cast<const char *>(rec->data.get()), Bytes(rec));
+  if (!m_spill) {
+    m_spill.clear();
+    m_spillFailed = true;  // disk full, keep everything in memory
+    return false;
+  }
+  if (offset == m_spillEnd) m_spillEnd += Bytes(rec);
+  entry.spill = offset;
+  entry.saved = true;
+  return true;
+}
+
+double *GribResidency::Load(const GribRecord *rec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return LoadLocked(rec);
+}
+
+double *GribResidency::LoadLocked(const GribRecord *rec) {
+  GribRecord *r = const_cast<GribRecord *>(rec);
+  if (double *values = r->data) return values;  // read back meanwhile
+
+  std::shared_ptr<double> grid = ReadBack(rec);
+  if (!grid) return nullptr;
+  r->m_residency.grid = grid;
+  r->data = grid.get();
+  m_current += Bytes(rec);
+  m_peak = std::max(m_peak, m_current);
+  return grid.get();
+}
+
+std::shared_ptr<double> GribResidency::ReadBack(const GribRecord *rec) {
+  const GribResidencyEntry &entry = rec->m_residency;
+  if (entry.owner != this || !entry.saved) return nullptr;
+
+  size_t count = (size_t)rec->getNi() * rec->getNj();
+  std::shared_ptr<double> grid(new (std::nothrow) double[count],
+                               std::default_delete<double[]>());
+  if (!grid) return nullptr;
+  if (entry.quantized) {
+    double *values = grid.get();
+    for (size_t k = 0; k < count; k++) {
+      uint16_t q = entry.quantized[k];
+      values[k] = q == 0xffff ? GRIB_NOTDEF : entry.reference + q * entry.step;
+    }
+  } else if (!entry.packed.empty()) {
+    if (!GribGridCodec::Decode(entry.packed, grid.get(), count))
+      return nullptr;
+  } else {
+    m_spill.seekg(entry.spill);
+    m_spill.read(reinterpret_cast<char *>(grid.get()), Bytes(rec));
+    if (!m_spill) {
+      m_spill.clear();
+      return nullptr;
+    }
+  }
+  m_reloads++;
+  return grid;
+}
+
+std::shared_ptr<const double> GribResidency::Share(const GribRecord *rec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!LoadLocked(rec)) return nullptr;
+  return rec->m_residency.grid;
+}
+
+std::shared_ptr<const double> GribResidency::Peek(const GribRecord *rec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (rec->data) return rec->m_residency.grid;
+  return ReadBack(rec);
+}
+
+void GribResidency::Modified(GribRecord *rec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  rec->m_residency.saved = false;
+  Discard(rec->m_residency);
+}
+
+void GribResidency::Discard(GribResidencyEntry &entry) {
+  m_compressed -= entry.packed.size();
+  std::vector<unsigned char>().swap(entry.packed);
+  entry.mapping.reset();
+  entry.quantized = nullptr;
+}
+
+void GribResidency::CloseSpill() {
+  if (m_spill.is_open()) m_spill.close();
+  if (!m_spillPath.empty()) std::remove(m_spillPath.c_str());
+  m_spillPath.clear();
+  m_spillEnd = 0;
+  m_spillFailed = false;
+}
+
+GribResidency::ReadGuard::ReadGuard() {
+  GribResidency &residency = Get();
+  std::lock_guard<std::mutex> lock(residency.m_mutex);
+  residency.m_readers++;
+}
+
+GribResidency::ReadGuard::~ReadGuard() {
+  GribResidency &residency = Get();
+  std::lock_guard<std::mutex> lock(residency.m_mutex);
+  residency.m_readers--;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribRouteSampler.h
+ */
+
+#include "GribRouteSampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double DEG = M_PI / 180.;
+
+// Mercator ordinate; rhumb lines are straight in it
+static double MercatorY(double lat) {
+  lat = std::max(-89.999, std::min(89.999, lat));
+  return log(tan(M_PI / 4. + lat * DEG / 2.));
+}
+
+// Shortest longitude difference, across the antimeridian if needed
+static double LonDelta(double lon0, double lon1) {
+  double d = fmod(lon1 - lon0, 360.);
+  if (d > 180.)
+    d -= 360.;
+  else if (d < -180.)
+    d += 360.;
+  return d;
+}
+
+static double NormalizeLon(double lon) {
+  lon = fmod(lon, 360.);
+  if (lon > 180.)
+    lon -= 360.;
+  else if (lon <= -180.)
+    lon += 360.;
+  return lon;
+}
+
+double GribRouteSampler::RhumbDistance(double lat0, double lon0, double lat1,
+                                       double lon1) {
+  double dlat = lat1 - lat0;
+  double dlon = LonDelta(lon0, lon1);
+  double dy = MercatorY(lat1) - MercatorY(lat0);
+  // Stretch of the longitudes, cos(lat) on an east-west line
+  double q = fabs(dy) > 1e-12 ? dlat * DEG / dy : cos(lat0 * DEG);
+  return 60. * sqrt(dlat * dlat + q * q * dlon * dlon);
+}
+
+bool GribRouteSampler::Densify(const DpGrib::RouteRequest &request,
+                               DpGrib::RouteSamples &samples,
+                               std::vector<DpGrib::SampleQuery> &queries) {
+  samples = DpGrib::RouteSamples();
+  samples.layerIds = request.layerIds;
+  queries.clear();
+
+  const std::vector<DpGrib::RouteWaypoint> &wp = request.waypoints;
+  if (wp.empty() || !(request.spacing > 0.)) return false;
+
+  time_t start = request.useTimestamps ? wp[0].time : request.departure;
+  auto add = [&](double lat, double lon, double seconds, double distance,
+                 int leg) {
+    DpGrib::SampleQuery q;
+    q.latitude = lat;
+    q.longitude = NormalizeLon(lon);
+    q.time = start + (time_t)llround(seconds);
+    queries.push_back(q);
+    samples.latitude.push_back(q.latitude);
+    samples.longitude.push_back(q.longitude);
+    samples.time.push_back(q.time);
+    samples.distance.push_back(distance);
+    samples.leg.push_back(leg);
+  };
+
+  double distance = 0., seconds = 0.;
+  for (size_t i = 0; i + 1 < wp.size(); i++) {
+    const DpGrib::RouteWaypoint &a = wp[i], &b = wp[i + 1];
+    double length = RhumbDistance(a.latitude, a.longitude, b.latitude,
+                                  b.longitude);
+    double duration;
+    if (request.useTimestamps) {
+      duration = difftime(b.time, a.time);
+      if (duration < 0.) return false;
+    } else {
+      if (!(a.speed > 0.)) return false;
+      duration = length / a.speed * 3600.;
+    }
+
+    double dlat = b.latitude - a.latitude;
+    double dlon = LonDelta(a.longitude, b.longitude);
+    double y0 = MercatorY(a.latitude);
+    double dy = MercatorY(b.latitude) - y0;
+    int steps = std::max(1, (int)ceil(length / request.spacing - 1e-9));
+    for (int s = 0; s < steps; s++) {
+      double f = (double)s / steps;
+      double lat = a.latitude + f * dlat;
+      double lon = a.longitude + (fabs(dy) > 1e-12
+                                      ? dlon * (MercatorY(lat) - y0) / dy
+                                      : f * dlon);
+      add(lat, lon, seconds + f * duration, distance + f * length, i);
+    }
+    distance += length;
+    seconds += duration;
+  }
+  add(wp.back().latitude, wp.back().longitude, seconds, distance,
+      std::max(0, (int)wp.size() - 2));
+  return true;
+}
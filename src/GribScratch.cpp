@@ -0,0 +1,85 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribScratch.h
+ */
+
+#include "GribScratch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace {
+
+const size_t ALIGNMENT = alignof(std::max_align_t);
+const size_t MIN_BLOCK = 64 << 10;
+// Arenas grown beyond this give their memory back once reset
+const size_t MAX_KEPT = 64 << 20;
+
+std::atomic<unsigned long> s_blocks{0}, s_allocations{0};
+
+// Arena of the thread, while not leased
+thread_local std::unique_ptr<GribScratch> t_idle;
+
+}  // namespace
+
+GribScratch::Counters GribScratch::GetCounters() {
+  Counters counters;
+  counters.blocks = s_blocks.load();
+  counters.allocations = s_allocations.load();
+  return counters;
+}
+
+GribScratch *GribScratch::Acquire() {
+  if (t_idle) return t_idle.release();
+  return new GribScratch();
+}
+
+void GribScratch::Release(GribScratch *scratch) {
+  scratch->Reset();
+  if (!t_idle)
+    t_idle.reset(scratch);
+  else
+    delete scratch;
+}
+
+void *GribScratch::Allocate(size_t bytes) {
+  if (bytes > SIZE_MAX - ALIGNMENT) return nullptr;
+  size_t offset = (m_used + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  if (m_blocks.empty() || offset + bytes > m_blocks.back().size) {
+    size_t size = std::max(bytes, MIN_BLOCK);
+    if (!m_blocks.empty()) size = std::max(size, 2 * m_blocks.back().size);
+    char *memory = new (std::nothrow) char[size];
+    if (!memory) return nullptr;
+    m_blocks.push_back({std::unique_ptr<char[]>(memory), size});
+    s_blocks++;
+    offset = 0;
+  }
+  m_used = offset + bytes;
+  s_allocations++;
+  return m_blocks.back().memory.get() + offset;
+}
+
+void GribScratch::Reset() {
+  m_used = 0;
+  if (m_blocks.size() == 1 && m_blocks[0].size <= MAX_KEPT) return;
+
+  // Grown while decoding: one block the size of all, if worth keeping
+  size_t size = 0;
+  for (const Block &block : m_blocks) size += block.size;
+  m_blocks.clear();
+  if (size && size <= MAX_KEPT) {
+    if (char *memory = new (std::nothrow) char[size]) {
+      m_blocks.push_back({std::unique_ptr<char[]>(memory), size});
+      s_blocks++;
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribScreenSampler.h
+ */
+
+#include "GribScreenSampler.h"
+
+#include <cmath>
+
+enum { GEO_LATTICE, SCREEN_LATTICE };
+
+//----------------------------------------------------------------------------
+// GribSampleLattice
+//----------------------------------------------------------------------------
+
+const std::vector<GribSampleCell> &GribSampleLattice::Cells(
+    const GribRecord *rec) {
+  GribGridGeometry geometry = rec->getGridGeometry();
+  for (auto &cells : m_cells)
+    if (cells.first == geometry) return cells.second;
+
+  m_cells.emplace_back(geometry, std::vector<GribSampleCell>());
+  std::vector<GribSampleCell> &cells = m_cells.back().second;
+  cells.resize(m_points.size());
+  for (size_t k = 0; k < m_points.size(); k++)
+    rec->getSampleCell(m_points[k].lon, m_points[k].lat, cells[k]);
+  return cells;
+}
+
+double GribSampleLattice::Value(const GribRecord *rec, size_t k,
+                                bool numericalInterpolation, bool dir) {
+  // A record that is not ok must not decide the cells of its geometry
+  if (!rec || !rec->isOk()) return GRIB_NOTDEF;
+  return rec->getInterpolatedValue(Cells(rec)[k], numericalInterpolation, dir);
+}
+
+bool GribSampleLattice::Values(double &M, double &A, const GribRecord *GRX,
+                               const GribRecord *GRY, size_t k,
+                               bool numericalInterpolation) {
+  if (!GRX || !GRY || !GRX->isOk() || !GRY->isOk()) return false;
+
+  if (!(GRX->getGridGeometry() == GRY->getGridGeometry()))
+    return GribRecord::getInterpolatedValues(M, A, GRX, GRY, m_points[k].lon,
+                                             m_points[k].lat,
+                                             numericalInterpolation);
+
+  return GribRecord::getInterpolatedValues(M, A, GRX, GRY, Cells(GRX)[k],
+                                           numericalInterpolation);
+}
+
+//----------------------------------------------------------------------------
+// GribScreenSampler
+//----------------------------------------------------------------------------
+
+void GribScreenSampler::Clear() {
+  m_lattices.clear();
+  m_valid = false;
+}
+
+void GribScreenSampler::CheckViewPort(PlugIn_ViewPort *vp) {
+  ViewPortKey key = {vp->clat,      vp->clon,          vp->view_scale_ppm,
+                     vp->rotation,  vp->skew,          vp->pix_width,
+                     vp->pix_height, vp->m_projection_type};
+  if (m_valid && key == m_vp) return;
+
+  m_lattices.clear();
+  m_vp = key;
+  m_valid = true;
+}
+
+GribSampleLattice &GribScreenSampler::GeoLattice(PlugIn_ViewPort *vp,
+                                                 int spacing) {
+  CheckViewPort(vp);
+
+  GribSampleLattice &lattice =
+      m_lattices[LatticeKey(GEO_LATTICE, 0, 0, 0, 0, spacing)];
+  if (!lattice.m_points.empty()) return lattice;
+
+  // Convert pixel spacing to geographic spacing around the centre
+  wxPoint center(vp->pix_width / 2, vp->pix_height / 2);
+  double center_lat, center_lon;
+  GetCanvasLLPix(vp, center, &center_lat, &center_lon);
+
+  wxPoint offset_point(center.x + spacing, center.y + spacing);
+  double offset_lat, offset_lon;
+  GetCanvasLLPix(vp, offset_point, &offset_lat, &offset_lon);
+
+  double lat_spacing = fabs(center_lat - offset_lat);
+  double lon_spacing = fabs(center_lon - offset_lon);
+  if (lat_spacing <= 0 || lon_spacing <= 0) return lattice;
+
+  double start_lat = floor(vp->lat_min / lat_spacing) * lat_spacing;
+  double start_lon = floor(vp->lon_min / lon_spacing) * lon_spacing;
+
+  // Expand bounds slightly to cover the viewport edges
+  double end_lat = vp->lat_max + lat_spacing;
+  double end_lon = vp->lon_max + lon_spacing;
+
+  for (double lat = start_lat; lat <= end_lat; lat += lat_spacing) {
+    for (double lon = start_lon; lon <= end_lon; lon += lon_spacing) {
+      GribSamplePoint pt;
+      GetCanvasPixLL(vp, &pt.p, lat, lon);
+      pt.lat = lat, pt.lon = lon;
+      lattice.m_points.push_back(pt);
+    }
+  }
+  return lattice;
+}
+
+GribSampleLattice &GribScreenSampler::ScreenLattice(PlugIn_ViewPort *vp,
+                                                    int x0, int y0, int x1,
+                                                    int y1, int step) {
+  CheckViewPort(vp);
+
+  GribSampleLattice &lattice =
+      m_lattices[LatticeKey(SCREEN_LATTICE, x0, y0, x1, y1, step)];
+  if (!lattice.m_points.empty() || step <= 0) return lattice;
+
+  for (int i = x0; i < x1; i += step) {
+    for (int j = y0; j < y1; j += step) {
+      GribSamplePoint pt;
+      pt.p = wxPoint(i, j);
+      GetCanvasLLPix(vp, pt.p, &pt.lat, &pt.lon);
+      lattice.m_points.push_back(pt);
+    }
+  }
+  return lattice;
+}
@@ -445,6 +445,11 @@ double GribOverlaySettings::CalibrationFactor(int settings, double input,
   return 1;
 }
 
+bool GribOverlaySettings::HasBeaufortUnits(int settings) {
+  return (unittype[settings] == 0 || unittype[settings] == 7) &&
+         Settings[settings].m_Units == BFS;
+}
+
 /*
 Beaufort scale
     force             in knots   in m/s         in knots
@@ -45,11 +45,6 @@ void GRIBTable::InitGribTable(ArrayOfGribRecordSets *rsa, int NowIndex) {
   m_pGribTable->m_gParent = this;
   m_pIndex = NowIndex;
 
-  // init row attr
-  wxGridCellAttr *datarow = new wxGridCellAttr();
-  datarow->SetFont(GetOCPNGUIScaledFont_PlugIn(_("Dialog")));
-  datarow->SetAlignment(wxALIGN_CENTRE, wxALIGN_CENTRE);
-
   // populate "cursor position" display
   wxString l;
   l.Append(toSDMM_PlugIn(1, m_cursor_lat))
@@ -60,178 +55,23 @@ void GRIBTable::InitGribTable(ArrayOfGribRecordSets *rsa, int NowIndex) {
       GetOCPNGUIScaledFont_PlugIn(_("Dialog")).MakeBold());
   m_pPositionText->SetFont(GetOCPNGUIScaledFont_PlugIn(_("Dialog")).MakeBold());
 
-  // create as columns as necessary
-  m_pGribTable->AppendCols(rsa->GetCount());
-
-  // populate grid
-  wxDateTime time, day, ptime;
-  int nrows, wcols = 0;
-  for (unsigned i = 0; i < rsa->GetCount(); i++) {
-    // populate time labels
-    time = rsa->Item(i).m_Reference_Time;
-    DateTimeFormatOptions opts = DateTimeFormatOptions().SetFormatString(
-        "$weekday_short_date\n$hour_minutes");
-    m_pGribTable->SetColLabelValue(
-        i, toUsrDateTimeFormat_Plugin(wxDateTime(time), opts));
-    nrows = -1;
-    GribTimelineRecordSet *pTimeset = m_pGDialog->GetTimeLineRecordSet(time);
-    if (pTimeset == 0) continue;
-
-    GribRecord **RecordArray = pTimeset->m_GribRecordPtrArray;
-
-    /*create and populate wind data row
-         wind is a special case:
-         1) if current unit is not bf ==> double speed display (current unit +
-       bf) 2) create two lines for direction and speed and a third for gust if
-       exists 3) these two or three lines will be part of the same block*/
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_WIND_VX) !=
-            wxNOT_FOUND &&
-        m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_WIND_VY) !=
-            wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Wind,Dir"), datarow);
-      double wdir;
-      GetWind(RecordArray, 1, wdir);  // this is a numerical row
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-      m_pGribTable->SetNumericalRow(nrows, i, R_WIND, wdir);
-      nrows++;
-      AddDataRow(nrows, i, _("Wind,Speed"), datarow);
-      if (m_pGDialog->m_OverlaySettings.Settings[GribOverlaySettings::WIND]
-              .m_Units != GribOverlaySettings::BFS)
-        m_pGribTable->SetCellValue(nrows, i, GetWind(RecordArray, 2, wdir));
-      else
-        m_pGribTable->SetCellValue(nrows, i, GetWind(RecordArray, 3, wdir));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-      if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_WIND_GUST) !=
-          wxNOT_FOUND) {
-        nrows++;
-        AddDataRow(nrows, i, _("Wind,Gust"), datarow);
-        if (m_pGDialog->m_OverlaySettings.Settings[GribOverlaySettings::WIND]
-                .m_Units != GribOverlaySettings::BFS)
-          m_pGribTable->SetCellValue(nrows, i, GetWindGust(RecordArray, 1));
-        else
-          m_pGribTable->SetCellValue(nrows, i, GetWindGust(RecordArray, 2));
-        m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-      }
-    }  // wind
-
-    // create and populate Pressure data rown
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_PRESSURE) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Pressure"), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetPressure(RecordArray));
-    }  // pressure
-
-    /*create and populate Waves data rows
-        waves is another special case:
-         1) if significant height data exists then create a line for direction
-       and height then a third for periode if data exists
-         2) these two or three lines will be part of the same block*/
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_HTSIGW) !=
-        wxNOT_FOUND) {
-      double wdir;
-      if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_WVDIR) !=
-          wxNOT_FOUND) {
-        nrows++;
-        AddDataRow(nrows, i, _("Waves,Dir"), datarow);
-        GetWaves(RecordArray, Idx_WVDIR, wdir);  // this is a numerical row
-        m_pGribTable->SetNumericalRow(nrows, i, R_WAVES, wdir);
-      }
-      nrows++;
-      AddDataRow(nrows, i, _("Waves,Hsig"), datarow);
-      m_pGribTable->SetCellValue(nrows, i,
-                                 GetWaves(RecordArray, Idx_HTSIGW, wdir));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-      if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_WVPER) !=
-          wxNOT_FOUND) {
-        nrows++;
-        AddDataRow(nrows, i, _("Waves,Per"), datarow);
-        m_pGribTable->SetCellValue(nrows, i,
-                                   GetWaves(RecordArray, Idx_WVPER, wdir));
-      }
-    }  // waves
-
-    // create and populate total rainfall data row
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_PRECIP_TOT) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Rainfall"), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetRainfall(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // rainfall
-
-    // create and populate total cloud control
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_CLOUD_TOT) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Cloud Cover"), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetCloudCover(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // cloud
-
-    // create and populate the Air Temperature data row
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_AIR_TEMP) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Air Temp."), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetAirTemp(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // air temp
-
-    // create and populate the Sea Surface Temperature data row
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_SEA_TEMP) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("Sea Temp."), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetSeaTemp(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // sea temp
-
-    // create and populate the Convective Available Potential Energy (CAPE) data
-    // row
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_CAPE) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("CAPE"), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetCAPE(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // cape
-
-    // create and populate the Composite Reflectivity data row
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(Idx_COMP_REFL) !=
-        wxNOT_FOUND) {
-      nrows++;
-      AddDataRow(nrows, i, _("C. Reflect."), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetCompRefl(RecordArray));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // composite Reflectivity
-
-    /*create and populate the current data rows
-        1)create two lines for direction and speed
-        2) these two or three lines will be part of the same block*/
-    if (m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(
-            Idx_SEACURRENT_VX) != wxNOT_FOUND &&
-        m_pGDialog->m_bGRIBActiveFile->m_GribIdxArray.Index(
-            Idx_SEACURRENT_VY) != wxNOT_FOUND) {
-      double wdir;
-      nrows++;
-      AddDataRow(nrows, i, _("Current,Dir"), datarow);
-      GetCurrent(RecordArray, 1, wdir);  // this is a numerical row
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-      m_pGribTable->SetNumericalRow(nrows, i, R_CURRENT, wdir);
-
-      nrows++;
-      AddDataRow(nrows, i, _("Current,Speed"), datarow);
-      m_pGribTable->SetCellValue(nrows, i, GetCurrent(RecordArray, 2, wdir));
-      m_pGribTable->SetCellBackgroundColour(nrows, i, m_pDataCellsColour);
-    }  // current // populate grid
-    delete pTimeset;
+  // rows and columns are sampled and formatted as they are drawn
+  m_pGribTable->SetTable(new GribTableData(*m_pGDialog, *m_pGribTable,
+                                           m_cursor_lat, m_cursor_lon),
+                         true, wxGridSelectRows);
+
+  // size the columns on the first, last and 'now' ones rather than all
+  int wcols = 0;
+  int ncols = m_pGribTable->GetNumberCols();
+  int samples[] = {0, m_pIndex, ncols - 1};
+  for (int i : samples) {
+    if (i < 0 || i >= ncols) continue;
     m_pGribTable->AutoSizeColumn(i, false);
     wcols = wxMax(m_pGribTable->GetColSize(i), wcols);
-  }  // populate grid
+  }
   // put cursor outside the grid
-  m_pGribTable->SetGridCursor(m_pGribTable->GetNumberRows() - 1, 0);
+  if (m_pGribTable->GetNumberRows() > 0)
+    m_pGribTable->SetGridCursor(m_pGribTable->GetNumberRows() - 1, 0);
   // set col size
   m_pGribTable->SetDefaultColSize(wcols, true);
   // set row size
@@ -241,8 +81,6 @@ void GRIBTable::InitGribTable(ArrayOfGribRecordSets *rsa, int NowIndex) {
   // set scroll steps
   m_pGribTable->SetScrollLineX(wcols);
 
-  datarow->DecRef();  // Give up pointer contrl to Grid
-
   m_tScrollToNowTimer.Connect(
       wxEVT_TIMER, wxTimerEventHandler(GRIBTable::OnScrollToNowTimer), nullptr,
       this);
@@ -332,298 +170,298 @@ void GRIBTable::CloseDialog() {
   }  //
 }
 
-void GRIBTable::AddDataRow(int num_rows, int num_cols, wxString label,
-                           wxGridCellAttr *row_attr) {
-  if (m_pGribTable->GetNumberRows() == num_rows) {
-    m_pGribTable->AppendRows(1);
-    m_pGribTable->SetRowLabelValue(num_rows, label);
-    row_attr->IncRef();
-    m_pGribTable->SetRowAttr(num_rows, row_attr);
-  }
-  m_pDataCellsColour = m_pGribTable->GetCellBackgroundColour(
-      num_rows, num_cols);  // set default colour
-}
-
 void GRIBTable::AutoSizeDataRows() {
-  int hrows = 0;
-  for (int i = 0; i < m_pGribTable->GetNumberRows(); i++) {
-    m_pGribTable->AutoSizeRow(i, false);
-    hrows = wxMax(m_pGribTable->GetRowHeight(i) + 3, hrows);
-  }
+  // all the rows use the same font, measure it instead of every cell
+  wxClientDC dc(m_pGribTable->GetGridWindow());
+  dc.SetFont(GetOCPNGUIScaledFont_PlugIn(_("Dialog")));
+  int hrows = dc.GetCharHeight() + 6 + 3;
+  dc.SetFont(m_pGribTable->GetLabelFont());
+  hrows = wxMax(dc.GetCharHeight() + 6 + 3, hrows);
   m_pGribTable->SetDefaultRowSize(hrows, true);
   // set scroll steps
   m_pGribTable->SetScrollLineY(hrows);
 }
 
-wxString GRIBTable::GetWind(GribRecord **recordarray, int datatype,
-                            double &wdir) {
-  wxString skn(wxEmptyString);
-  int altitude = 0;
-  double vkn, ang;
-  wdir = GRIB_NOTDEF;
-  if (GribRecord::getInterpolatedValues(
-          vkn, ang, recordarray[Idx_WIND_VX + altitude],
-          recordarray[Idx_WIND_VY + altitude], m_cursor_lon, m_cursor_lat)) {
-    if (datatype == 1) {
-      wdir = ang;
-      return skn;
-    }
-    double cvkn = m_pGDialog->m_OverlaySettings.CalibrateValue(
-        GribOverlaySettings::WIND, vkn);
-    m_pDataCellsColour =
-        m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-            GribOverlaySettings::WIND, cvkn);
-    skn.Printf(wxString::Format(
-        _T("%2d bf"),
-        (int)wxRound(m_pGDialog->m_OverlaySettings.GetmstobfFactor(vkn) *
-                     vkn)));
-    if (datatype == 2) {  // wind speed unit other than bf
-      skn.Prepend(wxString::Format(
-                      _T("%2d ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                       GribOverlaySettings::WIND),
-                      (int)wxRound(cvkn)) +
-                  _T(" - "));
-    }
+//------------------------------------------------------------------------------
+//          table model
+//------------------------------------------------------------------------------
+GribTableData::GribTableData(GRIBUICtrlBar &dialog, CustomGrid &grid,
+                             double lat, double lon)
+    : m_dialog(dialog), m_grid(grid), m_lat(lat), m_lon(lon) {
+  m_font = GetOCPNGUIScaledFont_PlugIn(_("Dialog"));
+  m_defaultColour = grid.GetDefaultCellBackgroundColour();
+
+  GRIBFile *file = dialog.m_bGRIBActiveFile.get();
+  ArrayOfGribRecordSets *rsa = file->GetRecordSetArrayPtr();
+  m_columns.resize(rsa->GetCount());
+  for (unsigned i = 0; i < rsa->GetCount(); i++)
+    m_columns[i].time = rsa->Item(i).m_Reference_Time;
+
+  auto has = [file](int idx) {
+    return file->m_GribIdxArray.Index(idx) != wxNOT_FOUND;
+  };
+
+  /*wind is a special case: two lines for direction and speed and a third
+    for gust if exists, part of the same block*/
+  if (has(Idx_WIND_VX) && has(Idx_WIND_VY)) {
+    AddRow(WIND_DIR, _("Wind,Dir"));
+    AddRow(WIND_SPEED, _("Wind,Speed"));
+    if (has(Idx_WIND_GUST)) AddRow(WIND_GUST, _("Wind,Gust"));
   }
-  return skn;
-}
-
-wxString GRIBTable::GetWindGust(GribRecord **recordarray, int datatype) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_WIND_GUST]) {
-    double vkn = recordarray[Idx_WIND_GUST]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-    if (vkn != GRIB_NOTDEF) {
-      double cvkn = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::WIND_GUST, vkn);
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::WIND_GUST, cvkn);
-
-      skn.Printf(wxString::Format(
-          _T("%2d bf"),
-          (int)wxRound(m_pGDialog->m_OverlaySettings.GetmstobfFactor(vkn) *
-                       vkn)));  // wind gust unit bf
-      if (datatype == 1) {      // wind gust unit other than bf
-        skn.Prepend(
-            wxString::Format(
-                _T("%2d ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                 GribOverlaySettings::WIND_GUST),
-                (int)wxRound(cvkn)) +
-            _T(" - " ));
-      }
-    }
+  if (has(Idx_PRESSURE)) AddRow(PRESSURE, _("Pressure"));
+  /*waves: direction and height if significant height exists, then period
+    if exists, part of the same block*/
+  if (has(Idx_HTSIGW)) {
+    if (has(Idx_WVDIR)) AddRow(WAVE_DIR, _("Waves,Dir"));
+    AddRow(WAVE_HSIG, _("Waves,Hsig"));
+    if (has(Idx_WVPER)) AddRow(WAVE_PER, _("Waves,Per"));
+  }
+  if (has(Idx_PRECIP_TOT)) AddRow(RAINFALL, _("Rainfall"));
+  if (has(Idx_CLOUD_TOT)) AddRow(CLOUD, _("Cloud Cover"));
+  if (has(Idx_AIR_TEMP)) AddRow(AIR_TEMP, _("Air Temp."));
+  if (has(Idx_SEA_TEMP)) AddRow(SEA_TEMP, _("Sea Temp."));
+  if (has(Idx_CAPE)) AddRow(CAPE, _("CAPE"));
+  if (has(Idx_COMP_REFL)) AddRow(COMP_REFL, _("C. Reflect."));
+  if (has(Idx_SEACURRENT_VX) && has(Idx_SEACURRENT_VY)) {
+    AddRow(CURRENT_DIR, _("Current,Dir"));
+    AddRow(CURRENT_SPEED, _("Current,Speed"));
   }
-  return skn;
 }
 
-wxString GRIBTable::GetPressure(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_PRESSURE]) {
-    double press = recordarray[Idx_PRESSURE]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (press != GRIB_NOTDEF) {
-      press = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::PRESSURE, press);
-      int p =
-          (m_pGDialog->m_OverlaySettings.Settings[GribOverlaySettings::PRESSURE]
-               .m_Units == 2)
-              ? 2
-              : 0;  // if PRESSURE & inHG = two decimals
-      skn.Printf(wxString::Format(
-          _T("%2.*f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                             GribOverlaySettings::PRESSURE),
-          p, (press)));
-    }
-  }
-  return skn;
+void GribTableData::AddRow(RowType type, const wxString &label) {
+  int row = m_rows.size();
+  m_rows.push_back(type);
+  m_rowLabels.push_back(label);
+  if (type == WIND_DIR) m_grid.SetNumericalRow(row, R_WIND);
+  if (type == WAVE_DIR) m_grid.SetNumericalRow(row, R_WAVES);
+  if (type == CURRENT_DIR) m_grid.SetNumericalRow(row, R_CURRENT);
 }
 
-wxString GRIBTable::GetWaves(GribRecord **recordarray, int datatype,
-                             double &wdir) {
-  wxString skn(wxEmptyString);
-  wdir = GRIB_NOTDEF;
-  switch (datatype) {
-    case Idx_HTSIGW:
-      if (recordarray[Idx_HTSIGW]) {
-        double height = recordarray[Idx_HTSIGW]->getInterpolatedValue(
-            m_cursor_lon, m_cursor_lat, true);
-        if (height != GRIB_NOTDEF) {
-          double cheight = m_pGDialog->m_OverlaySettings.CalibrateValue(
-              GribOverlaySettings::WAVE, height);
-          skn.Printf(wxString::Format(
-              _T("%4.1f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                 GribOverlaySettings::WAVE),
-              cheight));
-          m_pDataCellsColour =
-              m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-                  GribOverlaySettings::WAVE, cheight);
-        }
-      }
-      break;
-    case Idx_WVDIR:
-      if (recordarray[Idx_WVDIR]) {
-        double direction = recordarray[Idx_WVDIR]->getInterpolatedValue(
-            m_cursor_lon, m_cursor_lat, true, true);
-        wdir = direction;
-        return skn;
-      }
-      break;
-    case Idx_WVPER:
-      if (recordarray[Idx_WVPER]) {
-        double period = recordarray[Idx_WVPER]->getInterpolatedValue(
-            m_cursor_lon, m_cursor_lat, true);
-        if (period != GRIB_NOTDEF)
-          skn.Printf(wxString::Format(_T("%01ds"), (int)(period + 0.5)));
-      }
-  }
-  return skn;
+// same as the record interpolation of directions
+static double InterpolateDirection(double a0, double a1, double d) {
+  if (a1 - a0 > 180.) a1 -= 360.;
+  if (a0 - a1 > 180.) a1 += 360.;
+  double a = (1 - d) * a0 + d * a1;
+  if (a < 0.) a += 360.;
+  if (a >= 360.) a -= 360.;
+  return a;
 }
 
-wxString GRIBTable::GetRainfall(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_PRECIP_TOT]) {
-    double precip = recordarray[Idx_PRECIP_TOT]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (precip != GRIB_NOTDEF) {
-      precip = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::PRECIPITATION, precip);
-      skn.Printf(_T("%6.2f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                    GribOverlaySettings::PRECIPITATION),
-                 precip);
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::PRECIPITATION, precip);
-    }
-  }
-  return skn;
+double GribTableData::SampleScalar(int idx, time_t time, bool dir) {
+  if (!dir)
+    return m_dialog.getTimeInterpolatedValue(idx, m_lon, m_lat,
+                                             wxDateTime(time), &m_cursors[idx]);
+
+  GribRecordSet *GRS1, *GRS2;
+  double interp;
+  if (!m_dialog.GetBracketingRecordSets(idx, wxDateTime(time), GRS1, GRS2,
+                                        interp))
+    return GRIB_NOTDEF;
+  double v1 = GRS1->m_GribRecordPtrArray[idx]->getInterpolatedValue(
+      m_lon, m_lat, true, true);
+  if (GRS1 == GRS2) return v1;
+  double v2 = GRS2->m_GribRecordPtrArray[idx]->getInterpolatedValue(
+      m_lon, m_lat, true, true);
+  if (v1 == GRIB_NOTDEF || v2 == GRIB_NOTDEF) return GRIB_NOTDEF;
+  return InterpolateDirection(v1, v2, interp);
 }
 
-wxString GRIBTable::GetCloudCover(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_CLOUD_TOT]) {
-    double cloud = recordarray[Idx_CLOUD_TOT]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (cloud != GRIB_NOTDEF) {
-      cloud = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::CLOUD, cloud);
-      skn.Printf(_T("%5.1f "), cloud);
-      skn.Append(m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-          GribOverlaySettings::CLOUD));
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::CLOUD, cloud);
+const GribTableData::Column &GribTableData::GetColumn(int col) {
+  Column &c = m_columns[col];
+  if (c.sampled) return c;
+  c.sampled = true;
+
+  for (int i = 0; i < ROW_TYPE_COUNT; i++) c.values[i] = GRIB_NOTDEF;
+  wxDateTime time(c.time);
+  for (RowType type : m_rows) {
+    double M, A;
+    switch (type) {
+      case WIND_DIR:
+        if (m_dialog.getTimeInterpolatedValues(M, A, Idx_WIND_VX, Idx_WIND_VY,
+                                               m_lon, m_lat, time,
+                                               &m_cursors[Idx_WIND_VX])) {
+          c.values[WIND_SPEED] = M;
+          c.values[WIND_DIR] = A;
+        }
+        break;
+      case WIND_GUST:
+        c.values[type] = SampleScalar(Idx_WIND_GUST, c.time, false);
+        break;
+      case PRESSURE:
+        c.values[type] = SampleScalar(Idx_PRESSURE, c.time, false);
+        break;
+      case WAVE_DIR:
+        c.values[type] = SampleScalar(Idx_WVDIR, c.time, true);
+        break;
+      case WAVE_HSIG:
+        c.values[type] = SampleScalar(Idx_HTSIGW, c.time, false);
+        break;
+      case WAVE_PER:
+        c.values[type] = SampleScalar(Idx_WVPER, c.time, false);
+        break;
+      case RAINFALL:
+        c.values[type] = SampleScalar(Idx_PRECIP_TOT, c.time, false);
+        break;
+      case CLOUD:
+        c.values[type] = SampleScalar(Idx_CLOUD_TOT, c.time, false);
+        break;
+      case AIR_TEMP:
+        c.values[type] = SampleScalar(Idx_AIR_TEMP, c.time, false);
+        break;
+      case SEA_TEMP:
+        c.values[type] = SampleScalar(Idx_SEA_TEMP, c.time, false);
+        break;
+      case CAPE:
+        c.values[type] = SampleScalar(Idx_CAPE, c.time, false);
+        break;
+      case COMP_REFL:
+        c.values[type] = SampleScalar(Idx_COMP_REFL, c.time, false);
+        break;
+      case CURRENT_DIR:
+        if (m_dialog.getTimeInterpolatedValues(
+                M, A, Idx_SEACURRENT_VX, Idx_SEACURRENT_VY, m_lon, m_lat, time,
+                &m_cursors[Idx_SEACURRENT_VX])) {
+          c.values[CURRENT_SPEED] = M;
+          c.values[CURRENT_DIR] = A;
+        }
+        break;
+      default:  // sampled with their direction
+        break;
     }
   }
-  return skn;
+  return c;
 }
 
-wxString GRIBTable::GetAirTemp(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_AIR_TEMP]) {
-    double temp = recordarray[Idx_AIR_TEMP]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (temp != GRIB_NOTDEF) {
-      temp = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::AIR_TEMPERATURE, temp);
-      skn.Printf(_T("%5.1f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                    GribOverlaySettings::AIR_TEMPERATURE),
-                 temp);
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::AIR_TEMPERATURE, temp);
-    }
-  }
-  return skn;
+wxString GribTableData::GetValue(int row, int col) {
+  RowType type = m_rows[row];
+  // direction rows are drawn by their renderer
+  if (type == WIND_DIR || type == WAVE_DIR || type == CURRENT_DIR)
+    return wxEmptyString;
+  wxColour colour;
+  return Format(type, GetColumn(col).values[type], colour);
 }
 
-wxString GRIBTable::GetSeaTemp(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_SEA_TEMP]) {
-    double temp = recordarray[Idx_SEA_TEMP]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (temp != GRIB_NOTDEF) {
-      temp = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::SEA_TEMPERATURE, temp);
-      skn.Printf(_T("%5.1f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                                    GribOverlaySettings::SEA_TEMPERATURE),
-                 temp);
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::SEA_TEMPERATURE, temp);
-    }
-  }
-  return skn;
+bool GribTableData::IsEmptyCell(int row, int col) {
+  return GetValue(row, col).IsEmpty();
 }
 
-wxString GRIBTable::GetCAPE(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_CAPE]) {
-    double cape = recordarray[Idx_CAPE]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (cape != GRIB_NOTDEF) {
-      cape = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::CAPE, cape);
-      skn.Printf(wxString::Format(
-          _T("%5.0f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                             GribOverlaySettings::CAPE),
-          cape));
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::CAPE, cape);
-    }
+wxString GribTableData::GetRowLabelValue(int row) { return m_rowLabels[row]; }
+
+wxString GribTableData::GetColLabelValue(int col) {
+  Column &c = m_columns[col];
+  if (c.label.IsEmpty()) {
+    DateTimeFormatOptions opts = DateTimeFormatOptions().SetFormatString(
+        "$weekday_short_date\n$hour_minutes");
+    c.label = toUsrDateTimeFormat_Plugin(wxDateTime(c.time), opts);
   }
-  return skn;
+  return c.label;
 }
 
-wxString GRIBTable::GetCompRefl(GribRecord **recordarray) {
-  wxString skn(wxEmptyString);
-  if (recordarray[Idx_COMP_REFL]) {
-    double refl = recordarray[Idx_COMP_REFL]->getInterpolatedValue(
-        m_cursor_lon, m_cursor_lat, true);
-
-    if (refl != GRIB_NOTDEF) {
-      refl = m_pGDialog->m_OverlaySettings.CalibrateValue(
-          GribOverlaySettings::COMP_REFL, refl);
-      skn.Printf(wxString::Format(
-          _T("%5.0f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                             GribOverlaySettings::COMP_REFL),
-          refl));
-      m_pDataCellsColour =
-          m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-              GribOverlaySettings::COMP_REFL, refl);
+wxGridCellAttr *GribTableData::GetAttr(int row, int col,
+                                       wxGridCellAttr::wxAttrKind kind) {
+  wxGridCellAttr *attr = new wxGridCellAttr();
+  attr->SetFont(m_font);
+  attr->SetAlignment(wxALIGN_CENTRE, wxALIGN_CENTRE);
+
+  RowType type = m_rows[row];
+  double value = GetColumn(col).values[type];
+  int numerical = wxNOT_FOUND;
+  if (type == WIND_DIR) numerical = R_WIND;
+  if (type == WAVE_DIR) numerical = R_WAVES;
+  if (type == CURRENT_DIR) numerical = R_CURRENT;
+  if (numerical != wxNOT_FOUND) {
+    bool digit = m_grid.IsDigitRow(numerical);
+    /*Current direction is generally reported as the "flow" direction,which is
+     * opposite from wind convention. So, adjust.*/
+    if (numerical == R_CURRENT && digit && value != GRIB_NOTDEF) {
+      value += 180;
+      if (value >= 360) value -= 360;
+      if (value < 0) value += 360;
     }
+    attr->SetRenderer(new CustomRenderer(value, digit));
+    return attr;
   }
-  return skn;
+
+  wxColour colour = m_defaultColour;
+  Format(type, value, colour);
+  attr->SetBackgroundColour(colour);
+  return attr;
 }
 
-wxString GRIBTable::GetCurrent(GribRecord **recordarray, int datatype,
-                               double &wdir) {
-  wxString skn(wxEmptyString);
-  double vkn, ang;
-  wdir = GRIB_NOTDEF;
-  if (GribRecord::getInterpolatedValues(
-          vkn, ang, recordarray[Idx_SEACURRENT_VX],
-          recordarray[Idx_SEACURRENT_VY], m_cursor_lon, m_cursor_lat)) {
-    if (datatype == 1) {
-      wdir = ang;
+wxString GribTableData::Format(RowType type, double value,
+                               wxColour &colour) const {
+  if (value == GRIB_NOTDEF) return wxEmptyString;
+
+  GribOverlaySettings &settings = m_dialog.m_OverlaySettings;
+  GRIBOverlayFactory *factory = m_dialog.pPlugIn->m_pGRIBOverlayFactory;
+  bool bfs = settings.Settings[GribOverlaySettings::WIND].m_Units ==
+             GribOverlaySettings::BFS;
+  int layer;
+  wxString skn;
+  switch (type) {
+    case WIND_SPEED:
+    case WIND_GUST: {
+      layer = type == WIND_SPEED ? GribOverlaySettings::WIND
+                                 : GribOverlaySettings::WIND_GUST;
+      double cvkn = settings.CalibrateValue(layer, value);
+      colour = factory->GetGraphicColor(layer, cvkn);
+      skn = wxString::Format(
+          _T("%2d bf"), (int)wxRound(settings.GetmstobfFactor(value) * value));
+      if (!bfs)  // wind speed unit other than bf
+        skn.Prepend(wxString::Format(_T("%2d ") + settings.GetUnitSymbol(layer),
+                                     (int)wxRound(cvkn)) +
+                    _T(" - "));
       return skn;
     }
-    vkn = m_pGDialog->m_OverlaySettings.CalibrateValue(
-        GribOverlaySettings::CURRENT, vkn);
-    skn.Printf(wxString::Format(
-        _T("%4.1f ") + m_pGDialog->m_OverlaySettings.GetUnitSymbol(
-                           GribOverlaySettings::CURRENT),
-        vkn));
-    m_pDataCellsColour =
-        m_pGDialog->pPlugIn->m_pGRIBOverlayFactory->GetGraphicColor(
-            GribOverlaySettings::CURRENT, vkn);
+    case PRESSURE: {
+      value = settings.CalibrateValue(GribOverlaySettings::PRESSURE, value);
+      // if PRESSURE & inHG = two decimals
+      int p = (settings.Settings[GribOverlaySettings::PRESSURE].m_Units == 2)
+                  ? 2
+                  : 0;
+      return wxString::Format(
+          _T("%2.*f ") +
+              settings.GetUnitSymbol(GribOverlaySettings::PRESSURE),
+          p, value);
+    }
+    case WAVE_PER:
+      return wxString::Format(_T("%01ds"), (int)(value + 0.5));
+    case WAVE_HSIG:
+      layer = GribOverlaySettings::WAVE;
+      skn = _T("%4.1f ");
+      break;
+    case RAINFALL:
+      layer = GribOverlaySettings::PRECIPITATION;
+      skn = _T("%6.2f ");
+      break;
+    case CLOUD:
+      layer = GribOverlaySettings::CLOUD;
+      skn = _T("%5.1f ");
+      break;
+    case AIR_TEMP:
+      layer = GribOverlaySettings::AIR_TEMPERATURE;
+      skn = _T("%5.1f ");
+      break;
+    case SEA_TEMP:
+      layer = GribOverlaySettings::SEA_TEMPERATURE;
+      skn = _T("%5.1f ");
+      break;
+    case CAPE:
+      layer = GribOverlaySettings::CAPE;
+      skn = _T("%5.0f ");
+      break;
+    case COMP_REFL:
+      layer = GribOverlaySettings::COMP_REFL;
+      skn = _T("%5.0f ");
+      break;
+    case CURRENT_SPEED:
+      layer = GribOverlaySettings::CURRENT;
+      skn = _T("%4.1f ");
+      break;
+    default:
+      return wxEmptyString;
   }
-  return skn;
+  value = settings.CalibrateValue(layer, value);
+  colour = factory->GetGraphicColor(layer, value);
+  return wxString::Format(skn + settings.GetUnitSymbol(layer), value);
 }
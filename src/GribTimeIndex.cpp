@@ -0,0 +1,68 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribTimeIndex.h
+ */
+
+#include "GribTimeIndex.h"
+
+#include <algorithm>
+
+void GribTimeIndex::Clear() {
+  m_times.clear();
+  m_sets.clear();
+}
+
+void GribTimeIndex::Add(time_t time, unsigned int set) {
+  m_times.push_back(time);
+  m_sets.push_back(set);
+}
+
+size_t GribTimeIndex::LowerBound(time_t time) const {
+  return std::lower_bound(m_times.begin(), m_times.end(), time) -
+         m_times.begin();
+}
+
+// time falls in [Time(k), Time(k + 1))
+bool GribTimeIndex::Around(size_t k, time_t time) const {
+  return k < m_times.size() && m_times[k] <= time &&
+         (k + 1 == m_times.size() || time < m_times[k + 1]);
+}
+
+bool GribTimeIndex::Bracket(time_t time, size_t &before, size_t &after,
+                            GribTimeCursor *cursor) const {
+  before = after = NONE;
+  if (m_times.empty()) return false;
+
+  size_t k;
+  if (cursor && Around(cursor->pos, time))
+    k = cursor->pos;
+  else if (cursor && Around(cursor->pos + 1, time))
+    k = cursor->pos + 1;
+  else {
+    k = std::upper_bound(m_times.begin(), m_times.end(), time) -
+        m_times.begin();
+    if (k == 0) {
+      // Before the first one
+      if (cursor) cursor->pos = 0;
+      after = 0;
+      return false;
+    }
+    k--;
+  }
+  if (cursor) cursor->pos = k;
+
+  before = k;
+  if (m_times[k] == time)
+    after = k;
+  else if (k + 1 < m_times.size())
+    after = k + 1;
+  return after != NONE;
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribTimelineWorker.h
+ */
+
+#include "GribTimelineWorker.h"
+
+#include <algorithm>
+
+#include "GribUIDialog.h"
+
+// Frames are independent, a couple of threads keep up with playback without
+// taking every core away from the chart rendering.
+static const unsigned int MAX_THREADS = 2;
+
+GribTimelineWorker::Frame::~Frame() { delete set; }
+
+GribTimelineWorker::GribTimelineWorker() {
+  unsigned int threads = std::thread::hardware_concurrency() / 2;
+  threads = std::max(1u, std::min(threads, MAX_THREADS));
+  for (unsigned int i = 0; i < threads; i++)
+    m_threads.emplace_back(&GribTimelineWorker::Run, this);
+}
+
+GribTimelineWorker::~GribTimelineWorker() { Stop(); }
+
+std::shared_ptr<GribTimelineWorker::Frame> GribTimelineWorker::Find(
+    time_t time) {
+  for (auto &frame : m_frames)
+    if (frame->time == time) return frame;
+  return nullptr;
+}
+
+void GribTimelineWorker::DropAll(std::unique_lock<std::mutex> &lock) {
+  for (auto &frame : m_frames) frame->cancelled = true;
+  m_frames.clear();
+  m_idle.wait(lock, [this] { return m_running == 0; });
+}
+
+void GribTimelineWorker::SetBuilder(Builder builder) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  DropAll(lock);
+  m_builder = builder;
+}
+
+void GribTimelineWorker::Request(const std::vector<time_t> &times) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) return;
+
+    std::list<std::shared_ptr<Frame>> frames;
+    for (time_t time : times) {
+      std::shared_ptr<Frame> frame = Find(time);
+      if (frame)
+        m_frames.remove(frame);
+      else {
+        frame = std::make_shared<Frame>();
+        frame->time = time;
+      }
+      frames.push_back(frame);
+    }
+
+    // What is left fell out of the window
+    for (auto &frame : m_frames) frame->cancelled = true;
+    m_frames.swap(frames);
+  }
+  m_cv.notify_all();
+}
+
+GribTimelineWorker::State GribTimelineWorker::GetState(time_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::shared_ptr<Frame> frame = Find(time);
+  if (!frame) return UNKNOWN;
+  return frame->done ? READY : PENDING;
+}
+
+GribTimelineRecordSet *GribTimelineWorker::Take(time_t time) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::shared_ptr<Frame> frame = Find(time);
+  if (!frame || !frame->done) return nullptr;
+
+  GribTimelineRecordSet *set = frame->set;
+  frame->set = nullptr;
+  m_frames.remove(frame);
+  return set;
+}
+
+void GribTimelineWorker::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+    DropAll(lock);
+    m_builder = nullptr;
+  }
+  m_cv.notify_all();
+  for (std::thread &thread : m_threads)
+    if (thread.joinable()) thread.join();
+  m_threads.clear();
+}
+
+void GribTimelineWorker::Run() {
+  for (;;) {
+    std::shared_ptr<Frame> frame;
+    Builder builder;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this, &frame] {
+        if (m_stop) return true;
+        if (!m_builder) return false;
+        // Nearest position first
+        for (auto &f : m_frames)
+          if (!f->running && !f->done) {
+            frame = f;
+            return true;
+          }
+        return false;
+      });
+      if (m_stop) return;
+      frame->running = true;
+      builder = m_builder;
+      m_running++;
+    }
+
+    GribTimelineRecordSet *set = builder(frame->time);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      frame->running = false;
+      frame->done = true;
+      if (frame->cancelled)
+        delete set;
+      else
+        frame->set = set;
+      m_running--;
+    }
+    m_idle.notify_all();
+  }
+}
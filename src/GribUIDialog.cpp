@@ -40,12 +40,16 @@
 #include <math.h>
 #include <time.h>
 
+#include <algorithm>
+#include <chrono>
+
 #include "ocpn_plugin.h"
 #include "DpGrib_pi.h"
 #include "GribTable.h"
 #include "email.h"
 #include "folder.xpm"
 #include "GribUIDialog.h"
+#include "GribRecordSetBuilder.h"
 #include <wx/arrimpl.cpp>
 
 #ifdef __ANDROID__
@@ -110,6 +114,17 @@ int round(double x) {
 
 WX_DEFINE_OBJARRAY(ArrayOfGribRecordSets);
 
+// Most timeline steps a single playback frame may advance
+static const int MAX_PLAYBACK_STRIDE = 16;
+
+// Playback is paced on a monotonic clock: the MFD's wall clock steps on
+// GPS/NTP sync.
+static double PlaybackClockMs() {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 //    Sort compare function for File Modification Time
 static int CompareFileStringTime(const wxString &first,
                                  const wxString &second) {
@@ -142,12 +157,27 @@ wxWindow *GetGRIBCanvas() {
    screen */
 GribTimelineRecordSet::GribTimelineRecordSet(unsigned int cnt)
     : GribRecordSet(cnt) {
-  for (int i = 0; i < Idx_COUNT; i++) m_IsobarArray[i] = nullptr;
+  for (int i = 0; i < Idx_COUNT; i++) {
+    m_IsobarArray[i] = nullptr;
+    m_MagnitudeArray[i] = nullptr;
+  }
 }
 
 GribTimelineRecordSet::~GribTimelineRecordSet() {
   // RemoveGribRecords();
   ClearCachedData();
+  for (int i = 0; i < Idx_COUNT; i++) delete m_MagnitudeArray[i];
+}
+
+GribRecord *GribTimelineRecordSet::GetMagnitudeRecord(int idx, int idy) {
+  if (idx < 0 || idx >= Idx_COUNT || idy < 0 || idy >= Idx_COUNT)
+    return nullptr;
+  if (!m_GribRecordPtrArray[idx] || !m_GribRecordPtrArray[idy]) return nullptr;
+
+  if (!m_MagnitudeArray[idx])
+    m_MagnitudeArray[idx] = GribRecord::MagnitudeRecord(
+        *m_GribRecordPtrArray[idx], *m_GribRecordPtrArray[idy]);
+  return m_MagnitudeArray[idx];
 }
 
 void GribTimelineRecordSet::ClearCachedData() {
@@ -181,6 +211,13 @@ GRIBUICtrlBar::GRIBUICtrlBar(wxWindow *parent, wxWindowID id,
   pReq_Dialog = nullptr;
   m_bGRIBActiveFile = nullptr;
   m_pTimelineSet = nullptr;
+  m_playbackLookAhead = 3;
+  m_playbackFile = 0;
+  m_playbackAltitude = -1;
+  m_playbackPeriodMs = m_playbackStartMs = m_playbackLastMs = 0.;
+  m_playbackDueMs = m_playbackPrepMs = 0.;
+  m_playbackStride = 1;
+  m_playbackSteps = 0;
   m_gCursorData = nullptr;
   m_gGRIBUICData = nullptr;
   m_gtk_started = false;
@@ -256,6 +293,8 @@ GRIBUICtrlBar::GRIBUICtrlBar(wxWindow *parent, wxWindowID id,
 
     pConf->SetPath(_T( "/PlugIns/GRIB" ));
     pConf->Read(_T( "ManualRequestZoneSizing" ), &m_SavedZoneSelMode, 0);
+    // Playback frames prepared ahead of the displayed one (0 to disable)
+    pConf->Read(_T( "PlaybackLookAhead" ), &m_playbackLookAhead, 3);
 
     // Read XyGrib related configuration
     pConf->SetPath(_T ( "/Settings/GRIB/XyGrib" ));
@@ -278,6 +317,7 @@ GRIBUICtrlBar::GRIBUICtrlBar(wxWindow *parent, wxWindowID id,
   }
   // init zone selection parameters
   m_ZoneSelMode = m_SavedZoneSelMode;
+  m_playbackLookAhead = wxMax(0, wxMin(m_playbackLookAhead, 16));
 
   // connect Timer
   m_tPlayStop.Connect(wxEVT_TIMER,
@@ -312,6 +352,13 @@ GRIBUICtrlBar::GRIBUICtrlBar(wxWindow *parent, wxWindowID id,
 }
 
 GRIBUICtrlBar::~GRIBUICtrlBar() {
+  // No more files arriving, and none being merged
+  m_dirWatcher.Stop();
+  if (m_ingestThread.joinable()) m_ingestThread.join();
+
+  // Playback frames read the active file
+  m_timelineWorker.Stop();
+
   // Free per-canvas timeline overrides (owned here).
   for (int ci = 0; ci < 2; ci++) {
     delete m_pTimelineSetByCanvas[ci];
@@ -443,7 +490,9 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
   // Drop per-canvas time overrides before the record array is freed — their
   // interpolated sets reference the old array, so they must not survive the load.
   ResetCanvasTimeOverrides();
-  delete m_bGRIBActiveFile;
+  m_timelineWorker.SetBuilder(nullptr);
+  m_playbackFile = 0;
+  m_bGRIBActiveFile.reset();
   delete m_pTimelineSet;
   m_pTimelineSet = nullptr;
   m_sTimeline->SetValue(0);
@@ -465,8 +514,9 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
     newestFile = true;
   }
 
-  m_bGRIBActiveFile = new GRIBFile(m_file_names, pPlugIn->GetCopyFirstCumRec(),
-                                   pPlugIn->GetCopyMissWaveRec(), newestFile);
+  m_bGRIBActiveFile = std::make_shared<GRIBFile>(
+      m_file_names, pPlugIn->GetCopyFirstCumRec(),
+      pPlugIn->GetCopyMissWaveRec(), newestFile);
 
   ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
   wxString title;
@@ -475,8 +525,7 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
     title = (_("File: "));
     title.Append(fn.GetFullName());
     if (rsa->GetCount() == 0) {  // valid but empty file
-      delete m_bGRIBActiveFile;
-      m_bGRIBActiveFile = nullptr;
+      m_bGRIBActiveFile.reset();
       title.Prepend(_("Error! ")).Append(_(" contains no valid data!"));
     } else {
       PopulateComboDataList();
@@ -510,8 +559,7 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
       }
     }
   } else {
-    delete m_bGRIBActiveFile;
-    m_bGRIBActiveFile = nullptr;
+    m_bGRIBActiveFile.reset();
     title = _("No valid GRIB file");
   }
   pPlugIn->GetGRIBOverlayFactory()->SetMessage(title);
@@ -559,6 +607,8 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
 
   SetCanvasContextMenuItemViz(pPlugIn->m_MenuItem, m_TimeLineHours != 0);
 
+  UpdateDirectoryWatch();
+
   //
   if (m_bGRIBActiveFile == nullptr) {
     // there's no data we can use in this file
@@ -619,6 +669,140 @@ void GRIBUICtrlBar::OpenFile(bool newestFile) {
   }
 }
 
+void GRIBUICtrlBar::UpdateDirectoryWatch() {
+  if (!pPlugIn->Internal_IsDirectoryWatchEnabled() ||
+      !wxDir::Exists(m_grib_dir)) {
+    m_dirWatcher.Stop();
+    return;
+  }
+  std::string dir(m_grib_dir.mb_str(wxConvFile));
+  if (m_dirWatcher.IsRunning() && m_dirWatcher.GetDirectory() == dir) return;
+
+  // Same files as GetFilesInDirectory()
+  m_dirWatcher.Start(
+      dir, ".+\\.gri?b2?(\\.(bz2|gz))?",
+      [this](const std::vector<std::string> &files) {
+        CallAfter([this, files]() {
+          wxArrayString names;
+          for (const std::string &f : files)
+            names.Add(wxString(f.c_str(), wxConvFile));
+          IngestFiles(names);
+        });
+      });
+}
+
+void GRIBUICtrlBar::IngestFiles(const wxArrayString &files) {
+  for (const wxString &f : files)
+    if (m_ingestQueue.Index(f) == wxNOT_FOUND) m_ingestQueue.Add(f);
+  if (m_ingestThread.joinable() || m_ingestQueue.IsEmpty()) return;
+
+  // Nothing to merge into: the newest file is the forecast
+  if (!m_bGRIBActiveFile || !m_bGRIBActiveFile->IsOK()) {
+    m_ingestQueue.Clear();
+    OpenFile(true);
+    return;
+  }
+
+  std::shared_ptr<GRIBFile> base = m_bGRIBActiveFile;
+  wxArrayString names = m_ingestQueue;
+  m_ingestQueue.Clear();
+  bool cumRec = pPlugIn->GetCopyFirstCumRec(),
+       waveRec = pPlugIn->GetCopyMissWaveRec();
+  m_ingestThread = std::thread([this, base, names, cumRec, waveRec]() {
+    std::shared_ptr<GRIBFile> merged;
+    {
+      // Grids are read by the loads while the GUI thread may Trim()
+      GribResidency::ReadGuard guard;
+      merged = std::make_shared<GRIBFile>(base, names, cumRec, waveRec);
+      if (merged->NeedsFullLoad()) {
+        wxArrayString all = base->GetFileNames();
+        for (const wxString &name : names)
+          if (all.Index(name) == wxNOT_FOUND) all.Add(name);
+        merged = std::make_shared<GRIBFile>(all, cumRec, waveRec);
+      }
+    }
+    CallAfter([this, base, merged]() { OnFilesIngested(base, merged); });
+  });
+}
+
+void GRIBUICtrlBar::OnFilesIngested(std::shared_ptr<GRIBFile> base,
+                                    std::shared_ptr<GRIBFile> merged) {
+  m_ingestThread.join();
+  if (!merged->IsOK())
+    wxLogMessage("GRIBUICtrlBar::OnFilesIngested - %s",
+                 merged->GetLastMessage());
+  else if (m_bGRIBActiveFile == base)  // not replaced by OpenFile meanwhile
+    SwapActiveFile(merged);
+
+  // Files which arrived during the merge
+  IngestFiles(wxArrayString());
+}
+
+void GRIBUICtrlBar::SwapActiveFile(const std::shared_ptr<GRIBFile> &file) {
+  // The view stays at its time, the canvas overrides at theirs
+  wxDateTime time = TimelineTime();
+  time_t canvasTime[2];
+  for (int ci = 0; ci < 2; ci++)
+    canvasTime[ci] = m_canvasTimeIndex[ci] >= 0
+                         ? TimelineTimeForCanvas(ci).GetTicks()
+                         : 0;
+
+  // Timeline sets hold records of the previous file until rebuilt below
+  std::shared_ptr<GRIBFile> previous = m_bGRIBActiveFile;
+  m_timelineWorker.SetBuilder(nullptr);
+  m_playbackFile = 0;
+  pPlugIn->GetGRIBOverlayFactory()->ClearParticles();
+  m_bGRIBActiveFile = file;
+  m_file_names = file->GetFileNames();
+
+  ArrayOfGribRecordSets *rsa = file->GetRecordSetArrayPtr();
+  const GribTimeIndex &index = file->GetSetTimeIndex();
+  RestaureSelectionString();
+  PopulateComboDataList();
+  m_TimeLineHours = wxTimeSpan(wxDateTime(index.Time(index.Size() - 1)) -
+                               wxDateTime(index.Time(0)))
+                        .GetHours();
+  SetTimeLineMax(false);
+  m_cRecordForecast->SetSelection(
+      (int)std::min(index.LowerBound(time.GetTicks()), index.Size() - 1));
+  if (m_InterpolateMode) m_sTimeline->SetValue(GetNearestValue(time, 0));
+
+  SetFactoryOptions();
+  TimelineChanged();
+  for (int ci = 0; ci < 2; ci++) {
+    if (m_canvasTimeIndex[ci] < 0) continue;
+    m_canvasTimeIndex[ci] = (int)std::min(index.LowerBound(canvasTime[ci]),
+                                          index.Size() - 1);
+    TimelineChangedForCanvas(ci);
+  }
+
+  for (int i = 1; i < 5; i++) {
+    if (file->m_GribIdxArray.Index(Idx_WIND_VX + i) != wxNOT_FOUND &&
+        file->m_GribIdxArray.Index(Idx_WIND_VY + i) != wxNOT_FOUND)
+      m_HasAltitude = true;
+  }
+
+  wxFileName fn(m_file_names.Last());
+  wxString title = _("File: ");
+  title.Append(fn.GetFullName());
+  title.append(" (" +
+               toUsrDateTimeFormat_Plugin(wxDateTime(file->GetRefDateTime())) +
+               ")");
+  pPlugIn->GetGRIBOverlayFactory()->SetMessage(title);
+  SetTitle(title);
+
+  m_sTimeline->Enable(m_TimeLineHours);
+  m_bpPlay->Enable(m_TimeLineHours);
+  m_bpPrev->Enable(m_TimeLineHours);
+  m_bpNext->Enable(m_TimeLineHours);
+  m_bpNow->Enable(m_TimeLineHours);
+  SetCanvasContextMenuItemViz(pPlugIn->m_MenuItem, m_TimeLineHours != 0);
+
+  if (pPlugIn->GetGribAPI()) pPlugIn->GetGribAPI()->NotifyDataChanged();
+  wxLogMessage("GRIBUICtrlBar::SwapActiveFile - %d files, timesteps: %d",
+               (int)m_file_names.GetCount(), (int)rsa->GetCount());
+}
+
 bool GRIBUICtrlBar::GetGribZoneLimits(GribTimelineRecordSet *timelineSet,
                                       double *latmin, double *latmax,
                                       double *lonmin, double *lonmax) {
@@ -1304,11 +1488,102 @@ void GRIBUICtrlBar::OnPlayStop(wxCommandEvent &event) {
     m_tPlayStop.Start(3000 / m_OverlaySettings.m_UpdatesPerSecond,
                       wxTIMER_CONTINUOUS);
     m_InterpolateMode = m_OverlaySettings.m_bInterpolate;
+    StartPlaybackPacing();
+    RequestPlaybackFrames(TimelineTime());
+  }
+}
+
+void GRIBUICtrlBar::StartPlaybackPacing() {
+  double now = PlaybackClockMs();
+  m_playbackPeriodMs = m_tPlayStop.GetInterval();
+  m_playbackStartMs = m_playbackLastMs = now;
+  m_playbackDueMs = now + m_playbackPeriodMs;
+  m_playbackPrepMs = 0.;
+  m_playbackStride = 1;
+  m_playbackSteps = 0;
+  m_playbackStats = DpGrib::PlaybackStats();
+  pPlugIn->GetGRIBOverlayFactory()->TakeRenderMs();
+}
+
+int GRIBUICtrlBar::PlaybackStepsDue() {
+  double now = PlaybackClockMs();
+  double period = m_tPlayStop.GetInterval();
+
+  // A new speed restarts the schedule
+  if (period != m_playbackPeriodMs) StartPlaybackPacing();
+
+  // Timer events may come a little early or late, round to the nearest step
+  if (now < m_playbackDueMs - period / 2) return 0;
+  int steps = 1 + (int)((now - m_playbackDueMs + period / 2) / period);
+
+  // After a long stall (modal dialog, suspended system...) resume from here
+  // rather than jump far ahead
+  if (steps > MAX_PLAYBACK_STRIDE) {
+    m_playbackDueMs = now;
+    steps = 1;
   }
+  return steps;
+}
+
+DpGrib::PlaybackStats GRIBUICtrlBar::GetPlaybackStats() {
+  DpGrib::PlaybackStats stats = m_playbackStats;
+  stats.playing = m_tPlayStop.IsRunning();
+  stats.targetIntervalMs = m_playbackPeriodMs;
+  stats.stride = m_playbackStride;
+
+  double elapsed = m_playbackLastMs - m_playbackStartMs;
+  if (elapsed > 0.) {
+    stats.achievedRate = 1000. * m_playbackSteps / elapsed;
+    stats.shownRate = 1000. * stats.shownFrames / elapsed;
+  }
+  return stats;
 }
 
 void GRIBUICtrlBar::OnPlayStopTimer(wxTimerEvent &event) {
+  // The timeline advances one step per timer period whatever the frames
+  // cost: steps that fell due while the previous frame was prepared and
+  // rendered are skipped.
+  int steps = PlaybackStepsDue();
+  if (!steps) return;
+
+  if (!m_pNowMode && m_sTimeline->GetValue() < m_sTimeline->GetMax()) {
+    std::vector<wxDateTime> next;
+    GetNextTimelineTimes(TimelineTime(), steps, next);
+    if ((int)next.size() == steps) {
+      // Rather than build a frame inside the tick, show the latest one the
+      // worker has ready, or hold the current one while the due one is built
+      GribTimelineWorker::State state =
+          m_timelineWorker.GetState(next.back().GetTicks());
+      if (state != GribTimelineWorker::READY) {
+        int ready = steps - 1;
+        while (ready > 0 && m_timelineWorker.GetState(
+                                next[ready - 1].GetTicks()) !=
+                                GribTimelineWorker::READY)
+          ready--;
+        if (ready)
+          steps = ready;
+        else if (state == GribTimelineWorker::PENDING)
+          return;
+      }
+    }
+  }
+
+  // Cost of the frame on screen, now that it was rendered
+  if (m_playbackStats.shownFrames) {
+    double cost = m_playbackPrepMs +
+                  pPlugIn->GetGRIBOverlayFactory()->TakeRenderMs();
+    m_playbackStats.frameCostMs =
+        m_playbackStats.frameCostMs
+            ? 0.75 * m_playbackStats.frameCostMs + 0.25 * cost
+            : cost;
+    m_playbackStride =
+        wxMax(1, wxMin((int)ceil(m_playbackStats.frameCostMs /
+                                 m_tPlayStop.GetInterval()),
+                       MAX_PLAYBACK_STRIDE));
+  }
+
   if (m_sTimeline->GetValue() >= m_sTimeline->GetMax()) {
+    steps = 1;
     if (m_OverlaySettings.m_bLoopMode) {
       if (m_OverlaySettings.m_LoopStartPoint) {
         ComputeBestForecastForNow();
@@ -1326,18 +1601,29 @@ void GRIBUICtrlBar::OnPlayStopTimer(wxTimerEvent &event) {
                                  ? GetNearestValue(GetNow(), 1)
                                  : GetNearestIndex(GetNow(), 2)
                            : m_sTimeline->GetValue();
-    m_sTimeline->SetValue(value + 1);
+    steps = wxMax(1, wxMin(steps, m_sTimeline->GetMax() - value));
+    m_sTimeline->SetValue(value + steps);
   }
 
+  m_playbackDueMs += steps * m_tPlayStop.GetInterval();
+  m_playbackSteps += steps;
+  m_playbackStats.skippedSteps += steps - 1;
+  m_playbackStats.shownFrames++;
+
   m_pNowMode = false;
   if (!m_InterpolateMode)
     m_cRecordForecast->SetSelection(m_sTimeline->GetValue());
+
+  double start = PlaybackClockMs();
   TimelineChanged();
+  m_playbackLastMs = PlaybackClockMs();
+  m_playbackPrepMs = m_playbackLastMs - start;
 }
 
 void GRIBUICtrlBar::StopPlayBack() {
   if (m_tPlayStop.IsRunning()) {
     m_tPlayStop.Stop();
+    m_timelineWorker.Request(std::vector<time_t>());
     m_bpPlay->SetBitmapLabel(
         GetScaledBitmap(wxBitmap(play), _T("play"), m_ScaledFactor));
     m_bpPlay->SetToolTip(_("Start play back"));
@@ -1354,7 +1640,7 @@ void GRIBUICtrlBar::TimelineChanged() {
                               // label
 
   wxDateTime time = TimelineTime();
-  SetGribTimelineRecordSet(GetTimeLineRecordSet(time));
+  SetGribTimelineRecordSet(TakeTimeLineRecordSet(time));
 
   if (!m_InterpolateMode) {
     /* get closest value to update timeline */
@@ -1379,6 +1665,9 @@ void GRIBUICtrlBar::TimelineChanged() {
 
   UpdateTrackingControl();
 
+  // Between frames nothing holds grid pointers: a good time to evict
+  GribResidency::Get().Trim();
+
   pPlugIn->SendTimelineMessage(time);
   RequestRefresh(GetGRIBCanvas());
 }
@@ -1394,15 +1683,13 @@ void GRIBUICtrlBar::RestaureSelectionString() {
 
 int GRIBUICtrlBar::GetNearestIndex(wxDateTime time, int model) {
   /* get closest index to update combo box */
-  size_t i;
-  ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
+  const GribTimeIndex &index = m_bGRIBActiveFile->GetSetTimeIndex();
+  if (index.Size() < 2) return 0;
 
-  wxDateTime itime, ip1time;
-  for (i = 0; i < rsa->GetCount() - 1; i++) {
-    itime = rsa->Item(i).m_Reference_Time;
-    ip1time = rsa->Item(i + 1).m_Reference_Time;
-    if (ip1time >= time) break;
-  }
+  // First interval ending at or after time, past the last one if none
+  size_t i = std::max<size_t>(index.LowerBound(time.GetTicks()), 1) - 1;
+  size_t k = std::min(i, index.Size() - 2);
+  wxDateTime itime(index.Time(k)), ip1time(index.Time(k + 1));
   if (!model) return (time - itime > (ip1time - time) * 3) ? i + 1 : i;
 
   return model == 1 ? time == ip1time ? i : i + 1 : time == ip1time ? i + 1 : i;
@@ -1479,51 +1766,32 @@ wxDateTime GRIBUICtrlBar::MinTime() {
 
 GribTimelineRecordSet *GRIBUICtrlBar::GetTimeLineRecordSet(wxDateTime time) {
   if (m_bGRIBActiveFile == nullptr) return nullptr;
-  ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
+  return BuildTimeLineRecordSet(m_bGRIBActiveFile.get(), time);
+}
 
-  if (rsa->GetCount() == 0) return nullptr;
+GribTimelineRecordSet *GRIBUICtrlBar::BuildTimeLineRecordSet(GRIBFile *file,
+                                                             wxDateTime time) {
+  if (file->GetRecordSetArrayPtr()->GetCount() == 0) return nullptr;
 
-  GribTimelineRecordSet *set =
-      new GribTimelineRecordSet(m_bGRIBActiveFile->GetCounter());
+  GribTimelineRecordSet *set = new GribTimelineRecordSet(file->GetCounter());
   for (int i = 0; i < Idx_COUNT; i++) {
-    GribRecordSet *GRS1 = nullptr, *GRS2 = nullptr;
-    GribRecord *GR1 = nullptr, *GR2 = nullptr;
-    wxDateTime GR1time, GR2time;
+    GribRecordSet *GRS1, *GRS2;
+    double interp_const;
 
     // already computed using polar interpolation from first axis
     if (set->m_GribRecordPtrArray[i]) continue;
 
-    unsigned int j;
-    for (j = 0; j < rsa->GetCount(); j++) {
-      GribRecordSet *GRS = &rsa->Item(j);
-      GribRecord *GR = GRS->m_GribRecordPtrArray[i];
-      if (!GR) continue;
-
-      wxDateTime curtime = GRS->m_Reference_Time;
-      if (curtime <= time) GR1time = curtime, GRS1 = GRS, GR1 = GR;
-
-      if (curtime >= time) {
-        GR2time = curtime, GRS2 = GRS, GR2 = GR;
-        break;
-      }
-    }
-
-    if (!GR1 || !GR2) continue;
-
-    wxDateTime mintime = MinTime();
-    double minute2 = (GR2time - mintime).GetMinutes();
-    double minute1 = (GR1time - mintime).GetMinutes();
-    double nminute = (time - mintime).GetMinutes();
+    if (!GetBracketingRecordSets(file, i, time, GRS1, GRS2, interp_const))
+      continue;
 
-    if (minute2 < minute1 || nminute < minute1 || nminute > minute2) continue;
+    GribRecord *GR1 = GRS1->m_GribRecordPtrArray[i];
+    GribRecord *GR2 = GRS2->m_GribRecordPtrArray[i];
 
-    double interp_const;
-    if (minute1 == minute2) {
+    if (GRS1 == GRS2) {
       // with big grib a copy is slow use a reference.
       set->m_GribRecordPtrArray[i] = GR1;
       continue;
-    } else
-      interp_const = (nminute - minute1) / (minute2 - minute1);
+    }
 
     /* if this is a vector interpolation use the 2d method */
     if (i < Idx_WIND_VY) {
@@ -1562,6 +1830,130 @@ GribTimelineRecordSet *GRIBUICtrlBar::GetTimeLineRecordSet(wxDateTime time) {
   return set;
 }
 
+GribTimelineRecordSet *GRIBUICtrlBar::TakeTimeLineRecordSet(wxDateTime time) {
+  GribTimelineRecordSet *set = nullptr;
+  if (m_bGRIBActiveFile && m_playbackFile == m_bGRIBActiveFile->GetCounter())
+    set = m_timelineWorker.Take(time.GetTicks());
+  if (!set) set = GetTimeLineRecordSet(time);
+
+  if (m_tPlayStop.IsRunning()) RequestPlaybackFrames(time);
+  return set;
+}
+
+void GRIBUICtrlBar::RequestPlaybackFrames(wxDateTime time) {
+  if (!m_bGRIBActiveFile || !m_bGRIBActiveFile->IsOK()) return;
+
+  // Frames are built for one file and one altitude
+  if (m_playbackFile != m_bGRIBActiveFile->GetCounter() ||
+      m_playbackAltitude != m_Altitude) {
+    GRIBFile *file = m_bGRIBActiveFile.get();
+    int altitude = m_Altitude;
+    m_timelineWorker.SetBuilder([file, altitude](time_t t) {
+      GribResidency::ReadGuard guard;
+      GribTimelineRecordSet *set = BuildTimeLineRecordSet(file, wxDateTime(t));
+      if (set) {
+        // The magnitudes drawn by the overlay map and numbers
+        set->GetMagnitudeRecord(Idx_WIND_VX + altitude,
+                                Idx_WIND_VY + altitude);
+        set->GetMagnitudeRecord(Idx_SEACURRENT_VX, Idx_SEACURRENT_VY);
+      }
+      return set;
+    });
+    m_playbackFile = file->GetCounter();
+    m_playbackAltitude = m_Altitude;
+  }
+
+  // Slow frames skip steps: only prepare those that will be shown
+  int count = m_playbackLookAhead * m_playbackStride;
+  std::vector<wxDateTime> next;
+  GetNextTimelineTimes(time, count, next);
+
+  // Looping playback restarts from the beginning of the file
+  if ((int)next.size() < count && m_OverlaySettings.m_bLoopMode &&
+      !m_OverlaySettings.m_LoopStartPoint) {
+    wxDateTime first = MinTime();
+    next.push_back(first);
+    std::vector<wxDateTime> more;
+    GetNextTimelineTimes(first, count - next.size(), more);
+    next.insert(next.end(), more.begin(), more.end());
+  }
+
+  std::vector<time_t> times;
+  for (size_t k = m_playbackStride - 1; k < next.size(); k += m_playbackStride)
+    if (next[k] != time && std::find(times.begin(), times.end(),
+                                     next[k].GetTicks()) == times.end())
+      times.push_back(next[k].GetTicks());
+  m_timelineWorker.Request(times);
+}
+
+bool GRIBUICtrlBar::GetBracketingRecordSets(int idx, wxDateTime time,
+                                            GribRecordSet *&GRS1,
+                                            GribRecordSet *&GRS2,
+                                            double &interp) {
+  if (!m_bGRIBActiveFile) {
+    GRS1 = GRS2 = nullptr;
+    return false;
+  }
+  return GetBracketingRecordSets(m_bGRIBActiveFile.get(), idx, time, GRS1,
+                                 GRS2, interp);
+}
+
+bool GRIBUICtrlBar::GetBracketingRecordSets(GRIBFile *file, int idx,
+                                            wxDateTime time,
+                                            GribRecordSet *&GRS1,
+                                            GribRecordSet *&GRS2,
+                                            double &interp) {
+  GRS1 = GRS2 = nullptr;
+
+  // Set times are the current dates of their records
+  const GribTimeIndex &index = file->GetTimeIndex(idx);
+  size_t k1, k2;
+  if (!index.Bracket(time.GetTicks(), k1, k2)) return false;
+
+  ArrayOfGribRecordSets *rsa = file->GetRecordSetArrayPtr();
+  GRS1 = &rsa->Item(index.Set(k1));
+  GRS2 = &rsa->Item(index.Set(k2));
+  wxDateTime GR1time = GRS1->m_Reference_Time;
+  wxDateTime GR2time = GRS2->m_Reference_Time;
+
+  wxDateTime mintime = rsa->Item(0).m_Reference_Time;
+  double minute2 = (GR2time - mintime).GetMinutes();
+  double minute1 = (GR1time - mintime).GetMinutes();
+  double nminute = (time - mintime).GetMinutes();
+
+  if (minute2 < minute1 || nminute < minute1 || nminute > minute2)
+    return false;
+
+  interp = minute1 == minute2 ? 0. : (nminute - minute1) / (minute2 - minute1);
+  return true;
+}
+
+void GRIBUICtrlBar::GetNextTimelineTimes(wxDateTime time, int count,
+                                         std::vector<wxDateTime> &times) {
+  times.clear();
+  if (!m_bGRIBActiveFile || m_TimeLineHours == 0) return;
+  ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
+  if (rsa->GetCount() == 0) return;
+
+  if (m_InterpolateMode) {
+    wxDateTime last = rsa->Item(rsa->GetCount() - 1).m_Reference_Time;
+    int stepmin =
+        m_OverlaySettings.GetMinFromIndex(m_OverlaySettings.m_SlicesPerUpdate);
+    for (int k = 1; k <= count; k++) {
+      wxDateTime t = time + wxTimeSpan(0, k * stepmin);
+      if (t > last) break;
+      times.push_back(t);
+    }
+    return;
+  }
+
+  for (unsigned int j = 0; j < rsa->GetCount() && (int)times.size() < count;
+       j++) {
+    wxDateTime t = rsa->Item(j).m_Reference_Time;
+    if (t > time) times.push_back(t);
+  }
+}
+
 void GRIBUICtrlBar::GetProjectedLatLon(int &x, int &y, PlugIn_ViewPort *vp) {
   wxPoint p(0, 0);
   auto now = TimelineTime();
@@ -1580,33 +1972,23 @@ void GRIBUICtrlBar::GetProjectedLatLon(int &x, int &y, PlugIn_ViewPort *vp) {
 }
 
 double GRIBUICtrlBar::getTimeInterpolatedValue(int idx, double lon, double lat,
-                                               wxDateTime time) {
+                                               wxDateTime time,
+                                               GribTimeCursor *cursor) {
   if (m_bGRIBActiveFile == nullptr) return GRIB_NOTDEF;
   ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
 
-  if (rsa->GetCount() == 0) return GRIB_NOTDEF;
-
-  GribRecord *before = nullptr, *after = nullptr;
+  // Callers of the plugin API query one point at a time
+  static thread_local GribTimeCursor cursors[Idx_COUNT];
+  if (!cursor) cursor = &cursors[idx];
 
-  unsigned int j;
   time_t t = time.GetTicks();
-  for (j = 0; j < rsa->GetCount(); j++) {
-    GribRecordSet *GRS = &rsa->Item(j);
-    GribRecord *GR = GRS->m_GribRecordPtrArray[idx];
-    if (!GR) continue;
+  const GribTimeIndex &index = m_bGRIBActiveFile->GetTimeIndex(idx);
+  size_t k1, k2;
+  if (!index.Bracket(t, k1, k2, cursor)) return GRIB_NOTDEF;
 
-    time_t curtime = GR->getRecordCurrentDate();
-    if (curtime == t) return GR->getInterpolatedValue(lon, lat);
-
-    if (curtime < t) before = GR;
-
-    if (curtime > t) {
-      after = GR;
-      break;
-    }
-  }
-  // time_t wxDateTime::GetTicks();
-  if (!before || !after) return GRIB_NOTDEF;
+  GribRecord *before = rsa->Item(index.Set(k1)).m_GribRecordPtrArray[idx];
+  if (k1 == k2) return before->getInterpolatedValue(lon, lat);
+  GribRecord *after = rsa->Item(index.Set(k2)).m_GribRecordPtrArray[idx];
 
   time_t t1 = before->getRecordCurrentDate();
   time_t t2 = after->getRecordCurrentDate();
@@ -1624,42 +2006,32 @@ double GRIBUICtrlBar::getTimeInterpolatedValue(int idx, double lon, double lat,
 
 bool GRIBUICtrlBar::getTimeInterpolatedValues(double &M, double &A, int idx1,
                                               int idx2, double lon, double lat,
-                                              wxDateTime time) {
+                                              wxDateTime time,
+                                              GribTimeCursor *cursor) {
   M = GRIB_NOTDEF;
   A = GRIB_NOTDEF;
 
   if (m_bGRIBActiveFile == nullptr) return false;
   ArrayOfGribRecordSets *rsa = m_bGRIBActiveFile->GetRecordSetArrayPtr();
 
-  if (rsa->GetCount() == 0) return false;
+  // The second axis follows from the first one
+  static thread_local GribTimeCursor cursors[Idx_COUNT];
+  if (!cursor) cursor = &cursors[idx1];
 
-  GribRecord *beforeX = nullptr, *afterX = nullptr;
-  GribRecord *beforeY = nullptr, *afterY = nullptr;
-
-  unsigned int j;
   time_t t = time.GetTicks();
-  for (j = 0; j < rsa->GetCount(); j++) {
-    GribRecordSet *GRS = &rsa->Item(j);
-    GribRecord *GX = GRS->m_GribRecordPtrArray[idx1];
-    GribRecord *GY = GRS->m_GribRecordPtrArray[idx2];
-    if (!GX || !GY) continue;
-
-    time_t curtime = GX->getRecordCurrentDate();
-    if (curtime == t) {
-      return GribRecord::getInterpolatedValues(M, A, GX, GY, lon, lat, true);
-    }
-    if (curtime < t) {
-      beforeX = GX;
-      beforeY = GY;
-    }
-    if (curtime > t) {
-      afterX = GX;
-      afterY = GY;
-      break;
-    }
-  }
-  // time_t wxDateTime::GetTicks();
-  if (!beforeX || !afterX) return false;
+  const GribTimeIndex &index = m_bGRIBActiveFile->GetTimeIndex(idx1, idx2);
+  size_t k1, k2;
+  if (!index.Bracket(t, k1, k2, cursor)) return false;
+
+  GribRecordSet &before = rsa->Item(index.Set(k1));
+  GribRecord *beforeX = before.m_GribRecordPtrArray[idx1];
+  GribRecord *beforeY = before.m_GribRecordPtrArray[idx2];
+  if (k1 == k2)
+    return GribRecord::getInterpolatedValues(M, A, beforeX, beforeY, lon, lat,
+                                             true);
+  GribRecordSet &after = rsa->Item(index.Set(k2));
+  GribRecord *afterX = after.m_GribRecordPtrArray[idx1];
+  GribRecord *afterY = after.m_GribRecordPtrArray[idx2];
 
   time_t t1 = beforeX->getRecordCurrentDate();
   time_t t2 = afterX->getRecordCurrentDate();
@@ -1919,9 +2291,9 @@ void GRIBUICtrlBar::OnOpenFile(wxCommandEvent &event) {
 
 void GRIBUICtrlBar::CreateActiveFileFromNames(const wxArrayString &filenames) {
   if (filenames.GetCount() != 0) {
-    m_bGRIBActiveFile = nullptr;
-    m_bGRIBActiveFile = new GRIBFile(filenames, pPlugIn->GetCopyFirstCumRec(),
-                                     pPlugIn->GetCopyMissWaveRec());
+    m_bGRIBActiveFile =
+        std::make_shared<GRIBFile>(filenames, pPlugIn->GetCopyFirstCumRec(),
+                                   pPlugIn->GetCopyMissWaveRec());
   }
 }
 
@@ -2463,7 +2835,6 @@ GRIBFile::GRIBFile(const wxArrayString &file_names, bool CumRec, bool WaveRec,
                    bool newestFile)
     : m_counter(++ID) {
   m_bOK = false;  // Assume ok until proven otherwise
-  m_pGribReader = nullptr;
   m_last_message = wxEmptyString;
   for (unsigned int i = 0; i < file_names.GetCount(); i++) {
     wxString file_name = file_names[i];
@@ -2474,23 +2845,40 @@ GRIBFile::GRIBFile(const wxArrayString &file_names, bool CumRec, bool WaveRec,
     m_last_message = _(" files don't exist!");
     return;
   }
-  //    Use the zyGrib support classes, as (slightly) modified locally....
-  m_pGribReader = new GribReader();
-
-  //    Read and ingest the entire GRIB file.......
-  m_bOK = false;
-  wxString file_name;
-  for (unsigned int i = 0; i < file_names.GetCount(); i++) {
-    file_name = file_names[i];
-    m_pGribReader->openFile(file_name);
 
-    if (m_pGribReader->isOk()) {
-      m_bOK = true;
+  m_Stores.push_back(std::make_shared<RecordStore>());
+  RecordStore &store = *m_Stores.back();
+
+  //    A cache of the same load, when enabled, spares decoding the files
+  GribCache::Key cacheKey;
+  if (!GribCache::GetDirectory().empty()) {
+    unsigned int count = newestFile ? 1 : file_names.GetCount();
+    for (unsigned int i = 0; i < count; i++)
+      cacheKey.files.push_back(std::string(file_names[i].mb_str()));
+    cacheKey.version = std::string(
+        wxString::Format("%d.%d", PLUGIN_VERSION_MAJOR, PLUGIN_VERSION_MINOR)
+            .mb_str());
+    cacheKey.options =
+        (CumRec ? 1 : 0) | (WaveRec ? 2 : 0) | (newestFile ? 4 : 0);
+    if (LoadCache(cacheKey)) {
       if (newestFile) {
-        break;
+        m_FileNames.Clear();
+        m_FileNames.Add(file_names[0]);
+      } else {
+        m_FileNames = file_names;
       }
+      IndexTimes();
+      return;
     }
   }
+
+  //    Use the zyGrib support classes, as (slightly) modified locally....
+  store.reader.reset(new GribReader());
+  GribReader &reader = *store.reader;
+
+  //    Read and ingest the entire GRIB file.......
+  wxString file_name;
+  m_bOK = ReadFiles(reader, file_names, newestFile, file_name);
   if (m_bOK == false) {
     m_last_message = _(" can't be read!");
     return;
@@ -2503,336 +2891,244 @@ GRIBFile::GRIBFile(const wxArrayString &file_names, bool CumRec, bool WaveRec,
     m_FileNames = file_names;
   }
 
-  // fixup Accumulation records
-  m_pGribReader->computeAccumulationRecords(GRB_PRECIP_TOT, LV_GND_SURF, 0);
-  m_pGribReader->computeAccumulationRecords(GRB_PRECIP_RATE, LV_GND_SURF, 0);
-  m_pGribReader->computeAccumulationRecords(GRB_CLOUD_TOT, LV_ATMOS_ALL, 0);
-
-  if (CumRec)
-    m_pGribReader->copyFirstCumulativeRecord();  // add missing records if
-                                                 // option selected
-  if (WaveRec)
-    m_pGribReader->copyMissingWaveRecords();  //  ""                   ""
+  FixupRecords(reader, CumRec, WaveRec);
 
-  m_nGribRecords = m_pGribReader->getTotalNumberOfGribRecords();
+  m_nGribRecords = reader.getTotalNumberOfGribRecords();
 
   //    Walk the GribReader date list to populate our array of GribRecordSets
 
-  std::set<time_t>::iterator iter;
-  std::set<time_t> date_list = m_pGribReader->getListDates();
-  for (iter = date_list.begin(); iter != date_list.end(); iter++) {
+  //    The dates come sorted, so the set index doubles as the lookup of the
+  //    set of a record
+  std::set<time_t> date_list = reader.getListDates();
+  for (time_t reftime : date_list) {
     GribRecordSet *t = new GribRecordSet(m_counter);
-    time_t reftime = *iter;
     t->m_Reference_Time = reftime;
+    m_SetTimeIndex.Add(reftime, m_GribRecordSetArray.GetCount());
     m_GribRecordSetArray.Add(t);
   }
 
   //    Convert from zyGrib organization by data type/level to our organization
   //    by time.
+  std::vector<GribRecordSet *> sets;
+  for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++)
+    sets.push_back(&m_GribRecordSetArray.Item(j));
+  std::vector<int> indices;
+  GribRecord *pRec = GribRecordSetBuilder::Build(reader, sets, indices);
+  for (int idx : indices) m_GribIdxArray.Add(idx, 1);
+  CollectRecords(sets, store.records);
 
-  GribRecord *pRec;
-  bool isOK(false);
-  bool polarWind(false);
-  bool polarCurrent(false);
-  bool sigWave(false);
-  bool sigH(false);
-  //    Get the map of GribRecord vectors
-  std::map<std::string, std::vector<GribRecord *> *> *p_map =
-      m_pGribReader->getGribMap();
-
-  //    Iterate over the map to get vectors of related GribRecords
-  std::map<std::string, std::vector<GribRecord *> *>::iterator it;
-  for (it = p_map->begin(); it != p_map->end(); it++) {
-    std::vector<GribRecord *> *ls = (*it).second;
-    for (zuint i = 0; i < ls->size(); i++) {
-      pRec = ls->at(i);
-      isOK = true;
-      time_t thistime = pRec->getRecordCurrentDate();
-
-      //   Search the GribRecordSet array for a GribRecordSet with matching time
-      for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++) {
-        if (m_GribRecordSetArray.Item(j).m_Reference_Time == thistime) {
-          int idx = -1, mdx = -1;
-          switch (pRec->getDataType()) {
-            case GRB_WIND_DIR:
-              polarWind = true;
-              // fall through
-            case GRB_WIND_VX:
-              if (pRec->getLevelType() == LV_ISOBARIC) {
-                switch (pRec->getLevelValue()) {
-                  case 300:
-                    idx = Idx_WIND_VX300;
-                    break;
-                  case 500:
-                    idx = Idx_WIND_VX500;
-                    break;
-                  case 700:
-                    idx = Idx_WIND_VX700;
-                    break;
-                  case 850:
-                    idx = Idx_WIND_VX850;
-                    break;
-                }
-              } else
-                idx = Idx_WIND_VX;
-              break;
-            case GRB_WIND_SPEED:
-              polarWind = true;
-              // fall through
-            case GRB_WIND_VY:
-              if (pRec->getLevelType() == LV_ISOBARIC) {
-                switch (pRec->getLevelValue()) {
-                  case 300:
-                    idx = Idx_WIND_VY300;
-                    break;
-                  case 500:
-                    idx = Idx_WIND_VY500;
-                    break;
-                  case 700:
-                    idx = Idx_WIND_VY700;
-                    break;
-                  case 850:
-                    idx = Idx_WIND_VY850;
-                    break;
-                }
-              } else
-                idx = Idx_WIND_VY;
-              break;
-            case GRB_CUR_DIR:
-              polarCurrent = true;
-              // fall through
-            case GRB_UOGRD:
-              idx = Idx_SEACURRENT_VX;
-              break;
-            case GRB_CUR_SPEED:
-              polarCurrent = true;
-              // fall through
-            case GRB_VOGRD:
-              idx = Idx_SEACURRENT_VY;
-              break;
-            case GRB_WIND_GUST:
-              idx = Idx_WIND_GUST;
-              break;
-            case GRB_PRESSURE:
-              idx = Idx_PRESSURE;
-              break;
-            case GRB_HTSGW:
-              sigH = true;
-              idx = Idx_HTSIGW;
-              break;
-            case GRB_PER:
-              sigWave = true;
-              idx = Idx_WVPER;
-              break;
-            case GRB_DIR:
-              sigWave = true;
-              idx = Idx_WVDIR;
-              break;
-            case GRB_WVHGT:
-              idx = Idx_HTSIGW;
-              break;  // Translation from NOAA WW3
-            case GRB_WVPER:
-              idx = Idx_WVPER;
-              break;
-            case GRB_WVDIR:
-              idx = Idx_WVDIR;
-              break;
-            case GRB_PRECIP_RATE:
-            case GRB_PRECIP_TOT:
-              idx = Idx_PRECIP_TOT;
-              break;
-            case GRB_CLOUD_TOT:
-              idx = Idx_CLOUD_TOT;
-              break;
-            case GRB_TEMP:
-              if (pRec->getLevelType() == LV_ISOBARIC) {
-                switch (pRec->getLevelValue()) {
-                  case 300:
-                    idx = Idx_AIR_TEMP300;
-                    break;
-                  case 500:
-                    idx = Idx_AIR_TEMP500;
-                    break;
-                  case 700:
-                    idx = Idx_AIR_TEMP700;
-                    break;
-                  case 850:
-                    idx = Idx_AIR_TEMP850;
-                    break;
-                }
-              } else
-                idx = Idx_AIR_TEMP;
-              if (pRec->getDataCenterModel() == NORWAY_METNO)
-                mdx = 1000 + NORWAY_METNO;
-              break;
-            case GRB_WTMP:
-              idx = Idx_SEA_TEMP;
-              if (pRec->getDataCenterModel() == NOAA_GFS) mdx = 1000 + NOAA_GFS;
-              break;
-            case GRB_CAPE:
-              idx = Idx_CAPE;
-              break;
-            case GRB_COMP_REFL:
-              idx = Idx_COMP_REFL;
-              break;
-            case GRB_HUMID_REL:
-              if (pRec->getLevelType() == LV_ISOBARIC) {
-                switch (pRec->getLevelValue()) {
-                  case 300:
-                    idx = Idx_HUMID_RE300;
-                    break;
-                  case 500:
-                    idx = Idx_HUMID_RE500;
-                    break;
-                  case 700:
-                    idx = Idx_HUMID_RE700;
-                    break;
-                  case 850:
-                    idx = Idx_HUMID_RE850;
-                    break;
-                }
-              }
-              break;
-            case GRB_GEOPOT_HGT:
-              if (pRec->getLevelType() == LV_ISOBARIC) {
-                switch (pRec->getLevelValue()) {
-                  case 300:
-                    idx = Idx_GEOP_HGT300;
-                    break;
-                  case 500:
-                    idx = Idx_GEOP_HGT500;
-                    break;
-                  case 700:
-                    idx = Idx_GEOP_HGT700;
-                    break;
-                  case 850:
-                    idx = Idx_GEOP_HGT850;
-                    break;
-                }
-              }
-              break;
-          }
-          if (idx == -1) {
-            // XXX bug ?
-            break;
-          }
-
-          bool skip = false;
-
-          if (m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[idx]) {
-            // already one
-            GribRecord *oRec =
-                m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[idx];
-            if (idx == Idx_PRESSURE) {
-              skip = (oRec->getLevelType() == LV_MSL);
-            } else {
-              // we favor UV over DIR/SPEED
-              if (polarWind) {
-                if (oRec->getDataType() == GRB_WIND_VY ||
-                    oRec->getDataType() == GRB_WIND_VX)
-                  skip = true;
-              }
-              if (polarCurrent) {
-                if (oRec->getDataType() == GRB_UOGRD ||
-                    oRec->getDataType() == GRB_VOGRD)
-                  skip = true;
-              }
-              // favor average aka timeRange == 3 (HRRR subhourly subsets have
-              // both 3 and 0 records for winds)
-              if (!skip && (oRec->getTimeRange() == 3)) {
-                skip = true;
-              }
-              // we favor significant Wave other wind wave.
-              if (sigH) {
-                if (oRec->getDataType() == GRB_HTSGW) skip = true;
-              }
-              if (sigWave) {
-                if (oRec->getDataType() == GRB_DIR ||
-                    oRec->getDataType() == GRB_PER)
-                  skip = true;
-              }
-            }
-          }
-          if (!skip) {
-            m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[idx] = pRec;
-            if (m_GribIdxArray.Index(idx) == wxNOT_FOUND)
-              m_GribIdxArray.Add(idx, 1);
-            if (mdx != -1 && m_GribIdxArray.Index(mdx) == wxNOT_FOUND)
-              m_GribIdxArray.Add(mdx, 1);
-          }
-          break;
-        }
+  IndexTimes();
+
+  if (pRec)
+    m_pRefDateTime =
+        pRec->getRecordRefDate();  // to ovoid crash with some bad files
+
+  //    The cache of a newest file load is of the first file only
+  if (!cacheKey.files.empty() && pRec &&
+      (!newestFile || m_FileNames[0] == file_names[0]))
+    GribCache::Write(cacheKey, sets, indices, m_pRefDateTime);
+}
+
+GRIBFile::GRIBFile(const std::shared_ptr<GRIBFile> &base,
+                   const wxArrayString &file_names,
+                   bool /* CumRec, only copies accumulations */, bool WaveRec)
+    : m_counter(++ID) {
+  m_bOK = false;
+  m_last_message = wxEmptyString;
+  m_pRefDateTime = base->m_pRefDateTime;
+
+  //    Only the new messages are decoded
+  auto store = std::make_shared<RecordStore>();
+  store->reader.reset(new GribReader());
+  GribReader &reader = *store->reader;
+  wxString file_name;
+  if (!ReadFiles(reader, file_names, false, file_name)) {
+    m_last_message = _(" can't be read!");
+    return;
+  }
+  //    The fixups would only see the new records, not their neighbours in
+  //    time in base: those files need a full load
+  if (HasFixupRecords(reader, WaveRec)) {
+    m_bNeedsFullLoad = true;
+    return;
+  }
+
+  std::vector<std::unique_ptr<GribRecordSet>> owned;
+  std::vector<GribRecordSet *> added;
+  for (time_t reftime : reader.getListDates()) {
+    owned.emplace_back(new GribRecordSet(m_counter));
+    owned.back()->m_Reference_Time = reftime;
+    added.push_back(owned.back().get());
+  }
+  std::vector<int> indices;
+  GribRecord *pRec = GribRecordSetBuilder::Build(reader, added, indices);
+  if (!pRec) {
+    m_last_message = _(" contains no valid data!");
+    return;
+  }
+  //    Nor are records of another run, see NeedsFullLoad()
+  if (pRec->getRecordRefDate() != base->m_pRefDateTime) {
+    m_bNeedsFullLoad = true;
+    return;
+  }
+  CollectRecords(added, store->records);
+
+  //    Both timelines are sorted: merge them, the records of the new files
+  //    replacing those of the same kind and time
+  ArrayOfGribRecordSets &old = base->m_GribRecordSetArray;
+  size_t i = 0, k = 0;
+  while (i < old.GetCount() || k < added.size()) {
+    time_t t = k == added.size() ? old.Item(i).m_Reference_Time
+               : i == old.GetCount()
+                   ? added[k]->m_Reference_Time
+                   : std::min(old.Item(i).m_Reference_Time,
+                              added[k]->m_Reference_Time);
+    GribRecordSet *set = new GribRecordSet(m_counter);
+    set->m_Reference_Time = t;
+    if (i < old.GetCount() && old.Item(i).m_Reference_Time == t) {
+      for (int idx = 0; idx < Idx_COUNT; idx++)
+        set->m_GribRecordPtrArray[idx] = old.Item(i).m_GribRecordPtrArray[idx];
+      i++;
+    }
+    if (k < added.size() && added[k]->m_Reference_Time == t) {
+      for (int idx = 0; idx < Idx_COUNT; idx++)
+        if (added[k]->m_GribRecordPtrArray[idx])
+          set->m_GribRecordPtrArray[idx] = added[k]->m_GribRecordPtrArray[idx];
+      k++;
+    }
+    m_SetTimeIndex.Add(t, m_GribRecordSetArray.GetCount());
+    m_GribRecordSetArray.Add(set);
+  }
+
+  for (size_t j = 0; j < base->m_GribIdxArray.GetCount(); j++)
+    m_GribIdxArray.Add(base->m_GribIdxArray[j]);
+  for (int idx : indices)
+    if (m_GribIdxArray.Index(idx) == wxNOT_FOUND) m_GribIdxArray.Add(idx);
+
+  m_FileNames = base->m_FileNames;
+  for (unsigned int j = 0; j < file_names.GetCount(); j++)
+    if (m_FileNames.Index(file_names[j]) == wxNOT_FOUND)
+      m_FileNames.Add(file_names[j]);
+  m_nGribRecords = base->m_nGribRecords + reader.getTotalNumberOfGribRecords();
+
+  //    Keep the stores of base still holding records of ours, the others go
+  //    with base
+  std::vector<GribRecordSet *> sets;
+  for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++)
+    sets.push_back(&m_GribRecordSetArray.Item(j));
+  std::unordered_set<const GribRecord *> records;
+  CollectRecords(sets, records);
+  m_Stores.push_back(store);
+  for (const std::shared_ptr<RecordStore> &kept : base->m_Stores) {
+    for (const GribRecord *rec : kept->records) {
+      if (records.count(rec)) {
+        m_Stores.push_back(kept);
+        break;
       }
     }
   }
 
-  if (polarWind || polarCurrent) {
-    for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++) {
-      for (unsigned int i = 0; i < Idx_COUNT; i++) {
-        int idx = -1;
-        if (polarWind) {
-          GribRecord *pRec =
-              m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[i];
-
-          if (pRec != nullptr && pRec->getDataType() == GRB_WIND_DIR) {
-            switch (i) {
-              case Idx_WIND_VX300:
-                idx = Idx_WIND_VY300;
-                break;
-              case Idx_WIND_VX500:
-                idx = Idx_WIND_VY500;
-                break;
-              case Idx_WIND_VX700:
-                idx = Idx_WIND_VY700;
-                break;
-              case Idx_WIND_VX850:
-                idx = Idx_WIND_VY850;
-                break;
-              case Idx_WIND_VX:
-                idx = Idx_WIND_VY;
-                break;
-              default:
-                break;
-            }
-            if (idx != -1) {
-              GribRecord *pRec1 =
-                  m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[idx];
-              if (pRec1 != nullptr && pRec1->getDataType() == GRB_WIND_SPEED)
-                GribRecord::Polar2UV(pRec, pRec1);
-            }
-          }
-        }
-        if (polarCurrent) {
-          idx = -1;
-          GribRecord *pRec =
-              m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[i];
-
-          if (pRec != nullptr && pRec->getDataType() == GRB_CUR_DIR) {
-            switch (i) {
-              case Idx_SEACURRENT_VX:
-                idx = Idx_SEACURRENT_VY;
-                break;
-              default:
-                break;
-            }
-            if (idx != -1) {
-              GribRecord *pRec1 =
-                  m_GribRecordSetArray.Item(j).m_GribRecordPtrArray[idx];
-              if (pRec1 != nullptr && pRec1->getDataType() == GRB_CUR_SPEED)
-                GribRecord::Polar2UV(pRec, pRec1);
-            }
-          }
-        }
+  IndexTimes();
+  m_bOK = true;
+}
+
+GRIBFile::~GRIBFile() {}
+
+bool GRIBFile::ReadFiles(GribReader &reader, const wxArrayString &file_names,
+                         bool newestFile, wxString &file_name) {
+  bool ok = false;
+  for (unsigned int i = 0; i < file_names.GetCount(); i++) {
+    file_name = file_names[i];
+    reader.openFile(std::string(file_name.mb_str()));
+
+    if (reader.isOk()) {
+      ok = true;
+      if (newestFile) {
+        break;
       }
     }
   }
+  return ok;
+}
 
-  if (isOK)
-    m_pRefDateTime =
-        pRec->getRecordRefDate();  // to ovoid crash with some bad files
+void GRIBFile::FixupRecords(GribReader &reader, bool CumRec, bool WaveRec) {
+  // fixup Accumulation records
+  reader.computeAccumulationRecords(GRB_PRECIP_TOT, LV_GND_SURF, 0);
+  reader.computeAccumulationRecords(GRB_PRECIP_RATE, LV_GND_SURF, 0);
+  reader.computeAccumulationRecords(GRB_CLOUD_TOT, LV_ATMOS_ALL, 0);
+
+  if (CumRec)
+    reader.copyFirstCumulativeRecord();  // add missing records if
+                                         // option selected
+  if (WaveRec) reader.copyMissingWaveRecords();  //  ""                   ""
 }
 
-GRIBFile::~GRIBFile() { delete m_pGribReader; }
+bool GRIBFile::HasFixupRecords(GribReader &reader, bool WaveRec) {
+  //    Accumulations are always differenced, and CumRec only copies some
+  if (reader.getFirstGribRecord(GRB_PRECIP_TOT, LV_GND_SURF, 0) ||
+      reader.getFirstGribRecord(GRB_PRECIP_RATE, LV_GND_SURF, 0) ||
+      reader.getFirstGribRecord(GRB_CLOUD_TOT, LV_ATMOS_ALL, 0))
+    return true;
+  if (!WaveRec) return false;
+  for (int type : {GRB_HTSGW, GRB_WVDIR, GRB_WVPER, GRB_DIR, GRB_PER})
+    if (reader.getFirstGribRecord(type, LV_GND_SURF, 0)) return true;
+  return false;
+}
+
+void GRIBFile::CollectRecords(const std::vector<GribRecordSet *> &sets,
+                              std::unordered_set<const GribRecord *> &records) {
+  for (const GribRecordSet *set : sets)
+    for (int i = 0; i < Idx_COUNT; i++)
+      if (set->m_GribRecordPtrArray[i])
+        records.insert(set->m_GribRecordPtrArray[i]);
+}
+
+bool GRIBFile::LoadCache(const GribCache::Key &key) {
+  RecordStore &store = *m_Stores.back();
+  store.cache = GribCache::Open(key);
+  if (!store.cache) return false;
+
+  std::vector<GribRecordSet *> sets;
+  for (size_t j = 0; j < store.cache->GetSetCount(); j++) {
+    GribRecordSet *t = new GribRecordSet(m_counter);
+    store.cache->FillSet(j, *t);
+    m_SetTimeIndex.Add(t->m_Reference_Time, m_GribRecordSetArray.GetCount());
+    m_GribRecordSetArray.Add(t);
+    sets.push_back(t);
+  }
+  CollectRecords(sets, store.records);
+  for (int idx : store.cache->GetIndices()) m_GribIdxArray.Add(idx, 1);
+  m_nGribRecords = store.cache->GetRecordCount();
+  m_pRefDateTime = store.cache->GetRefDate();
+  m_bOK = true;
+  return true;
+}
+
+void GRIBFile::IndexTimes() {
+  //    Index the timeline of each record type for the point queries
+  for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++) {
+    GribRecordSet &set = m_GribRecordSetArray.Item(j);
+    for (int i = 0; i < Idx_COUNT; i++) {
+      GribRecord *rec = set.m_GribRecordPtrArray[i];
+      if (rec) m_TimeIndex[i].Add(rec->getRecordCurrentDate(), j);
+    }
+  }
+}
+
+const GribTimeIndex &GRIBFile::GetTimeIndex(int idx1, int idx2) {
+  std::lock_guard<std::mutex> lock(m_PairTimeIndexMutex);
+  auto it = m_PairTimeIndex.find(idx1 * Idx_COUNT + idx2);
+  if (it != m_PairTimeIndex.end()) return it->second;
+
+  GribTimeIndex &index = m_PairTimeIndex[idx1 * Idx_COUNT + idx2];
+  for (unsigned int j = 0; j < m_GribRecordSetArray.GetCount(); j++) {
+    GribRecordSet &set = m_GribRecordSetArray.Item(j);
+    GribRecord *GX = set.m_GribRecordPtrArray[idx1];
+    if (GX && set.m_GribRecordPtrArray[idx2])
+      index.Add(GX->getRecordCurrentDate(), j);
+  }
+  return index;
+}
 
 //---------------------------------------------------------------------------------------
 //               GRIB Cursor Data Ctrl & Display implementation
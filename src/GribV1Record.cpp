@@ -19,15 +19,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * \file
  * \implements \ref GribV1Record.h
  */
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include "wx/wx.h"
-#endif  // precompiled headers
-
 #include <stdlib.h>
+#include <string.h>
 
 #include "GribV1Record.h"
+#include "GribDecodeStats.h"
+#include "GribScratch.h"
 
 //-------------------------------------------------------------------------------
 // Adjust data type from different mete center
@@ -326,6 +323,7 @@ GribV1Record::GribV1Record(ZUFILE* file, int id_) {
   eof = false;
   knownData = true;
   IsDuplicated = false;
+  GribDecodeStats::Timer timer;
   long start = zu_tell(file);
 
   //      Pre read 4 bytes to check for length adder needed for some GRIBS (like
@@ -376,6 +374,7 @@ GribV1Record::GribV1Record(ZUFILE* file, int id_) {
 
   ok = readGribSection0_IS(file, b_haveReadGRIB);
   if (ok) {
+    timer.Lap(GribDecodeStats::SCAN);
     ok = readGribSection1_PDS(file);
     zu_seek(file, fileOffset1 + sectionSize1, SEEK_SET);
   }
@@ -388,10 +387,13 @@ GribV1Record::GribV1Record(ZUFILE* file, int id_) {
     zu_seek(file, fileOffset3 + sectionSize3, SEEK_SET);
   }
   if (ok) {
+    timer.Lap(GribDecodeStats::PARSE);
     ok = readGribSection4_BDS(file);
     zu_seek(file, fileOffset4 + sectionSize4, SEEK_SET);
   }
   if (ok) {
+    // GRIB1 grids are always simple packing
+    timer.LapUnpack(1, 0, (size_t)Ni * Nj);
     ok = readGribSection5_ES(file);
   }
   if (ok) {
@@ -672,6 +674,7 @@ bool GribV1Record::readGribSection4_BDS(ZUFILE* file) {
   refValue = readFloat4(file);          // byte 7-8-9-10
   nbBitsInPack = readChar(file);        // byte 11
   scaleFactorEpow2 = pow(2., scaleFactorE);
+  packingStep = scaleFactorEpow2 / decimalFactorD;
   unusedBitsEndBDS = flags & 0x0F;
   isGridData = (flags & 0x80) == 0;
   isSimplePacking = (flags & 0x80) == 0;
@@ -703,9 +706,14 @@ bool GribV1Record::readGribSection4_BDS(ZUFILE* file) {
   }
   zuint startbit = 0;
   int datasize = sectionSize4 - 11;
-  zuchar* buf =
-      new zuchar[datasize +
-                 4]();  // +4 pour simplifier les décalages ds readPackedBits
+  GribScratch::Lease scratch;
+  zuchar* buf = scratch->Allocate<zuchar>(
+      datasize + 4);  // +4 pour simplifier les décalages ds readPackedBits
+  if (buf == nullptr) {
+    ok = false;
+    return ok;
+  }
+  memset(buf + datasize, 0, 4);
 
   if (zu_read(file, buf, datasize) != datasize) {
     erreur("Record %d: data read error", id);
@@ -713,7 +721,6 @@ bool GribV1Record::readGribSection4_BDS(ZUFILE* file) {
     eof = true;
   }
   if (!ok) {
-    delete[] buf;
     return ok;
   }
 
@@ -775,7 +782,6 @@ bool GribV1Record::readGribSection4_BDS(ZUFILE* file) {
     }
   }
 
-  delete[] buf;
   return ok;
 }
 
@@ -35,15 +35,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define __STDC_LIMIT_MACROS
 
-#include "wx/wxprec.h"
-
-#ifndef WX_PRECOMP
-#include "wx/wx.h"
-#endif  // precompiled headers
-
 #include <stdlib.h>
 
 #include "GribV2Record.h"
+#include "GribDecodeStats.h"
+#include "GribScratch.h"
 
 #ifdef JASPER
 #include <jasper/jasper.h>
@@ -71,12 +67,6 @@ public:
     lvl2 = 0.;
   };
 
-  ~GRIBMetadata() {
-    delete[] stat_proc.t;
-    delete[] bitmap;
-    delete[] bms;
-  };
-
   int gds_templ_num;
 
   int earth_shape;
@@ -146,6 +136,7 @@ public:
   float R;
   int E, D, num_packed, pack_width, orig_val_type;
   int bms_ind;
+  // bitmap, bms and stat_proc.t are in the scratch memory of the message
   unsigned char *bitmap;
   ///
   zuchar *bms;
@@ -163,7 +154,8 @@ public:
 class GRIBMessage {
 public:
   GRIBMessage() : buffer(0) {};
-  ~GRIBMessage() { delete[] buffer; };
+  // Decoding temporaries, the buffer among them, freed with the message
+  GribScratch::Lease scratch;
   unsigned char *buffer;
   int offset; /* offset in bytes to next GRIB2 section */
   int total_len, disc, ed_num;
@@ -526,11 +518,12 @@ static void unpack_stat_proc(GRIBMessage *grib_msg, unsigned const char *b) {
   grib_msg->md.stat_proc.nmiss =
       uint4(b + 8); /* number of values missing from process */
 
-  if (grib_msg->md.stat_proc.t != 0) {
-    delete[] grib_msg->md.stat_proc.t;
+  grib_msg->md.stat_proc.t = grib_msg->scratch->Allocate<GRIBStatproc>(
+      grib_msg->md.stat_proc.num_ranges);
+  if (grib_msg->md.stat_proc.t == nullptr) {
+    grib_msg->md.stat_proc.num_ranges = 0;
+    return;
   }
-  grib_msg->md.stat_proc.t =
-      new GRIBStatproc[grib_msg->md.stat_proc.num_ranges];
   off = 12;
   for (n = 0; n < (size_t)grib_msg->md.stat_proc.num_ranges; n++) {
     grib_msg->md.stat_proc.t[n].proc_code = b[off];
@@ -714,10 +707,11 @@ static bool unpackBMS(GRIBMessage *grib_msg) {
       len -= 6;
       grib_msg->md.bmssize = len;
       len *= 8;
-      delete[] grib_msg->md.bitmap;
-      delete[] grib_msg->md.bms;
-      grib_msg->md.bitmap = new unsigned char[len];
-      grib_msg->md.bms = new zuchar[grib_msg->md.bmssize];
+      grib_msg->md.bitmap = grib_msg->scratch->Allocate<unsigned char>(len);
+      grib_msg->md.bms =
+          grib_msg->scratch->Allocate<zuchar>(grib_msg->md.bmssize);
+      if (grib_msg->md.bitmap == nullptr || grib_msg->md.bms == nullptr)
+        return false;
       memcpy(grib_msg->md.bms, b + 6, grib_msg->md.bmssize);
       for (n = 0; n < len; n++) {
         getBits(grib_msg->buffer, &bit, grib_msg->offset + 48 + n, 1);
@@ -728,9 +722,7 @@ static bool unpackBMS(GRIBMessage *grib_msg) {
                // to this product.
       break;
     case 255:  // A bit map does not apply to this product.
-      delete[] grib_msg->md.bitmap;
       grib_msg->md.bitmap = nullptr;
-      delete[] grib_msg->md.bms;
       grib_msg->md.bms = nullptr;
       grib_msg->md.bmssize = 0;
       break;
@@ -777,8 +769,9 @@ static bool unpackDS(GRIBMessage *grib_msg) {
     case 3:
       if (grib_msg->md.complex_pack.num_groups > 0) {
         if (grib_msg->md.complex_pack.spatial_diff.order) {
-          groups.first_vals =
-              new int[grib_msg->md.complex_pack.spatial_diff.order];
+          groups.first_vals = grib_msg->scratch->Allocate<int>(
+              grib_msg->md.complex_pack.spatial_diff.order);
+          if (groups.first_vals == nullptr) return false;
           for (n = 0; n < grib_msg->md.complex_pack.spatial_diff.order; ++n) {
             getBits(
                 grib_msg->buffer, &groups.first_vals[n], off,
@@ -810,9 +803,13 @@ static bool unpackDS(GRIBMessage *grib_msg) {
         groups.miss_val = GRIB_MISSING_VALUE;
       }
 
-      groups.ref_vals = new int[grib_msg->md.complex_pack.num_groups];
-      groups.widths = new int[grib_msg->md.complex_pack.num_groups];
-      groups.lengths = new int[grib_msg->md.complex_pack.num_groups];
+      n = grib_msg->md.complex_pack.num_groups;
+      groups.ref_vals = grib_msg->scratch->Allocate<int>(n);
+      groups.widths = grib_msg->scratch->Allocate<int>(n);
+      groups.lengths = grib_msg->scratch->Allocate<int>(n);
+      if (groups.ref_vals == nullptr || groups.widths == nullptr ||
+          groups.lengths == nullptr)
+        return false;
 
       for (n = 0; n < grib_msg->md.complex_pack.num_groups; ++n) {
         getBits(grib_msg->buffer, &groups.ref_vals[n], off,
@@ -924,7 +921,6 @@ static bool unpackDS(GRIBMessage *grib_msg) {
             ++m;
           }
         }
-        delete[] groups.first_vals;
       } else
         for (l = 0; l < npoints; ++l) {
           if (grib_msg->grids.gridpoints[l] != GRIB_MISSING_VALUE) {
@@ -932,9 +928,6 @@ static bool unpackDS(GRIBMessage *grib_msg) {
                 grib_msg->md.R + grib_msg->grids.gridpoints[l] * E / D;
           }
         }
-      delete[] groups.ref_vals;
-      delete[] groups.widths;
-      delete[] groups.lengths;
       break;
     case 4: {
       // Grid point data - IEEE Floating Point Data
@@ -983,7 +976,8 @@ static bool unpackDS(GRIBMessage *grib_msg) {
       getBits(grib_msg->buffer, &len, grib_msg->offset, 32);
       if (len < 5) return false;
       len = len - 5;
-      jvals = new int[npoints];
+      jvals = grib_msg->scratch->Allocate<int>(npoints);
+      if (jvals == nullptr) return false;
       grib_msg->grids.gridpoints = new double[npoints];
       if (len > 0)
         dec_jpeg2000((char *)&grib_msg->buffer[grib_msg->offset / 8 + 5], len,
@@ -996,7 +990,6 @@ static bool unpackDS(GRIBMessage *grib_msg) {
         } else
           grib_msg->grids.gridpoints[l] = GRIB_MISSING_VALUE;
       }
-      delete[] jvals;
       break;
 #endif
     default:
@@ -1550,6 +1543,7 @@ void GribV2Record::readDataSet(ZUFILE *file) {
   knownData = false;
   IsDuplicated = false;
 
+  GribDecodeStats::Timer timer;
   while (strncmp(&((char *)grib_msg->buffer)[grib_msg->offset / 8], "7777",
                  4) != 0) {
     DS = false;
@@ -1670,11 +1664,18 @@ void GribV2Record::readDataSet(ZUFILE *file) {
           if (ok) {
             data = grib_msg->grids.gridpoints;
             grib_msg->grids.gridpoints = 0;
+            if (grib_msg->md.drs_templ_num != 4)  // not IEEE floats
+              packingStep =
+                  pow(2., grib_msg->md.E) / pow(10., grib_msg->md.D);
           }
         }
         if (grib_msg->num_grids != 1) DS = true;
         break;
     }
+    if (sec_num == 7 && !skip)
+      timer.LapUnpack(2, grib_msg->md.drs_templ_num, (size_t)Ni * Nj);
+    else
+      timer.Lap(GribDecodeStats::PARSE);
     grib_msg->offset += len * 8;
     if (ok == false || DS == true) break;
   }
@@ -1718,6 +1719,7 @@ GribV2Record::GribV2Record(ZUFILE *file, int id_) {
   knownData = false;
   IsDuplicated = false;
   long start = seekStart;
+  GribDecodeStats::Timer timer;
 
   grib_msg = new GRIBMessage();
 
@@ -1750,6 +1752,7 @@ GribV2Record::GribV2Record(ZUFILE *file, int id_) {
 
   int len, sec_num;
   if (ok) {
+    timer.Lap(GribDecodeStats::SCAN);
     unpackIDS(grib_msg);  // Section 1: Identification Section
     int off;
     /* find out how many grids are in this message */
@@ -1777,6 +1780,7 @@ GribV2Record::GribV2Record(ZUFILE *file, int id_) {
   idModel = grib_msg->table_ver;
   idGrid = 0;  // FIXME data1[6];
   productDiscipline = grib_msg->disc;
+  timer.Lap(GribDecodeStats::PARSE);
   readDataSet(file);
 }
 
@@ -1820,10 +1824,7 @@ static bool unpackIS(ZUFILE *fp, GRIBMessage *grib_msg) {
   int status;
   size_t num;
 
-  if (grib_msg->buffer != nullptr) {
-    delete[] grib_msg->buffer;
-    grib_msg->buffer = nullptr;
-  }
+  grib_msg->buffer = nullptr;
   grib_msg->num_grids = 0;
 
   if ((status = zu_read(fp, &temp[4], 12)) != 12) {
@@ -1841,7 +1842,9 @@ static bool unpackIS(ZUFILE *fp, GRIBMessage *grib_msg) {
     return false;
 
   grib_msg->md.nx = grib_msg->md.ny = 0;
-  grib_msg->buffer = new unsigned char[grib_msg->total_len + 4];
+  grib_msg->buffer =
+      grib_msg->scratch->Allocate<unsigned char>(grib_msg->total_len + 4);
+  if (grib_msg->buffer == nullptr) return false;
   memcpy(grib_msg->buffer, temp, 16);
   num = grib_msg->total_len - 16;
 
@@ -0,0 +1,288 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribValuesMessage.h
+ */
+
+#include "GribValuesMessage.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "GribBatchSampler.h"
+#include "GribRecord.h"
+#include "GribRecordSet.h"
+
+static const char BASE64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const struct {
+  const char *name;
+  unsigned int field;
+} FIELD_NAMES[] = {{"WIND", GribValuesBatch::WIND},
+                   {"CURRENT", GribValuesBatch::CURRENT},
+                   {"GUST", GribValuesBatch::GUST},
+                   {"SWELL", GribValuesBatch::SWELL}};
+
+static const char *SkipSpaces(const char *p) {
+  while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+  return p;
+}
+
+// Start of the value of "key", or nullptr
+static const char *FindValue(const char *body, const char *key) {
+  size_t len = strlen(key);
+  for (const char *p = strchr(body, '"'); p; p = strchr(p + 1, '"')) {
+    if (strncmp(p + 1, key, len) || p[len + 1] != '"') continue;
+    const char *v = SkipSpaces(p + len + 2);
+    if (*v == ':') return SkipSpaces(v + 1);
+  }
+  return nullptr;
+}
+
+// End of the JSON string starting at p, just past its closing quote, or
+// nullptr if it is not terminated
+static const char *SkipString(const char *p) {
+  for (p++; *p; p++) {
+    if (*p == '\\' && p[1])
+      p++;
+    else if (*p == '"')
+      return p + 1;
+  }
+  return nullptr;
+}
+
+// End of the JSON number starting at p, or nullptr if there is none
+static const char *SkipNumber(const char *p) {
+  if (*p == '-') p++;
+  if (!isdigit((unsigned char)*p)) return nullptr;
+  while (isdigit((unsigned char)*p)) p++;
+  if (*p == '.') {
+    if (!isdigit((unsigned char)*++p)) return nullptr;
+    while (isdigit((unsigned char)*p)) p++;
+  }
+  if (*p == 'e' || *p == 'E') {
+    if (*++p == '+' || *p == '-') p++;
+    if (!isdigit((unsigned char)*p)) return nullptr;
+    while (isdigit((unsigned char)*p)) p++;
+  }
+  return p;
+}
+
+// The binary payload is little-endian whatever the host
+static bool IsBigEndian() {
+  const uint16_t one = 1;
+  return *reinterpret_cast<const unsigned char *>(&one) == 0;
+}
+
+static void SwapBytes(double *v, size_t count) {
+  for (size_t k = 0; k < count; k++) {
+    unsigned char *b = reinterpret_cast<unsigned char *>(v + k);
+    std::reverse(b, b + sizeof(double));
+  }
+}
+
+// Bounds of the string value of "key"
+static bool FindString(const char *body, const char *key, const char *&begin,
+                       const char *&end) {
+  const char *p = FindValue(body, key);
+  if (!p || *p != '"') return false;
+  begin = p + 1;
+  end = strchr(begin, '"');
+  return end != nullptr;
+}
+
+bool GribValuesBatch::Parse(const char *body) {
+  m_id.clear();
+  m_fields = 0;
+  m_binaryReply = false;
+  m_points.clear();
+  m_values.clear();
+
+  const char *begin, *end;
+  if (!FindString(body, "Fields", begin, end)) return false;
+  while (begin < end) {
+    const char *comma = begin;
+    while (comma < end && *comma != ',') comma++;
+    for (auto &name : FIELD_NAMES)
+      if (strlen(name.name) == (size_t)(comma - begin) &&
+          !strncmp(begin, name.name, comma - begin))
+        m_fields |= name.field;
+    begin = comma + 1;
+  }
+  if (!m_fields) return false;
+
+  // Echoed as is: a string, quotes and escapes included, or a number
+  if (const char *p = FindValue(body, "Id")) {
+    end = *p == '"' ? SkipString(p) : SkipNumber(p);
+    if (!end) return false;
+    m_id.assign(p, end);
+  }
+
+  if (FindString(body, "Reply", begin, end))
+    m_binaryReply = end - begin == 6 && !strncmp(begin, "binary", 6);
+
+  const size_t triple = 3 * sizeof(double);
+  if (FindString(body, "Binary", begin, end)) {
+    if (!DecodeBase64(begin, end - begin, m_binary) ||
+        m_binary.size() % triple)
+      return false;
+    m_points.resize(m_binary.size() / triple);
+    for (size_t k = 0; k < m_points.size(); k++) {
+      double v[3];
+      memcpy(v, m_binary.data() + k * triple, triple);
+      if (IsBigEndian()) SwapBytes(v, 3);
+      m_points[k].latitude = v[0];
+      m_points[k].longitude = v[1];
+      m_points[k].time = (time_t)v[2];
+    }
+    return true;
+  }
+
+  const char *p = FindValue(body, "Points");
+  if (!p || *p != '[') return false;
+  double v[3];
+  int n = 0;
+  for (p++;; p++) {
+    p = SkipSpaces(p);
+    if (*p == ']') break;
+    char *next;
+    v[n] = strtod(p, &next);
+    if (next == p) return false;
+    if (++n == 3) {
+      DpGrib::SampleQuery q;
+      q.latitude = v[0];
+      q.longitude = v[1];
+      q.time = (time_t)v[2];
+      m_points.push_back(q);
+      n = 0;
+    }
+    p = SkipSpaces(next);
+    if (*p == ']') break;
+    if (*p != ',') return false;
+  }
+  return n == 0;
+}
+
+int GribValuesBatch::ValuesPerPoint() const {
+  return (m_fields & WIND ? 2 : 0) + (m_fields & CURRENT ? 2 : 0) +
+         (m_fields & GUST ? 1 : 0) + (m_fields & SWELL ? 1 : 0);
+}
+
+void GribValuesBatch::Sample(GRIBFile *file) {
+  const size_t stride = ValuesPerPoint();
+  m_values.assign(stride * m_points.size(), GRIB_NOTDEF);
+  if (!file || m_points.empty()) return;
+
+  GribSampleLayer layers[4];
+  layers[0].kind = layers[1].kind = GribSampleLayer::VECTOR;
+  layers[0].idx = Idx_WIND_VX, layers[0].idy = Idx_WIND_VY;
+  layers[1].idx = Idx_SEACURRENT_VX, layers[1].idy = Idx_SEACURRENT_VY;
+  layers[2].idx = Idx_WIND_GUST;
+  layers[3].idx = Idx_HTSIGW;
+
+  m_samples.resize(m_points.size());
+  GribBatchSampler sampler(file, m_points);
+  size_t column = 0;
+  for (int f = 0; f < 4; f++) {
+    if (!(m_fields & FIELD_NAMES[f].field)) continue;
+    sampler.Sample(layers[f], m_samples.data());
+    bool vector = layers[f].kind == GribSampleLayer::VECTOR;
+    for (size_t k = 0; k < m_points.size(); k++) {
+      const DpGrib::SampleValue &s = m_samples[k];
+      // GRIB_VALUES drops a vector without a value, its direction too
+      if (!s.valid || (vector && !s.hasDirection)) continue;
+      m_values[k * stride + column] = s.value;
+      if (vector) m_values[k * stride + column + 1] = s.direction;
+    }
+    column += vector ? 2 : 1;
+  }
+}
+
+void GribValuesBatch::FormatReply(std::string &out) const {
+  out = "{\"Type\":\"Reply\"";
+  if (!m_id.empty()) out += ",\"Id\":" + m_id;
+
+  out += ",\"Fields\":\"";
+  bool first = true;
+  for (auto &name : FIELD_NAMES) {
+    if (!(m_fields & name.field)) continue;
+    if (!first) out += ',';
+    out += name.name;
+    first = false;
+  }
+  char buf[32];
+  snprintf(buf, sizeof buf, "\",\"Count\":%zu", m_points.size());
+  out += buf;
+
+  if (m_binaryReply) {
+    out += ",\"Binary\":\"";
+    if (IsBigEndian()) {
+      std::vector<double> values(m_values);
+      SwapBytes(values.data(), values.size());
+      EncodeBase64(values.data(), values.size() * sizeof(double), out);
+    } else {
+      EncodeBase64(m_values.data(), m_values.size() * sizeof(double), out);
+    }
+    out += "\"}";
+    return;
+  }
+
+  out += ",\"Values\":[";
+  out.reserve(out.size() + m_values.size() * 12 + 2);
+  for (size_t k = 0; k < m_values.size(); k++) {
+    if (k) out += ',';
+    if (m_values[k] == GRIB_NOTDEF) {
+      out += "null";
+      continue;
+    }
+    snprintf(buf, sizeof buf, "%.10g", m_values[k]);
+    out += buf;
+  }
+  out += "]}";
+}
+
+void GribValuesBatch::EncodeBase64(const void *data, size_t size,
+                                   std::string &out) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  out.reserve(out.size() + (size + 2) / 3 * 4);
+  for (size_t k = 0; k < size; k += 3) {
+    unsigned int n = p[k] << 16;
+    if (k + 1 < size) n |= p[k + 1] << 8;
+    if (k + 2 < size) n |= p[k + 2];
+    out += BASE64[(n >> 18) & 63];
+    out += BASE64[(n >> 12) & 63];
+    out += k + 1 < size ? BASE64[(n >> 6) & 63] : '=';
+    out += k + 2 < size ? BASE64[n & 63] : '=';
+  }
+}
+
+bool GribValuesBatch::DecodeBase64(const char *text, size_t size,
+                                   std::vector<char> &data) {
+  data.clear();
+  data.reserve(size / 4 * 3);
+  unsigned int n = 0;
+  int bits = 0;
+  for (size_t k = 0; k < size && text[k] != '='; k++) {
+    const char *pos = text[k] ? strchr(BASE64, text[k]) : nullptr;
+    if (!pos) return false;
+    n = (n << 6) | (unsigned int)(pos - BASE64);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      data.push_back((char)((n >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
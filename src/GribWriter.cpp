@@ -0,0 +1,625 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref GribWriter.h
+ */
+
+#include "GribWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "GribRecord.h"
+
+#ifdef JASPER
+#include <jasper/jasper.h>
+#endif
+
+namespace {
+
+// The decoders read packed values 32 bits at a time from any bit offset
+const int MAX_BITS = 24;
+// Values of a group of the complex packings
+const unsigned int GROUP_LENGTH = 16;
+
+void Put(std::vector<unsigned char> &out, uint64_t v, int bytes) {
+  for (int k = bytes - 1; k >= 0; k--)
+    out.push_back((unsigned char)(v >> 8 * k));
+}
+
+// Sign and magnitude, as GRIB has it
+void PutSigned(std::vector<unsigned char> &out, int64_t v, int bytes) {
+  uint64_t magnitude = v < 0 ? -v : v;
+  if (v < 0) magnitude |= (uint64_t)1 << (8 * bytes - 1);
+  Put(out, magnitude, bytes);
+}
+
+void Set(std::vector<unsigned char> &out, size_t at, uint64_t v, int bytes) {
+  for (int k = 0; k < bytes; k++)
+    out[at + k] = (unsigned char)(v >> 8 * (bytes - 1 - k));
+}
+
+uint32_t IeeeBits(float f) {
+  uint32_t u;
+  memcpy(&u, &f, sizeof u);
+  return u;
+}
+
+// Greatest float not above v
+float FloatBelow(double v) {
+  float f = (float)v;
+  if (f > v) f = std::nextafter(f, -HUGE_VALF);
+  return f;
+}
+
+// IBM single precision of the greatest such number not above v, and what
+// it decodes to
+uint32_t IbmBelow(double v, double &decoded) {
+  decoded = 0;
+  if (v == 0) return 0;
+  double a = std::fabs(v);
+  int exponent = 64;
+  while (a >= 1) {
+    a /= 16;
+    exponent++;
+  }
+  while (a < 1. / 16) {
+    a *= 16;
+    exponent--;
+  }
+  if (exponent < 0 || exponent > 127) return 0;
+  double m = a * 16777216.;  // 2^24
+  uint32_t mantissa = (uint32_t)(v > 0 ? std::floor(m) : std::ceil(m));
+  if (mantissa >= 16777216) {
+    mantissa >>= 4;
+    exponent++;
+  }
+  decoded = std::ldexp((double)mantissa, -24) * std::pow(16., exponent - 64);
+  if (v < 0) decoded = -decoded;
+  return (v < 0 ? 0x80000000u : 0) | (uint32_t)exponent << 24 | mantissa;
+}
+
+int BitsFor(uint64_t v) {
+  int n = 0;
+  while (v) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<unsigned char> &out) : m_out(out) {}
+  ~BitWriter() { Align(); }
+
+  void Put(uint64_t v, int bits) {
+    while (bits > 0) {
+      if (m_used == 0) m_out.push_back(0);
+      int n = std::min(bits, 8 - m_used);
+      unsigned char part = (unsigned char)(v >> (bits - n)) & ((1 << n) - 1);
+      m_out.back() |= part << (8 - m_used - n);
+      m_used = (m_used + n) % 8;
+      bits -= n;
+    }
+  }
+  void Align() { m_used = 0; }
+
+private:
+  std::vector<unsigned char> &m_out;
+  int m_used = 0;  // bits of the last byte
+};
+
+bool UtcDate(time_t time, struct tm &date) {
+#ifdef _WIN32
+  return gmtime_s(&date, &time) == 0;
+#else
+  return gmtime_r(&time, &date) != nullptr;
+#endif
+}
+
+void Bitmap(const std::vector<bool> &present, std::vector<unsigned char> &out) {
+  BitWriter bits(out);
+  for (bool p : present) bits.Put(p, 1);
+}
+
+}  // namespace
+
+bool GribWriter::Encode(const Field &field, std::vector<unsigned char> &out) {
+  if (field.ni < 2 || field.nj < 2 || !field.values) return false;
+  if ((double)field.ni * field.nj > 1e9) return false;
+  switch (field.edition) {
+    case 1:
+      return EncodeGrib1(field, out);
+    case 2:
+      return EncodeGrib2(field, out);
+  }
+  return false;
+}
+
+double GribWriter::Tolerance(const Field &field) {
+  double largest = 0;
+  size_t n = (size_t)field.ni * field.nj;
+  for (size_t k = 0; k < n; k++) {
+    if (field.values[k] != GRIB_NOTDEF)
+      largest = std::max(largest, std::fabs(field.values[k]));
+  }
+  if (field.edition == 2 && field.packing == IEEE)
+    return field.bits == 64 ? 0 : largest * std::ldexp(1., -23);
+
+  Packed packed;
+  if (!Pack(field, field.edition == 1, packed)) return 0;
+  double step =
+      std::ldexp(1., packed.binaryScale) / std::pow(10., field.decimalScale);
+  // GRIB2 decoding goes through single precision
+  double rounding = largest * std::ldexp(1., field.edition == 1 ? -40 : -20);
+  return step / 2 + rounding;
+}
+
+bool GribWriter::Pack(const Field &field, bool ibmReference, Packed &packed) {
+  if (field.bits < 1 || field.bits > MAX_BITS) return false;
+  size_t n = (size_t)field.ni * field.nj;
+  double scale = std::pow(10., field.decimalScale);
+  double lo = HUGE_VAL, hi = -HUGE_VAL;
+  packed.present.assign(n, false);
+  packed.count = 0;
+  for (size_t k = 0; k < n; k++) {
+    double v = field.values[k];
+    if (v == GRIB_NOTDEF) continue;
+    if (!std::isfinite(v)) return false;
+    lo = std::min(lo, v * scale);
+    hi = std::max(hi, v * scale);
+    packed.present[k] = true;
+    packed.count++;
+  }
+  if (!packed.count) lo = hi = 0;
+
+  // Smallest E the range fits in; R a multiple of 2^E if a float can hold
+  // it, so that the sums of the spatial differencing decoder stay exact
+  double largest = std::ldexp(1., field.bits) - 1;
+  int e = hi > lo ? (int)std::ceil(std::log2((hi - lo) / largest)) : 0;
+  for (;; e++) {
+    double step = std::ldexp(1., e);
+    double r;
+    if (ibmReference) {
+      IbmBelow(lo, r);
+    } else {
+      double k = std::floor(lo / step);
+      r = std::fabs(k) < 16777216. ? k * step : FloatBelow(lo);
+    }
+    if (std::floor((hi - r) / step + 0.5) <= largest || e > 1000) {
+      packed.reference = r;
+      break;
+    }
+  }
+  if (e > 1000) return false;
+  packed.binaryScale = e;
+
+  double step = std::ldexp(1., e);
+  unsigned int most = 0;
+  packed.x.clear();
+  packed.x.reserve(packed.count);
+  for (size_t k = 0; k < n; k++) {
+    if (!packed.present[k]) continue;
+    double x = std::floor((field.values[k] * scale - packed.reference) / step +
+                          0.5);
+    unsigned int u = (unsigned int)std::min(std::max(x, 0.), largest);
+    packed.x.push_back(u);
+    most = std::max(most, u);
+  }
+  packed.bits = BitsFor(most);
+  return true;
+}
+
+void GribWriter::DataSimple(const Packed &packed, int bits,
+                            std::vector<unsigned char> &section) {
+  BitWriter writer(section);
+  for (unsigned int x : packed.x) writer.Put(x, bits);
+}
+
+// ============================================================================
+// GRIB1
+// ============================================================================
+
+bool GribWriter::EncodeGrib1(const Field &field,
+                             std::vector<unsigned char> &out) {
+  if (field.packing != SIMPLE) return false;
+  Packed packed;
+  if (!Pack(field, true, packed)) return false;
+
+  struct tm date;
+  if (!UtcDate(field.reference, date)) return false;
+  int year = date.tm_year + 1900;
+  int century = (year - 1) / 100 + 1;
+
+  std::vector<unsigned char> pds;
+  Put(pds, 28, 3);
+  pds.push_back(2);  // table version
+  pds.push_back(field.center);
+  pds.push_back(field.process);
+  pds.push_back(255);  // grid defined by the GDS
+  bool bitmap = packed.count < packed.present.size();
+  pds.push_back(0x80 | (bitmap ? 0x40 : 0));
+  pds.push_back(field.parameter);
+  pds.push_back(field.levelType);
+  Put(pds, field.levelValue, 2);
+  pds.push_back(year - (century - 1) * 100);
+  pds.push_back(date.tm_mon + 1);
+  pds.push_back(date.tm_mday);
+  pds.push_back(date.tm_hour);
+  pds.push_back(date.tm_min);
+  pds.push_back(1);  // hours
+  if (field.forecastHours < 256) {
+    pds.push_back(field.forecastHours);
+    pds.push_back(0);
+    pds.push_back(0);  // valid at reference + P1
+  } else {
+    Put(pds, field.forecastHours, 2);
+    pds.push_back(10);  // P1 on two octets
+  }
+  Put(pds, 0, 3);  // averaging
+  pds.push_back(century);
+  pds.push_back(0);  // sub-center
+  PutSigned(pds, field.decimalScale, 2);
+
+  std::vector<unsigned char> gds;
+  Put(gds, 32, 3);
+  gds.push_back(0);    // NV
+  gds.push_back(255);  // PV
+  gds.push_back(0);    // lat/lon grid
+  Put(gds, field.ni, 2);
+  Put(gds, field.nj, 2);
+  double lat2 = field.lat1 + (field.nj - 1) * field.dj;
+  double lon2 = field.lon1 + (field.ni - 1) * field.di;
+  PutSigned(gds, std::lround(field.lat1 * 1000), 3);
+  PutSigned(gds, std::lround(field.lon1 * 1000), 3);
+  gds.push_back(0x80);  // increments given
+  PutSigned(gds, std::lround(lat2 * 1000), 3);
+  PutSigned(gds, std::lround(lon2 * 1000), 3);
+  PutSigned(gds, std::lround(std::fabs(field.di) * 1000), 2);
+  PutSigned(gds, std::lround(std::fabs(field.dj) * 1000), 2);
+  gds.push_back((field.di < 0 ? 0x80 : 0) | (field.dj > 0 ? 0x40 : 0));
+  Put(gds, 0, 4);
+
+  std::vector<unsigned char> bms;
+  if (bitmap) {
+    Put(bms, 0, 6);
+    Bitmap(packed.present, bms);
+    if (bms.size() % 2) bms.push_back(0);
+    size_t unused = bms.size() * 8 - 48 - packed.present.size();
+    Set(bms, 0, bms.size(), 3);
+    bms[3] = (unsigned char)unused;
+  }
+
+  std::vector<unsigned char> bds;
+  Put(bds, 0, 11);
+  DataSimple(packed, field.bits, bds);
+  if (bds.size() % 2) bds.push_back(0);
+  size_t unused = (bds.size() - 11) * 8 - packed.count * field.bits;
+  double decoded;
+  Set(bds, 0, bds.size(), 3);
+  bds[3] = (unsigned char)unused;  // grid point, simple packing, floats
+  int e = packed.binaryScale;
+  bds[4] = (unsigned char)((e < 0 ? 0x80 : 0) | (std::abs(e) >> 8));
+  bds[5] = (unsigned char)std::abs(e);
+  Set(bds, 6, IbmBelow(packed.reference, decoded), 4);
+  bds[10] = (unsigned char)field.bits;
+
+  size_t total = 8 + pds.size() + gds.size() + bms.size() + bds.size() + 4;
+  if (total >= 1 << 24) return false;
+  static const unsigned char GRIB[] = {'G', 'R', 'I', 'B'};
+  out.insert(out.end(), GRIB, GRIB + 4);
+  Put(out, total, 3);
+  out.push_back(1);
+  out.insert(out.end(), pds.begin(), pds.end());
+  out.insert(out.end(), gds.begin(), gds.end());
+  out.insert(out.end(), bms.begin(), bms.end());
+  out.insert(out.end(), bds.begin(), bds.end());
+  out.insert(out.end(), {'7', '7', '7', '7'});
+  return true;
+}
+
+// ============================================================================
+// GRIB2
+// ============================================================================
+
+bool GribWriter::EncodeGrib2(const Field &field,
+                             std::vector<unsigned char> &out) {
+  Packed packed;
+  if (field.packing == IEEE) {
+    if (field.bits != 32 && field.bits != 64) return false;
+    Field bounds = field;
+    bounds.bits = MAX_BITS;  // only for the bitmap
+    if (!Pack(bounds, false, packed)) return false;
+  } else if (!Pack(field, false, packed)) {
+    return false;
+  }
+
+  struct tm date;
+  if (!UtcDate(field.reference, date)) return false;
+
+  std::vector<unsigned char> ids;
+  Put(ids, 21, 4);
+  ids.push_back(1);
+  Put(ids, field.center, 2);
+  Put(ids, 0, 2);    // sub-center
+  ids.push_back(2);  // master tables version
+  ids.push_back(0);  // no local tables
+  ids.push_back(1);  // reference is the start of the forecast
+  Put(ids, date.tm_year + 1900, 2);
+  ids.push_back(date.tm_mon + 1);
+  ids.push_back(date.tm_mday);
+  ids.push_back(date.tm_hour);
+  ids.push_back(date.tm_min);
+  ids.push_back(date.tm_sec);
+  ids.push_back(0);  // operational
+  ids.push_back(1);  // forecast
+
+  std::vector<unsigned char> gds;
+  Put(gds, 72, 4);
+  gds.push_back(3);
+  gds.push_back(0);  // grid defined here
+  Put(gds, (uint64_t)field.ni * field.nj, 4);
+  gds.push_back(0);  // no list of points per row
+  gds.push_back(0);
+  Put(gds, 0, 2);    // template 3.0, lat/lon
+  gds.push_back(6);  // spherical earth of 6371229 m
+  gds.push_back(0);
+  Put(gds, 0, 4);
+  gds.push_back(0);
+  Put(gds, 0, 4);
+  gds.push_back(0);
+  Put(gds, 0, 4);
+  Put(gds, field.ni, 4);
+  Put(gds, field.nj, 4);
+  Put(gds, 0, 4);  // basic angle
+  Put(gds, 0xffffffff, 4);
+  double lat2 = field.lat1 + (field.nj - 1) * field.dj;
+  double lon2 = field.lon1 + (field.ni - 1) * field.di;
+  PutSigned(gds, std::llround(field.lat1 * 1e6), 4);
+  PutSigned(gds, std::llround(field.lon1 * 1e6), 4);
+  gds.push_back(0x30);  // increments given
+  PutSigned(gds, std::llround(lat2 * 1e6), 4);
+  PutSigned(gds, std::llround(lon2 * 1e6), 4);
+  Put(gds, std::llround(std::fabs(field.di) * 1e6), 4);
+  Put(gds, std::llround(std::fabs(field.dj) * 1e6), 4);
+  gds.push_back((field.di < 0 ? 0x80 : 0) | (field.dj > 0 ? 0x40 : 0));
+
+  std::vector<unsigned char> pds;
+  Put(pds, 34, 4);
+  pds.push_back(4);
+  Put(pds, 0, 2);  // no vertical coordinates
+  Put(pds, 0, 2);  // template 4.0, forecast at a time
+  pds.push_back(field.category);
+  pds.push_back(field.number);
+  pds.push_back(2);  // forecast
+  pds.push_back(0);
+  pds.push_back(field.process);
+  Put(pds, 0, 2);
+  pds.push_back(0);
+  pds.push_back(1);  // hours
+  Put(pds, field.forecastHours, 4);
+  pds.push_back(field.levelType);
+  pds.push_back(0);
+  PutSigned(pds, field.levelValue, 4);
+  pds.push_back(255);  // no second level
+  pds.push_back(0);
+  Put(pds, 0, 4);
+
+  std::vector<unsigned char> drs, data;
+  Put(drs, 0, 4);
+  drs.push_back(5);
+  Put(drs, packed.count, 4);
+  Put(drs, field.packing, 2);
+  if (field.packing == IEEE) {
+    drs.push_back(field.bits == 32 ? 1 : 2);
+    size_t n = packed.present.size();
+    for (size_t k = 0; k < n; k++) {
+      if (!packed.present[k]) continue;
+      if (field.bits == 32) {
+        Put(data, IeeeBits((float)field.values[k]), 4);
+      } else {
+        uint64_t u;
+        memcpy(&u, &field.values[k], sizeof u);
+        Put(data, u, 8);
+      }
+    }
+  } else {
+    Put(drs, IeeeBits((float)packed.reference), 4);
+    PutSigned(drs, packed.binaryScale, 2);
+    PutSigned(drs, field.decimalScale, 2);
+    switch (field.packing) {
+      case SIMPLE:
+        drs.push_back(field.bits);
+        drs.push_back(0);  // floats
+        DataSimple(packed, field.bits, data);
+        break;
+      case COMPLEX:
+      case COMPLEX_SPATIAL:
+        if (!DataComplex(field, packed, drs, data)) return false;
+        break;
+      case JPEG2000:
+        drs.push_back(packed.bits);
+        drs.push_back(0);    // floats
+        drs.push_back(0);    // lossless
+        drs.push_back(255);  // no compression ratio
+        if (!DataJpeg2000(field, packed, data)) return false;
+        break;
+      default:
+        return false;
+    }
+  }
+  Set(drs, 0, drs.size(), 4);
+
+  std::vector<unsigned char> bms;
+  Put(bms, 0, 4);
+  bms.push_back(6);
+  if (packed.count < packed.present.size()) {
+    bms.push_back(0);
+    Bitmap(packed.present, bms);
+  } else {
+    bms.push_back(255);
+  }
+  Set(bms, 0, bms.size(), 4);
+
+  size_t total = 16 + ids.size() + gds.size() + pds.size() + drs.size() +
+                 bms.size() + 5 + data.size() + 4;
+  if (total > 0x7fffffff) return false;
+  out.insert(out.end(), {'G', 'R', 'I', 'B', 0, 0});
+  out.push_back(field.discipline);
+  out.push_back(2);
+  Put(out, total, 8);
+  out.insert(out.end(), ids.begin(), ids.end());
+  out.insert(out.end(), gds.begin(), gds.end());
+  out.insert(out.end(), pds.begin(), pds.end());
+  out.insert(out.end(), drs.begin(), drs.end());
+  out.insert(out.end(), bms.begin(), bms.end());
+  Put(out, 5 + data.size(), 4);
+  out.push_back(7);
+  out.insert(out.end(), data.begin(), data.end());
+  out.insert(out.end(), {'7', '7', '7', '7'});
+  return true;
+}
+
+bool GribWriter::DataComplex(const Field &field, const Packed &packed,
+                             std::vector<unsigned char> &drs,
+                             std::vector<unsigned char> &data) {
+  const std::vector<unsigned int> &x = packed.x;
+  size_t n = x.size();
+  int order = 0;
+  std::vector<int64_t> v(x.begin(), x.end());
+  int64_t omin = 0;
+  int orderBytes = 0;
+  if (field.packing == COMPLEX_SPATIAL) {
+    order = field.spatialOrder;
+    if (order != 1 && order != 2) return false;
+    // The first values are kept as they are, the rest replaced by their
+    // differences, less the smallest one
+    for (size_t k = n; k-- > (size_t)order;) {
+      v[k] = order == 1 ? v[k] - v[k - 1] : v[k] - 2 * v[k - 1] + v[k - 2];
+    }
+    if (n > (size_t)order)
+      omin = *std::min_element(v.begin() + order, v.end());
+    int64_t first = 0;
+    for (size_t k = 0; k < (size_t)order; k++) {
+      if (k < n) first = std::max(first, v[k]);
+      if (k < n) v[k] = 0;
+    }
+    for (size_t k = order; k < n; k++) v[k] -= omin;
+    int bits = std::max(BitsFor(first), BitsFor(std::abs(omin)) + 1);
+    orderBytes = (bits + 7) / 8;
+    if (orderBytes > 4) return false;
+  }
+
+  unsigned int groups = (unsigned int)((n + GROUP_LENGTH - 1) / GROUP_LENGTH);
+  std::vector<int64_t> refs(groups);
+  std::vector<int> widths(groups);
+  int64_t refMax = 0;
+  int widthMax = 0;
+  for (unsigned int g = 0; g < groups; g++) {
+    auto begin = v.begin() + g * GROUP_LENGTH;
+    auto end = v.begin() + std::min(n, (size_t)(g + 1) * GROUP_LENGTH);
+    auto range = std::minmax_element(begin, end);
+    refs[g] = *range.first;
+    widths[g] = BitsFor(*range.second - *range.first);
+    refMax = std::max(refMax, refs[g]);
+    widthMax = std::max(widthMax, widths[g]);
+  }
+  int refBits = BitsFor(refMax);
+  if (refBits > MAX_BITS || widthMax > MAX_BITS) return false;
+
+  drs.push_back(refBits);
+  drs.push_back(0);  // floats
+  drs.push_back(1);  // general group splitting
+  drs.push_back(0);  // no missing values but in the bitmap
+  Put(drs, 0, 4);
+  Put(drs, 0, 4);
+  Put(drs, groups, 4);
+  drs.push_back(0);  // widths from 0
+  drs.push_back(BitsFor(widthMax));
+  Put(drs, GROUP_LENGTH, 4);  // all groups this long but the last
+  drs.push_back(1);
+  Put(drs, groups ? n - (groups - 1) * GROUP_LENGTH : 0, 4);
+  drs.push_back(0);  // so no bits for the lengths
+  if (order) {
+    drs.push_back(order);
+    drs.push_back(orderBytes);
+  }
+
+  BitWriter writer(data);
+  if (order && groups) {
+    for (int k = 0; k < order; k++)
+      writer.Put((size_t)k < n ? x[k] : 0, orderBytes * 8);
+    writer.Put(omin < 0, 1);
+    writer.Put(std::abs(omin), orderBytes * 8 - 1);
+  }
+  for (unsigned int g = 0; g < groups; g++) writer.Put(refs[g], refBits);
+  writer.Align();
+  for (unsigned int g = 0; g < groups; g++)
+    writer.Put(widths[g], BitsFor(widthMax));
+  writer.Align();
+  for (size_t k = 0; k < n; k++) {
+    unsigned int g = (unsigned int)(k / GROUP_LENGTH);
+    writer.Put(v[k] - refs[g], widths[g]);
+  }
+  return true;
+}
+
+bool GribWriter::DataJpeg2000(const Field &field, const Packed &packed,
+                              std::vector<unsigned char> &data) {
+  if (packed.bits == 0 || packed.x.empty()) return true;  // all R
+#ifdef JASPER
+  // The whole grid as an image, or a row of the values there are
+  bool whole = packed.count == packed.present.size();
+  int width = whole ? field.ni : (int)packed.count;
+  int height = whole ? field.nj : 1;
+
+  jas_image_cmptparm_t parameters;
+  parameters.tlx = 0;
+  parameters.tly = 0;
+  parameters.hstep = 1;
+  parameters.vstep = 1;
+  parameters.width = width;
+  parameters.height = height;
+  parameters.prec = packed.bits;
+  parameters.sgnd = 0;
+  jas_image_t *image = jas_image_create(1, &parameters, JAS_CLRSPC_SGRAY);
+  if (!image) return false;
+  jas_image_setcmpttype(image, 0, JAS_IMAGE_CT_GRAY_Y);
+
+  bool ok = false;
+  jas_matrix_t *matrix = jas_matrix_create(height, width);
+  jas_stream_t *stream = jas_stream_memopen(nullptr, 0);
+  if (matrix && stream) {
+    for (size_t k = 0; k < packed.x.size(); k++)
+      jas_matrix_set(matrix, k / width, k % width, packed.x[k]);
+    ok = jas_image_writecmpt(image, 0, 0, 0, width, height, matrix) == 0 &&
+         jpc_encode(image, stream, nullptr) == 0 &&
+         jas_stream_flush(stream) == 0;
+  }
+  if (ok) {
+    long length = jas_stream_tell(stream);
+    ok = length > 0 && jas_stream_rewind(stream) == 0;
+    if (ok) {
+      size_t at = data.size();
+      data.resize(at + length);
+      ok = jas_stream_read(stream, data.data() + at, length) == length;
+    }
+  }
+  if (stream) jas_stream_close(stream);
+  if (matrix) jas_matrix_destroy(matrix);
+  jas_image_destroy(image);
+  return ok;
+#else
+  return false;
+#endif
+}
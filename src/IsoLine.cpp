@@ -32,6 +32,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // #include "model/georef.h"
 #include <wx/graphics.h>
 
+#include <algorithm>
+
 #include "IsoLine.h"
 #include "GribSettingsDialog.h"
 #include "GribOverlayFactory.h"
@@ -44,10 +46,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // static void ClearSplineList();
 wxList ocpn_wx_spline_point_list;
 
-#include <wx/listimpl.cpp>
-WX_DEFINE_LIST(MySegList);
-WX_DEFINE_LIST(MySegListList);
-
 #ifndef PI
 #define PI 3.14159
 #endif
@@ -165,217 +163,204 @@ ClipResult cohen_sutherland_line_clip_i(int *x0_, int *y0_, int *x1_, int *y1_,
 double round_msvc(double x) { return (floor(x + 0.5)); }
 
 //---------------------------------------------------------------
-IsoLine::IsoLine(double val, double coeff, double offset,
-                 const GribRecord *rec_) {
-  if (wxGetDisplaySize().x > 0) {
-    m_pixelMM = PlugInGetDisplaySizeMM() / wxGetDisplaySize().x;
-    m_pixelMM = wxMax(.02, m_pixelMM);  // protect against bad data
-  } else
-    m_pixelMM = 0.27;  // semi-standard number...
-
-  value = val / coeff - offset;
+// Isolines may be built away from the GUI thread: keep the constructors free
+// of any wx GUI call.
+IsoLine::IsoLine(double val, const GribRecord *rec_) {
+  value = val;
 
-  rec = rec_;
   W = rec_->getNi();
   H = rec_->getNj();
+}
 
-  //---------------------------------------------------------
-  // Génère la liste des segments.
-  extractIsoLine(rec_);
-
-  value = val;
-
-  if (trace.size() == 0) return;
+//---------------------------------------------------------------
+IsoLine::IsoLine(double val, double coeff, double offset,
+                 const GribRecord *rec_)
+    : IsoLine(val, rec_) {
+  std::vector<IsoLinePolylines> lines;
+  IsoLineTracer::Trace(rec_->getValues(), rec_->getGridGeometry(),
+                       std::vector<double>(1, val / coeff - offset), lines);
+  std::swap(m_lines, lines[0]);
+}
 
-  //      Join the isoline segments into a nice list
-  //      Which is end-to-end continuous and unidirectional
+//---------------------------------------------------------------
+IsoLine::~IsoLine() {}
 
-  //      Create a master wxList of the trace list
-  std::list<Segment *>::iterator it;
-  for (it = trace.begin(); it != trace.end(); it++) {
-    Segment *seg = *it;
-    seg->bUsed = false;
-    m_seglist.Append(*it);
+//---------------------------------------------------------------
+std::vector<IsoLine *> IsoLine::BuildIsoLines(
+    const std::vector<double> &values, const std::vector<double> &rawValues,
+    const GribRecord *rec) {
+  size_t nlevels = std::min(values.size(), rawValues.size());
+
+  std::vector<IsoLinePolylines> lines;
+  IsoLineTracer::Trace(
+      rec->getValues(), rec->getGridGeometry(),
+      std::vector<double>(rawValues.begin(), rawValues.begin() + nlevels),
+      lines);
+
+  std::vector<IsoLine *> isolines;
+  isolines.reserve(nlevels);
+  for (size_t k = 0; k < nlevels; k++) {
+    isolines.push_back(new IsoLine(values[k], rec));
+    std::swap(isolines.back()->m_lines, lines[k]);
   }
+  return isolines;
+}
 
-  //      Isoline may be discontinuous....
-  //      So build a list of continuous segments
-  bool bdone = false;
-  while (!bdone) {
-    MySegList *ps = BuildContinuousSegment();
-
-    m_SegListList.Append(ps);
-
-    MySegList::Node *node;
-    Segment *seg;
-
-    // recreate the master list, removing used segs
+//---------------------------------------------------------------
+// Zoom bands
+//---------------------------------------------------------------
+// Band b simplifies polylines with a tolerance of ISO_BAND_TOLERANCE * 2^b
+// degrees, the largest that stays under ISO_SIMPLIFY_PIXELS on screen.
+#define ISO_SIMPLIFY_PIXELS 0.5
+#define ISO_BAND_TOLERANCE 1e-3
+#define ISO_BAND_MIN -8
+#define ISO_BAND_MAX 16
+
+int IsoLine::getZoomBand(PlugIn_ViewPort *vp) {
+  // Mercator stretches latitudes by 1/cos(lat): use the worst visible one
+  double lat = wxMin(85., wxMax(fabs(vp->lat_min), fabs(vp->lat_max)));
+  double pixPerDeg = vp->view_scale_ppm * 1852. * 60. / cos(lat * M_PI / 180.);
+  if (!(pixPerDeg > 0)) return ISO_BAND_MIN;
+
+  double tolerance = ISO_SIMPLIFY_PIXELS / pixPerDeg;
+  int band = (int)floor(log2(tolerance / ISO_BAND_TOLERANCE));
+  return wxMax(ISO_BAND_MIN, wxMin(ISO_BAND_MAX, band));
+}
 
-    node = m_seglist.GetFirst();
-    while (node) {
-      seg = node->GetData();
-      if (seg->bUsed) {
-        m_seglist.Erase(node);
-        node = m_seglist.GetFirst();
+//---------------------------------------------------------------
+// Douglas-Peucker simplification of points[first..last], marking the
+// vertices to keep. Segments jumping across the antimeridian keep both ends
+// so the wrap test of drawIsoLine still sees them.
+static void simplifyPolyline(const std::vector<IsoLinePoint> &points,
+                             size_t first, size_t last, double tolerance,
+                             std::vector<char> &keep) {
+  keep[first] = keep[last] = 1;
+  for (size_t k = first + 1; k <= last; k++)
+    if (fabs(points[k].x - points[k - 1].x) > 180) keep[k - 1] = keep[k] = 1;
+
+  double tol2 = tolerance * tolerance;
+  std::vector<std::pair<size_t, size_t>> stack;
+  size_t start = first;
+  for (size_t k = first + 1; k <= last; k++)
+    if (keep[k]) stack.push_back({start, k}), start = k;
+
+  while (!stack.empty()) {
+    size_t i0 = stack.back().first, i1 = stack.back().second;
+    stack.pop_back();
+    if (i1 <= i0 + 1) continue;
+
+    const IsoLinePoint &p0 = points[i0], &p1 = points[i1];
+    double dx = p1.x - p0.x, dy = p1.y - p0.y;
+    double len2 = dx * dx + dy * dy;
+
+    double dmax = -1;
+    size_t imax = i0;
+    for (size_t k = i0 + 1; k < i1; k++) {
+      double ex = points[k].x - p0.x, ey = points[k].y - p0.y;
+      double d2;
+      if (len2 > 0) {
+        double c = ex * dy - ey * dx;
+        d2 = c * c / len2;
       } else
-        node = node->GetNext();
+        d2 = ex * ex + ey * ey;  // closed loop: distance to the end point
+      if (d2 > dmax) dmax = d2, imax = k;
+    }
+    if (dmax > tol2) {
+      keep[imax] = 1;
+      stack.push_back({i0, imax});
+      stack.push_back({imax, i1});
     }
-
-    if (0 == m_seglist.GetCount()) bdone = true;
   }
-
-  /// printf("create Isobar : press=%4.0f long=%d\n", pressure/100,
-  /// trace.size());
 }
-//---------------------------------------------------------------
-IsoLine::~IsoLine() {
-  // printf("delete Isobar : press=%4.0f long=%d\n", pressure/100,
-  // trace.size());
-
-  std::list<Segment *>::iterator it;
-  for (it = trace.begin(); it != trace.end(); it++) {
-    delete *it;
-    *it = nullptr;
-  }
-  trace.clear();
-
-  m_SegListList.DeleteContents(true);
-  m_SegListList.Clear();
-}
-
-MySegList *IsoLine::BuildContinuousSegment(void) {
-  MySegList::Node *node;
-  Segment *seg;
-
-  MySegList *ret_list = new MySegList;
-
-  //     Build a chain extending from the "2" end of the target segment
-  //      The joined list, side 2...
-  MySegList segjoin2;
-
-  //      Add any first segment to the list
-  node = m_seglist.GetFirst();
-  Segment *seg0 = node->GetData();
-  seg0->bUsed = true;
-  segjoin2.Append(seg0);
 
-  Segment *tseg = seg0;
+const IsoLinePolylines &IsoLine::getPolylines(int band) {
+  if (band < 0) return m_lines;
 
-  while (tseg) {
-    bool badded = false;
-    Segment *seg;
-    node = m_seglist.GetFirst();
-    while (node) {
-      seg = node->GetData();
+  auto it = m_simplified.find(band);
+  if (it != m_simplified.end()) return it->second;
 
-      if ((!seg->bUsed) && (seg->py1 == tseg->py2) &&
-          (seg->px1 == tseg->px2))  // fits without reverse
-      {
-        seg->bUsed = true;
-        segjoin2.Append(seg);
-        badded = true;
-        break;
-      } else if ((!seg->bUsed) && (seg->py2 == tseg->py2) &&
-                 (seg->px2 == tseg->px2))  // fits, needs reverse
-      {
-        seg->bUsed = true;
-        double a = seg->px2;
-        seg->px2 = seg->px1;
-        seg->px1 = a;
-        double b = seg->py2;
-        seg->py2 = seg->py1;
-        seg->py1 = b;
-        segjoin2.Append(seg);
-        badded = true;
-        break;
-      }
+  IsoLinePolylines &out = m_simplified[band];
+  double tolerance = ISO_BAND_TOLERANCE * pow(2., band);
+  std::vector<char> keep(m_lines.points.size(), 0);
+  for (size_t line = 0; line + 1 < m_lines.lineStart.size(); line++) {
+    size_t first = m_lines.lineStart[line];
+    size_t last = m_lines.lineStart[line + 1] - 1;
+    if (last <= first) continue;
+    simplifyPolyline(m_lines.points, first, last, tolerance, keep);
 
-      node = node->GetNext();
-    }
-    if (badded == true)
-      tseg = seg;
-    else
-      tseg = nullptr;
+    out.lineStart.push_back(out.points.size());
+    for (size_t k = first; k <= last; k++)
+      if (keep[k]) out.points.push_back(m_lines.points[k]);
   }
+  out.lineStart.push_back(out.points.size());
+  return out;
+}
 
-  //     Build a chain extending from the "1" end of the target segment
-  //      The joined list, side 1...
-  MySegList segjoin1;
-
-  //      Add the same first segment to the list
-  node = m_seglist.GetFirst();
-  seg0 = node->GetData();
-  seg0->bUsed = true;
-  segjoin1.Append(seg0);
-
-  tseg = seg0;
-
-  while (tseg) {
-    bool badded = false;
-    node = m_seglist.GetFirst();
-    while (node) {
-      seg = node->GetData();
-
-      if ((!seg->bUsed) && (seg->py2 == tseg->py1) &&
-          (seg->px2 == tseg->px1))  // fits without reverse
-      {
-        seg->bUsed = true;
-        segjoin1.Append(seg);
-        badded = true;
-        break;
-      } else if ((!seg->bUsed) && (seg->py1 == tseg->py1) &&
-                 (seg->px1 == tseg->px1))  // fits, needs reverse
-      {
-        seg->bUsed = true;
-        double a = seg->px2;
-        seg->px2 = seg->px1;
-        seg->px1 = a;
-        double b = seg->py2;
-        seg->py2 = seg->py1;
-        seg->py1 = b;
-        segjoin1.Append(seg);
-        badded = true;
-        break;
+//---------------------------------------------------------------
+// Label positions are chosen in Mercator space at the scale and rotation of
+// the view, rather than projecting every candidate point each frame, and
+// kept while the view only pans. The scale goes in steps of a quarter
+// octave and the rotation in steps of 5 degrees, so zooming or rotating
+// reuses a layout until the overlap test would change noticeably. width and
+// height are the size of the (inflated) label rectangle in pixels.
+#define ISO_LABEL_CACHE_MAX 8
+#define ISO_LABEL_SCALE_STEPS 4  // per doubling of view_scale_ppm
+#define ISO_LABEL_ROTATION_STEP (M_PI / 36)
+
+const std::vector<IsoLinePoint> &IsoLine::getLabelPositions(
+    PlugIn_ViewPort *vp, int density, int first, int width, int height) {
+  double ppm = wxMax(vp->view_scale_ppm, 1e-12);
+  int scaleStep = (int)lround(log2(ppm) * ISO_LABEL_SCALE_STEPS);
+  int rotationStep = (int)lround(vp->rotation / ISO_LABEL_ROTATION_STEP);
+  LabelKey key{scaleStep, rotationStep, density, first, width, height};
+  auto it = m_labelCache.find(key);
+  if (it != m_labelCache.end()) return it->second;
+  if (m_labelCache.size() >= ISO_LABEL_CACHE_MAX) m_labelCache.clear();
+
+  std::vector<LabelCandidate> &candidates =
+      m_labelCandidates[std::make_pair(density, first)];
+  if (candidates.empty()) {
+    int nb = first;
+    for (size_t line = 0; line + 1 < m_lines.lineStart.size(); line++) {
+      for (size_t k = m_lines.lineStart[line];
+           k + 1 < m_lines.lineStart[line + 1]; k++, nb++) {
+        if (nb % density != 0) continue;
+        const IsoLinePoint &pt = m_lines.points[k];
+        double lat = wxMin(85., wxMax(-85., pt.y)) * M_PI / 180.;
+        candidates.push_back(
+            {pt, pt.x, log(tan(M_PI / 4 + lat / 2)) * 180. / M_PI});
       }
-
-      node = node->GetNext();
     }
-    if (badded == true)
-      tseg = seg;
-    else
-      tseg = nullptr;
-  }
-
-  //     Now have two lists...
-
-  //     Start with "1" side list,
-  //    starting from the end, and skipping the first segment
-
-  int n1 = segjoin1.GetCount();
-  for (int i = n1 - 1; i > 0; i--) {
-    node = segjoin1.Item(i);
-    seg = node->GetData();
-    ret_list->Append(seg);
   }
 
-  //     Now add the "2"side list
-  int n2 = segjoin2.GetCount();
-  for (int i = 0; i < n2; i++) {
-    node = segjoin2.Item(i);
-    seg = node->GetData();
-    ret_list->Append(seg);
+  // Screen pixels as GetCanvasPixLL has them, up to a translation
+  double pixPerDeg =
+      pow(2., (double)scaleStep / ISO_LABEL_SCALE_STEPS) * 1852. * 60.;
+  double rotation = rotationStep * ISO_LABEL_ROTATION_STEP;
+  double cosr = cos(-rotation), sinr = sin(-rotation);
+
+  std::vector<IsoLinePoint> &labels = m_labelCache[key];
+  bool hasPrev = false;
+  double prevx = 0, prevy = 0;
+  for (const LabelCandidate &c : candidates) {
+    double dx = c.x * pixPerDeg, dy = -c.y * pixPerDeg;
+    double x = dx * cosr - dy * sinr, y = dx * sinr + dy * cosr;
+
+    // same rectangle overlap test as wxRect::Intersects for equal sizes
+    if (hasPrev && fabs(x - prevx) < width && fabs(y - prevy) < height)
+      continue;
+
+    labels.push_back(c.pt);
+    prevx = x, prevy = y;
+    hasPrev = true;
   }
-
-  //     And there it is
-
-  return ret_list;
+  return labels;
 }
 
 //---------------------------------------------------------------
 void IsoLine::drawIsoLine(GRIBOverlayFactory *pof, wxDC *dc,
                           PlugIn_ViewPort *vp, bool bHiDef) {
-  int nsegs = trace.size();
-  if (nsegs < 1) return;
+  if (getNbSegments() < 1) return;
 
   GetGlobalColor(_T ( "UITX1" ), &isoLineColor);
 
@@ -395,21 +380,6 @@ void IsoLine::drawIsoLine(GRIBOverlayFactory *pof, wxDC *dc,
     dc->SetPen(ppISO);
   } else { /* opengl */
 #ifdef ocpnUSE_GL
-    // #ifndef USE_ANDROID_GLES2
-    //            if(m_pixelMM > 0.2){        // pixel size large enough to
-    //            render well
-    //            //      Enable anti-aliased lines, at best quality
-    //              glEnable( GL_LINE_SMOOTH );
-    //              glEnable( GL_BLEND );
-    //              glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-    //              glHint( GL_LINE_SMOOTH_HINT, GL_NICEST );
-    //              glLineWidth( 2 );
-    //            }
-    //            else{
-    //              glLineWidth( 0.4/m_pixelMM);        //  set a target line
-    //              width by MM
-    //            }
-    // #else
     if (pof->m_oDC) {
       wxPen ppISO(isoLineColor, 2);
       pof->m_oDC->SetPen(ppISO);
@@ -417,59 +387,69 @@ void IsoLine::drawIsoLine(GRIBOverlayFactory *pof, wxDC *dc,
 #endif
   }
 
-  std::list<Segment *>::iterator it;
+  bool wrapCheck = vp->m_projection_type == PI_PROJECTION_MERCATOR ||
+                   vp->m_projection_type == PI_PROJECTION_EQUIRECTANGULAR;
+
+  // Only as many vertices as can be told apart at this zoom
+  const IsoLinePolylines &lines = getPolylines(getZoomBand(vp));
+  const std::vector<IsoLinePoint> &points = lines.points;
 
   //---------------------------------------------------------
   // Dessine les segments
   //---------------------------------------------------------
-  for (it = trace.begin(); it != trace.end(); it++) {
-    Segment *seg = *it;
-
-    if (vp->m_projection_type == PI_PROJECTION_MERCATOR ||
-        vp->m_projection_type == PI_PROJECTION_EQUIRECTANGULAR) {
-      /* skip segments that go the wrong way around the world */
-      double sx1 = seg->px1, sx2 = seg->px2;
-      if (sx2 - sx1 > 180)
-        sx2 -= 360;
-      else if (sx1 - sx2 > 180)
-        sx1 -= 360;
-
-      if ((sx1 + 180 < vp->clon && sx2 + 180 > vp->clon) ||
-          (sx1 + 180 > vp->clon && sx2 + 180 < vp->clon) ||
-          (sx1 - 180 < vp->clon && sx2 - 180 > vp->clon) ||
-          (sx1 - 180 > vp->clon && sx2 - 180 < vp->clon))
-        continue;
-    }
+  for (size_t line = 0; line + 1 < lines.lineStart.size(); line++) {
+    size_t first = lines.lineStart[line], last = lines.lineStart[line + 1];
+    if (last - first < 2) continue;
 
     wxPoint ab;
-    GetCanvasPixLL(vp, &ab, seg->py1, seg->px1);
-    wxPoint cd;
-    GetCanvasPixLL(vp, &cd, seg->py2, seg->px2);
+    GetCanvasPixLL(vp, &ab, points[first].y, points[first].x);
+    for (size_t k = first + 1; k < last; k++) {
+      const IsoLinePoint &p1 = points[k - 1];
+      const IsoLinePoint &p2 = points[k];
+
+      wxPoint cd;
+      GetCanvasPixLL(vp, &cd, p2.y, p2.x);
+
+      if (wrapCheck) {
+        /* skip segments that go the wrong way around the world */
+        double sx1 = p1.x, sx2 = p2.x;
+        if (sx2 - sx1 > 180)
+          sx2 -= 360;
+        else if (sx1 - sx2 > 180)
+          sx1 -= 360;
+
+        if ((sx1 + 180 < vp->clon && sx2 + 180 > vp->clon) ||
+            (sx1 + 180 > vp->clon && sx2 + 180 < vp->clon) ||
+            (sx1 - 180 < vp->clon && sx2 - 180 > vp->clon) ||
+            (sx1 - 180 > vp->clon && sx2 - 180 < vp->clon)) {
+          ab = cd;
+          continue;
+        }
+      }
 
-    if (dc) {
+      if (dc) {
 #if wxUSE_GRAPHICS_CONTEXT
-      if (bHiDef && pgc)
-        pgc->StrokeLine(ab.x, ab.y, cd.x, cd.y);
-      else
+        if (bHiDef && pgc)
+          pgc->StrokeLine(ab.x, ab.y, cd.x, cd.y);
+        else
 #endif
-        dc->DrawLine(ab.x, ab.y, cd.x, cd.y);
-    } else { /* opengl */
+          dc->DrawLine(ab.x, ab.y, cd.x, cd.y);
+      } else { /* opengl */
 #ifdef ocpnUSE_GL
 
-      if (pof->m_oDC) {
-        pof->m_oDC->DrawLine(ab.x, ab.y, cd.x, cd.y);
-      }
+        if (pof->m_oDC) {
+          pof->m_oDC->DrawLine(ab.x, ab.y, cd.x, cd.y);
+        }
 
 #endif
+      }
+      ab = cd;
     }
   }
 
 #if wxUSE_GRAPHICS_CONTEXT
   delete pgc;
 #endif
-
-  //      if(!dc) /* opengl */
-  //          glEnd();
 }
 
 //---------------------------------------------------------------
@@ -479,46 +459,27 @@ void IsoLine::drawIsoLineLabels(GRIBOverlayFactory *pof, wxDC *dc,
                                 wxImage &imageLabel)
 
 {
-  std::list<Segment *>::iterator it;
-  int nb = first;
-  wxString label;
+  int w = imageLabel.GetWidth();
+  int h = imageLabel.GetHeight();
+  int label_offset = 6;
 
   //---------------------------------------------------------
   // Ecrit les labels
   //---------------------------------------------------------
-  wxRect prev;
-  for (it = trace.begin(); it != trace.end(); it++, nb++) {
-    if (nb % density == 0) {
-      Segment *seg = *it;
+  // label rectangle (w, h) inflated by w on each side
+  const std::vector<IsoLinePoint> &labels =
+      getLabelPositions(vp, density, first, 3 * w, h + 2 * w);
+  for (const IsoLinePoint &pt : labels) {
+    wxPoint ab;
+    GetCanvasPixLL(vp, &ab, pt.y, pt.x);
 
-      //            if(vp->vpBBox.PointInBox((seg->px1 + seg->px2)/2., (seg->py1
-      //            + seg->py2)/2., 0.))
-      {
-        wxPoint ab;
-        GetCanvasPixLL(vp, &ab, seg->py1, seg->px1);
-        wxPoint cd;
-        GetCanvasPixLL(vp, &cd, seg->py1, seg->px1);
-
-        int w = imageLabel.GetWidth();
-        int h = imageLabel.GetHeight();
-
-        int label_offset = 6;
-        int xd = (ab.x + cd.x - (w + label_offset * 2)) / 2;
-        int yd = (ab.y + cd.y - h) / 2;
-
-        int x = xd - label_offset;
-        wxRect r(x, yd, w, h);
-        r.Inflate(w);
-        if (!prev.Intersects(r)) {
-          prev = r;
-
-          /* don't use alpha for isobars, for some reason draw bitmap ignores
-             the 4th argument (true or false has same result) */
-          wxImage img(w, h, imageLabel.GetData(), true);
-          dc->DrawBitmap(img, xd, yd, false);
-        }
-      }
-    }
+    int xd = ab.x - (w + label_offset * 2) / 2;
+    int yd = ab.y - h / 2;
+
+    /* don't use alpha for isobars, for some reason draw bitmap ignores
+       the 4th argument (true or false has same result) */
+    wxImage img(w, h, imageLabel.GetData(), true);
+    dc->DrawBitmap(img, xd, yd, false);
   }
 }
 
@@ -527,230 +488,41 @@ void IsoLine::drawIsoLineLabelsGL(GRIBOverlayFactory *pof, PlugIn_ViewPort *vp,
                                   wxColour &color, TexFont &texfont)
 
 {
-  std::list<Segment *>::iterator it;
-  int nb = first;
-
 #ifdef ocpnUSE_GL
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  int w, h;
+  texfont.GetTextExtent(label, &w, &h);
+
+  int label_offsetx = 6, label_offsety = 1;
+  int rw = w + 2 * label_offsetx, rh = h + 2 * label_offsety;
+
   //---------------------------------------------------------
   // Ecrit les labels
   //---------------------------------------------------------
-  wxRect prev;
-  for (it = trace.begin(); it != trace.end(); it++, nb++) {
-    if (nb % density == 0) {
-      Segment *seg = *it;
+  // label box (rw, rh) inflated by rw on each side
+  const std::vector<IsoLinePoint> &labels =
+      getLabelPositions(vp, density, first, 3 * rw, rh + 2 * rw);
+  for (const IsoLinePoint &pt : labels) {
+    wxPoint ab;
+    GetCanvasPixLL(vp, &ab, pt.y, pt.x);
 
-      //            if(vp->vpBBox.PointInBox((seg->px1 + seg->px2)/2., (seg->py1
-      //            + seg->py2)/2., 0.))
-      {
-        wxPoint ab;
-        GetCanvasPixLL(vp, &ab, seg->py1, seg->px1);
-        wxPoint cd;
-        GetCanvasPixLL(vp, &cd, seg->py1, seg->px1);
-
-        int w, h;
-        texfont.GetTextExtent(label, &w, &h);
-
-        int label_offsetx = 6, label_offsety = 1;
-        int xd = (ab.x + cd.x - (w + label_offsetx * 2)) / 2;
-        int yd = (ab.y + cd.y - h) / 2;
-        int x = xd - label_offsetx, y = yd - label_offsety;
-        w += 2 * label_offsetx, h += 2 * label_offsety;
-
-        wxRect r(x, y, w, h);
-        r.Inflate(w);
-        if (!prev.Intersects(r)) {
-#if 1
-          prev = r;
-          if (pof->m_oDC) {
-            // pof->m_oDC->SetFont( *mfont );
-            pof->m_oDC->SetPen(*wxBLACK_PEN);
-            pof->m_oDC->SetBrush(color);
-            pof->m_oDC->DrawRectangle(x, y, w, h);
-            pof->m_oDC->DrawText(label, xd, yd);
-          }
-
-#else
-          prev = r;
-          glColor4ub(color.Red(), color.Green(), color.Blue(), color.Alpha());
-
-          /* draw bounding rectangle */
-          glBegin(GL_QUADS);
-          glVertex2i(x, y);
-          glVertex2i(x + w, y);
-          glVertex2i(x + w, y + h);
-          glVertex2i(x, y + h);
-          glEnd();
-
-          glColor3ub(0, 0, 0);
-
-          glBegin(GL_LINE_LOOP);
-          glVertex2i(x, y);
-          glVertex2i(x + w, y);
-          glVertex2i(x + w, y + h);
-          glVertex2i(x, y + h);
-          glEnd();
-
-          glEnable(GL_TEXTURE_2D);
-          texfont.RenderString(label, xd, yd);
-          glDisable(GL_TEXTURE_2D);
-#endif
-        }
-      }
+    int xd = ab.x - (w + label_offsetx * 2) / 2;
+    int yd = ab.y - h / 2;
+    int x = xd - label_offsetx, y = yd - label_offsety;
+
+    if (pof->m_oDC) {
+      pof->m_oDC->SetPen(*wxBLACK_PEN);
+      pof->m_oDC->SetBrush(color);
+      pof->m_oDC->DrawRectangle(x, y, rw, rh);
+      pof->m_oDC->DrawText(label, xd, yd);
     }
   }
   glDisable(GL_BLEND);
 #endif
 }
 
-//==================================================================================
-// Segment
-//==================================================================================
-Segment::Segment(int I, int w, int J, char c1, char c2, char c3, char c4,
-                 const GribRecord *rec, double pressure) {
-  traduitCode(I, w, J, c1, i, j);
-  traduitCode(I, w, J, c2, k, l);
-  traduitCode(I, w, J, c3, m, n);
-  traduitCode(I, w, J, c4, o, p);
-
-  intersectionAreteGrille(i, j, k, l, &px1, &py1, rec, pressure);
-  intersectionAreteGrille(m, n, o, p, &px2, &py2, rec, pressure);
-}
-//-----------------------------------------------------------------------
-void Segment::intersectionAreteGrille(int i, int j, int k, int l, double *x,
-                                      double *y, const GribRecord *rec,
-                                      double pressure) {
-  double xa, xb, ya, yb, pa, pb, dec;
-  pa = rec->getValue(i, j);
-  pb = rec->getValue(k, l);
-
-  rec->getXY(i, j, &xa, &ya);
-  rec->getXY(k, l, &xb, &yb);
-
-  // Abscisse
-  if (pb != pa)
-    dec = (pressure - pa) / (pb - pa);
-  else
-    dec = 0.5;
-  if (fabs(dec) > 1) dec = 0.5;
-  double xd = xb - xa;
-  if (xd < -180)
-    xd += 360;
-  else if (xd > 180)
-    xd -= 360;
-  *x = xa + xd * dec;
-
-  // Ordonnée
-  if (pb != pa)
-    dec = (pressure - pa) / (pb - pa);
-  else
-    dec = 0.5;
-  if (fabs(dec) > 1) dec = 0.5;
-  *y = ya + (yb - ya) * dec;
-}
-//---------------------------------------------------------------
-void Segment::traduitCode(int I, int w, int J, char c1, int &i, int &j) {
-  int Im1 = I ? I - 1 : w - 1;
-  switch (c1) {
-    case 'a':
-      i = Im1;
-      j = J - 1;
-      break;
-    case 'b':
-      i = I;
-      j = J - 1;
-      break;
-    case 'c':
-      i = Im1;
-      j = J;
-      break;
-    case 'd':
-      i = I;
-      j = J;
-      break;
-    default:
-      i = I;
-      j = J;
-  }
-}
-
-//-----------------------------------------------------------------------
-// Génère la liste des segments.
-// Les coordonnées sont les indices dans la grille du GribRecord
-//---------------------------------------------------------
-void IsoLine::extractIsoLine(const GribRecord *rec) {
-  int i, j, W, H;
-  double a, b, c, d;
-  W = rec->getNi();
-  H = rec->getNj();
-
-  int We = W;
-  if (rec->getLonMax() + rec->getDi() - rec->getLonMin() == 360) We++;
-
-  for (j = 1; j < H; j++)  // !!!! 1 to end
-  {
-    a = rec->getValue(0, j - 1);
-    c = rec->getValue(0, j);
-    for (i = 1; i < We; i++, a = b, c = d) {
-      //            x = rec->getX(i);
-      //            y = rec->getY(j);
-
-      int ni = i;
-      if (i == W) ni = 0;
-      b = rec->getValue(ni, j - 1);
-      d = rec->getValue(ni, j);
-
-      if (a == GRIB_NOTDEF || b == GRIB_NOTDEF || c == GRIB_NOTDEF ||
-          d == GRIB_NOTDEF)
-        continue;
-
-      if ((a < value && b < value && c < value && d < value) ||
-          (a > value && b > value && c > value && d > value))
-        continue;
-
-      // Détermine si 1 ou 2 segments traversent la case ab-cd
-      // a  b
-      // c  d
-      //--------------------------------
-      // 1 segment en diagonale
-      //--------------------------------
-      if ((a <= value && b <= value && c <= value && d > value) ||
-          (a > value && b > value && c > value && d <= value))
-        trace.push_back(new Segment(ni, W, j, 'c', 'd', 'b', 'd', rec, value));
-      else if ((a <= value && c <= value && d <= value && b > value) ||
-               (a > value && c > value && d > value && b <= value))
-        trace.push_back(new Segment(ni, W, j, 'a', 'b', 'b', 'd', rec, value));
-      else if ((c <= value && d <= value && b <= value && a > value) ||
-               (c > value && d > value && b > value && a <= value))
-        trace.push_back(new Segment(ni, W, j, 'a', 'b', 'a', 'c', rec, value));
-      else if ((a <= value && b <= value && d <= value && c > value) ||
-               (a > value && b > value && d > value && c <= value))
-        trace.push_back(new Segment(ni, W, j, 'a', 'c', 'c', 'd', rec, value));
-      //--------------------------------
-      // 1 segment H ou V
-      //--------------------------------
-      else if ((a <= value && b <= value && c > value && d > value) ||
-               (a > value && b > value && c <= value && d <= value))
-        trace.push_back(new Segment(ni, W, j, 'a', 'c', 'b', 'd', rec, value));
-      else if ((a <= value && c <= value && b > value && d > value) ||
-               (a > value && c > value && b <= value && d <= value))
-        trace.push_back(new Segment(ni, W, j, 'a', 'b', 'c', 'd', rec, value));
-      //--------------------------------
-      // 2 segments en diagonale
-      //--------------------------------
-      else if (a <= value && d <= value && c > value && b > value) {
-        trace.push_back(new Segment(ni, W, j, 'a', 'b', 'b', 'd', rec, value));
-        trace.push_back(new Segment(ni, W, j, 'a', 'c', 'c', 'd', rec, value));
-      } else if (a > value && d > value && c <= value && b <= value) {
-        trace.push_back(new Segment(ni, W, j, 'a', 'b', 'a', 'c', rec, value));
-        trace.push_back(new Segment(ni, W, j, 'b', 'd', 'c', 'd', rec, value));
-      }
-    }
-  }
-}
-
 // ----------------------------------------------------------------------------
 // splines code lifted from wxWidgets
 // ----------------------------------------------------------------------------
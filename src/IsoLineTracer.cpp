@@ -0,0 +1,281 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref IsoLineTracer.h
+ */
+
+#include "IsoLineTracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+// Part of an isoline crossing one grid cell, from edge e1 to edge e2.
+// An edge is identified by its first grid node and its orientation, so the
+// two cells sharing an edge give it the same id.
+struct IsoSegment {
+  uint64_t e1, e2;
+  double x1, y1, x2, y2;
+};
+
+// Cell edges, with the corners named as in extractIsoLines
+// a  b
+// c  d
+enum { EDGE_AB, EDGE_CD, EDGE_AC, EDGE_BD };
+
+struct IsoCell {
+  int I, Im1, J, W;
+  double a, b, c, d;
+};
+
+uint64_t edgeId(int i, int j, int W, bool vertical) {
+  return ((uint64_t)j * W + i) << 1 | (vertical ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------
+// Intersection de l'isoligne avec une arête de la case
+void intersectionAreteGrille(const IsoCell &cell, int edge,
+                             const GribGridGeometry &grid, double value,
+                             uint64_t *id, double *x, double *y) {
+  int i, j, k, l;
+  double pa, pb;
+  switch (edge) {
+    case EDGE_AB:
+      i = cell.Im1, j = cell.J - 1, k = cell.I, l = cell.J - 1;
+      pa = cell.a, pb = cell.b;
+      *id = edgeId(i, j, cell.W, false);
+      break;
+    case EDGE_CD:
+      i = cell.Im1, j = cell.J, k = cell.I, l = cell.J;
+      pa = cell.c, pb = cell.d;
+      *id = edgeId(i, j, cell.W, false);
+      break;
+    case EDGE_AC:
+      i = cell.Im1, j = cell.J - 1, k = cell.Im1, l = cell.J;
+      pa = cell.a, pb = cell.c;
+      *id = edgeId(i, j, cell.W, true);
+      break;
+    default:  // EDGE_BD
+      i = cell.I, j = cell.J - 1, k = cell.I, l = cell.J;
+      pa = cell.b, pb = cell.d;
+      *id = edgeId(i, j, cell.W, true);
+      break;
+  }
+
+  double xa, xb, ya, yb, dec;
+  xa = grid.Lo1 + i * grid.Di, ya = grid.La1 + j * grid.Dj;
+  xb = grid.Lo1 + k * grid.Di, yb = grid.La1 + l * grid.Dj;
+
+  if (pb != pa)
+    dec = (value - pa) / (pb - pa);
+  else
+    dec = 0.5;
+  if (fabs(dec) > 1) dec = 0.5;
+
+  double xd = xb - xa;
+  if (xd < -180)
+    xd += 360;
+  else if (xd > 180)
+    xd -= 360;
+  *x = xa + xd * dec;
+  *y = ya + (yb - ya) * dec;
+}
+
+void addSegment(std::vector<IsoSegment> &segs, const IsoCell &cell,
+                int edge1, int edge2, const GribGridGeometry &grid,
+                double value) {
+  IsoSegment s;
+  intersectionAreteGrille(cell, edge1, grid, value, &s.e1, &s.x1, &s.y1);
+  intersectionAreteGrille(cell, edge2, grid, value, &s.e2, &s.x2, &s.y2);
+  segs.push_back(s);
+}
+
+//-----------------------------------------------------------------------
+// Génère les segments de tous les niveaux en un seul passage sur la grille.
+// levels doit être trié par ordre croissant.
+//-----------------------------------------------------------------------
+void extractIsoLines(const double *values, const GribGridGeometry &grid,
+                     const std::vector<double> &levels,
+                     std::vector<std::vector<IsoSegment>> &segs) {
+  int W = grid.Ni;
+  int H = grid.Nj;
+
+  int We = W;
+  double lonMin = std::min(grid.Lo1, grid.Lo2);
+  double lonMax = std::max(grid.Lo1, grid.Lo2);
+  if (lonMax + grid.Di - lonMin == 360) We++;
+
+  IsoCell cell;
+  cell.W = W;
+  for (int j = 1; j < H; j++)  // !!!! 1 to end
+  {
+    cell.J = j;
+    double a = values[(j - 1) * W];
+    double c = values[j * W];
+    for (int i = 1; i < We; i++, a = cell.b, c = cell.d) {
+      int ni = i;
+      if (i == W) ni = 0;
+      cell.I = ni;
+      cell.Im1 = ni ? ni - 1 : W - 1;
+      cell.a = a;
+      cell.c = c;
+      cell.b = values[(j - 1) * W + ni];
+      cell.d = values[j * W + ni];
+      double b = cell.b, d = cell.d;
+
+      if (a == GRIB_NOTDEF || b == GRIB_NOTDEF || c == GRIB_NOTDEF ||
+          d == GRIB_NOTDEF)
+        continue;
+
+      // Only the levels within [min, max] of the corners cross this cell
+      double vmin = std::min(std::min(a, b), std::min(c, d));
+      double vmax = std::max(std::max(a, b), std::max(c, d));
+      size_t k = std::lower_bound(levels.begin(), levels.end(), vmin) -
+                 levels.begin();
+
+      for (; k < levels.size() && levels[k] <= vmax; k++) {
+        double value = levels[k];
+        std::vector<IsoSegment> &trace = segs[k];
+
+        // Détermine si 1 ou 2 segments traversent la case ab-cd
+        // a  b
+        // c  d
+        //--------------------------------
+        // 1 segment en diagonale
+        //--------------------------------
+        if ((a <= value && b <= value && c <= value && d > value) ||
+            (a > value && b > value && c > value && d <= value))
+          addSegment(trace, cell, EDGE_CD, EDGE_BD, grid, value);
+        else if ((a <= value && c <= value && d <= value && b > value) ||
+                 (a > value && c > value && d > value && b <= value))
+          addSegment(trace, cell, EDGE_AB, EDGE_BD, grid, value);
+        else if ((c <= value && d <= value && b <= value && a > value) ||
+                 (c > value && d > value && b > value && a <= value))
+          addSegment(trace, cell, EDGE_AB, EDGE_AC, grid, value);
+        else if ((a <= value && b <= value && d <= value && c > value) ||
+                 (a > value && b > value && d > value && c <= value))
+          addSegment(trace, cell, EDGE_AC, EDGE_CD, grid, value);
+        //--------------------------------
+        // 1 segment H ou V
+        //--------------------------------
+        else if ((a <= value && b <= value && c > value && d > value) ||
+                 (a > value && b > value && c <= value && d <= value))
+          addSegment(trace, cell, EDGE_AC, EDGE_BD, grid, value);
+        else if ((a <= value && c <= value && b > value && d > value) ||
+                 (a > value && c > value && b <= value && d <= value))
+          addSegment(trace, cell, EDGE_AB, EDGE_CD, grid, value);
+        //--------------------------------
+        // 2 segments en diagonale
+        //--------------------------------
+        else if (a <= value && d <= value && c > value && b > value) {
+          addSegment(trace, cell, EDGE_AB, EDGE_BD, grid, value);
+          addSegment(trace, cell, EDGE_AC, EDGE_CD, grid, value);
+        } else if (a > value && d > value && c <= value && b <= value) {
+          addSegment(trace, cell, EDGE_AB, EDGE_AC, grid, value);
+          addSegment(trace, cell, EDGE_BD, EDGE_CD, grid, value);
+        }
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------
+// Joins the segments of one level into continuous, unidirectional
+// polylines. A grid edge is crossed by at most two segments, so each
+// segment end is linked to its neighbour through a hash on the edge id.
+//-----------------------------------------------------------------------
+void joinSegments(const std::vector<IsoSegment> &segs,
+                  std::vector<IsoLinePoint> &points,
+                  std::vector<size_t> &lineStart) {
+  const int n = segs.size();
+  if (n == 0) return;
+
+  // link[2 * s + end] is the end of the segment joined to end of s, or -1
+  std::vector<int> link(2 * n, -1);
+  std::unordered_map<uint64_t, int> open;
+  open.reserve(n);
+  for (int s = 0; s < n; s++) {
+    for (int end = 0; end < 2; end++) {
+      int slot = 2 * s + end;
+      auto ins = open.emplace(end ? segs[s].e2 : segs[s].e1, slot);
+      if (!ins.second) {
+        link[slot] = ins.first->second;
+        link[ins.first->second] = slot;
+        open.erase(ins.first);
+      }
+    }
+  }
+
+  points.reserve(n + n / 8 + 1);
+  std::vector<char> used(n, 0);
+  for (int s = 0; s < n; s++) {
+    if (used[s]) continue;
+
+    // Walk back to the open end of the chain, or all around a closed one
+    int entry = 2 * s;
+    for (int steps = 0; link[entry] >= 0 && steps < n; steps++) {
+      int prev = link[entry];
+      if ((prev >> 1) == s) break;
+      entry = prev ^ 1;
+    }
+
+    lineStart.push_back(points.size());
+    for (int slot = entry; slot >= 0 && !used[slot >> 1];
+         slot = link[slot ^ 1]) {
+      const IsoSegment &seg = segs[slot >> 1];
+      used[slot >> 1] = 1;
+      if (points.size() == lineStart.back()) {
+        if (slot & 1)
+          points.push_back({seg.x2, seg.y2});
+        else
+          points.push_back({seg.x1, seg.y1});
+      }
+      if (slot & 1)
+        points.push_back({seg.x1, seg.y1});
+      else
+        points.push_back({seg.x2, seg.y2});
+    }
+  }
+  lineStart.push_back(points.size());
+}
+
+}  // namespace
+
+void IsoLineTracer::Trace(const double *values, const GribGridGeometry &grid,
+                          const std::vector<double> &levels,
+                          std::vector<IsoLinePolylines> &lines) {
+  size_t nlevels = levels.size();
+  lines.assign(nlevels, IsoLinePolylines());
+  if (!values || grid.Ni < 1 || grid.Nj < 1) return;
+
+  // extractIsoLines wants the levels sorted; the calibration may not be
+  // monotonic, so keep track of where each one came from.
+  std::vector<size_t> order(nlevels);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+    return levels[l] < levels[r];
+  });
+
+  std::vector<double> sorted(nlevels);
+  for (size_t k = 0; k < nlevels; k++) sorted[k] = levels[order[k]];
+
+  std::vector<std::vector<IsoSegment>> segs(nlevels);
+  extractIsoLines(values, grid, sorted, segs);
+
+  for (size_t k = 0; k < nlevels; k++) {
+    IsoLinePolylines &out = lines[order[k]];
+    joinSegments(segs[k], out.points, out.lineStart);
+    std::vector<IsoSegment>().swap(segs[k]);
+  }
+}
@@ -0,0 +1,223 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * \implements \ref IsoLineWorker.h
+ */
+
+#include "IsoLineWorker.h"
+
+#include <algorithm>
+
+#include "GribRecord.h"
+#include "IsoLine.h"
+
+// Jobs kept around, queued or built. Beyond this the oldest look-ahead
+// results are dropped.
+static const size_t MAX_JOBS = 16;
+
+// Levels are published in this many interleaved batches, so a partial map
+// shows isolines spread over the whole range rather than only the lowest.
+static const size_t PROGRESSIVE_BATCHES = 4;
+
+IsoLineWorker::Job::~Job() {
+  for (IsoLine *iso : lines) delete iso;
+}
+
+IsoLineWorker::IsoLineWorker() {
+  m_thread = std::thread(&IsoLineWorker::Run, this);
+}
+
+IsoLineWorker::~IsoLineWorker() { Stop(); }
+
+void IsoLineWorker::SetReadyCallback(std::function<void(bool)> callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_readyCallback = callback;
+}
+
+std::shared_ptr<IsoLineWorker::Job> IsoLineWorker::Find(
+    const IsoLineKey &key) {
+  for (auto &job : m_jobs)
+    if (job->key == key) return job;
+  return nullptr;
+}
+
+void IsoLineWorker::Request(const IsoLineKey &key,
+                            const std::vector<double> &values,
+                            const IsoLineSource &source, bool urgent) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop || !source.x1) return;
+
+    // The timeline moved: what was urgent for another time no longer is
+    if (urgent)
+      for (auto &job : m_jobs)
+        if (job->key.time != key.time) job->urgent = false;
+
+    std::shared_ptr<Job> job = Find(key);
+    if (job) {
+      if (urgent && !job->running && !job->done) {
+        m_jobs.remove(job);
+        m_jobs.push_front(job);
+      }
+      job->urgent |= urgent;
+      return;
+    }
+
+    job = std::make_shared<Job>();
+    job->key = key;
+    job->values = values;
+    job->source = source;
+    job->urgent = urgent;
+    if (urgent)
+      m_jobs.push_front(job);
+    else
+      m_jobs.push_back(job);
+
+    Trim(key.fileId);
+  }
+  m_cv.notify_one();
+}
+
+void IsoLineWorker::Trim(unsigned int fileId) {
+  // A new file invalidates everything built from the previous one
+  for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+    if ((*it)->key.fileId != fileId) {
+      (*it)->cancelled = true;
+      it = m_jobs.erase(it);
+    } else
+      ++it;
+  }
+
+  auto it = m_jobs.end();
+  while (m_jobs.size() > MAX_JOBS && it != m_jobs.begin()) {
+    --it;
+    if ((*it)->running || (*it)->urgent) continue;
+    (*it)->cancelled = true;
+    it = m_jobs.erase(it);
+  }
+}
+
+bool IsoLineWorker::IsKnown(const IsoLineKey &key) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return Find(key) != nullptr;
+}
+
+IsoLineWorker::State IsoLineWorker::Fetch(const IsoLineKey &key,
+                                          std::vector<IsoLine *> &lines) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::shared_ptr<Job> job = Find(key);
+  if (!job) return UNKNOWN;
+
+  if (!job->done) {
+    lines = job->lines;
+    return PENDING;
+  }
+
+  lines.swap(job->lines);
+  job->lines.clear();
+  m_jobs.remove(job);
+  return READY;
+}
+
+void IsoLineWorker::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &job : m_jobs) job->cancelled = true;
+  m_jobs.clear();
+}
+
+void IsoLineWorker::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    for (auto &job : m_jobs) job->cancelled = true;
+    m_jobs.clear();
+    m_readyCallback = nullptr;
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable()) m_thread.join();
+}
+
+void IsoLineWorker::Run() {
+  for (;;) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this, &job] {
+        if (m_stop) return true;
+        for (auto &j : m_jobs)
+          if (!j->running && !j->done) {
+            job = j;
+            return true;
+          }
+        return false;
+      });
+      if (m_stop) return;
+      job->running = true;
+    }
+
+    Build(job);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job->running = false;
+    job->done = true;
+  }
+}
+
+void IsoLineWorker::Build(const std::shared_ptr<Job> &job) {
+  const IsoLineSource &src = job->source;
+
+  // Same records the timeline set would hold at this position
+  std::unique_ptr<GribRecord> owned;
+  const GribRecord *rec = src.x1.get();
+  if (src.x2) {
+    if (src.y1 && src.y2) {
+      GribRecord *ry = nullptr;
+      std::unique_ptr<GribRecord> rx(GribRecord::Interpolated2DRecord(
+          ry, *src.x1, *src.y1, *src.x2, *src.y2, src.interp));
+      std::unique_ptr<GribRecord> pry(ry);
+      if (rx && ry) owned.reset(GribRecord::MagnitudeRecord(*rx, *ry));
+    } else
+      owned.reset(GribRecord::InterpolatedRecord(*src.x1, *src.x2, src.interp));
+    rec = owned.get();
+  } else if (src.y1) {
+    owned.reset(GribRecord::MagnitudeRecord(*src.x1, *src.y1));
+    rec = owned.get();
+  }
+  if (!rec || !rec->isOk()) return;
+
+  const std::vector<double> &values = job->values;
+  const std::vector<double> &rawValues = job->key.rawValues;
+  size_t nbatches = std::min(PROGRESSIVE_BATCHES, values.size());
+  for (size_t b = 0; b < nbatches; b++) {
+    std::vector<double> batchValues, batchRaw;
+    for (size_t k = b; k < values.size() && k < rawValues.size();
+         k += nbatches) {
+      batchValues.push_back(values[k]);
+      batchRaw.push_back(rawValues[k]);
+    }
+    std::vector<IsoLine *> lines =
+        IsoLine::BuildIsoLines(batchValues, batchRaw, rec);
+
+    std::function<void(bool)> callback;
+    bool urgent;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (job->cancelled || m_stop) {
+        for (IsoLine *iso : lines) delete iso;
+        return;
+      }
+      job->lines.insert(job->lines.end(), lines.begin(), lines.end());
+      if (b + 1 == nbatches) job->done = true;
+      callback = m_readyCallback;
+      urgent = job->urgent;
+    }
+    if (callback) callback(urgent);
+  }
+}
@@ -401,3 +401,39 @@ void TexFont::RenderString(const char *string, int x, int y) {
 void TexFont::RenderString(const wxString &string, int x, int y) {
   RenderString((const char *)string.ToUTF8(), x, y);
 }
+
+void TexFont::GetGlyphQuads(const wxString &string, int x, int y,
+                            std::vector<float> &vertexes) {
+  wxCharBuffer buf = string.ToUTF8();
+  const char *str = buf.data();
+  float dx = x, dy = y;
+  float w = m_maxglyphw, h = m_maxglyphh;
+
+  for (int i = 0; str[i]; i++) {
+    int c = (unsigned char)str[i];
+    if (c == '\n') {
+      dx = x;
+      dy += tgi[(int)'A'].height;
+      continue;
+    }
+    /* degree symbol */
+    if (c == 0xc2 && (unsigned char)str[i + 1] == 0xb0) {
+      c = DEGREE_GLYPH;
+      i++;
+    }
+    if (c < MIN_GLYPH || c >= MAX_GLYPH) continue;
+
+    TexGlyphInfo &tgic = tgi[c];
+    float tx1 = (float)tgic.x / (float)tex_w;
+    float tx2 = (float)(tgic.x + w) / (float)tex_w;
+    float ty1 = (float)tgic.y / (float)tex_h;
+    float ty2 = (float)(tgic.y + h) / (float)tex_h;
+
+    const float quad[] = {dx,     dy,     tx1, ty1, dx + w, dy,     tx2, ty1,
+                          dx + w, dy + h, tx2, ty2, dx,     dy,     tx1, ty1,
+                          dx + w, dy + h, tx2, ty2, dx,     dy + h, tx1, ty2};
+    vertexes.insert(vertexes.end(), quad, quad + 24);
+
+    dx += tgic.advance;
+  }
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * The memory budget holds while a file loads: reading it, the fixups,
+ * filing it into sets and writing its cache never keep many more grids in
+ * memory than the budget allows.
+ *
+ *   grib-test-budget DIR
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GribCache.h"
+#include "GribReader.h"
+#include "GribRecordSet.h"
+#include "GribRecordSetBuilder.h"
+#include "GribResidency.h"
+#include "GribTest.h"
+
+namespace {
+
+const int NI = 360, NJ = 181, STEPS = 48;
+const size_t GRID = (size_t)NI * NJ * sizeof(double);
+const size_t BUDGET = 6 * GRID;
+// Trim() runs after a grid is read back, so one may be over
+const size_t LIMIT = BUDGET + GRID;
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: grib-test-budget DIR\n");
+    return 2;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(argv[1], ec);
+  std::string path = std::string(argv[1]) + "/budget.grb";
+  CHECK(GribTestWriteFile(path, NI, NJ, STEPS));
+
+  GribResidency &residency = GribResidency::Get();
+  residency.SetBudget(BUDGET);
+
+  auto reader = std::make_unique<GribReader>();
+  reader->openFile(path);
+  CHECK(reader->isOk());
+  CHECK(reader->getTotalNumberOfGribRecords() == STEPS);
+  reader->computeAccumulationRecords(GRB_PRESSURE, LV_MSL, 0);
+  DpGrib::MemoryUsage usage = residency.GetUsage();
+  CHECK(usage.total == STEPS * GRID);
+  CHECK(usage.peak <= LIMIT);
+
+  std::vector<std::unique_ptr<GribRecordSet>> owned;
+  std::vector<GribRecordSet *> sets;
+  for (time_t date : reader->getListDates()) {
+    owned.emplace_back(new GribRecordSet(0));
+    owned.back()->m_Reference_Time = date;
+    sets.push_back(owned.back().get());
+  }
+  std::vector<int> indices;
+  GribRecord *first = GribRecordSetBuilder::Build(*reader, sets, indices);
+  CHECK(first && sets.size() == STEPS);
+  if (!first) return GribTestResult();
+
+  // A pass over every grid, as writing the cache does, loads none of them
+  size_t current = residency.GetUsage().current;
+  for (GribRecordSet *set : sets) {
+    const GribRecord *rec = set->m_GribRecordPtrArray[Idx_PRESSURE];
+    std::shared_ptr<const double> values = rec->peekValues();
+    CHECK(values && values.get()[0] > 99000);
+  }
+  CHECK(residency.GetUsage().current == current);
+
+  GribCache::SetDirectory(std::string(argv[1]) + "/cache");
+  GribCache::Key key;
+  key.files.push_back(path);
+  key.version = "test";
+  CHECK(GribCache::Write(key, sets, indices, first->getRecordRefDate()));
+  usage = residency.GetUsage();
+  CHECK(usage.evictions > 0);
+  CHECK(usage.peak <= LIMIT);
+  if (usage.peak > LIMIT)
+    fprintf(stderr, "peak %zu bytes, over %zu\n", usage.peak, LIMIT);
+
+  // Every grid is still there, read back one at a time
+  for (GribRecordSet *set : sets) {
+    const GribRecord *rec = set->m_GribRecordPtrArray[Idx_PRESSURE];
+    CHECK(rec->getValues() && fabs(rec->getValue(0, 0) - 101325) < 1);
+    residency.Trim();
+  }
+  CHECK(residency.GetUsage().peak <= LIMIT);
+
+  reader.reset();
+  CHECK(residency.GetUsage().total == 0);
+  return GribTestResult();
+}
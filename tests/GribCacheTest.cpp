@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * A GribCache gives back the sets it was written for, and goes stale once
+ * the size or modification time of a source, the plugin version or the
+ * load options differ from those it was written for.
+ *
+ *   grib-test-cache DIR
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "GribCache.h"
+#include "GribReader.h"
+#include "GribRecordSet.h"
+#include "GribRecordSetBuilder.h"
+#include "GribTest.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int NI = 60, NJ = 31, STEPS = 6;
+
+std::set<fs::path> CacheFiles(const std::string &directory) {
+  std::set<fs::path> files;
+  std::error_code ec;
+  for (const fs::directory_entry &entry :
+       fs::directory_iterator(directory, ec))
+    if (entry.path().extension() == ".cache") files.insert(entry.path());
+  return files;
+}
+
+// The cache file Write() adds to directory
+fs::path Written(const std::string &directory, const GribCache::Key &key,
+                 const std::vector<GribRecordSet *> &sets,
+                 const std::vector<int> &indices, time_t refDate) {
+  std::set<fs::path> before = CacheFiles(directory);
+  CHECK(GribCache::Write(key, sets, indices, refDate));
+  for (const fs::path &path : CacheFiles(directory))
+    if (!before.count(path)) return path;
+  return fs::path();
+}
+
+bool Opens(const GribCache::Key &key) {
+  return GribCache::Open(key) != nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: grib-test-cache DIR\n");
+    return 2;
+  }
+  std::error_code ec;
+  fs::remove_all(argv[1], ec);
+  fs::create_directories(argv[1], ec);
+  std::string path = std::string(argv[1]) + "/cache.grb";
+  std::string directory = std::string(argv[1]) + "/cache";
+  fs::create_directories(directory, ec);
+  CHECK(GribTestWriteFile(path, NI, NJ, STEPS));
+
+  GribReader reader(path);
+  CHECK(reader.isOk());
+  std::vector<std::unique_ptr<GribRecordSet>> owned;
+  std::vector<GribRecordSet *> sets;
+  for (time_t date : reader.getListDates()) {
+    owned.emplace_back(new GribRecordSet(0));
+    owned.back()->m_Reference_Time = date;
+    sets.push_back(owned.back().get());
+  }
+  std::vector<int> indices;
+  GribRecord *first = GribRecordSetBuilder::Build(reader, sets, indices);
+  CHECK(first && sets.size() == STEPS);
+  if (!first) return GribTestResult();
+  time_t refDate = first->getRecordRefDate();
+
+  GribCache::Key key;
+  key.files.push_back(path);
+  key.version = "1.0";
+  key.options = 3;
+
+  // No directory, no cache
+  CHECK(!GribCache::Write(key, sets, indices, refDate));
+  CHECK(!Opens(key));
+
+  GribCache::SetDirectory(directory);
+  CHECK(!Opens(key));
+  fs::path written = Written(directory, key, sets, indices, refDate);
+  CHECK(!written.empty());
+
+  // What was written comes back
+  {
+    std::unique_ptr<GribCache> cache = GribCache::Open(key);
+    CHECK(cache);
+    if (!cache) return GribTestResult();
+    CHECK(cache->GetSetCount() == STEPS);
+    CHECK(cache->GetRecordCount() == STEPS);
+    CHECK(cache->GetIndices() == indices);
+    CHECK(cache->GetRefDate() == refDate);
+    for (size_t k = 0; k < cache->GetSetCount(); k++) {
+      GribRecordSet set(0);
+      cache->FillSet(k, set);
+      CHECK(set.m_Reference_Time == sets[k]->m_Reference_Time);
+      const GribRecord *rec = set.m_GribRecordPtrArray[Idx_PRESSURE];
+      const GribRecord *orig = sets[k]->m_GribRecordPtrArray[Idx_PRESSURE];
+      CHECK(rec && rec->getNi() == NI && rec->getNj() == NJ);
+      if (!rec) continue;
+      for (int j = 0; j < NJ; j += 5)
+        for (int i = 0; i < NI; i += 7)
+          CHECK(fabs(rec->getValue(i, j) - orig->getValue(i, j)) < 0.5);
+    }
+  }
+
+  // Other version, options or files
+  GribCache::Key other = key;
+  other.version = "1.1";
+  CHECK(!Opens(other));
+  other = key;
+  other.options = 1;
+  CHECK(!Opens(other));
+  other = key;
+  other.files.push_back(path);
+  CHECK(!Opens(other));
+
+  // The header decides, not only the file name: a cache written for one
+  // key is not read for another
+  for (int pass = 0; pass < 2; pass++) {
+    other = key;
+    if (pass)
+      other.options = 7;
+    else
+      other.version = "2.0";
+    fs::path target = Written(directory, other, sets, indices, refDate);
+    CHECK(!target.empty() && Opens(other));
+    fs::copy_file(written, target, fs::copy_options::overwrite_existing, ec);
+    CHECK(!ec);
+    CHECK(!Opens(other));
+  }
+  CHECK(Opens(key));
+
+  // A source touched, or changed keeping its time, makes it stale
+  fs::file_time_type mtime = fs::last_write_time(path, ec);
+  fs::last_write_time(path, mtime + std::chrono::seconds(2), ec);
+  CHECK(!Opens(key));
+  fs::last_write_time(path, mtime, ec);
+  CHECK(Opens(key));
+
+  uintmax_t size = fs::file_size(path, ec);
+  FILE *file = fopen(path.c_str(), "ab");
+  CHECK(file && fputc(0, file) == 0 && fclose(file) == 0);
+  fs::last_write_time(path, mtime, ec);
+  CHECK(!Opens(key));
+  fs::resize_file(path, size, ec);
+  fs::last_write_time(path, mtime, ec);
+  CHECK(Opens(key));
+
+  // A missing source, or a truncated cache
+  fs::rename(path, path + ".moved", ec);
+  CHECK(!Opens(key));
+  fs::rename(path + ".moved", path, ec);
+  fs::last_write_time(path, mtime, ec);
+  CHECK(Opens(key));
+  fs::resize_file(written, fs::file_size(written, ec) / 2, ec);
+  CHECK(!Opens(key));
+
+  // Written again, it is valid again
+  CHECK(GribCache::Write(key, sets, indices, refDate));
+  CHECK(Opens(key));
+  return GribTestResult();
+}
@@ -0,0 +1,140 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * GribDirectoryWatcher reports a matching file once it stops changing for
+ * the settle time, not while it is being written, oldest first, and not
+ * those there before it started unless they change.
+ *
+ *   grib-test-watcher DIR
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GribDirectoryWatcher.h"
+#include "GribTest.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const unsigned int SETTLE_MS = 600, POLL_MS = 100;
+// Longer than a file takes to be reported once settled
+const std::chrono::milliseconds REPORTED(4 * SETTLE_MS);
+// Long enough for a file that is not to be reported to have been
+const std::chrono::milliseconds QUIET(2 * SETTLE_MS);
+
+class Reports {
+public:
+  void Add(const std::vector<std::string> &files) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const std::string &file : files)
+      m_files.push_back(fs::path(file).filename().string());
+    m_cv.notify_all();
+  }
+
+  // The names reported so far once there are count of them, or after
+  // timeout, and forgets them
+  std::vector<std::string> Take(size_t count,
+                                std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait_for(lock, timeout, [&] { return m_files.size() >= count; });
+    std::vector<std::string> files;
+    files.swap(m_files);
+    return files;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<std::string> m_files;
+};
+
+bool Append(const fs::path &path, const std::string &text) {
+  FILE *file = fopen(path.string().c_str(), "ab");
+  if (!file) return false;
+  bool ok = fputs(text.c_str(), file) >= 0;
+  return fclose(file) == 0 && ok;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: grib-test-watcher DIR\n");
+    return 2;
+  }
+  std::error_code ec;
+  fs::path dir = fs::path(argv[1]) / "watched";
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir, ec);
+  CHECK(Append(dir / "before.grb2", "GRIB"));
+
+  GribDirectoryWatcher watcher;
+  Reports reports;
+  watcher.SetSettleTime(SETTLE_MS);
+  watcher.SetPollInterval(POLL_MS);
+  CHECK(!watcher.Start((dir / "missing").string(), ".*", nullptr));
+  CHECK(!watcher.Start(dir.string(), "(", nullptr));
+  auto callback = [&reports](const std::vector<std::string> &files) {
+    reports.Add(files);
+  };
+  CHECK(watcher.Start(dir.string(), R"(.*\.grb2?)", callback));
+  CHECK(watcher.IsRunning());
+
+  // Nothing for what was there, nor for names that do not match
+  CHECK(Append(dir / "notes.txt", "text"));
+  CHECK(reports.Take(1, QUIET).empty());
+
+  // A file written for longer than the settle time is reported once, after
+  // its last write
+  auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < 12; k++) {
+    CHECK(Append(dir / "slow.GRB2", "chunk"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS / 6));
+  }
+  std::vector<std::string> files = reports.Take(1, REPORTED);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(files.size() == 1 && files[0] == "slow.GRB2");
+  CHECK(elapsed >= std::chrono::milliseconds(11 * SETTLE_MS / 6 + SETTLE_MS));
+  CHECK(reports.Take(1, QUIET).empty());
+
+  // Several settled together come oldest first
+  auto now = fs::file_time_type::clock::now();
+  CHECK(Append(dir / "b.grb", "GRIB"));
+  CHECK(Append(dir / "a.grb", "GRIB"));
+  fs::last_write_time(dir / "b.grb", now - std::chrono::hours(1), ec);
+  fs::last_write_time(dir / "a.grb", now - std::chrono::hours(2), ec);
+  files = reports.Take(2, REPORTED);
+  CHECK(files.size() == 2 && files[0] == "a.grb" && files[1] == "b.grb");
+
+  // Changed, or removed and back, a file is reported again
+  CHECK(Append(dir / "before.grb2", "more"));
+  files = reports.Take(1, REPORTED);
+  CHECK(files.size() == 1 && files[0] == "before.grb2");
+  fs::remove(dir / "a.grb", ec);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2 * POLL_MS));
+  CHECK(Append(dir / "a.grb", "GRIB"));
+  files = reports.Take(1, REPORTED);
+  CHECK(files.size() == 1 && files[0] == "a.grb");
+
+  // Nothing once stopped
+  watcher.Stop();
+  CHECK(!watcher.IsRunning());
+  CHECK(Append(dir / "late.grb", "GRIB"));
+  CHECK(reports.Take(1, QUIET).empty());
+  return GribTestResult();
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * GribGridCodec round trips: exact grids come back bit for bit, stepped
+ * ones within half a step, missing values stay missing, and decoding
+ * refuses what is not the encoding of as many values.
+ *
+ *   grib-test-codec DIR
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "GribGridCodec.h"
+#include "GribRecord.h"
+#include "GribTest.h"
+
+namespace {
+
+// Deterministic noise in [0, 1)
+double Noise(uint32_t &state) {
+  state = state * 1664525u + 1013904223u;
+  return (state >> 8) / 16777216.;
+}
+
+std::vector<double> Smooth(size_t count) {
+  std::vector<double> values(count);
+  for (size_t k = 0; k < count; k++)
+    values[k] = 101325 + 2000 * std::sin(k * M_PI / 180);
+  return values;
+}
+
+void CheckExact(const std::vector<double> &values) {
+  std::vector<unsigned char> encoded;
+  GribGridCodec::Encode(values.data(), values.size(), 0, encoded);
+  CHECK(!encoded.empty() && encoded[0] == 'X');
+  std::vector<double> decoded(values.size());
+  CHECK(GribGridCodec::Decode(encoded, decoded.data(), decoded.size()));
+  CHECK(!memcmp(values.data(), decoded.data(),
+                values.size() * sizeof(double)));
+}
+
+// Returns the encoded size
+size_t CheckSteps(const std::vector<double> &values, double step) {
+  std::vector<unsigned char> encoded;
+  GribGridCodec::Encode(values.data(), values.size(), step, encoded);
+  CHECK(!encoded.empty() && encoded[0] == 'S');
+  std::vector<double> decoded(values.size());
+  CHECK(GribGridCodec::Decode(encoded, decoded.data(), decoded.size()));
+  for (size_t k = 0; k < values.size(); k++) {
+    if (values[k] == GRIB_NOTDEF)
+      CHECK(decoded[k] == GRIB_NOTDEF);
+    else
+      CHECK(std::fabs(decoded[k] - values[k]) <= step * 0.500001);
+  }
+  return encoded.size();
+}
+
+}  // namespace
+
+int main(int, char **) {
+  const size_t COUNT = 360 * 181;
+  uint32_t state = 1;
+
+  // Exact: smooth, noisy, missing, special and degenerate grids, and runs
+  // around the 128 byte limit
+  std::vector<double> smooth = Smooth(COUNT);
+  CheckExact(smooth);
+  std::vector<double> noisy(COUNT);
+  for (double &v : noisy) v = (Noise(state) - 0.5) * 1e6;
+  CheckExact(noisy);
+  std::vector<double> holes = smooth;
+  for (size_t k = 0; k < COUNT; k += 7) holes[k] = GRIB_NOTDEF;
+  CheckExact(holes);
+  CheckExact({0.0, -0.0, std::numeric_limits<double>::infinity(),
+              -std::numeric_limits<double>::infinity(),
+              std::numeric_limits<double>::quiet_NaN(),
+              std::numeric_limits<double>::denorm_min(), GRIB_NOTDEF});
+  CheckExact({});
+  CheckExact({42.5});
+  for (size_t n : {127, 128, 129, 255, 256, 257}) {
+    CheckExact(std::vector<double>(n, 0.0));
+    CheckExact(std::vector<double>(n, 3.25));
+    std::vector<double> alternate(n);
+    for (size_t k = 0; k < n; k++) alternate[k] = k % 2 ? 1.0 : -7.0;
+    CheckExact(alternate);
+  }
+
+  // Stepped: within half a step, and a few times smaller than the doubles
+  std::vector<double> packed(COUNT);
+  const double step = 0.1;
+  for (size_t k = 0; k < COUNT; k++)
+    packed[k] = std::floor(smooth[k] / step) * step +
+                (Noise(state) - 0.5) * step * 0.99;
+  size_t size = CheckSteps(packed, step);
+  CHECK(size < COUNT * 3);
+  for (size_t k = 0; k < COUNT; k += 11) packed[k] = GRIB_NOTDEF;
+  CheckSteps(packed, step);
+  CheckSteps(std::vector<double>(1000, GRIB_NOTDEF), step);
+  CheckSteps({-5.0, 5.0, -5.0, 5.0}, 0.5);
+
+  // What steps cannot hold is kept exactly
+  std::vector<double> wide = {0.0, 1e30};
+  std::vector<unsigned char> encoded;
+  GribGridCodec::Encode(wide.data(), wide.size(), 0.01, encoded);
+  CHECK(!encoded.empty() && encoded[0] == 'X');
+  std::vector<double> special = {1.0, std::numeric_limits<double>::infinity()};
+  GribGridCodec::Encode(special.data(), special.size(), 0.5, encoded);
+  CHECK(!encoded.empty() && encoded[0] == 'X');
+  GribGridCodec::Encode(smooth.data(), smooth.size(),
+                        std::numeric_limits<double>::quiet_NaN(), encoded);
+  CHECK(!encoded.empty() && encoded[0] == 'X');
+
+  // Wrong counts, truncated and unknown encodings fail
+  std::vector<double> out(COUNT + 1);
+  for (double s : {0.0, step}) {
+    GribGridCodec::Encode(smooth.data(), COUNT, s, encoded);
+    CHECK(!GribGridCodec::Decode(encoded, out.data(), COUNT - 1));
+    CHECK(!GribGridCodec::Decode(encoded, out.data(), COUNT + 1));
+    std::vector<unsigned char> truncated(encoded.begin(), encoded.end() - 1);
+    CHECK(!GribGridCodec::Decode(truncated, out.data(), COUNT));
+    truncated.resize(5);
+    CHECK(!GribGridCodec::Decode(truncated, out.data(), COUNT));
+  }
+  CHECK(!GribGridCodec::Decode({}, out.data(), COUNT));
+  encoded[0] = '?';
+  CHECK(!GribGridCodec::Decode(encoded, out.data(), COUNT));
+  return GribTestResult();
+}
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * GribResidency evicts the grids used least recently, none while a
+ * ReadGuard lives, and gives back the values it evicted, from memory or
+ * from its spill file.
+ *
+ *   grib-test-residency DIR
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GribReader.h"
+#include "GribResidency.h"
+#include "GribTest.h"
+
+namespace {
+
+const int NI = 90, NJ = 46, STEPS = 12;
+const size_t COUNT = (size_t)NI * NJ;
+const size_t GRID = COUNT * sizeof(double);
+// Trim() goes down to 7/8 of it: three grids
+const size_t BUDGET = 4 * GRID;
+
+std::vector<GribRecord *> Records(GribReader &reader) {
+  std::vector<GribRecord *> *list =
+      reader.getListOfGribRecords(GRB_PRESSURE, LV_MSL, 0);
+  return list ? *list : std::vector<GribRecord *>();
+}
+
+bool Same(const GribRecord *rec, const std::vector<double> &expected) {
+  const double *values = rec->getValues();
+  return values && !memcmp(values, expected.data(), GRID);
+}
+
+// Each grid is read back exactly as it was decoded
+void CheckValues(const std::vector<GribRecord *> &records,
+                 const std::vector<std::vector<double>> &decoded) {
+  GribResidency &residency = GribResidency::Get();
+  for (size_t k = 0; k < records.size(); k++) {
+    CHECK(Same(records[k], decoded[k]));
+    residency.Trim();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: grib-test-residency DIR\n");
+    return 2;
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(argv[1], ec);
+  std::string path = std::string(argv[1]) + "/residency.grb";
+  CHECK(GribTestWriteFile(path, NI, NJ, STEPS));
+
+  GribResidency &residency = GribResidency::Get();
+  residency.SetBudget(0);
+  residency.SetCompression(DpGrib::GRID_COMPRESSION_LOSSLESS);
+
+  auto reader = std::make_unique<GribReader>(path);
+  std::vector<GribRecord *> records = Records(*reader);
+  CHECK(records.size() == STEPS);
+  if (records.size() != STEPS) return GribTestResult();
+
+  std::vector<std::vector<double>> decoded;
+  for (GribRecord *rec : records) {
+    const double *values = rec->getValues();
+    decoded.emplace_back(values, values + COUNT);
+  }
+  CHECK(residency.GetUsage().current == STEPS * GRID);
+
+  // Grids used since the last Trim() stay, the others go down to the budget
+  residency.SetBudget(BUDGET);
+  residency.Trim();
+  CHECK(residency.GetUsage().current == STEPS * GRID);
+  residency.Trim();
+  DpGrib::MemoryUsage usage = residency.GetUsage();
+  CHECK(usage.current <= BUDGET);
+  CHECK(usage.evictions >= STEPS - 3);
+  CHECK(usage.compressed > 0 && usage.compressed < (STEPS - 3) * GRID);
+
+  // Least recently used first: after a walk over the records, the last
+  // three are still in memory and the first is not
+  for (GribRecord *rec : records) {
+    CHECK(rec->getValues());
+    residency.Trim();
+  }
+  CHECK(residency.GetUsage().current <= BUDGET);
+  unsigned long reloads = residency.GetUsage().reloads;
+  for (size_t k = STEPS - 3; k < STEPS; k++) CHECK(records[k]->getValues());
+  CHECK(residency.GetUsage().reloads == reloads);
+  CHECK(records[0]->getValues());
+  CHECK(residency.GetUsage().reloads == reloads + 1);
+  residency.Trim();
+
+  // Whatever their age
+  CHECK(records[1]->getValues());
+  residency.Trim();
+  reloads = residency.GetUsage().reloads;
+  CHECK(records[1]->getValues());
+  CHECK(residency.GetUsage().reloads == reloads);
+
+  // Nothing moves while a reader holds a guard
+  {
+    GribResidency::ReadGuard guard;
+    for (GribRecord *rec : records) CHECK(rec->getValues());
+    unsigned long evictions = residency.GetUsage().evictions;
+    residency.Trim();
+    usage = residency.GetUsage();
+    CHECK(usage.current == STEPS * GRID);
+    CHECK(usage.evictions == evictions);
+  }
+  residency.Trim();
+  CHECK(residency.GetUsage().current <= BUDGET);
+
+  // Evicted and read back, the values are those decoded
+  CheckValues(records, decoded);
+
+  // Peek() reads an evicted grid back without loading it
+  CHECK(residency.GetUsage().current <= BUDGET);
+  {
+    size_t current = residency.GetUsage().current;
+    std::shared_ptr<const double> peeked = records[0]->peekValues();
+    CHECK(peeked && !memcmp(peeked.get(), decoded[0].data(), GRID));
+    CHECK(residency.GetUsage().current == current);
+  }
+
+  // Uncompressed, through the spill file
+  reader.reset();
+  CHECK(residency.GetUsage().total == 0);
+  residency.SetBudget(0);
+  residency.SetCompression(DpGrib::GRID_COMPRESSION_NONE);
+  residency.SetSpillDirectory(argv[1]);
+  reader = std::make_unique<GribReader>(path);
+  records = Records(*reader);
+  CHECK(records.size() == STEPS);
+  if (records.size() != STEPS) return GribTestResult();
+  residency.SetBudget(BUDGET);
+  residency.Trim();
+  residency.Trim();
+  usage = residency.GetUsage();
+  CHECK(usage.current <= BUDGET);
+  CHECK(usage.compressed == 0);
+  CheckValues(records, decoded);
+
+  reader.reset();
+  CHECK(residency.GetUsage().total == 0);
+  return GribTestResult();
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * Checks for the grib_core tests, which are plain executables run by ctest:
+ * CHECK() reports a failed condition and carries on, main returns
+ * GribTestResult(), non zero after any failure. GribTestWriteFile() makes
+ * the GRIB files they read.
+ */
+
+#ifndef GRIBTEST_H
+#define GRIBTEST_H
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "GribWriter.h"
+
+inline int &GribTestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition)                                                   \
+  do {                                                                     \
+    if (!(condition)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #condition);                                                 \
+      GribTestFailures()++;                                                \
+    }                                                                      \
+  } while (0)
+
+inline int GribTestResult() { return GribTestFailures() ? 1 : 0; }
+
+/**
+ * Writes steps grids of MSL pressure, ni by nj points on a 1 degree grid
+ * from 0E 90N, 3 hours apart: a smooth field that moves east with time.
+ */
+inline bool GribTestWriteFile(const std::string &path, int ni, int nj,
+                              int steps) {
+  std::vector<unsigned char> out;
+  std::vector<double> values((size_t)ni * nj);
+  for (int step = 0; step < steps; step++) {
+    for (int j = 0; j < nj; j++)
+      for (int i = 0; i < ni; i++)
+        values[(size_t)j * ni + i] =
+            101325 + 2000 * std::sin((i + 5 * step) * M_PI / 180) *
+                         std::cos((90 - j) * M_PI / 180);
+    GribWriter::Field field;
+    field.category = 3;  // MSL pressure
+    field.number = 1;
+    field.levelType = 101;
+    field.reference = 1767225600;  // 2026-01-01
+    field.forecastHours = 3 * step;
+    field.ni = ni, field.nj = nj;
+    field.lon1 = 0, field.lat1 = 90;
+    field.values = values.data();
+    if (!GribWriter::Encode(field, out)) return false;
+  }
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file) return false;
+  bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+  return fclose(file) == 0 && ok;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * GribTimeIndex::Bracket() at and between the times of an index, before and
+ * after its ends, with and without a cursor, and a cursor that does not fit
+ * the query or the index.
+ *
+ *   grib-test-timeindex DIR
+ */
+
+#include <cstddef>
+
+#include "GribTest.h"
+#include "GribTimeIndex.h"
+
+namespace {
+
+const time_t T0 = 1767225600;  // 2026-01-01
+const time_t STEP = 3 * 3600;
+const size_t COUNT = 8;
+
+// Bracket() finds before and after, and whether both exist
+void Expect(const GribTimeIndex &index, time_t time, bool found,
+            size_t before, size_t after, GribTimeCursor *cursor) {
+  size_t b = 0, a = 0;
+  CHECK(index.Bracket(time, b, a, cursor) == found);
+  CHECK(b == before);
+  CHECK(a == after);
+}
+
+}  // namespace
+
+int main(int, char **) {
+  const size_t NONE = GribTimeIndex::NONE;
+  GribTimeIndex index;
+  size_t before, after;
+
+  // Empty
+  CHECK(!index.Bracket(T0, before, after));
+  CHECK(before == NONE && after == NONE);
+  CHECK(index.LowerBound(T0) == 0);
+
+  for (size_t k = 0; k < COUNT; k++) index.Add(T0 + k * STEP, 10 + k);
+  CHECK(index.Size() == COUNT);
+  CHECK(index.Set(3) == 13 && index.Time(3) == T0 + 3 * STEP);
+  CHECK(index.LowerBound(T0 - 1) == 0);
+  CHECK(index.LowerBound(T0 + STEP) == 1);
+  CHECK(index.LowerBound(T0 + STEP + 1) == 2);
+  CHECK(index.LowerBound(T0 + COUNT * STEP) == COUNT);
+
+  for (int pass = 0; pass < 2; pass++) {
+    GribTimeCursor cursor;
+    GribTimeCursor *c = pass ? &cursor : nullptr;
+
+    // Ends, and outside them
+    Expect(index, T0 - 1, false, NONE, 0, c);
+    Expect(index, T0, true, 0, 0, c);
+    Expect(index, T0 + (COUNT - 1) * STEP, true, COUNT - 1, COUNT - 1, c);
+    Expect(index, T0 + (COUNT - 1) * STEP + 1, false, COUNT - 1, NONE, c);
+
+    // Walking forward, as a route does: exact times and in between
+    for (size_t k = 0; k + 1 < COUNT; k++) {
+      time_t t = T0 + k * STEP;
+      Expect(index, t, true, k, k, c);
+      Expect(index, t + 1, true, k, k + 1, c);
+      Expect(index, t + STEP - 1, true, k, k + 1, c);
+      if (c) CHECK(cursor.pos == k);
+    }
+
+    // Backward, and jumps the cursor cannot take
+    for (size_t k = COUNT - 1; k > 0; k--)
+      Expect(index, T0 + k * STEP - 1, true, k - 1, k, c);
+    Expect(index, T0 + 6 * STEP + 7, true, 6, 7, c);
+    Expect(index, T0 + STEP + 7, true, 1, 2, c);
+  }
+
+  // A cursor past the end of the index is only a hint
+  GribTimeCursor cursor;
+  cursor.pos = 100;
+  Expect(index, T0 + 2 * STEP + 1, true, 2, 3, &cursor);
+  CHECK(cursor.pos == 2);
+
+  GribTimeIndex one;
+  one.Add(T0, 0);
+  cursor.pos = 5;
+  Expect(one, T0, true, 0, 0, &cursor);
+  Expect(one, T0 + 1, false, 0, NONE, &cursor);
+  Expect(one, T0 - 1, false, NONE, 0, &cursor);
+  CHECK(cursor.pos == 0);
+
+  // Cleared
+  index.Clear();
+  CHECK(index.Size() == 0);
+  CHECK(!index.Bracket(T0, before, after, &cursor));
+  CHECK(before == NONE && after == NONE);
+  return GribTestResult();
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * IsoLineTracer joins the segments of a level into whole polylines, closed
+ * around a peak, open across a front, across the antimeridian of a grid
+ * going all around the world, and broken by missing values; and tracing
+ * several levels in one pass gives what tracing each alone does.
+ *
+ *   grib-test-isoline DIR
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "GribRecord.h"
+#include "GribTest.h"
+#include "IsoLineTracer.h"
+
+namespace {
+
+GribGridGeometry Grid(int ni, int nj, double di, double dj) {
+  GribGridGeometry grid;
+  grid.Ni = ni, grid.Nj = nj;
+  grid.Di = di, grid.Dj = dj;
+  grid.Lo1 = 0, grid.La1 = 0;
+  grid.Lo2 = (ni - 1) * di, grid.La2 = (nj - 1) * dj;
+  return grid;
+}
+
+// A cone of height 10 centred on node (ci, cj); with wrap, the distance
+// along i goes around the grid
+std::vector<double> Peak(int ni, int nj, int ci, int cj, bool wrap) {
+  std::vector<double> values((size_t)ni * nj);
+  for (int j = 0; j < nj; j++)
+    for (int i = 0; i < ni; i++) {
+      int di = std::abs(i - ci);
+      if (wrap) di = std::min(di, ni - di);
+      values[(size_t)j * ni + i] = 10 - std::hypot(di, j - cj);
+    }
+  return values;
+}
+
+IsoLinePolylines TraceOne(const std::vector<double> &values,
+                          const GribGridGeometry &grid, double level) {
+  std::vector<IsoLinePolylines> lines;
+  IsoLineTracer::Trace(values.data(), grid, std::vector<double>(1, level),
+                       lines);
+  CHECK(lines.size() == 1);
+  return lines.empty() ? IsoLinePolylines() : lines[0];
+}
+
+size_t LineCount(const IsoLinePolylines &lines) {
+  return lines.lineStart.empty() ? 0 : lines.lineStart.size() - 1;
+}
+
+size_t PointCount(const IsoLinePolylines &lines, size_t k) {
+  return lines.lineStart[k + 1] - lines.lineStart[k];
+}
+
+bool Closed(const IsoLinePolylines &lines, size_t k) {
+  const IsoLinePoint &first = lines.points[lines.lineStart[k]];
+  const IsoLinePoint &last = lines.points[lines.lineStart[k + 1] - 1];
+  return PointCount(lines, k) > 2 && first.x == last.x && first.y == last.y;
+}
+
+bool Same(const IsoLinePolylines &a, const IsoLinePolylines &b) {
+  if (a.lineStart != b.lineStart || a.points.size() != b.points.size())
+    return false;
+  for (size_t k = 0; k < a.points.size(); k++)
+    if (a.points[k].x != b.points[k].x || a.points[k].y != b.points[k].y)
+      return false;
+  return true;
+}
+
+}  // namespace
+
+int main(int, char **) {
+  // Around a peak, one closed line at the level's distance from the top
+  GribGridGeometry grid = Grid(11, 11, 1, 1);
+  std::vector<double> peak = Peak(11, 11, 5, 5, false);
+  IsoLinePolylines lines = TraceOne(peak, grid, 6.5);
+  CHECK(LineCount(lines) == 1 && Closed(lines, 0));
+  for (const IsoLinePoint &p : lines.points) {
+    double r = std::hypot(p.x - 5, p.y - 5);
+    CHECK(r > 3 && r < 4);
+  }
+
+  // Above the top or below the bottom, nothing
+  CHECK(TraceOne(peak, grid, 10.5).points.empty());
+  CHECK(TraceOne(peak, grid, -10).lineStart.empty());
+
+  // Across a front, one open line from edge to edge, in grid coordinates
+  GribGridGeometry front = Grid(10, 7, 2, -1);
+  std::vector<double> ramp(10 * 7);
+  for (int j = 0; j < 7; j++)
+    for (int i = 0; i < 10; i++) ramp[j * 10 + i] = i;
+  lines = TraceOne(ramp, front, 4.5);
+  CHECK(LineCount(lines) == 1 && PointCount(lines, 0) == 7);
+  CHECK(!Closed(lines, 0));
+  for (const IsoLinePoint &p : lines.points) CHECK(p.x == 9);
+  if (!lines.points.empty())
+    CHECK(std::fabs(lines.points.front().y - lines.points.back().y) == 6);
+
+  // Missing values break it: the cells next to one are skipped
+  std::vector<double> holed = ramp;
+  holed[3 * 10 + 4] = GRIB_NOTDEF;
+  lines = TraceOne(holed, front, 4.5);
+  CHECK(LineCount(lines) == 2 && lines.points.size() == 6);
+  for (const IsoLinePoint &p : lines.points) CHECK(p.y <= -4 || p.y >= -2);
+
+  // A saddle cell holds two segments, which stay apart
+  GribGridGeometry cell = Grid(2, 2, 1, 1);
+  for (const std::vector<double> &saddle :
+       {std::vector<double>{0, 2, 2, 0}, std::vector<double>{2, 0, 0, 2}}) {
+    lines = TraceOne(saddle, cell, 1);
+    CHECK(LineCount(lines) == 2 && lines.points.size() == 4);
+  }
+
+  // Several levels in one pass, in any order, are each traced as alone,
+  // and the lines come back in the order of the levels
+  std::vector<double> levels = {7.5, 4.5, 9.5, 6.5, 5.5, 20};
+  std::vector<IsoLinePolylines> all;
+  IsoLineTracer::Trace(peak.data(), grid, levels, all);
+  CHECK(all.size() == levels.size());
+  for (size_t k = 0; k < levels.size() && k < all.size(); k++)
+    CHECK(Same(all[k], TraceOne(peak, grid, levels[k])));
+  CHECK(all.size() == levels.size() && all.back().points.empty());
+  IsoLineTracer::Trace(nullptr, grid, levels, all);
+  CHECK(all.size() == levels.size() && all[0].points.empty());
+
+  // A peak on the antimeridian of a grid going all around the world is
+  // one closed line; on one that does not, it is cut in two
+  GribGridGeometry world = Grid(36, 7, 10, -10);
+  std::vector<double> meridian = Peak(36, 7, 0, 3, true);
+  lines = TraceOne(meridian, world, 7.5);
+  CHECK(LineCount(lines) == 1 && Closed(lines, 0));
+  bool west = false, east = false;
+  for (const IsoLinePoint &p : lines.points) {
+    CHECK(p.x >= 0 && p.x <= 360);
+    west |= p.x > 340;
+    east |= p.x < 20;
+  }
+  CHECK(west && east);
+
+  GribGridGeometry part = Grid(36, 7, 9, -10);
+  lines = TraceOne(meridian, part, 7.5);
+  CHECK(LineCount(lines) == 2 && !Closed(lines, 0) && !Closed(lines, 1));
+  return GribTestResult();
+}
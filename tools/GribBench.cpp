@@ -0,0 +1,426 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * grib-bench: decoding and query benchmark of the GRIB core.
+ *
+ * Reads each file of a corpus the way GRIBFile does: decoding, the fixups
+ * of accumulated and missing records, filing into record sets. Reports per
+ * file the time of each stage with GribDecodeStats, allocations and
+ * throughput, then times point queries and the time interpolation of whole
+ * grids on the records read. Output is JSON on stdout.
+ *
+ *   grib-bench [--repeat N] [--queries N] [--grids N] FILE|DIR...
+ *
+ * Directories are searched recursively. Of the repeated reads of a file the
+ * fastest is reported.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "GribDecodeStats.h"
+#include "GribReader.h"
+#include "GribRecordSet.h"
+#include "GribRecordSetBuilder.h"
+#include "GribScratch.h"
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+namespace {
+std::atomic<unsigned long> s_newCalls{0};
+std::atomic<unsigned long long> s_newBytes{0};
+}  // namespace
+
+// The array and nothrow forms call this one unless replaced themselves
+void *operator new(size_t size) {
+  s_newCalls.fetch_add(1, std::memory_order_relaxed);
+  s_newBytes.fetch_add(size, std::memory_order_relaxed);
+  if (void *p = malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double Since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Options {
+  int repeat = 3;
+  long queries = 200000;
+  long grids = 200;
+  std::vector<std::string> files;
+};
+
+struct Stage {
+  double seconds = 0;
+  unsigned long count = 0;
+  unsigned long long values = 0;
+};
+
+struct Run {
+  bool ok = false;
+  int records = 0;
+  size_t sets = 0;
+  double read = 0;  // opening the file to the sets being filed
+  Stage stages[GribDecodeStats::STAGE_COUNT];
+  GribDecodeStats::UnpackTotals unpack;
+  double build = 0;
+  unsigned long newCalls = 0;
+  unsigned long long newBytes = 0;
+  unsigned long scratchBlocks = 0, scratchBuffers = 0;
+
+  Stage pointQuery, gridInterpolation;
+  double checksum = 0;
+};
+
+void Usage() {
+  fprintf(stderr,
+          "usage: grib-bench [--repeat N] [--queries N] [--grids N] "
+          "FILE|DIR...\n");
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    long *value = nullptr;
+    long repeat = 0;
+    if (arg == "--repeat")
+      value = &repeat;
+    else if (arg == "--queries")
+      value = &options.queries;
+    else if (arg == "--grids")
+      value = &options.grids;
+    else if (arg.compare(0, 2, "--") == 0)
+      return false;
+
+    if (!value) {
+      options.files.push_back(arg);
+      continue;
+    }
+    if (++i == argc) return false;
+    char *end;
+    *value = strtol(argv[i], &end, 10);
+    if (*end || *value < 0) return false;
+    if (value == &repeat) options.repeat = std::max(1L, repeat);
+  }
+  return !options.files.empty();
+}
+
+// Expands directories into the regular files below them, sorted
+std::vector<std::string> Corpus(const std::vector<std::string> &args) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> files;
+  for (const std::string &arg : args) {
+    std::error_code ec;
+    if (!fs::is_directory(arg, ec)) {
+      files.push_back(arg);
+      continue;
+    }
+    std::vector<std::string> found;
+    for (fs::recursive_directory_iterator it(arg, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      if (it->is_regular_file(ec)) found.push_back(it->path().string());
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return files;
+}
+
+// Random points inside each record, a record after the other
+void PointQueries(const std::vector<GribRecord *> &records, long queries,
+                  Run &run) {
+  if (records.empty() || !queries) return;
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  Clock::time_point start = Clock::now();
+  for (long q = 0; q < queries; q++) {
+    const GribRecord *rec = records[q % records.size()];
+    double lon = rec->getLonMin() +
+                 uniform(random) * (rec->getLonMax() - rec->getLonMin());
+    double lat = rec->getLatMin() +
+                 uniform(random) * (rec->getLatMax() - rec->getLatMin());
+    double v = rec->getInterpolatedValue(lon, lat, true);
+    if (v != GRIB_NOTDEF) run.checksum += v;
+  }
+  run.pointQuery.seconds = Since(start);
+  run.pointQuery.count = queries;
+  run.pointQuery.values = queries;
+}
+
+// Halfway between the records of consecutive sets, as the timeline does
+void GridInterpolation(const std::vector<GribRecordSet *> &sets, long grids,
+                       Run &run) {
+  std::vector<std::pair<GribRecord *, GribRecord *>> pairs;
+  for (size_t j = 0; j + 1 < sets.size(); j++) {
+    for (int i = 0; i < Idx_COUNT; i++) {
+      GribRecord *r1 = sets[j]->m_GribRecordPtrArray[i];
+      GribRecord *r2 = sets[j + 1]->m_GribRecordPtrArray[i];
+      if (r1 && r2) pairs.push_back(std::make_pair(r1, r2));
+    }
+  }
+  if (pairs.empty() || !grids) return;
+
+  Clock::time_point start = Clock::now();
+  for (long g = 0; g < grids; g++) {
+    const auto &pair = pairs[g % pairs.size()];
+    GribRecord *rec =
+        GribRecord::InterpolatedRecord(*pair.first, *pair.second, 0.5);
+    if (!rec) continue;
+    run.gridInterpolation.count++;
+    run.gridInterpolation.values += (size_t)rec->getNi() * rec->getNj();
+    delete rec;
+  }
+  run.gridInterpolation.seconds = Since(start);
+}
+
+Run ReadFile(const std::string &file, const Options &options) {
+  Run run;
+  GribDecodeStats::Reset();
+  GribScratch::Counters scratch = GribScratch::GetCounters();
+  unsigned long newCalls = s_newCalls;
+  unsigned long long newBytes = s_newBytes;
+  Clock::time_point start = Clock::now();
+
+  GribReader reader;
+  reader.openFile(file);
+  if (!reader.isOk()) return run;
+
+  // As GRIBFile does, with both options for missing records on
+  GribDecodeStats::Timer timer;
+  reader.computeAccumulationRecords(GRB_PRECIP_TOT, LV_GND_SURF, 0);
+  reader.computeAccumulationRecords(GRB_PRECIP_RATE, LV_GND_SURF, 0);
+  reader.computeAccumulationRecords(GRB_CLOUD_TOT, LV_ATMOS_ALL, 0);
+  reader.copyFirstCumulativeRecord();
+  reader.copyMissingWaveRecords();
+  timer.Lap(GribDecodeStats::FIXUP);
+
+  Clock::time_point built = Clock::now();
+  std::vector<std::unique_ptr<GribRecordSet>> owned;
+  std::vector<GribRecordSet *> sets;
+  for (time_t date : reader.getListDates()) {
+    owned.emplace_back(new GribRecordSet(0));
+    owned.back()->m_Reference_Time = date;
+    sets.push_back(owned.back().get());
+  }
+  std::vector<int> indices;
+  GribRecordSetBuilder::Build(reader, sets, indices);
+  run.build = Since(built);
+  run.read = Since(start);
+
+  run.ok = true;
+  run.records = reader.getTotalNumberOfGribRecords();
+  run.sets = sets.size();
+  for (int s = 0; s < GribDecodeStats::STAGE_COUNT; s++) {
+    GribDecodeStats::Totals totals =
+        GribDecodeStats::Get((GribDecodeStats::Stage)s);
+    run.stages[s].seconds = totals.seconds;
+    run.stages[s].count = totals.count;
+    run.stages[s].values = totals.values;
+  }
+  run.unpack = GribDecodeStats::GetUnpack();
+  run.newCalls = s_newCalls - newCalls;
+  run.newBytes = s_newBytes - newBytes;
+  run.scratchBlocks = GribScratch::GetCounters().blocks - scratch.blocks;
+  run.scratchBuffers =
+      GribScratch::GetCounters().allocations - scratch.allocations;
+
+  std::vector<GribRecord *> records;
+  for (GribRecordSet *set : sets) {
+    for (int i = 0; i < Idx_COUNT; i++) {
+      GribRecord *rec = set->m_GribRecordPtrArray[i];
+      if (rec && rec->isOk()) records.push_back(rec);
+    }
+  }
+  PointQueries(records, options.queries, run);
+  GridInterpolation(sets, options.grids, run);
+  return run;
+}
+
+// ============================================================================
+// JSON output
+// ============================================================================
+
+// Where the JSON goes, see main()
+FILE *s_json = stdout;
+
+void Json(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vfprintf(s_json, format, args);
+  va_end(args);
+}
+
+void String(const std::string &s) {
+  Json("\"");
+  for (unsigned char c : s) {
+    if (c == '"' || c == '\\')
+      Json("\\%c", c);
+    else if (c < 0x20)
+      Json("\\u%04x", c);
+    else
+      Json("%c", c);
+  }
+  Json("\"");
+}
+
+double Rate(double amount, double seconds) {
+  return seconds > 0 ? amount / seconds : 0;
+}
+
+void StageJson(const char *name, const Stage &stage, bool values) {
+  Json("        \"%s\": {\"seconds\": %.6f, \"count\": %lu", name,
+       stage.seconds, stage.count);
+  if (values)
+    Json(", \"values\": %llu, \"mvalues_per_s\": %.3f", stage.values,
+         Rate(stage.values / 1e6, stage.seconds));
+  Json("}");
+}
+
+void RunJson(const std::string &file, uintmax_t bytes, const Run &run) {
+  static const char *const STAGES[] = {"scan", "parse", "unpack", "fixup"};
+  Json("    {\n      \"file\": ");
+  String(file);
+  Json(",\n      \"bytes\": %ju,\n      \"ok\": %s", bytes,
+       run.ok ? "true" : "false");
+  if (!run.ok) {
+    Json("\n    }");
+    return;
+  }
+  Json(",\n      \"records\": %d,\n      \"sets\": %zu,\n", run.records,
+       run.sets);
+  Json("      \"seconds\": %.6f,\n", run.read);
+  Json("      \"mb_per_s\": %.3f,\n", Rate(bytes / 1e6, run.read));
+  Json("      \"records_per_s\": %.1f,\n", Rate(run.records, run.read));
+
+  Json("      \"stages\": {\n");
+  for (int s = 0; s < GribDecodeStats::STAGE_COUNT; s++) {
+    StageJson(STAGES[s], run.stages[s], s == GribDecodeStats::UNPACK);
+    Json(",\n");
+  }
+  Json("        \"sets\": {\"seconds\": %.6f, \"count\": %zu}\n", run.build,
+       run.sets);
+  Json("      },\n");
+
+  Json("      \"unpack_by_packing\": [");
+  const char *separator = "\n";
+  for (const auto &it : run.unpack) {
+    const GribDecodeStats::Totals &totals = it.second;
+    Json("%s        {\"edition\": %d, \"template\": %d, ", separator,
+         it.first.first, it.first.second);
+    Json("\"seconds\": %.6f, \"count\": %lu, \"values\": %llu, ",
+         totals.seconds, totals.count, totals.values);
+    Json("\"mvalues_per_s\": %.3f}", Rate(totals.values / 1e6, totals.seconds));
+    separator = ",\n";
+  }
+  Json("%s],\n", run.unpack.empty() ? "" : "\n      ");
+
+  Json("      \"allocations\": {\"count\": %lu, \"bytes\": %llu, ",
+       run.newCalls, run.newBytes);
+  Json("\"per_record\": %.2f, ", Rate(run.newCalls, run.records));
+  Json("\"scratch_blocks\": %lu, \"scratch_buffers\": %lu},\n",
+       run.scratchBlocks, run.scratchBuffers);
+
+  Json("      \"point_query\": {\"queries\": %lu, \"seconds\": %.6f, ",
+       run.pointQuery.count, run.pointQuery.seconds);
+  Json("\"ns_per_query\": %.1f},\n",
+       Rate(run.pointQuery.seconds * 1e9, run.pointQuery.count));
+  Json("      \"grid_interpolation\": {\"grids\": %lu, \"values\": %llu, ",
+       run.gridInterpolation.count, run.gridInterpolation.values);
+  Json("\"seconds\": %.6f, \"mvalues_per_s\": %.3f},\n",
+       run.gridInterpolation.seconds,
+       Rate(run.gridInterpolation.values / 1e6,
+            run.gridInterpolation.seconds));
+  Json("      \"checksum\": %.6g\n    }", run.checksum);
+}
+
+long PeakRssKb() {
+#ifdef _WIN32
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;  // bytes there
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    Usage();
+    return 2;
+  }
+  std::vector<std::string> files = Corpus(options.files);
+
+  // The decoders print their complaints on stdout, which must hold JSON only
+  int fd = dup(fileno(stdout));
+  if (fd != -1 && (s_json = fdopen(fd, "w")) != nullptr)
+    dup2(fileno(stderr), fileno(stdout));
+  else
+    s_json = stdout;
+
+  GribDecodeStats::Enable(true);
+  bool allOk = !files.empty();
+  Json("{\n  \"repeat\": %d,\n  \"files\": [", options.repeat);
+  const char *separator = "\n";
+  for (const std::string &file : files) {
+    Run best;
+    for (int r = 0; r < options.repeat; r++) {
+      Run run = ReadFile(file, options);
+      if (r == 0 || (run.ok && run.read < best.read)) best = run;
+      if (!run.ok) break;
+    }
+    allOk = allOk && best.ok;
+
+    std::error_code ec;
+    uintmax_t bytes = std::filesystem::file_size(file, ec);
+    Json("%s", separator);
+    RunJson(file, ec ? 0 : bytes, best);
+    separator = ",\n";
+  }
+  Json("\n  ],\n  \"peak_rss_kb\": %ld\n}\n", PeakRssKb());
+  fflush(s_json);
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,410 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Deeprey Research Ltd                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+/**
+ * \file
+ * grib-gen: synthetic GRIB files for grib-bench and for trying the decoders.
+ *
+ * Writes a forecast of analytic fields, smooth functions of position and
+ * time, so that the same options always give the same file:
+ *
+ *   grib-gen [--edition 1|2] [--grid NIxNJ] [--step DEG] [--origin LAT,LON]
+ *            [--packing simple|complex|spatial|ieee|jpeg2000] [--bits N]
+ *            [--decimal D] [--bitmap] [--params LIST] [--steps N]
+ *            [--interval H] [--start YYYYMMDDHH] [--verify] FILE
+ *
+ * LIST is a comma separated subset of wind, pressure, temperature, gust,
+ * waves and current. --bitmap masks out land where the fields have no
+ * values. --verify reads the file back with GribReader and checks each
+ * field against what was encoded, within GribWriter::Tolerance().
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GribReader.h"
+#include "GribRecord.h"
+#include "GribWriter.h"
+
+namespace {
+
+const double DEG = M_PI / 180;
+
+struct Options {
+  int edition = 2;
+  int ni = 360, nj = 181;
+  double step = 1;
+  double lat1 = 90, lon1 = 0;
+  GribWriter::Packing packing = GribWriter::SIMPLE;
+  int bits = 0;  // 16, 32 for IEEE
+  int decimalScale = 0;
+  bool bitmap = false;
+  std::vector<std::string> params{"wind", "pressure"};
+  int steps = 24;
+  int interval = 3;
+  time_t start = 0;
+  bool verify = false;
+  std::string file;
+};
+
+// An analytic field at a position and forecast hour, phase going round
+// once a day
+typedef double (*Function)(double lon, double lat, double phase);
+
+double WindU(double lon, double lat, double phase) {
+  return 8 * std::cos(3 * lat * DEG + phase) + 4 * std::sin(2 * lon * DEG);
+}
+double WindV(double lon, double lat, double phase) {
+  return 6 * std::sin(3 * lon * DEG - phase) * std::cos(lat * DEG);
+}
+double Pressure(double lon, double lat, double phase) {
+  return 101325 +
+         1500 * std::sin(2 * lon * DEG + phase) * std::cos(2 * lat * DEG);
+}
+double Temperature(double lon, double lat, double phase) {
+  double s = std::sin(lat * DEG);
+  return 288 - 30 * s * s + 3 * std::sin(lon * DEG + phase);
+}
+double Gust(double lon, double lat, double phase) {
+  return 2 + 1.4 * std::hypot(WindU(lon, lat, phase), WindV(lon, lat, phase));
+}
+double Waves(double lon, double lat, double phase) {
+  return 1.5 +
+         1.2 * (1 + std::sin(2 * lon * DEG - phase)) * std::cos(lat * DEG);
+}
+double CurrentU(double, double lat, double) {
+  return 0.5 * std::sin(4 * lat * DEG);
+}
+double CurrentV(double lon, double, double phase) {
+  return 0.3 * std::cos(4 * lon * DEG + phase);
+}
+
+// Land, periodic in longitude like the fields
+bool IsLand(double lon, double lat) {
+  return std::sin(3 * lon * DEG) * std::cos(2 * lat * DEG) > 0.6;
+}
+
+struct Component {
+  const char *param;
+  int discipline, category, number;
+  int level2, value2;  // GRIB2 table 4.5
+  int parameter;       // GRIB1 table 2, the reader's data type too
+  int level1, value1;  // GRIB1 table 3, the reader's level type too
+  Function function;
+};
+
+const Component COMPONENTS[] = {
+    {"wind", 0, 2, 2, 103, 10, GRB_WIND_VX, LV_ABOV_GND, 10, WindU},
+    {"wind", 0, 2, 3, 103, 10, GRB_WIND_VY, LV_ABOV_GND, 10, WindV},
+    {"pressure", 0, 3, 1, 101, 0, GRB_PRESSURE, LV_MSL, 0, Pressure},
+    {"temperature", 0, 0, 0, 103, 2, GRB_TEMP, LV_ABOV_GND, 2, Temperature},
+    {"gust", 0, 2, 22, 1, 0, GRB_WIND_GUST, LV_GND_SURF, 0, Gust},
+    {"waves", 10, 0, 3, 1, 0, GRB_HTSGW, LV_GND_SURF, 0, Waves},
+    {"current", 10, 1, 2, 1, 0, GRB_UOGRD, LV_GND_SURF, 0, CurrentU},
+    {"current", 10, 1, 3, 1, 0, GRB_VOGRD, LV_GND_SURF, 0, CurrentV},
+};
+
+void Usage() {
+  fprintf(stderr,
+          "usage: grib-gen [--edition 1|2] [--grid NIxNJ] [--step DEG]\n"
+          "                [--origin LAT,LON] [--packing simple|complex|"
+          "spatial|ieee|jpeg2000]\n"
+          "                [--bits N] [--decimal D] [--bitmap] "
+          "[--params LIST]\n"
+          "                [--steps N] [--interval H] [--start YYYYMMDDHH]\n"
+          "                [--verify] FILE\n"
+          "LIST: comma separated, of wind, pressure, temperature, gust, "
+          "waves, current\n");
+}
+
+bool ParseInt(const char *text, int &value) {
+  char *end;
+  long v = strtol(text, &end, 10);
+  if (end == text || *end || v < INT32_MIN || v > INT32_MAX) return false;
+  value = (int)v;
+  return true;
+}
+
+bool ParsePair(const std::string &text, char separator, double &a,
+               double &b) {
+  size_t at = text.find(separator);
+  if (at == std::string::npos) return false;
+  char *end;
+  a = strtod(text.c_str(), &end);
+  if (end != text.c_str() + at) return false;
+  b = strtod(text.c_str() + at + 1, &end);
+  return end != text.c_str() + at + 1 && !*end;
+}
+
+bool ParsePacking(const std::string &text, GribWriter::Packing &packing) {
+  static const struct {
+    const char *name;
+    GribWriter::Packing packing;
+  } NAMES[] = {{"simple", GribWriter::SIMPLE},
+               {"complex", GribWriter::COMPLEX},
+               {"spatial", GribWriter::COMPLEX_SPATIAL},
+               {"ieee", GribWriter::IEEE},
+               {"jpeg2000", GribWriter::JPEG2000}};
+  for (const auto &name : NAMES) {
+    if (text == name.name) {
+      packing = name.packing;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseParams(const std::string &text, std::vector<std::string> &params) {
+  params.clear();
+  std::istringstream list(text);
+  std::string param;
+  while (std::getline(list, param, ',')) {
+    bool known = false;
+    for (const Component &c : COMPONENTS) known = known || param == c.param;
+    if (!known) return false;
+    params.push_back(param);
+  }
+  return !params.empty();
+}
+
+// YYYYMMDDHH, UTC
+bool ParseStart(const std::string &text, time_t &start) {
+  if (text.size() != 10 ||
+      text.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  struct tm date = {};
+  date.tm_year = atoi(text.substr(0, 4).c_str()) - 1900;
+  date.tm_mon = atoi(text.substr(4, 2).c_str()) - 1;
+  date.tm_mday = atoi(text.substr(6, 2).c_str());
+  date.tm_hour = atoi(text.substr(8, 2).c_str());
+#ifdef _WIN32
+  start = _mkgmtime(&date);
+#else
+  start = timegm(&date);
+#endif
+  return start != (time_t)-1;
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  // 2026-01-01 00:00 UTC
+  options.start = 1767225600;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--bitmap") {
+      options.bitmap = true;
+      continue;
+    }
+    if (arg == "--verify") {
+      options.verify = true;
+      continue;
+    }
+    if (arg.compare(0, 2, "--") != 0) {
+      if (!options.file.empty()) return false;
+      options.file = arg;
+      continue;
+    }
+    if (++i == argc) return false;
+    const char *value = argv[i];
+    double a, b;
+    bool ok;
+    if (arg == "--edition") {
+      ok = ParseInt(value, options.edition);
+    } else if (arg == "--grid") {
+      ok = ParsePair(value, 'x', a, b) && a >= 2 && b >= 2 && a <= 1e5 &&
+           b <= 1e5;
+      options.ni = (int)a;
+      options.nj = (int)b;
+    } else if (arg == "--step") {
+      options.step = strtod(value, nullptr);
+      ok = options.step >= 0.001 && options.step <= 90;
+    } else if (arg == "--origin") {
+      ok = ParsePair(value, ',', options.lat1, options.lon1);
+    } else if (arg == "--packing") {
+      ok = ParsePacking(value, options.packing);
+    } else if (arg == "--bits") {
+      ok = ParseInt(value, options.bits);
+    } else if (arg == "--decimal") {
+      ok = ParseInt(value, options.decimalScale) &&
+           std::abs(options.decimalScale) <= 10;
+    } else if (arg == "--params") {
+      ok = ParseParams(value, options.params);
+    } else if (arg == "--steps") {
+      ok = ParseInt(value, options.steps) && options.steps >= 1;
+    } else if (arg == "--interval") {
+      ok = ParseInt(value, options.interval) && options.interval >= 1;
+    } else if (arg == "--start") {
+      ok = ParseStart(value, options.start);
+    } else {
+      ok = false;
+    }
+    if (!ok) return false;
+  }
+  if (!options.bits)
+    options.bits = options.packing == GribWriter::IEEE ? 32 : 16;
+  if (options.edition == 1 && options.packing != GribWriter::SIMPLE) {
+    fprintf(stderr, "grib-gen: GRIB1 has simple packing only\n");
+    return false;
+  }
+  if (options.lat1 - (options.nj - 1) * options.step < -90) {
+    fprintf(stderr, "grib-gen: the grid goes south of the pole\n");
+    return false;
+  }
+  return !options.file.empty();
+}
+
+bool Wanted(const Options &options, const Component &component) {
+  return std::find(options.params.begin(), options.params.end(),
+                   component.param) != options.params.end();
+}
+
+GribWriter::Field MakeField(const Options &options, const Component &c,
+                            int hours, std::vector<double> &values) {
+  GribWriter::Field field;
+  field.edition = options.edition;
+  field.discipline = c.discipline;
+  field.category = c.category;
+  field.number = c.number;
+  field.parameter = c.parameter;
+  field.levelType = options.edition == 1 ? c.level1 : c.level2;
+  field.levelValue = options.edition == 1 ? c.value1 : c.value2;
+  field.process = options.edition == 1 ? 96 : 2;  // GFS
+  field.reference = options.start;
+  field.forecastHours = hours;
+  field.ni = options.ni;
+  field.nj = options.nj;
+  field.lat1 = options.lat1;
+  field.lon1 = options.lon1;
+  field.di = options.step;
+  field.dj = -options.step;
+  field.packing = options.packing;
+  field.bits = options.bits;
+  field.decimalScale = options.decimalScale;
+
+  double phase = 2 * M_PI * hours / 24;
+  values.resize((size_t)options.ni * options.nj);
+  for (int j = 0; j < options.nj; j++) {
+    double lat = field.lat1 + j * field.dj;
+    for (int i = 0; i < options.ni; i++) {
+      double lon = field.lon1 + i * field.di;
+      values[(size_t)j * options.ni + i] =
+          options.bitmap && IsLand(lon, lat) ? GRIB_NOTDEF
+                                             : c.function(lon, lat, phase);
+    }
+  }
+  field.values = values.data();
+  return field;
+}
+
+bool Generate(const Options &options) {
+  FILE *file = fopen(options.file.c_str(), "wb");
+  if (!file) {
+    fprintf(stderr, "grib-gen: can't create %s\n", options.file.c_str());
+    return false;
+  }
+  bool ok = true;
+  size_t messages = 0, bytes = 0;
+  std::vector<double> values;
+  std::vector<unsigned char> message;
+  for (int s = 0; s < options.steps && ok; s++) {
+    for (const Component &c : COMPONENTS) {
+      if (!Wanted(options, c)) continue;
+      GribWriter::Field field =
+          MakeField(options, c, s * options.interval, values);
+      message.clear();
+      if (!GribWriter::Encode(field, message)) {
+        fprintf(stderr, "grib-gen: can't encode %s with these options\n",
+                c.param);
+        ok = false;
+        break;
+      }
+      ok = fwrite(message.data(), 1, message.size(), file) == message.size();
+      if (!ok) break;
+      messages++;
+      bytes += message.size();
+    }
+  }
+  ok = fclose(file) == 0 && ok;
+  if (ok)
+    fprintf(stderr, "grib-gen: %zu messages, %zu bytes to %s\n", messages,
+            bytes, options.file.c_str());
+  return ok;
+}
+
+// Reads the file back, every field must be there and decode to the values
+// encoded
+bool Verify(const Options &options) {
+  GribReader reader;
+  reader.openFile(options.file);
+  if (!reader.isOk()) {
+    fprintf(stderr, "grib-gen: can't read back %s\n", options.file.c_str());
+    return false;
+  }
+  size_t fields = 0, failed = 0;
+  double worst = 0;  // greatest error as a fraction of the tolerance
+  std::vector<double> values;
+  for (int s = 0; s < options.steps; s++) {
+    int hours = s * options.interval;
+    for (const Component &c : COMPONENTS) {
+      if (!Wanted(options, c)) continue;
+      fields++;
+      GribWriter::Field field = MakeField(options, c, hours, values);
+      GribRecord *rec = reader.getGribRecord(c.parameter, c.level1, c.value1,
+                                             options.start + hours * 3600);
+      const double *decoded = rec && rec->isOk() ? rec->getValues() : nullptr;
+      if (!decoded || rec->getNi() != field.ni || rec->getNj() != field.nj) {
+        fprintf(stderr, "grib-gen: %s (%d) at +%dh missing\n", c.param,
+                c.parameter, hours);
+        failed++;
+        continue;
+      }
+      double tolerance = GribWriter::Tolerance(field);
+      size_t bad = 0;
+      for (size_t k = 0; k < values.size(); k++) {
+        bool missing = values[k] == GRIB_NOTDEF;
+        double error = std::fabs(decoded[k] - values[k]);
+        if (missing != (decoded[k] == GRIB_NOTDEF) ||
+            (!missing && error > tolerance)) {
+          if (!bad++)
+            fprintf(stderr,
+                    "grib-gen: %s (%d) at +%dh, point %zu: %g decoded as "
+                    "%g, tolerance %g\n",
+                    c.param, c.parameter, hours, k, values[k], decoded[k],
+                    tolerance);
+        } else if (!missing && tolerance > 0) {
+          worst = std::max(worst, error / tolerance);
+        }
+      }
+      if (bad) failed++;
+    }
+  }
+  fprintf(stderr, "grib-gen: %zu fields read back, %zu wrong", fields,
+          failed);
+  if (!failed) fprintf(stderr, ", worst error %.2f of tolerance", worst);
+  fprintf(stderr, "\n");
+  return failed == 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    Usage();
+    return 2;
+  }
+  if (!Generate(options)) return 1;
+  if (options.verify && !Verify(options)) return 1;
+  return 0;
+}